@@ -0,0 +1,64 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Disk-backed cache of DSPAnalysisResults
+// Each result is stored as one binary file named after a 64-bit hash of its
+// key; the full key is stored inside the file and checked on load. An index
+// file tracks entry sizes and last use, and the least recently used entries
+// are evicted once the cache grows past its size cap.
+//
+// The key is built by the caller and must describe everything the result
+// depends on (source file identity, item/take settings, analysis config).
+// Thread-safe.
+class MagdaAnalysisCache {
+public:
+  MagdaAnalysisCache(const std::string &directory, long long maxBytes);
+
+  // Returns true and fills result on a hit
+  bool Lookup(const std::string &key, DSPAnalysisResult &result);
+
+  // Store a successful result (failed results are ignored)
+  void Store(const std::string &key, const DSPAnalysisResult &result);
+
+  // Remove every entry
+  void Clear();
+
+  long long GetTotalBytes();
+  int GetNumEntries();
+
+  // Append the DSPAnalysisConfig fields that change analysis output
+  static void AppendConfigKey(const DSPAnalysisConfig &config, std::string &key);
+
+  // Binary (de)serialization, exposed for tests
+  static void Serialize(const std::string &key, const DSPAnalysisResult &result,
+                        std::vector<char> &out);
+  static bool Deserialize(const std::vector<char> &data, const std::string &key,
+                          DSPAnalysisResult &result);
+
+private:
+  struct Entry {
+    long long bytes;
+    long long lastUse;
+  };
+
+  void LoadIndex();
+  void SaveIndex() const;
+  bool EnsureDirectory() const;
+  void EvictToFit();
+  void RemoveEntry(unsigned long long hash);
+  std::string EntryPath(unsigned long long hash) const;
+  static unsigned long long HashKey(const std::string &key);
+
+  std::string m_directory;
+  long long m_maxBytes;
+  long long m_totalBytes;
+  long long m_useCounter;
+  bool m_loaded;
+  std::map<unsigned long long, Entry> m_entries;
+  std::mutex m_mutex;
+};
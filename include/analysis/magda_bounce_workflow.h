@@ -3,11 +3,14 @@
 #include "../WDL/WDL/wdlstring.h"
 #include "reaper_plugin.h"
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 
 // Forward declarations
 class MediaTrack;
+struct MultiTrackComparison;
+struct ReaperCommand;
 
 // Bounce mode preference - what to bounce
 enum BounceMode {
@@ -16,6 +19,12 @@ enum BounceMode {
   BOUNCE_MODE_SELECTION = 2   // Bounce time selection
 };
 
+// How the post-FX signal of a track is captured for analysis
+enum MixCaptureMode {
+  MIX_CAPTURE_TRACK_ACCESSOR = 0, // Track audio accessor when it hears the output, else bounce
+  MIX_CAPTURE_BOUNCE = 1          // Always render the item to a new take
+};
+
 // Current phase of mix analysis workflow
 enum MixAnalysisPhase {
   MIX_PHASE_IDLE = 0,
@@ -45,16 +54,21 @@ struct MixStreamingState {
 using MixAnalysisCallback = std::function<void(bool success, const std::string &result)>;
 
 // Mix analysis bounce workflow
-// Workflow structure:
+// By default the selected track is read directly through a track audio
+// accessor (no render, nothing to clean up). Accessor samples are pre-FX, so
+// the bounce below is used for tracks the accessor can't fully hear (active
+// track FX, folder parents, tracks with receives) or when the accessor read
+// fails.
+//
+// Bounce workflow structure:
 // 1. Prepare track (copy, hide, select item) - Synchronous (safe from callback)
 // 2. Render item to take - Queued, executed on main thread (outside callback)
 // 3. DSP Analysis - Synchronous (in async thread)
 // 4. API Call - Asynchronous (in async thread)
 // 5. Delete track - Queued, executed on main thread (outside callback)
 //
-// Reaper commands (render, delete) are queued and processed via
-// ProcessCommandQueue() which is called from the timer callback on the main
-// thread.
+// Reaper commands (render, delete) are posted to MagdaMainThreadQueue, which
+// the timer runs on the main thread within a per-tick time budget.
 class MagdaBounceWorkflow {
 public:
   // Execute the full workflow for a selected track:
@@ -72,7 +86,9 @@ public:
 
   // Execute multi-track comparison workflow
   // Parses track identifiers from compareArgs (e.g., "track1 and track2" or
-  // "selected") Analyzes multiple tracks and sends them together for comparison
+  // "selected"). Renders are queued one per timer tick; each finished render
+  // is analyzed on the worker pool while the next one runs, and a single
+  // request with every track goes out when the last analysis finishes.
   static bool ExecuteMultiTrackWorkflow(const char *compareArgs, WDL_FastString &error_msg);
 
   // Set callback for when mix analysis completes
@@ -107,19 +123,20 @@ public:
   // Set current analysis phase (called by workflow)
   static void SetCurrentPhase(MixAnalysisPhase phase);
 
+  // Progress (0-1) within the current phase, or -1 if unknown. Reset by
+  // SetCurrentPhase().
+  static float GetPhaseProgress();
+  static void SetPhaseProgress(float progress);
+
   // Get current bounce mode preference from settings
   static BounceMode GetBounceModePreference();
 
   // Set bounce mode preference in settings
   static void SetBounceModePreference(BounceMode mode);
 
-  // Process queued Reaper commands (must be called from main thread, outside
-  // callbacks) Returns true if any commands were processed
-  static bool ProcessCommandQueue();
-
-  // Process cleanup queue (delete tracks)
-  // Returns true if any tracks were deleted
-  static bool ProcessCleanupQueue();
+  // Capture mode preference (persisted in REAPER's extended state)
+  static MixCaptureMode GetCaptureModePreference();
+  static void SetCaptureModePreference(MixCaptureMode mode);
 
 private:
   // Step 1: Bounce track to new track
@@ -138,4 +155,21 @@ private:
   static bool SendToMixAPI(const char *analysisJson, const char *fxJson, const char *trackType,
                            const char *userRequest, int trackIndex, const char *trackName,
                            WDL_FastString &responseJson, WDL_FastString &error_msg);
+
+  // Send one track's analysis to the mix API from a detached thread
+  static void StartMixAPIThread(const std::string &analysisJson, const std::string &fxJson,
+                                const std::string &trackName, const std::string &trackType,
+                                const std::string &userRequest, int selectedTrackIndex);
+
+  // Record one comparison track's analysis JSON (empty = failed). The call
+  // that completes the comparison sends the combined request.
+  static void FinishComparisonTrack(const std::shared_ptr<MultiTrackComparison> &comparison,
+                                    int slot, const std::string &analysisJson);
+
+  // Post cmd to the main-thread queue
+  static void QueueCommand(const ReaperCommand &cmd);
+
+  // One main-thread step of cmd. Returns false to run again on the next tick
+  // (render rate limit, rendered file not yet stable).
+  static bool RunCommand(ReaperCommand &cmd);
 };
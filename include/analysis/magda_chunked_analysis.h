@@ -0,0 +1,80 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include "magda_sample_ring.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class MagdaDSPStream;
+
+// Cooperative analysis of a source that can only be read on the main thread
+// Step() is called once per timer tick and reads blocks until its time
+// budget (or frame cap) is used up, pushing them into a ring buffer. Worker
+// pool tasks drain the ring through MagdaDSPStream as blocks arrive, so the
+// main thread only ever pays for one step of accessor reads and the DSP
+// never runs there. Once the source is exhausted and the ring is empty,
+// onDone receives the result on a worker thread. Sources that don't need the
+// main thread (NeedsMainThread() false) are read and analyzed by a single
+// pool task instead, and Step() only reports whether reading is over.
+class MagdaChunkedAnalysis : public std::enable_shared_from_this<MagdaChunkedAnalysis> {
+public:
+  using DoneCallback = std::function<void(DSPAnalysisResult &result)>;
+
+  // Main thread. A main-thread source is read and destroyed by Step() only.
+  static std::shared_ptr<MagdaChunkedAnalysis> Start(std::unique_ptr<MagdaBlockSource> source,
+                                                     const DSPAnalysisConfig &config,
+                                                     DoneCallback onDone);
+
+  ~MagdaChunkedAnalysis();
+
+  MagdaChunkedAnalysis(const MagdaChunkedAnalysis &) = delete;
+  MagdaChunkedAnalysis &operator=(const MagdaChunkedAnalysis &) = delete;
+
+  // Main thread: read until budgetMs has elapsed, maxFrames frames were read
+  // (0 = no cap) or the ring is full. Returns true once reading is over and
+  // the source has been closed; the result follows on a worker thread.
+  bool Step(double budgetMs, long long maxFrames = 0);
+
+  // Share of the source analyzed so far (0-1)
+  float GetProgress() const;
+
+  // True once onDone has run
+  bool IsDone() const { return m_done.load(); }
+
+private:
+  MagdaChunkedAnalysis(std::unique_ptr<MagdaBlockSource> source, const DSPAnalysisConfig &config,
+                       DoneCallback onDone);
+
+  // Close the source and let the drain task finish up (main thread)
+  void FinishReading(bool failed);
+  // Start a drain task unless one is already running
+  void ScheduleDrain();
+  void Drain();
+  // Pool task for sources that may be read from any thread
+  void ReadOffThread();
+
+  DSPAnalysisConfig m_config;
+  DoneCallback m_onDone;
+  int m_channels;
+  int m_blockFrames;
+  long long m_totalFrames;
+
+  // Producer side (main thread)
+  std::unique_ptr<MagdaBlockSource> m_source;
+  std::vector<float> m_readBlock;
+  long long m_framesRead;
+
+  MagdaSampleRing m_ring;
+  std::atomic<bool> m_readDone;
+  std::atomic<bool> m_readFailed;
+  std::atomic<bool> m_draining; // A drain task owns the consumer side
+  std::atomic<bool> m_done;
+  std::atomic<long long> m_framesAnalyzed;
+  bool m_offThread; // Set before the read task starts
+
+  // Consumer side (whichever drain task is running)
+  std::unique_ptr<MagdaDSPStream> m_stream;
+  std::vector<float> m_drainBlock;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../WDL/WDL/wdlstring.h"
+#include <vector>
+
+// Compact number output for analysis JSON
+// Values are rounded to a fixed number of decimals and formatted with
+// integer arithmetic (no snprintf per value). Trailing zeros are dropped and
+// non-finite values are written as 0, so arrays stay short and valid JSON.
+class MagdaCompactJSON {
+public:
+  static const int kMaxNumberChars = 32;
+
+  // Write value into out (at least kMaxNumberChars bytes), returns the length
+  static int FormatFixed(double value, int decimals, char *out);
+
+  static void AppendNumber(WDL_FastString &json, double value, int decimals);
+
+  // Quoted, escaped string (control characters other than newline dropped)
+  static void AppendString(WDL_FastString &json, const char *text);
+
+  // ,"name":[v0,v1,...] (no leading comma when first is true)
+  static void AppendArray(WDL_FastString &json, const char *name, const float *values, int count,
+                          int decimals, bool first);
+
+  // Reduce a linear-bin spectrum in dB to numBands log-spaced bands between
+  // minHz and maxHz. Band levels are energy averages of the bins inside the
+  // band (or the nearest bin for bands narrower than a bin).
+  static void LogBinSpectrum(const std::vector<float> &frequencies,
+                             const std::vector<float> &magnitudesDb, int numBands, float minHz,
+                             float maxHz, std::vector<float> &centresHz,
+                             std::vector<float> &levelsDb);
+};
@@ -1,21 +1,37 @@
 #pragma once
 
 #include "../WDL/WDL/wdlstring.h"
-#include "reaper_plugin.h"
+#include "magda_feature_frames.h"
+#include "magda_onsets.h"
+#include "magda_true_peak.h"
 #include <cmath>
+#include <memory>
+#include <string>
 #include <vector>
 
 // Forward declarations (use class to match REAPER SDK)
 class MediaTrack;
 class MediaItem;
 class MediaItem_Take;
+class MagdaMultiResSpectrum;
 
 // DSP Analysis configuration
 struct DSPAnalysisConfig {
-  int fftSize = 4096;           // FFT window size
-  int hopSize = 2048;           // FFT hop size (overlap)
-  float analysisLength = 10.0f; // Max seconds to analyze (0 = full item)
-  bool analyzeFullItem = true;  // Analyze entire item vs. selection
+  int fftSize = 4096;                  // FFT window size
+  int hopSize = 2048;                  // FFT hop size (overlap)
+  float analysisLength = 10.0f;        // Max seconds to analyze (0 = full item)
+  bool analyzeFullItem = true;         // Analyze entire item vs. selection
+  int streamBlockSize = 16384;         // Frames per block when streaming from an audio accessor
+  int truePeakOversampling = 4;        // True-peak interpolation factor (BS.1770: 4x)
+  float truePeakOverThreshold = -1.0f; // dBTP above which inter-sample overs are reported
+  int analysisThreads = 0;             // Threads for STFT windows (0 = all cores)
+  bool useCache = true;                // Reuse results from the on-disk analysis cache
+  int featureFrameBudget = 256;        // Max time-resolved frames (longer items are decimated)
+  int featureFrameBands = 24;          // Log-spaced bands per time-resolved frame
+  bool criticalBandFrames = false;     // Frames use critical (Bark) bands, not featureFrameBands
+  int maxOnsets = 512;                 // Strongest onsets kept in the result
+  float silenceGateDb = -70.0f;        // Window RMS (dBFS) below which the FFT is skipped
+  bool multiResolutionBands = true;    // Low bands/EQ profile from decimated long windows
 
   // What to analyze
   bool analyzeFrequency = true;
@@ -25,6 +41,7 @@ struct DSPAnalysisConfig {
   bool analyzeStereo = true;
   bool analyzeTransients = true;
   bool analyzeSpectralFeatures = true;
+  bool analyzeFeatureFrames = false; // Time-resolved band energies/centroid/flatness/RMS
 };
 
 // Frequency band energy levels (dB)
@@ -68,11 +85,13 @@ struct SpectralFeatures {
 
 // Loudness analysis
 struct LoudnessAnalysis {
-  float rms;           // dB RMS
-  float lufs;          // Integrated LUFS (approximation)
-  float lufsShortTerm; // Short-term LUFS
-  float peak;          // dB peak
-  float truePeak;      // dB True Peak (interpolated)
+  float rms;              // dB RMS
+  float lufs;             // Integrated LUFS (BS.1770 gated)
+  float lufsShortTerm;    // Max short-term (3 s) LUFS
+  float lufsMomentaryMax; // Max momentary (400 ms) LUFS
+  float loudnessRange;    // LRA (LU, EBU Tech 3342)
+  float peak;             // dB peak
+  float truePeak;         // dB True Peak (interpolated)
 };
 
 // Dynamics analysis
@@ -84,15 +103,28 @@ struct DynamicsAnalysis {
 
 // Stereo analysis
 struct StereoAnalysis {
-  float width;       // 0=mono, 1=full stereo
-  float correlation; // L/R correlation (-1 to 1)
-  float balance;     // -1=L, 0=center, 1=R
+  float width;               // 0=mono, 1=full stereo
+  float correlation;         // L/R correlation (-1 to 1)
+  float balance;             // -1=L, 0=center, 1=R
+  float lowEndCorrelation;   // L/R correlation below 120 Hz (from the STFT)
+  bool lowEndMonoCompatible; // Low end keeps its level when folded to mono
+};
+
+// Stereo image of one frequency band (mid/side spectra of the STFT)
+struct StereoBand {
+  float lowFreq;     // Hz
+  float highFreq;    // Hz
+  float midLevel;    // dB, mean mid power per bin
+  float sideLevel;   // dB, mean side power per bin
+  float correlation; // L/R correlation in the band (-1 to 1)
+  float width;       // Side/mid ratio (0=mono, 1=full stereo)
 };
 
 // Transient analysis
 struct TransientAnalysis {
-  float attackTime;      // seconds
-  float transientEnergy; // 0-1
+  float attackTime;      // Median onset attack (seconds)
+  float transientEnergy; // Share of spectral flux on onsets (0-1)
+  float onsetRate;       // Onsets per second
 };
 
 // Raw audio data (for passing between threads)
@@ -103,6 +135,25 @@ struct RawAudioData {
   int channels = 0;
 };
 
+// Interleaved float blocks from an analysis source. Audio accessor sources
+// must be read (and destroyed) on the main thread; see NeedsMainThread().
+class MagdaBlockSource {
+public:
+  virtual ~MagdaBlockSource() {}
+
+  // Read up to maxFrames interleaved frames into out. Returns frames read,
+  // 0 at the end, -1 on error.
+  virtual int ReadBlock(float *out, int maxFrames) = 0;
+
+  virtual int GetSampleRate() const = 0;
+  virtual int GetChannels() const = 0;
+  virtual long long GetTotalFrames() const = 0;
+  // True once any block came back with audio
+  virtual bool HadAudio() const = 0;
+  // False if blocks may be read from any thread
+  virtual bool NeedsMainThread() const { return true; }
+};
+
 // Complete analysis result
 struct DSPAnalysisResult {
   bool success = false;
@@ -112,6 +163,7 @@ struct DSPAnalysisResult {
   int sampleRate = 0;
   int channels = 0;
   double lengthSeconds = 0.0;
+  double activeSeconds = 0.0; // Time above the silence gate (spectrum is averaged over it)
 
   // Frequency analysis
   std::vector<float> fftFrequencies; // Frequency bins (Hz)
@@ -127,32 +179,81 @@ struct DSPAnalysisResult {
   // Other analysis
   SpectralFeatures spectralFeatures;
   LoudnessAnalysis loudness;
+  std::vector<TruePeakOver> truePeakOvers; // Worst true-peak overs, loudest first
   DynamicsAnalysis dynamics;
   StereoAnalysis stereo;
+  std::vector<StereoBand> stereoBands; // Per FrequencyBands range (stereo input only)
   TransientAnalysis transients;
+  std::vector<Onset> onsets; // Spectral-flux onsets in time order
+
+  // Time-resolved features (empty unless analyzeFeatureFrames is set)
+  FeatureFrames featureFrames;
+};
+
+// ToJSON output size controls
+// Arrays are written with fixed precision. With a byte budget, the detail
+// sections (feature frames, onset list, spectrum bands) are thinned until
+// the output fits; the scalar summary is always complete.
+struct DSPJSONOptions {
+  int spectrumBands = 0; // Log-spaced bands for the averaged spectrum (0 = leave out)
+  int maxBytes = 0;      // Approximate output cap (0 = no cap)
 };
 
 // DSP Analyzer class
 class MagdaDSPAnalyzer {
+  friend class MagdaDSPStream;
+
 public:
   // Analyze a specific track (pre-FX or post-FX audio)
   static DSPAnalysisResult AnalyzeTrack(int trackIndex, const DSPAnalysisConfig &config);
 
   // Analyze a specific media item
+  // Streams the take through the analyzer in streamBlockSize blocks, so memory
+  // stays bounded and the full item can be analyzed (MUST be called from main
+  // thread)
   static DSPAnalysisResult AnalyzeItem(MediaItem *item, const DSPAnalysisConfig &config);
 
+  // Check that a track audio accessor hears everything the track outputs
+  // (not a folder parent, no receives, no active track FX, accessor API
+  // present); reason says why not. MUST be called from main thread.
+  static bool CanAnalyzeTrackOutput(int trackIndex, WDL_FastString &reason);
+
+  // Analyze a track's output through a track audio accessor, with no render
+  // or track copy. Accessor samples are pre-FX, so this is the track's output
+  // only when CanAnalyzeTrackOutput() says so. Streams [startTime, endTime) in streamBlockSize
+  // blocks (endTime <= startTime = whole track). MUST be called from main
+  // thread.
+  static DSPAnalysisResult AnalyzeTrackOutput(int trackIndex, const DSPAnalysisConfig &config,
+                                              double startTime = 0.0, double endTime = 0.0);
+
   // Analyze the master track
   static DSPAnalysisResult AnalyzeMaster(const DSPAnalysisConfig &config);
 
   // Read raw audio samples from track (MUST be called from main thread)
   static RawAudioData ReadTrackSamples(int trackIndex, const DSPAnalysisConfig &config);
 
+  // Block sources for MagdaChunkedAnalysis: the active take of a track's
+  // first item (full length), or the track's output as in
+  // AnalyzeTrackOutput(). nullptr on error. MUST be called from main thread.
+  // Plain WAV/AIFF takes (no FX, envelopes, fades, volume or pan changes)
+  // are decoded from the mapped file and can be read from any thread
+  // (NeedsMainThread() is false).
+  static std::unique_ptr<MagdaBlockSource> OpenTakeSource(int trackIndex,
+                                                          const DSPAnalysisConfig &config,
+                                                          WDL_FastString &error_msg);
+  static std::unique_ptr<MagdaBlockSource> OpenTrackOutputSource(int trackIndex,
+                                                                 const DSPAnalysisConfig &config,
+                                                                 double startTime, double endTime,
+                                                                 WDL_FastString &error_msg);
+
   // Analyze pre-loaded samples (can be called from background thread)
+  // Runs the same streaming pipeline as AnalyzeItem over the buffer
   static DSPAnalysisResult AnalyzeSamples(const RawAudioData &audioData,
                                           const DSPAnalysisConfig &config);
 
-  // Convert analysis result to JSON string
-  static void ToJSON(const DSPAnalysisResult &result, WDL_FastString &json);
+  // Convert analysis result to JSON string (see DSPJSONOptions for size control)
+  static void ToJSON(const DSPAnalysisResult &result, WDL_FastString &json,
+                     const DSPJSONOptions &options = DSPJSONOptions());
 
   // Get FX info for a track
   static void GetTrackFXInfo(int trackIndex, WDL_FastString &json);
@@ -162,21 +263,26 @@ private:
   static bool GetAudioSamples(MediaItem_Take *take, std::vector<float> &samples, int &sampleRate,
                               int &channels, const DSPAnalysisConfig &config);
 
-  // FFT analysis
-  static void PerformFFT(const std::vector<float> &samples, int sampleRate, int fftSize,
-                         std::vector<float> &frequencies, std::vector<float> &magnitudes);
+  // Get the active take of the first item on a track (nullptr if none)
+  static MediaItem_Take *GetFirstItemTake(int trackIndex);
 
-  // Simple DFT for when REAPER FFT isn't available
-  static void SimpleDFT(const float *input, int N, float *realOut, float *imagOut);
+  // Build the analysis cache key for a take (source file identity, item/take
+  // settings including volume, pan and fades, take envelope state, config).
+  // Returns false if the take can't be cached.
+  static bool BuildCacheKey(MediaItem *item, MediaItem_Take *take, const DSPAnalysisConfig &config,
+                            std::string &key);
 
-  // Calculate frequency bands from FFT
+  // Calculate frequency bands from FFT. With multiRes, the bands it
+  // resolves better (the low end) come from its decimated levels.
   static void CalculateFrequencyBands(const std::vector<float> &frequencies,
-                                      const std::vector<float> &magnitudes, FrequencyBands &bands);
+                                      const std::vector<float> &magnitudes, FrequencyBands &bands,
+                                      const MagdaMultiResSpectrum *multiRes = nullptr);
 
-  // Calculate 1/3 octave EQ profile
+  // Calculate 1/3 octave EQ profile (multiRes as above)
   static void CalculateEQProfile(const std::vector<float> &frequencies,
                                  const std::vector<float> &magnitudes, std::vector<float> &eqFreqs,
-                                 std::vector<float> &eqMags);
+                                 std::vector<float> &eqMags,
+                                 const MagdaMultiResSpectrum *multiRes = nullptr);
 
   // Detect peaks in spectrum
   static void DetectPeaks(const std::vector<float> &frequencies,
@@ -192,20 +298,6 @@ private:
   static SpectralFeatures CalculateSpectralFeatures(const std::vector<float> &frequencies,
                                                     const std::vector<float> &magnitudes);
 
-  // Calculate loudness metrics
-  static LoudnessAnalysis CalculateLoudness(const std::vector<float> &samples, int sampleRate,
-                                            int channels);
-
-  // Calculate dynamics metrics
-  static DynamicsAnalysis CalculateDynamics(const std::vector<float> &samples, int channels);
-
-  // Calculate stereo metrics
-  static StereoAnalysis CalculateStereo(const std::vector<float> &samples, int channels);
-
-  // Calculate transient metrics
-  static TransientAnalysis CalculateTransients(const std::vector<float> &samples, int sampleRate,
-                                               int channels);
-
   // Utility: dB conversion
   static float LinearToDb(float linear) {
     if (linear <= 0.0f)
@@ -217,8 +309,4 @@ private:
 
   // Utility: Hann window
   static float HannWindow(int n, int N) { return 0.5f * (1.0f - cosf(2.0f * M_PI * n / (N - 1))); }
-
-  // JSON helpers
-  static void AppendFloatArray(WDL_FastString &json, const char *name,
-                               const std::vector<float> &arr, bool first = false);
 };
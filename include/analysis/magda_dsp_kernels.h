@@ -0,0 +1,40 @@
+#pragma once
+
+// Running time-domain statistics for one stream of interleaved audio.
+// Everything the loudness, dynamics and stereo stages need comes out of these
+// sums, so the samples only have to be read once.
+struct TimeDomainStats {
+  double sumSquares = 0.0; // Sum of x^2 over all channels
+  float peak = 0.0f;       // Max |x| over all channels
+  long long sampleCount = 0;
+
+  // First two channels only (left untouched for mono input)
+  double sumL2 = 0.0;
+  double sumR2 = 0.0;
+  double sumLR = 0.0;
+};
+
+// Fused single-pass time-domain kernel
+// One pass over an interleaved block updates TimeDomainStats and writes the
+// per-frame channel mean (for the STFT), mean absolute level (for the
+// transient envelope) and side signal (L-R)/2 (for the per-band stereo
+// image). Mono and stereo use SIMD (SSE2/AVX2 picked at runtime on x86, NEON
+// on ARM); other channel counts use the scalar path.
+class MagdaDSPKernels {
+public:
+  // monoOut, monoAbsOut and sideOut must hold numFrames floats each (any
+  // may be nullptr if not needed). Side is taken from the first two channels
+  // and is silence for mono input.
+  static void AccumulateTimeDomain(const float *interleaved, int numFrames, int channels,
+                                   TimeDomainStats &stats, float *monoOut, float *monoAbsOut,
+                                   float *sideOut = nullptr);
+
+  // Plain C++ reference implementation (used for odd channel counts and tests)
+  static void AccumulateTimeDomainScalar(const float *interleaved, int numFrames, int channels,
+                                         TimeDomainStats &stats, float *monoOut,
+                                         float *monoAbsOut, float *sideOut = nullptr);
+
+  // Name of the instruction set the dispatcher picked ("avx2", "sse2",
+  // "neon" or "scalar")
+  static const char *GetActiveISA();
+};
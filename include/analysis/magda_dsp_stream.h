@@ -0,0 +1,74 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include "magda_dsp_kernels.h"
+#include "magda_feature_frames.h"
+#include "magda_loudness.h"
+#include "magda_multires_spectrum.h"
+#include "magda_onsets.h"
+#include "magda_stft.h"
+#include "magda_true_peak.h"
+#include <memory>
+#include <vector>
+
+// Incremental (streaming) DSP analysis
+// Audio is pushed through Process() in interleaved float blocks of any size,
+// in order. Each block is read once by the fused time-domain kernel (levels,
+// stereo sums, mono downmix, side signal), then the STFT runs on the downmix
+// (and the side, for the per-band stereo image) and feeds its windows to the
+// onset and feature-frame stages; the multi-resolution spectrum decimates the
+// same downmix for the low EQ-profile bands. Finish() turns the running state
+// into a DSPAnalysisResult; Snapshot() does the same mid-stream, for live
+// metering.
+//
+// Memory use depends on the FFT size only, not on how much audio is pushed
+// through, so full-item analysis of long masters stays cheap.
+class MagdaDSPStream {
+public:
+  // expectedFrames (if known) lets time-resolved features use their whole
+  // frame budget; 0 = unknown length
+  MagdaDSPStream(int sampleRate, int channels, const DSPAnalysisConfig &config,
+                 long long expectedFrames = 0);
+  ~MagdaDSPStream();
+
+  // Feed numFrames frames of interleaved audio (numFrames * channels floats)
+  void Process(const float *interleaved, int numFrames);
+
+  // Finalize and build the result (call once, after the last block)
+  DSPAnalysisResult Finish();
+
+  // Result for the audio processed so far; Process() can carry on after it.
+  // Costs depend on the FFT size and the length so far, not on block count.
+  DSPAnalysisResult Snapshot();
+
+  long long GetFramesProcessed() const { return m_framesProcessed; }
+  int GetSampleRate() const { return m_sampleRate; }
+  int GetChannels() const { return m_channels; }
+
+private:
+  // STFT window hook: hands each window to the per-window stages
+  void ProcessWindow(const float *samples, const float *magnitudes);
+
+  // Finish() (final) or Snapshot()
+  DSPAnalysisResult BuildResult(bool final);
+
+  DSPAnalysisConfig m_config;
+  int m_sampleRate;
+  int m_channels;
+  long long m_framesProcessed;
+
+  // Spectrum (STFT over the downmix, windows run on the worker pool)
+  std::unique_ptr<MagdaSTFT> m_stft;
+  std::unique_ptr<MagdaFeatureFrameBuilder> m_featureFrames; // Fed per STFT window
+  std::unique_ptr<MagdaOnsetDetector> m_onsets;              // Fed per STFT window
+  std::unique_ptr<MagdaMultiResSpectrum> m_multiRes;         // Low-end bands, fed the downmix
+
+  // Level + stereo state (loudness, dynamics, stereo)
+  TimeDomainStats m_timeStats;
+  std::vector<float> m_mono; // Per-frame channel mean of the current block
+  std::vector<float> m_side; // Per-frame (L-R)/2 of the current block (stereo STFT only)
+
+  // BS.1770 loudness (K-weighted, gated)
+  std::unique_ptr<MagdaLoudnessMeter> m_loudness;
+  std::unique_ptr<MagdaTruePeakDetector> m_truePeak;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+// Time-resolved spectral descriptors, stored column-wise (one array per
+// feature) so long items stay compact and easy to slice
+struct FeatureFrames {
+  double startSeconds = 0.0;       // Start of the first frame
+  double frameSeconds = 0.0;       // Time covered by each frame
+  std::vector<float> bandEdges;    // numBands + 1 band edges (Hz)
+  std::vector<float> rms;          // Per frame level (dB)
+  std::vector<float> centroid;     // Per frame spectral centroid (Hz)
+  std::vector<float> flatness;     // Per frame flatness (0=tonal, 1=noise-like)
+  std::vector<float> bandEnergies; // Band energy (dB), band-major: [band * numFrames + frame]
+
+  int GetNumFrames() const { return (int)rms.size(); }
+  int GetNumBands() const { return bandEdges.empty() ? 0 : (int)bandEdges.size() - 1; }
+};
+
+// Builds FeatureFrames from STFT windows
+// Windows are added in order and summed into frames of windowsPerFrame
+// windows each. Whenever the frame count reaches maxFrames, neighbouring
+// frames are merged pairwise and windowsPerFrame doubles, so memory and
+// output size stay bounded no matter how long the input is.
+class MagdaFeatureFrameBuilder {
+public:
+  // expectedWindows (if known) sets the initial decimation so the output
+  // uses most of the frame budget; 0 starts at one window per frame
+  MagdaFeatureFrameBuilder(int sampleRate, int fftSize, int hopSize, int numBands, int maxFrames,
+                           long long expectedWindows = 0);
+
+  // Same, with explicit band edges (ascending, at least two)
+  MagdaFeatureFrameBuilder(int sampleRate, int fftSize, int hopSize,
+                           const std::vector<float> &bandEdges, int maxFrames,
+                           long long expectedWindows = 0);
+
+  // numBands log-spaced bands from 20 Hz to 20 kHz (or Nyquist)
+  static std::vector<float> LogBandEdges(int sampleRate, int numBands);
+
+  // Zwicker's critical bands (Bark scale) up to Nyquist
+  static std::vector<float> CriticalBandEdges(int sampleRate);
+
+  // One analysis window: fftSize time samples and fftSize/2+1 magnitudes
+  void AddWindow(const float *samples, const float *magnitudes);
+
+  // Convert the accumulated frames (including a partial last one)
+  void Finish(FeatureFrames &out) const;
+
+  int GetWindowsPerFrame() const { return m_windowsPerFrame; }
+  int GetNumFrames() const;
+
+  // Merge every `factor` consecutive frames of in (levels are averaged as
+  // power, centroid and flatness as plain means)
+  static void Decimate(const FeatureFrames &in, int factor, FeatureFrames &out);
+
+private:
+  void CommitFrame();
+  void MergePairs();
+
+  int m_sampleRate;
+  int m_fftSize;
+  int m_hopSize;
+  int m_numBins;
+  int m_numBands;
+  int m_maxFrames;
+  int m_windowsPerFrame;
+
+  std::vector<float> m_bandEdges;
+  std::vector<int> m_bandFirstBin; // First bin of each band
+  std::vector<int> m_bandLastBin;  // One past the last bin of each band
+
+  // Linear sums per committed frame; band power is frame-major while
+  // building so pairwise merges stay contiguous
+  std::vector<double> m_power;
+  std::vector<double> m_spectralEnergy;
+  std::vector<double> m_weightedFrequency;
+  std::vector<double> m_flatness;
+  std::vector<double> m_bandPower;
+
+  // Frame being filled
+  int m_pendingWindows;
+  double m_pendingPower;
+  double m_pendingEnergy;
+  double m_pendingWeighted;
+  double m_pendingFlatness;
+  std::vector<double> m_pendingBands;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// Real-input FFT plan for one transform size.
+// Power-of-two sizes use a mixed radix-4/radix-2 complex FFT of size N/2 plus a
+// real-to-complex split step. Other sizes fall back to a table-driven DFT (no
+// per-sample trig calls, but still O(N^2)).
+//
+// A plan is immutable after construction, so a single plan can be used from
+// several threads at once as long as each thread passes its own work buffer.
+class MagdaFFTPlan {
+public:
+  explicit MagdaFFTPlan(int size);
+
+  int GetSize() const { return m_size; }
+  int GetNumBins() const { return m_size / 2 + 1; }
+
+  // Number of floats the caller must provide as work buffer for Forward()
+  int GetWorkSize() const { return m_size + 2; }
+
+  // Hann window of length size, same shape as MagdaDSPAnalyzer::HannWindow()
+  const float *GetWindow() const { return m_window.data(); }
+
+  // Forward transform of `size` real samples into size/2+1 complex bins.
+  // Output is unnormalized (matches a textbook DFT with e^-j sign).
+  // `work` must point to at least GetWorkSize() floats.
+  void Forward(const float *input, float *realOut, float *imagOut, float *work) const;
+
+private:
+  void ComplexFFT(float *data) const; // In-place, interleaved re/im, size m_half
+  void DirectDFT(const float *input, float *realOut, float *imagOut) const;
+
+  int m_size;
+  int m_half;
+  bool m_powerOfTwo;
+  bool m_leadingRadix2; // log2(m_half) is odd: one radix-2 pass before radix-4 passes
+
+  std::vector<int> m_bitReverse;     // Permutation for the size m_half complex FFT
+  std::vector<float> m_stageTwiddle; // Per radix-4 stage: (w1, w2, w3) re/im for each k
+  std::vector<float> m_splitTwiddle; // e^(-j*2*pi*k/N) for the real split step
+  std::vector<float> m_dftTable;     // cos/sin table for the non power-of-two fallback
+  std::vector<float> m_window;
+};
+
+// Process-wide plan cache. Plans are built on first use and shared by every
+// caller asking for the same size.
+class MagdaFFT {
+public:
+  static std::shared_ptr<const MagdaFFTPlan> GetPlan(int size);
+
+  // Drop all cached plans (plans still held by callers stay valid)
+  static void ClearCache();
+
+  static bool IsPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include <mutex>
+
+// Two overlapping analysis segments over live playback, staggered by half
+// a span. Each starts over once it holds spanFrames, so the older one always
+// covers between half the span and the whole span of the latest playback.
+// The live meter keeps a running analysis per segment, so a result is ready
+// at any time without keeping the audio or re-analyzing it.
+class MagdaLiveSegments {
+public:
+  static const int kSegments = 2;
+
+  explicit MagdaLiveSegments(long long spanFrames = 2);
+
+  // Start over with segment 0 running and empty (spanFrames >= 2)
+  void Reset(long long spanFrames);
+
+  // Frames that can be counted before a segment starts or starts over
+  long long GetFramesUntilChange() const;
+
+  // Count frames (at most GetFramesUntilChange()) into the running
+  // segments. Returns the segment that starts (over) empty after them, or -1.
+  int Advance(long long frames);
+
+  bool IsRunning(int segment) const { return m_running[segment]; }
+  long long GetFrames(int segment) const { return m_frames[segment]; }
+  long long GetSpanFrames() const { return m_spanFrames; }
+
+  // Running segment covering the most playback
+  int GetOldest() const;
+
+private:
+  long long m_spanFrames;
+  long long m_frames[kSegments];
+  bool m_running[kSegments];
+};
+
+// Latest live analysis and when it was made
+// Times are seconds on any monotonic clock the caller chooses. Thread-safe.
+class MagdaLiveResult {
+public:
+  MagdaLiveResult();
+
+  void Publish(DSPAnalysisResult result, double seconds, double now);
+  void Reset();
+
+  // The latest result if it covers at least minSeconds of playback and was
+  // made at most maxAge seconds before now
+  bool Get(double minSeconds, double maxAge, double now, DSPAnalysisResult &result,
+           double &seconds) const;
+
+private:
+  mutable std::mutex m_mutex;
+  DSPAnalysisResult m_result;
+  bool m_hasResult;
+  double m_seconds; // Playback the result covers
+  double m_time;    // When it was published
+};
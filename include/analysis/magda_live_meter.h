@@ -0,0 +1,93 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include "magda_dsp_stream.h"
+#include "magda_live_history.h"
+#include "magda_sample_ring.h"
+#include "reaper_plugin.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Live analysis of the master (hardware) output
+// An audio hook copies every output block into a lock-free ring on the audio
+// thread, without locks or allocation. An analysis thread drains the ring
+// into two running analysis streams staggered by half the history length
+// (MagdaLiveSegments), so each block is analyzed once, as it arrives. About
+// once a second the older stream's state is published, so a mix request can
+// use the latest result instead of rendering. Digital silence (stopped
+// transport) is not analyzed.
+class MagdaLiveMeter {
+public:
+  static MagdaLiveMeter &Get();
+  ~MagdaLiveMeter();
+
+  MagdaLiveMeter(const MagdaLiveMeter &) = delete;
+  MagdaLiveMeter &operator=(const MagdaLiveMeter &) = delete;
+
+  // Longest history Start accepts
+  static constexpr double kMaxHistorySeconds = 600.0;
+
+  // Main thread. Analyze the latest historySeconds of playback (1 to
+  // kMaxHistorySeconds; results cover between half of that and all of it);
+  // restarts with the new length if already running. The ring is sized here
+  // for the current device rate.
+  bool Start(double historySeconds, WDL_FastString &error_msg);
+
+  // Main thread. Unregisters the hook and joins the analysis thread.
+  void Stop();
+
+  bool IsRunning() const { return m_running.load(); }
+  double GetHistorySeconds() const { return m_historySeconds; }
+
+  // Seconds of playback the next result will cover
+  double GetCapturedSeconds() const;
+
+  // Latest analysis of the history and the seconds of playback it covers.
+  // Returns false unless it covers at least minSeconds and was made at most
+  // maxAgeSeconds ago.
+  bool GetLatestResult(double minSeconds, double maxAgeSeconds, DSPAnalysisResult &result,
+                       double &seconds) const;
+
+  // Frames the audio thread dropped because the ring was full
+  long long GetDroppedFrames() const { return m_droppedFrames.load(); }
+
+private:
+  MagdaLiveMeter();
+
+  // Audio thread
+  static void OnAudioBuffer(bool isPost, int len, double srate, audio_hook_register_t *reg);
+
+  void AnalysisLoop();
+  // Analysis thread: start over at a new rate, feed the streams, publish
+  void ResetStreams(int rate);
+  void AnalyzeBlock(const float *data, int frames);
+  // Returns the milliseconds the snapshot took
+  double PublishResult();
+  // Join the analysis thread (no REAPER calls, safe at exit)
+  void StopThread();
+
+  audio_hook_register_t m_hook;
+  std::unique_ptr<MagdaSampleRing> m_ring;
+  std::vector<float> m_hookBlock; // Audio thread scratch, sized before registering
+  std::atomic<int> m_sampleRate;
+  std::atomic<long long> m_droppedFrames;
+  std::atomic<bool> m_running;
+  double m_historySeconds;
+
+  std::thread m_thread;
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  bool m_stopping; // Guarded by m_wakeMutex
+
+  // Analysis thread only (m_streamRate and m_capturedFrames are also read by
+  // GetCapturedSeconds)
+  MagdaLiveSegments m_segments;
+  std::unique_ptr<MagdaDSPStream> m_streams[MagdaLiveSegments::kSegments];
+  std::atomic<int> m_streamRate;
+  std::atomic<long long> m_capturedFrames;
+  MagdaLiveResult m_result;
+};
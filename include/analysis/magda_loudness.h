@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+// ITU-R BS.1770-4 / EBU R128 loudness meter
+// Audio is K-weighted (pre-filter shelf + RLB high-pass), squared and summed
+// into 100 ms sub-blocks. Momentary (400 ms) and short-term (3 s) loudness are
+// sliding means over the last 4 / 30 sub-blocks, updated every 100 ms.
+//
+// Integrated loudness (absolute -70 LUFS gate, relative -10 LU gate) and
+// loudness range (EBU Tech 3342, relative -20 LU gate, 10th..95th percentile)
+// are read from fixed-size loudness histograms, so memory use is constant no
+// matter how long the stream is.
+class MagdaLoudnessMeter {
+public:
+  MagdaLoudnessMeter(int sampleRate, int channels);
+
+  // Feed numFrames frames of interleaved audio
+  void Process(const float *interleaved, int numFrames);
+
+  // Gated integrated loudness (LUFS); kNoLoudness if nothing passed the gate
+  double GetIntegrated() const;
+
+  // Loudness range (LU); 0 if there isn't enough short-term data
+  double GetLoudnessRange() const;
+
+  // Highest momentary / short-term loudness seen so far (LUFS)
+  double GetMomentaryMax() const { return m_momentaryMax; }
+  double GetShortTermMax() const { return m_shortTermMax; }
+
+  // Loudness of the most recent window (LUFS)
+  double GetMomentary() const;
+  double GetShortTerm() const;
+
+  // Returned when a measurement has no data (below the absolute gate)
+  static constexpr double kNoLoudness = -96.0;
+
+private:
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+  };
+
+  // Fixed histogram over the gated loudness range
+  struct LoudnessHistogram {
+    std::vector<long long> counts;
+    std::vector<double> energySums;
+
+    LoudnessHistogram();
+    void Add(double energy);
+    // Mean energy of blocks whose bin lies at or above gateLufs
+    double MeanEnergyAbove(double gateLufs, long long *countOut = nullptr) const;
+  };
+
+  static double EnergyToLufs(double energy);
+  static double LufsToEnergy(double lufs);
+  static int HistogramBin(double lufs);
+  static double HistogramBinCenter(int bin);
+
+  void FinishSubBlock();
+  double WindowEnergy(int subBlocks) const;
+
+  int m_sampleRate;
+  int m_channels;
+  Biquad m_shelf;
+  Biquad m_highPass;
+  std::vector<double> m_channelWeights;
+  std::vector<double> m_filterState; // 4 per channel per stage: x1, x2, y1, y2
+
+  int m_subBlockSize; // Frames per 100 ms
+  int m_subBlockFill;
+  double m_subBlockSum;
+
+  // Ring of the last 30 sub-block mean energies (3 s)
+  std::vector<double> m_subBlocks;
+  int m_subBlockHead;
+  long long m_subBlockCount;
+
+  double m_momentaryMax;
+  double m_shortTermMax;
+
+  LoudnessHistogram m_momentaryHistogram; // 400 ms gating blocks (integrated)
+  LoudnessHistogram m_shortTermHistogram; // 3 s blocks (loudness range)
+};
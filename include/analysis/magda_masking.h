@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../WDL/WDL/wdlstring.h"
+#include "magda_feature_frames.h"
+#include <string>
+#include <vector>
+
+// One track's input to the masking analysis
+struct MaskingTrack {
+  const FeatureFrames *frames = nullptr; // Time-resolved band energies
+  double startTime = 0.0;                // Project time of the track's first sample (seconds)
+};
+
+// Masking between two tracks in one band, aggregated over time
+struct MaskingBand {
+  float overlap = 0.0f;          // Share of active time where both tracks compete (0-1)
+  float competingSeconds = 0.0f; // Time both are active at similar levels
+  float levelDiff = 0.0f;        // Mean level of A minus B while competing (dB)
+};
+
+struct MaskingPair {
+  int trackA = 0;
+  int trackB = 0;
+  std::vector<MaskingBand> bands;
+};
+
+// Pairwise masking for N tracks that share one band layout
+struct MaskingMatrix {
+  std::vector<float> bandEdges;   // numBands + 1 band edges (Hz)
+  double frameSeconds = 0.0;      // Step of the common time grid
+  std::vector<MaskingPair> pairs; // (0,1), (0,2) ... (N-2,N-1)
+};
+
+// A run of adjacent bands where one pair of tracks competes
+struct MaskingConflict {
+  int trackA = 0;
+  int trackB = 0;
+  float lowHz = 0.0f;
+  float highHz = 0.0f;
+  float overlap = 0.0f;   // Mean overlap over the run
+  float seconds = 0.0f;   // Longest competing time of any band in the run
+  float levelDiff = 0.0f; // A minus B (dB), weighted by competing time
+};
+
+// Cross-track spectral masking from FeatureFrames
+// Two tracks compete in a band while both are active there and their levels
+// are within a few dB of each other, which is when the louder one hides the
+// quieter one. Tracks are placed on a common time grid by start time and
+// compared frame by frame, so overlap only counts when they actually play
+// together.
+class MagdaMaskingAnalyzer {
+public:
+  // Compare every pair of tracks; pairs run on the worker pool (maxThreads
+  // 0 = all cores). Returns false unless at least two tracks are given and
+  // all share the same band edges.
+  static bool Compute(const std::vector<MaskingTrack> &tracks, MaskingMatrix &out,
+                      int maxThreads = 0);
+
+  // Merge adjacent bands with at least minOverlap into runs and keep the
+  // maxConflicts strongest (overlap x competing time), strongest first
+  static void FindConflicts(const MaskingMatrix &matrix, float minOverlap, int maxConflicts,
+                            std::vector<MaskingConflict> &out);
+
+  // ,"masking":[{"a":name,"b":name,"hz":[low,high],"overlap":..,"seconds":..,"diff":..},...]
+  static void AppendJSON(WDL_FastString &json, const std::vector<MaskingConflict> &conflicts,
+                         const std::vector<std::string> &trackNames);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "magda_stft.h"
+#include <memory>
+#include <vector>
+
+// Multi-resolution spectrum for the low end
+// A single linear FFT has the same bin width everywhere, so a 4096-point
+// spectrum puts less than one bin into the lowest third-octave bands. This
+// halves the mono downmix repeatedly (half-band FIR + decimation by 2) and
+// runs a short STFT on each octave level, so every band is measured with
+// enough bins in a window of matching length: a 1024-point FFT at 375 Hz
+// spans the same time, and resolves the same detail, as a 131072-point one
+// at 48 kHz, for a fraction of the work. Bands the reference (main) spectrum
+// already resolves keep using it.
+//
+// Band levels are returned in the units of the reference spectrum (mean
+// per-bin power of an fftSize-point FFT at the full rate), so bands from
+// either source line up for broadband material.
+class MagdaMultiResSpectrum {
+public:
+  // refFftSize is the main spectrum's FFT size; levels are added until
+  // bands down to lowestHz are resolved
+  MagdaMultiResSpectrum(int sampleRate, int refFftSize, float lowestHz = 20.0f,
+                        int maxThreads = 0);
+  ~MagdaMultiResSpectrum();
+
+  // Skip level windows below thresholdDb dBFS (see MagdaSTFT::SetSilenceGate)
+  void SetSilenceGate(float thresholdDb);
+
+  // Feed numFrames mono samples at the full rate
+  void Process(const float *mono, int numFrames);
+
+  // Analyze the windows still pending on every level (call before reading)
+  void Flush();
+
+  // Decimated levels in use (0 when the reference spectrum resolves
+  // everything down to lowestHz)
+  int GetNumLevels() const { return (int)m_levels.size(); }
+
+  // Level (dB) of [lowHz, highHz): each part of the range comes from the
+  // coarsest source that gives it enough bins. refFrequencies/refMagnitudes
+  // are the main spectrum (Hz, dB); levels without a complete window fall
+  // back to the next finer one.
+  float GetBandLevel(float lowHz, float highHz, const std::vector<float> &refFrequencies,
+                     const std::vector<float> &refMagnitudes) const;
+
+private:
+  struct Level {
+    int factor;                       // Decimation relative to the full rate (2^level)
+    std::vector<float> history;       // Last kTaps-1 input samples of the half-band filter
+    bool skipNext;                    // Next input sample has no output
+    std::vector<float> output;        // Decimated samples of the current block
+    std::unique_ptr<MagdaSTFT> stft;  // Only on levels that serve bands
+    float minHz;                      // Lowest frequency this level serves
+  };
+
+  // Half-band filter and decimate in into level.output
+  void Decimate(const float *in, int numFrames, Level &level);
+  // Add power * bin width for level bins in [lowHz, highHz)
+  void AccumulateLevel(const Level &level, float lowHz, float highHz, double &weightedPower,
+                       double &width) const;
+
+  int m_sampleRate;
+  int m_refFftSize;
+  float m_refMinHz;              // Lowest frequency the reference spectrum serves
+  std::vector<Level> m_chain;    // Every decimation stage, full rate / 2 first
+  std::vector<Level *> m_levels; // Stages with an STFT, finest first
+  std::vector<float> m_taps;
+  std::vector<float> m_scratch;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+// One detected note/hit onset
+struct Onset {
+  double time;    // Seconds from the start of the analyzed audio
+  float strength; // Spectral flux relative to the strongest onset (0-1)
+  float attack;   // Rise time from 10% to 90% of the following level peak (seconds)
+};
+
+// Spectral-flux onset detector fed by STFT windows
+// Flux is the summed positive change of log-compressed magnitudes between
+// consecutive windows. A window is an onset when its flux is a local maximum
+// and clears an adaptive threshold (local mean plus a share of the largest
+// flux so far). Timing is refined below the hop size with a short level
+// envelope taken from the centre slice of each window, which also gives the
+// per-onset attack time. Only a few windows of history are kept, so memory
+// doesn't grow with input length.
+class MagdaOnsetDetector {
+public:
+  MagdaOnsetDetector(int sampleRate, int fftSize, int hopSize, int maxOnsets = 4096);
+
+  // One analysis window: fftSize time samples and fftSize/2+1 magnitudes
+  void AddWindow(const float *samples, const float *magnitudes);
+
+  // Resolve the windows still waiting for look-ahead (call once, at the end)
+  void Finish();
+
+  // Onsets in time order after Finish(): the maxOnsets strongest when there
+  // were more (GetTotalOnsets() counts all)
+  const std::vector<Onset> &GetOnsets() const { return m_onsets; }
+  long long GetTotalOnsets() const { return m_totalOnsets; }
+
+  // The onsets found so far, as GetOnsets() would give them after Finish(),
+  // without ending detection (the last windows still wait for look-ahead)
+  std::vector<Onset> GetOnsetsSoFar() const;
+
+  // Median attack time over the stored onsets (0 if none)
+  float GetMedianAttack() const;
+
+  // Share of the total flux that falls on onset windows (0-1)
+  float GetOnsetFluxShare() const;
+
+private:
+  void Evaluate(long long window, long long lastWindow);
+  double FluxAt(long long window) const;
+  void RefineOnset(long long window, Onset &onset) const;
+  // Time order, strength relative to the strongest onset
+  static void SortAndNormalize(std::vector<Onset> &onsets);
+
+  int m_sampleRate;
+  int m_fftSize;
+  int m_hopSize;
+  int m_numBins;
+  int m_maxOnsets;
+  int m_subBlockSize;  // Samples per envelope value
+  int m_subBlocks;     // Envelope values per hop
+  long long m_windows; // Windows added so far
+
+  std::vector<float> m_prevLogMagnitudes;
+  std::vector<double> m_fluxRing;     // Flux of the most recent windows
+  std::vector<float> m_envelopeRing;  // Centre-slice RMS envelope of the most recent windows
+  double m_maxFlux;
+  double m_totalFlux;
+  double m_onsetFlux;
+
+  std::vector<Onset> m_onsets; // Min-heap on raw flux until Finish(), then time order
+  long long m_totalOnsets;
+  bool m_finished;
+};
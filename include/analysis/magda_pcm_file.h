@@ -0,0 +1,93 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Sample encodings MagdaPCMFile decodes
+enum PCMSampleFormat {
+  PCM_FORMAT_INT16 = 0,
+  PCM_FORMAT_INT24,
+  PCM_FORMAT_INT32,
+  PCM_FORMAT_FLOAT32,
+  PCM_FORMAT_FLOAT64
+};
+
+// Memory-mapped uncompressed WAV or AIFF/AIFC file
+// Parses the header and decodes interleaved frames straight from the
+// mapping into floats, so no REAPER source or audio accessor is involved and
+// it can be used from any thread. Supports 16/24/32-bit integer and 32/64-bit
+// float PCM (WAVE_FORMAT_EXTENSIBLE, AIFC 'sowt' and 'fl32'/'fl64' included).
+class MagdaPCMFile {
+public:
+  MagdaPCMFile();
+  ~MagdaPCMFile();
+
+  MagdaPCMFile(const MagdaPCMFile &) = delete;
+  MagdaPCMFile &operator=(const MagdaPCMFile &) = delete;
+
+  // Map and parse path. Fails for other file types and compressed audio.
+  bool Open(const char *path, WDL_FastString &error_msg);
+  void Close();
+
+  int GetSampleRate() const { return m_sampleRate; }
+  int GetChannels() const { return m_channels; }
+  long long GetNumFrames() const { return m_numFrames; }
+  PCMSampleFormat GetFormat() const { return m_format; }
+
+  // Decode frames [first, first + frames) into out (interleaved). Frames
+  // outside the file are silence, or wrap around it when loop is set.
+  void ReadFrames(long long first, int frames, float *out, bool loop) const;
+
+private:
+  bool ParseWAV(WDL_FastString &error_msg);
+  bool ParseAIFF(WDL_FastString &error_msg);
+  // Decode frames that all lie inside the file
+  void Decode(long long first, int frames, float *out) const;
+
+  const unsigned char *m_data; // Whole mapped file
+  size_t m_size;
+#ifdef _WIN32
+  void *m_file;
+  void *m_mapping;
+#endif
+
+  const unsigned char *m_samples; // First sample frame
+  int m_sampleRate;
+  int m_channels;
+  long long m_numFrames;
+  PCMSampleFormat m_format;
+  int m_bytesPerSample;
+  bool m_bigEndian;
+};
+
+// Block source over the part of a PCM file an item plays: the take start
+// offset, the item length and the playrate (linear interpolation when the
+// rate isn't 1), with the take volume applied. Reads need no main thread.
+class MagdaPCMFileSource : public MagdaBlockSource {
+public:
+  // startOffset in source seconds, length in project seconds
+  MagdaPCMFileSource(std::unique_ptr<MagdaPCMFile> file, double startOffset, double length,
+                     double playrate, float gain, bool loop);
+
+  int ReadBlock(float *out, int maxFrames) override;
+
+  int GetSampleRate() const override { return m_file->GetSampleRate(); }
+  int GetChannels() const override { return m_file->GetChannels(); }
+  long long GetTotalFrames() const override { return m_totalFrames; }
+  bool HadAudio() const override { return m_hadAudio; }
+  bool NeedsMainThread() const override { return false; }
+
+private:
+  std::unique_ptr<MagdaPCMFile> m_file;
+  double m_startFrame; // Source frame the item starts at
+  double m_playrate;
+  float m_gain;
+  bool m_loop;
+  long long m_totalFrames;
+  long long m_position;
+  bool m_hadAudio;
+  std::vector<float> m_scratch; // Source frames for interpolation
+};
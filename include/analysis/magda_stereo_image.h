@@ -0,0 +1,21 @@
+#pragma once
+
+#include "magda_dsp_analyzer.h"
+#include "magda_stft.h"
+#include <vector>
+
+// Per-band stereo image from the mid/side sums of a MagdaSTFT that ran with
+// its side channel enabled (mid = (L+R)/2, side = (L-R)/2). Gives the
+// correlation, width and levels of each FrequencyBands range, and whether
+// the low end survives a fold to mono.
+class MagdaStereoImage {
+public:
+  // Stereo image of [lowHz, highHz)
+  static StereoBand Band(const MagdaSTFT &stft, int sampleRate, float lowHz, float highHz);
+
+  // One band per FrequencyBands range into bands, plus the low-end
+  // correlation and mono check in stereo. Low end too quiet to hear counts
+  // as mono compatible.
+  static void Analyze(const MagdaSTFT &stft, int sampleRate, std::vector<StereoBand> &bands,
+                      StereoAnalysis &stereo);
+};
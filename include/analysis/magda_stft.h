@@ -0,0 +1,106 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class MagdaFFTPlan;
+
+// Short-time Fourier analysis of a mono stream
+// Samples are pushed in blocks of any size. Complete windows are collected
+// into batches and transformed on MagdaWorkerPool threads; each window's
+// magnitudes land in their own row and are summed in window order, so the
+// result is bit-identical for any thread count.
+//
+// With a silence gate set, a cheap energy pre-pass over each batch finds the
+// windows whose RMS is below the gate; those skip the FFT, get an all-zero
+// magnitude row and are left out of the sums and the active window count.
+//
+// With the side channel enabled, the side signal (L-R)/2 is transformed in the
+// same window task as the mid (downmix), and each bin adds |M|^2, |S|^2 and
+// Re(M S*) to per-bin sums: one complex multiply-accumulate per bin and
+// window, from which per-band L/R correlation and width follow.
+class MagdaSTFT {
+public:
+  // maxThreads caps the threads used per batch (0 = all cores)
+  MagdaSTFT(int fftSize, int hopSize, int maxThreads = 0);
+  ~MagdaSTFT();
+
+  // Feed numFrames mono samples (and as many side samples when the side
+  // channel is enabled; nullptr counts as silence)
+  void Process(const float *mono, int numFrames, const float *side = nullptr);
+
+  // Analyze every complete window still pending (call before reading sums)
+  void Flush();
+
+  // Optional per-window hook, called in window order on the thread running
+  // Process()/Flush() with the window's fftSize input samples and magnitudes
+  using WindowCallback = std::function<void(const float *samples, const float *magnitudes)>;
+  void SetWindowCallback(WindowCallback callback) { m_windowCallback = std::move(callback); }
+
+  // Skip windows whose RMS (before windowing) is below thresholdDb dBFS.
+  // Off by default; set it before the first Process() call.
+  void SetSilenceGate(float thresholdDb);
+
+  // Also transform a side channel (call before the first Process())
+  void EnableSideChannel();
+  bool HasSideChannel() const { return m_sideEnabled; }
+
+  int GetFFTSize() const { return m_fftSize; }
+  int GetHopSize() const { return m_hopSize; }
+  int GetNumBins() const;
+  long long GetNumWindows() const { return m_numWindows; }
+  // Windows at or above the silence gate (all windows when no gate is set)
+  long long GetNumActiveWindows() const { return m_numActiveWindows; }
+
+  // Per-bin sum of |X[k]| over all active windows
+  const std::vector<double> &GetMagnitudeSums() const { return m_magnitudeSums; }
+
+  // Side channel only: per-bin sums over active windows of |M|^2, |S|^2
+  // and Re(M S*), M being the mid (downmix) spectrum and S the side one
+  const std::vector<double> &GetMidPowerSums() const { return m_midPowerSums; }
+  const std::vector<double> &GetSidePowerSums() const { return m_sidePowerSums; }
+  const std::vector<double> &GetCrossSums() const { return m_crossSums; }
+
+private:
+  struct Scratch {
+    std::vector<float> windowed;
+    std::vector<float> realOut;
+    std::vector<float> imagOut;
+    std::vector<float> work;
+    std::vector<float> sideReal; // Side channel spectrum
+    std::vector<float> sideImag;
+  };
+
+  void RunBatch(int numWindows);
+  // Flag the batch windows at or above the silence gate
+  void GateBatch(int numWindows);
+  void AnalyzeWindow(const float *frame, float *magnitudes, Scratch &scratch) const;
+  // After AnalyzeWindow: transform the side window and fill the bin's
+  // |M|^2, |S|^2, Re(M S*) triples
+  void AnalyzeSideWindow(const float *frame, float *stereoRow, Scratch &scratch) const;
+
+  std::shared_ptr<const MagdaFFTPlan> m_plan;
+  int m_fftSize;
+  int m_hopSize;
+  int m_maxThreads;
+
+  std::vector<float> m_pending;         // Unconsumed samples; index 0 is the next window start
+  std::vector<float> m_batchMagnitudes; // One row of bins per window in the batch
+  std::vector<Scratch> m_scratch;       // One per chunk of windows
+  std::vector<double> m_magnitudeSums;
+  long long m_numWindows;
+
+  bool m_sideEnabled;
+  std::vector<float> m_pendingSide; // Same layout as m_pending
+  std::vector<float> m_batchStereo; // Three floats per bin per window in the batch
+  std::vector<double> m_midPowerSums;
+  std::vector<double> m_sidePowerSums;
+  std::vector<double> m_crossSums;
+
+  double m_gateEnergy;                // Window sum of squares below which it's skipped (0 = off)
+  std::vector<double> m_energyPrefix; // Running sum of squares over the batch samples
+  std::vector<char> m_batchActive;    // Per batch window: 1 = analyzed, 0 = gated
+  long long m_numActiveWindows;
+  WindowCallback m_windowCallback;
+};
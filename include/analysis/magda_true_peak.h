@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+// One inter-sample over: a run of oversampled values above the threshold
+struct TruePeakOver {
+  double time; // Seconds from the start of the analyzed audio
+  float level; // Highest true-peak level in the run (dBTP)
+  int channel; // Channel index
+};
+
+// Oversampled true-peak detector (ITU-R BS.1770-4 Annex 2)
+// Each channel is upsampled with a polyphase FIR and the absolute maximum of
+// the interpolated signal is tracked. The 4x factor uses the 48-tap filter
+// from the recommendation; other factors use a Hann-windowed sinc with the
+// same 12 taps per phase. All phases of one input sample are computed
+// together (SSE2 on x86, NEON on ARM).
+//
+// Runs of values above the over threshold are merged into events and the
+// worst events are kept, so callers can point at exact spots.
+class MagdaTruePeakDetector {
+public:
+  MagdaTruePeakDetector(int sampleRate, int channels, int oversampling = 4,
+                        float overThresholdDb = -1.0f, int maxOvers = 8);
+
+  // Feed numFrames frames of interleaved audio
+  void Process(const float *interleaved, int numFrames);
+
+  // Highest true-peak level so far (linear, never below the sample peak)
+  float GetTruePeak() const;
+
+  // Worst overs, loudest first (closes any run still in progress)
+  std::vector<TruePeakOver> GetOvers() const;
+
+  int GetOversampling() const { return m_factor; }
+
+private:
+  struct OverRun {
+    bool active = false;
+    long long lastFrame = 0;
+    float level = 0.0f; // Linear
+    double time = 0.0;
+  };
+
+  void BuildFilter();
+  void ProcessChannel(int ch, const float *samples, int numFrames);
+  void OnOver(int ch, long long frame, int phase, float value);
+  static void InsertOver(std::vector<TruePeakOver> &overs, const TruePeakOver &over, int maxOvers);
+  TruePeakOver CloseRun(int ch, const OverRun &run) const;
+
+  int m_sampleRate;
+  int m_channels;
+  int m_factor;
+  int m_groups;      // Phases rounded up to groups of 4 (one SIMD register each)
+  int m_taps;        // Taps per phase
+  double m_delay;    // Filter delay in input samples (for over positions)
+  float m_threshold; // Linear over threshold
+
+  std::vector<float> m_coefs; // [tap][group * 4 + phase], zero padded
+
+  std::vector<float> m_history; // Last m_taps - 1 input samples per channel
+  std::vector<float> m_scratch; // History + current block for one channel
+  std::vector<float> m_peaks;   // Per-channel max |oversampled|
+  std::vector<float> m_samplePeaks;
+  long long m_framesProcessed;
+
+  int m_maxOvers;
+  int m_holdFrames; // Overs closer than this merge into one event
+  std::vector<OverRun> m_runs;
+  std::vector<TruePeakOver> m_overs;
+};
@@ -6,6 +6,7 @@
 #include "../WDL/WDL/jnetlib/httpget.h"
 #include "../WDL/WDL/wdlstring.h"
 #include "reaper_plugin.h"
+#include <functional>
 
 // Forward declaration
 class JNL_IAsyncDNS;
@@ -54,6 +55,17 @@ public:
   bool SendLoginRequest(const char *email, const char *password, WDL_FastString &jwt_token_out,
                         WDL_FastString &error_msg);
 
+  // Completion of an async request; runs on the main thread. result holds
+  // the JWT token for logins and is empty otherwise.
+  typedef std::function<void(bool success, const WDL_FastString &result,
+                             const WDL_FastString &error_msg)>
+      AsyncCallback;
+
+  // SendLoginRequest without blocking the caller
+  // The request runs on the network thread (a worker on Windows); the
+  // client may be destroyed before done runs
+  void SendLoginRequestAsync(const char *email, const char *password, AsyncCallback done);
+
   // Send refresh token request to backend
   // Returns true on success, false on error
   // jwt_token_out contains the new JWT token on success
@@ -72,6 +84,9 @@ public:
   // Health check - returns true if API is reachable
   bool CheckHealth(WDL_FastString &error_msg, int timeout_seconds = 5);
 
+  // CheckHealth without blocking the caller (see SendLoginRequestAsync)
+  void CheckHealthAsync(AsyncCallback done, int timeout_seconds = 5);
+
   // Helper to extract actions JSON from response
   // Finds the "actions" field and extracts its value as a JSON string
   static char *ExtractActionsJSON(const char *json_str, int json_len);
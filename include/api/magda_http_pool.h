@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef _WIN32
+#include <curl/curl.h>
+#include <mutex>
+#include <vector>
+
+// Timing of one transfer in milliseconds. Phases follow each other, so a
+// request on a reused connection has no DNS, connect or TLS time.
+struct MagdaHTTPTiming {
+  double dnsMs = 0.0;       // Name lookup
+  double connectMs = 0.0;   // TCP connect
+  double tlsMs = 0.0;       // TLS handshake
+  double firstByteMs = 0.0; // Request sent until the first response byte
+  double totalMs = 0.0;
+  bool reusedConnection = false;
+};
+
+// Shared libcurl handles for every HTTPS request the extension makes
+// A handle from curl_easy_init() starts with empty caches, so each request
+// paid a DNS lookup, TCP connect and TLS handshake before the server saw it.
+// The pool keeps finished easy handles for the next request and attaches
+// all of them to one share handle, so DNS results, TLS sessions and open
+// connections carry over between requests. Handles only perform on the
+// MagdaHTTPReactor thread, which is what makes sharing connections safe.
+//
+// Acquire() hands out an idle handle (or a new one) reset to default
+// options; the caller sets its options, performs, and gives it back with
+// Release(). A handle belongs to one thread until it is released, so any
+// number of requests can run at once.
+class MagdaHTTPPool {
+public:
+  static MagdaHTTPPool &Get();
+
+  MagdaHTTPPool();
+  ~MagdaHTTPPool();
+
+  MagdaHTTPPool(const MagdaHTTPPool &) = delete;
+  MagdaHTTPPool &operator=(const MagdaHTTPPool &) = delete;
+
+  // Easy handle attached to the share handle, nullptr if curl can't make one
+  CURL *Acquire();
+
+  // Return a handle from Acquire() (nullptr is ignored). Its options are
+  // reset; its connection stays open for the next request.
+  void Release(CURL *curl);
+
+  // Timing of the last transfer on curl (read it before Release)
+  static MagdaHTTPTiming GetTiming(CURL *curl);
+
+  // "dns 12.3 ms, connect ..., reused" for log lines
+  static void FormatTiming(const MagdaHTTPTiming &timing, char *buf, int bufSize);
+
+  // Close idle handles and the shared caches (extension unload). Handles
+  // still out keep working and are closed, not pooled, when released; the
+  // share handle goes with the last of them.
+  void Shutdown();
+
+private:
+  static void Lock(CURL *curl, curl_lock_data data, curl_lock_access access, void *userptr);
+  static void Unlock(CURL *curl, curl_lock_data data, void *userptr);
+
+  // Clean up the share handle once no easy handle uses it (m_mutex held)
+  void CloseShareIfUnused();
+
+  std::mutex m_mutex; // Guards everything but m_shareLocks
+  std::vector<CURL *> m_idle;
+  int m_numOut;
+  bool m_shutdown;
+  CURLSH *m_share;
+  std::mutex m_shareLocks[CURL_LOCK_DATA_LAST];
+};
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+
+#ifndef _WIN32
+#include <curl/curl.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One network thread for every HTTPS transfer (curl multi interface)
+// Blocking requests used to run curl_easy_perform on a thread of their own.
+// The reactor instead adds each configured easy handle to a single multi
+// handle and drives all of them - short requests and long SSE streams alike
+// - from one thread, so a request costs no thread and the number of open
+// connections is capped in one place.
+//
+// Handles come from MagdaHTTPPool and are configured as for
+// curl_easy_perform. Write and header callbacks then run on the reactor
+// thread: they must not block, and must never wait on the reactor.
+//
+// Start() is fire-and-forget; its completion runs on the main thread via
+// MagdaMainThreadQueue. Perform()/PerformAll() block the calling
+// (background) thread until their transfers finish. Launch() is the
+// building block for background threads that wait on several transfers
+// and react as each one ends.
+class MagdaHTTPReactor {
+public:
+  // Runs on the main thread; curl is still valid for curl_easy_getinfo and
+  // goes back to the pool afterwards
+  typedef std::function<void(CURL *curl, CURLcode result)> Completion;
+
+  static MagdaHTTPReactor &Get();
+
+  MagdaHTTPReactor();
+  ~MagdaHTTPReactor();
+
+  MagdaHTTPReactor(const MagdaHTTPReactor &) = delete;
+  MagdaHTTPReactor &operator=(const MagdaHTTPReactor &) = delete;
+
+  // Run curl in the background and take ownership of it. Returns an id for
+  // Cancel(), or 0 if the reactor is shut down (curl is released, onDone
+  // never runs).
+  int Start(CURL *curl, Completion onDone);
+
+  // Run curl and call onFinish on the reactor thread when it ends. The
+  // caller keeps ownership of the handle. onFinish must be quick and must
+  // not wait on the reactor; it runs with CURLE_ABORTED_BY_CALLBACK after
+  // Cancel() or Shutdown(). Returns an id, or 0 (onFinish never runs) if
+  // the reactor is shut down.
+  int Launch(CURL *curl, std::function<void(CURLcode)> onFinish);
+
+  // Stop a transfer from Start() or Launch(); its completion runs with
+  // CURLE_ABORTED_BY_CALLBACK unless it already finished
+  void Cancel(int id);
+
+  // Background threads only: run curl and wait for it. The caller keeps
+  // ownership of the handle.
+  CURLcode Perform(CURL *curl);
+
+  // Run count transfers side by side and wait for all of them
+  void PerformAll(CURL *const *handles, int count, CURLcode *results);
+
+  // Abort everything in flight and stop the thread (extension unload).
+  // Blocked callers return CURLE_ABORTED_BY_CALLBACK; Start() completions
+  // are dropped.
+  void Shutdown();
+
+private:
+  struct Transfer {
+    int id = 0;
+    CURL *curl = nullptr;
+    Completion onDone;                  // Start(): runs on the main thread
+    std::function<void(CURLcode)> wake; // Launch(): signals the waiter
+  };
+
+  // Queue a transfer for the reactor thread (started on first use).
+  // Returns its id, or 0 once shut down.
+  int Submit(Transfer transfer);
+  void ThreadLoop();
+  // Reactor thread: hand a finished transfer to its owner. Start()
+  // completions are dropped (and the handle released) unless deliver.
+  void Finish(Transfer &transfer, CURLcode result, bool deliver);
+
+  CURLM *m_multi;
+  std::thread m_thread;
+
+  std::mutex m_mutex; // Guards the members below
+  std::deque<Transfer> m_incoming;
+  std::vector<int> m_cancelled;
+  int m_nextId;
+  bool m_stop;
+
+  // Owned by the reactor thread
+  std::map<CURL *, Transfer> m_active;
+};
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Task priority: each tick runs higher priorities first
+enum MainThreadPriority {
+  MAIN_THREAD_HIGH = 0,   // User-visible edits (streamed actions)
+  MAIN_THREAD_NORMAL = 1, // Workflow steps (renders, analysis, cleanup)
+  MAIN_THREAD_LOW = 2,    // Anything that can wait
+  MAIN_THREAD_NUM_PRIORITIES = 3
+};
+
+// Queue of work that must run on REAPER's main thread
+// Any thread can post; posting is a lock-free push. RunPending() is called
+// from the timer and runs tasks until its time budget is spent, so a long
+// queue spreads over several ticks instead of freezing the arrange view.
+// Tasks posted while a tick is running wait for the next tick.
+//
+// Post() returns a future for the task's result. Background threads may wait
+// on it; the main thread must not, since the task can only run there.
+// Tasks dropped by Clear() or the destructor break their futures.
+class MagdaMainThreadQueue {
+public:
+  static MagdaMainThreadQueue &Get();
+
+  MagdaMainThreadQueue();
+  ~MagdaMainThreadQueue();
+
+  MagdaMainThreadQueue(const MagdaMainThreadQueue &) = delete;
+  MagdaMainThreadQueue &operator=(const MagdaMainThreadQueue &) = delete;
+
+  // Run fn once on the main thread
+  template <typename F>
+  std::future<std::invoke_result_t<F>> Post(F &&fn,
+                                            MainThreadPriority priority = MAIN_THREAD_NORMAL) {
+    using Result = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+    std::future<Result> future = task->get_future();
+    PostPolling(
+        [task]() {
+          (*task)();
+          return true;
+        },
+        priority);
+    return future;
+  }
+
+  // Run step once per tick until it returns true. Returning false keeps it
+  // queued in the same position for the next tick.
+  void PostPolling(std::function<bool()> step, MainThreadPriority priority = MAIN_THREAD_NORMAL);
+
+  // Main thread only: run queued tasks, highest priority first, until
+  // budgetMs has elapsed. At least one task runs per call so nothing starves
+  // behind a slow task. Returns the number of tasks that ran.
+  int RunPending(double budgetMs);
+
+  // Main thread (or after the timer is gone): drop every queued task
+  void Clear();
+
+  // Tasks posted but not finished (approximate while other threads post)
+  int GetNumPending() const { return m_numPending.load(std::memory_order_relaxed); }
+
+  // Number of RunPending() calls so far; lets tasks rate-limit themselves
+  // (e.g. one render per tick)
+  long long GetTick() const { return m_tick; }
+
+  // True on the thread that last called RunPending()
+  bool IsMainThread() const { return std::this_thread::get_id() == m_mainThread.load(); }
+
+private:
+  struct Task {
+    std::function<bool()> step;
+    MainThreadPriority priority = MAIN_THREAD_NORMAL;
+    Task *next = nullptr;
+  };
+
+  // Move everything posted so far into m_ready, oldest first
+  void TakeIncoming();
+
+  // Lock-free stack of posted tasks (newest first); the consumer detaches
+  // the whole stack at once, so there is no ABA problem
+  std::atomic<Task *> m_incoming;
+  std::atomic<int> m_numPending;
+  std::atomic<std::thread::id> m_mainThread;
+
+  // Owned by the main thread
+  std::deque<Task *> m_ready[MAIN_THREAD_NUM_PRIORITIES];
+  long long m_tick;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of floats
+// One thread writes and one other thread reads; neither ever blocks. Writes
+// are all-or-nothing, so a reader only sees whole writes (e.g. whole
+// interleaved frames) as long as it reads in multiples of the write size.
+class MagdaSampleRing {
+public:
+  // capacity is rounded up to a power of two
+  explicit MagdaSampleRing(size_t capacity);
+
+  MagdaSampleRing(const MagdaSampleRing &) = delete;
+  MagdaSampleRing &operator=(const MagdaSampleRing &) = delete;
+
+  // Producer: append count floats. Returns false (and writes nothing) if
+  // they don't fit.
+  bool Write(const float *data, size_t count);
+
+  // Consumer: take up to maxCount floats. Returns the number read.
+  size_t Read(float *out, size_t maxCount);
+
+  // Floats the consumer can read / the producer can write right now
+  size_t GetReadAvailable() const;
+  size_t GetWriteAvailable() const { return m_buffer.size() - GetReadAvailable(); }
+  size_t GetCapacity() const { return m_buffer.size(); }
+
+private:
+  std::vector<float> m_buffer;
+  size_t m_mask;
+  // Free-running positions (wrap via m_mask); each is written by one side only
+  alignas(64) std::atomic<size_t> m_writePos;
+  alignas(64) std::atomic<size_t> m_readPos;
+};
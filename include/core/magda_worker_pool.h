@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared pool of worker threads for data-parallel jobs (background analysis)
+// ParallelFor() blocks the caller, which also works on the job, so nested or
+// concurrent calls from several background threads never deadlock.
+// Do NOT call from the main thread for long jobs - the UI would stall.
+// Submit() queues a task without waiting, so the main thread can hand work
+// off and return.
+class MagdaWorkerPool {
+public:
+  // Process-wide pool with one worker per core (minus the calling thread),
+  // and at least one
+  static MagdaWorkerPool &Get();
+
+  explicit MagdaWorkerPool(int numWorkers);
+  ~MagdaWorkerPool();
+
+  MagdaWorkerPool(const MagdaWorkerPool &) = delete;
+  MagdaWorkerPool &operator=(const MagdaWorkerPool &) = delete;
+
+  int GetNumWorkers() const { return (int)m_workers.size(); }
+
+  // Run fn(i) for every i in [0, count) and wait for all of them.
+  // maxThreads caps how many threads (caller included) work on this job;
+  // 0 means no cap.
+  void ParallelFor(int count, int maxThreads, const std::function<void(int)> &fn);
+
+  // Run task on a worker and return immediately. Tasks may call
+  // ParallelFor(). Never runs the task on the caller: without workers it
+  // gets a detached thread of its own. Tasks still queued when the pool is
+  // destroyed are dropped.
+  void Submit(std::function<void()> task);
+
+private:
+  struct Job {
+    const std::function<void(int)> *fn = nullptr;
+    std::function<void(int)> ownedFn; // Submit() jobs own their function
+    bool detached = false;            // Nobody waits; the last helper removes it
+    int count = 0;
+    int next = 0;      // Next index to hand out (guarded by m_mutex)
+    int completed = 0; // Finished indices (guarded by m_mutex)
+    int helpers = 0;   // Workers currently attached
+    int maxHelpers = 0;
+    std::condition_variable done;
+  };
+
+  void WorkerLoop();
+  // Take indices from job until none are left. Returns with m_mutex held.
+  void RunIndices(Job &job, std::unique_lock<std::mutex> &lock);
+  // Drop job from m_jobs (m_mutex held)
+  void RemoveJob(const std::shared_ptr<Job> &job);
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<std::shared_ptr<Job>> m_jobs;
+  bool m_stopping;
+};
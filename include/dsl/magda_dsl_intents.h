@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace MagdaDSL {
+
+// ============================================================================
+// Local Intent Matcher
+// ============================================================================
+// Turns simple, unambiguous commands into DSL without asking the LLM:
+//
+//   "mute track 3"                → track(id=3).set_track(mute=true)
+//   "set Bass volume to -6"       → track(id=2).set_track(volume_db=-6)
+//   "delete the selected track"   → track(selected=true).delete()
+//
+// Commands are matched against a fixed table of templates and the project's
+// current track names. The whole command must fit one template, and every
+// reading of it must give the same DSL. Track names must also resolve to
+// exactly one track. Anything else is left to the LLM.
+//
+// Matching is plain string work on a handful of words and takes a few
+// microseconds; it needs no REAPER calls.
+
+struct IntentMatch {
+  std::string dsl;              // One DSL statement for MagdaDSL::Interpreter
+  const char *intent = nullptr; // Template family, e.g. "mute" or "volume"
+};
+
+class IntentMatcher {
+public:
+  // trackNames[i] is the name of track i + 1 (DSL track ids are 1-based).
+  // Returns false if the command should go to the LLM.
+  static bool Match(const char *command, const std::vector<std::string> &trackNames,
+                    IntentMatch &out);
+};
+
+} // namespace MagdaDSL
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace MagdaDSL {
+
+// ============================================================================
+// Statement Stream
+// ============================================================================
+// Splits DSL text that arrives in pieces (a streamed LLM response) into
+// complete top-level statements, so each one can run while the rest of the
+// program is still being generated.
+//
+// A statement is complete once its parentheses close and the next token is
+// not a '.' continuing the chain. "track(id=1)" is therefore held back until
+// the next statement starts (or the stream ends), in case ".delete()"
+// follows on the next line.
+//
+// Statements come out trimmed, without comments, and with line breaks
+// outside strings removed - the same one-line form the chat gets by joining
+// chained lines of a complete program.
+class StatementStream {
+public:
+  StatementStream();
+
+  // Append streamed text; statements it completes are added to out in order
+  void Feed(const char *text, int len, std::vector<std::string> &out);
+  void Feed(const char *text, std::vector<std::string> &out);
+
+  // End of stream: whatever is left counts as the last statement
+  void Finish(std::vector<std::string> &out);
+
+  void Reset();
+
+private:
+  // Move m_buffer[0, end) to out as a statement (if it holds one)
+  void Emit(size_t end, std::vector<std::string> &out);
+
+  std::string m_buffer; // Statement in progress and anything after it
+  size_t m_scan;        // Next character of m_buffer to look at
+  int m_depth;          // Open ( and [
+  bool m_inString;
+  bool m_inComment;
+  bool m_closed;     // Parentheses balanced after a ')'; complete unless a '.' follows
+  size_t m_closeEnd; // Just past that ')'
+};
+
+} // namespace MagdaDSL
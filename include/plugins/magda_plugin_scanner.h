@@ -45,6 +45,13 @@ public:
   // Get cache file path
   static const char *GetCacheFilePath();
 
+  // Helper: Get user config directory (~/.magda on Mac/Linux, %APPDATA%/MAGDA
+  // on Windows)
+  static const char *GetConfigDirectory();
+
+  // Helper: Create config directory if it doesn't exist
+  static bool EnsureConfigDirectory();
+
   // Check if cache is valid (exists and not too old)
   bool IsCacheValid() const;
 
@@ -118,13 +125,6 @@ private:
   // Check if plugin name indicates it's an instrument
   bool IsInstrument(const char *full_name) const;
 
-  // Helper: Get user config directory (~/.magda on Mac/Linux, %APPDATA%/MAGDA
-  // on Windows)
-  static const char *GetConfigDirectory();
-
-  // Helper: Create config directory if it doesn't exist
-  static bool EnsureConfigDirectory();
-
   // Load aliases from cache file
   bool LoadAliasesFromCache();
 
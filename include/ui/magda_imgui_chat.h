@@ -2,7 +2,9 @@
 
 #include "reaper_plugin.h"
 #include <functional>
+#include <future>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -209,14 +211,36 @@ private:
   bool m_directOpenAI = false;    // True when using direct OpenAI (DSL result)
   std::string m_asyncResponseJson;
   std::string m_asyncErrorMsg;
-  std::string m_pendingQuestion;               // Question being processed
-  std::vector<std::string> m_streamingActions; // Actions queued from stream
-                                               // (executed on main thread)
+  std::string m_asyncTiming; // Agent orchestration timing for the status line
+  std::string m_pendingQuestion;                 // Question being processed
+  int m_streamGeneration = 0;                    // Bumped per request; older actions are skipped
+  std::shared_future<void> m_lastStreamedAction; // Last action posted to the main-thread queue
+
+  // DSL statements run while the program was still streaming (main thread
+  // only); ProcessAsyncResult folds them into the final summary
+  struct StreamedDSL {
+    int generation = -1; // m_streamGeneration of the request they belong to
+    int successCount = 0;
+    bool failed = false;
+    std::string lastError;
+    std::vector<std::string> summaries;
+    std::set<std::string> executed;
+  };
+  StreamedDSL m_streamedDSL;
 
   // Internal methods
   void ProcessAsyncResult();
   void StartAsyncRequest(const std::string &question);
   void StartDirectOpenAIRequest(const std::string &question);
+  // Run a simple track command locally, without the LLM; false if none matched
+  bool StartLocalCommand(const std::string &question);
+  // Post a streamed action to the main-thread queue (m_asyncMutex held)
+  void QueueStreamedAction(const std::string &actionJson);
+  // Run on the main thread unless the request was cancelled or replaced
+  void ExecuteStreamedAction(const std::string &actionJson, int generation);
+  // Same for a complete DSL statement from a streamed program
+  void QueueStreamedDSL(const std::string &statement);
+  void ExecuteStreamedDSL(const std::string &statement, int generation);
   void CheckAPIHealth();
   void RenderHeader();
   void RenderInputArea();
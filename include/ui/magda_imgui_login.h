@@ -4,7 +4,6 @@
 #include <functional>
 #include <mutex>
 #include <string>
-#include <thread>
 
 // Auth mode detected from API
 enum class AuthMode {
@@ -104,7 +103,6 @@ private:
 
   // Async request state
   std::mutex m_asyncMutex;
-  std::thread m_asyncThread;
   bool m_asyncPending = false;
   bool m_asyncResultReady = false;
   bool m_asyncSuccess = false;
@@ -0,0 +1,452 @@
+#include "magda_analysis_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// Bump whenever DSPAnalysisResult (or anything it serializes) changes layout
+// or meaning; older entries then simply miss and get overwritten.
+static const unsigned int kCacheVersion = 6;
+static const char kCacheMagic[4] = {'M', 'D', 'A', 'C'};
+
+// ============================================================================
+// Serialization helpers
+// ============================================================================
+
+namespace {
+
+class Writer {
+public:
+  explicit Writer(std::vector<char> &out) : m_out(out) {}
+
+  template <typename T> void Pod(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "POD only");
+    const char *p = (const char *)&value;
+    m_out.insert(m_out.end(), p, p + sizeof(T));
+  }
+
+  template <typename T> void PodVector(const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value, "POD only");
+    Pod((unsigned int)values.size());
+    const char *p = (const char *)values.data();
+    m_out.insert(m_out.end(), p, p + values.size() * sizeof(T));
+  }
+
+  void String(const char *s) {
+    unsigned int len = s ? (unsigned int)strlen(s) : 0;
+    Pod(len);
+    m_out.insert(m_out.end(), s, s + len);
+  }
+
+private:
+  std::vector<char> &m_out;
+};
+
+class Reader {
+public:
+  explicit Reader(const std::vector<char> &data) : m_data(data), m_pos(0), m_ok(true) {}
+
+  template <typename T> void Pod(T &value) {
+    if (!Take(&value, sizeof(T))) {
+      value = T();
+    }
+  }
+
+  template <typename T> void PodVector(std::vector<T> &values) {
+    unsigned int count = 0;
+    Pod(count);
+    if (!m_ok || (size_t)count * sizeof(T) > m_data.size() - m_pos) {
+      m_ok = false;
+      values.clear();
+      return;
+    }
+    values.resize(count);
+    Take(values.data(), count * sizeof(T));
+  }
+
+  void String(std::string &s) {
+    unsigned int len = 0;
+    Pod(len);
+    if (!m_ok || len > m_data.size() - m_pos) {
+      m_ok = false;
+      s.clear();
+      return;
+    }
+    s.assign(m_data.data() + m_pos, len);
+    m_pos += len;
+  }
+
+  bool Ok() const { return m_ok; }
+
+private:
+  bool Take(void *dst, size_t bytes) {
+    if (!m_ok || bytes > m_data.size() - m_pos) {
+      m_ok = false;
+      return false;
+    }
+    memcpy(dst, m_data.data() + m_pos, bytes);
+    m_pos += bytes;
+    return true;
+  }
+
+  const std::vector<char> &m_data;
+  size_t m_pos;
+  bool m_ok;
+};
+
+} // namespace
+
+// Resonance labels are const char* (normally string literals); loaded labels
+// are interned so the pointers stay valid for the life of the process
+static const char *InternLabel(const std::string &label) {
+  static std::mutex s_labelMutex;
+  static std::set<std::string> s_labels;
+  std::lock_guard<std::mutex> lock(s_labelMutex);
+  return s_labels.insert(label).first->c_str();
+}
+
+void MagdaAnalysisCache::Serialize(const std::string &key, const DSPAnalysisResult &result,
+                                   std::vector<char> &out) {
+  out.clear();
+  out.insert(out.end(), kCacheMagic, kCacheMagic + 4);
+
+  Writer w(out);
+  w.Pod(kCacheVersion);
+  w.String(key.c_str());
+
+  w.Pod(result.sampleRate);
+  w.Pod(result.channels);
+  w.Pod(result.lengthSeconds);
+  w.Pod(result.activeSeconds);
+  w.PodVector(result.fftFrequencies);
+  w.PodVector(result.fftMagnitudes);
+  w.PodVector(result.eqProfileFreqs);
+  w.PodVector(result.eqProfileMags);
+  w.Pod(result.bands);
+  w.PodVector(result.peaks);
+
+  w.Pod((unsigned int)result.resonances.size());
+  for (const Resonance &res : result.resonances) {
+    w.Pod(res.frequency);
+    w.Pod(res.magnitude);
+    w.Pod(res.q);
+    w.String(res.severity);
+    w.String(res.type);
+  }
+
+  w.Pod(result.spectralFeatures);
+  w.Pod(result.loudness);
+  w.PodVector(result.truePeakOvers);
+  w.Pod(result.dynamics);
+  w.Pod(result.stereo);
+  w.PodVector(result.stereoBands);
+  w.Pod(result.transients);
+  w.PodVector(result.onsets);
+
+  w.Pod(result.featureFrames.startSeconds);
+  w.Pod(result.featureFrames.frameSeconds);
+  w.PodVector(result.featureFrames.bandEdges);
+  w.PodVector(result.featureFrames.rms);
+  w.PodVector(result.featureFrames.centroid);
+  w.PodVector(result.featureFrames.flatness);
+  w.PodVector(result.featureFrames.bandEnergies);
+}
+
+bool MagdaAnalysisCache::Deserialize(const std::vector<char> &data, const std::string &key,
+                                     DSPAnalysisResult &result) {
+  if (data.size() < 4 || memcmp(data.data(), kCacheMagic, 4) != 0) {
+    return false;
+  }
+
+  std::vector<char> body(data.begin() + 4, data.end());
+  Reader r(body);
+
+  unsigned int version = 0;
+  r.Pod(version);
+  std::string storedKey;
+  r.String(storedKey);
+  if (!r.Ok() || version != kCacheVersion || storedKey != key) {
+    return false;
+  }
+
+  DSPAnalysisResult loaded;
+  r.Pod(loaded.sampleRate);
+  r.Pod(loaded.channels);
+  r.Pod(loaded.lengthSeconds);
+  r.Pod(loaded.activeSeconds);
+  r.PodVector(loaded.fftFrequencies);
+  r.PodVector(loaded.fftMagnitudes);
+  r.PodVector(loaded.eqProfileFreqs);
+  r.PodVector(loaded.eqProfileMags);
+  r.Pod(loaded.bands);
+  r.PodVector(loaded.peaks);
+
+  unsigned int numResonances = 0;
+  r.Pod(numResonances);
+  for (unsigned int i = 0; i < numResonances && r.Ok(); i++) {
+    Resonance res;
+    std::string severity, type;
+    r.Pod(res.frequency);
+    r.Pod(res.magnitude);
+    r.Pod(res.q);
+    r.String(severity);
+    r.String(type);
+    res.severity = InternLabel(severity);
+    res.type = InternLabel(type);
+    loaded.resonances.push_back(res);
+  }
+
+  r.Pod(loaded.spectralFeatures);
+  r.Pod(loaded.loudness);
+  r.PodVector(loaded.truePeakOvers);
+  r.Pod(loaded.dynamics);
+  r.Pod(loaded.stereo);
+  r.PodVector(loaded.stereoBands);
+  r.Pod(loaded.transients);
+  r.PodVector(loaded.onsets);
+
+  r.Pod(loaded.featureFrames.startSeconds);
+  r.Pod(loaded.featureFrames.frameSeconds);
+  r.PodVector(loaded.featureFrames.bandEdges);
+  r.PodVector(loaded.featureFrames.rms);
+  r.PodVector(loaded.featureFrames.centroid);
+  r.PodVector(loaded.featureFrames.flatness);
+  r.PodVector(loaded.featureFrames.bandEnergies);
+
+  if (!r.Ok()) {
+    return false;
+  }
+
+  loaded.success = true;
+  result = loaded;
+  return true;
+}
+
+void MagdaAnalysisCache::AppendConfigKey(const DSPAnalysisConfig &config, std::string &key) {
+  // streamBlockSize and analysisThreads are left out on purpose: results
+  // don't depend on them
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "|fft=%d|hop=%d|len=%.3f|full=%d|tp=%d,%.2f|gate=%.1f|flags=%d%d%d%d%d%d%d",
+           config.fftSize, config.hopSize, config.analysisLength, config.analyzeFullItem ? 1 : 0,
+           config.truePeakOversampling, config.truePeakOverThreshold, config.silenceGateDb,
+           config.analyzeFrequency ? 1 : 0, config.analyzeResonances ? 1 : 0,
+           config.analyzeLoudness ? 1 : 0, config.analyzeDynamics ? 1 : 0,
+           config.analyzeStereo ? 1 : 0, config.analyzeTransients ? 1 : 0,
+           config.analyzeSpectralFeatures ? 1 : 0);
+  key += buf;
+  if (config.analyzeTransients) {
+    snprintf(buf, sizeof(buf), "|onsets=%d", config.maxOnsets);
+    key += buf;
+  }
+  if (config.analyzeFeatureFrames) {
+    snprintf(buf, sizeof(buf), "|frames=%d,%d,%d", config.featureFrameBudget,
+             config.featureFrameBands, config.criticalBandFrames ? 1 : 0);
+    key += buf;
+  }
+  if (config.analyzeFrequency && config.multiResolutionBands) {
+    key += "|multires";
+  }
+}
+
+// ============================================================================
+// Cache store
+// ============================================================================
+
+MagdaAnalysisCache::MagdaAnalysisCache(const std::string &directory, long long maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes), m_totalBytes(0), m_useCounter(0),
+      m_loaded(false) {}
+
+unsigned long long MagdaAnalysisCache::HashKey(const std::string &key) {
+  // FNV-1a (64-bit)
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string MagdaAnalysisCache::EntryPath(unsigned long long hash) const {
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.bin", hash);
+  return m_directory + name;
+}
+
+bool MagdaAnalysisCache::EnsureDirectory() const {
+#ifdef _WIN32
+  _mkdir(m_directory.c_str());
+  struct _stat st;
+  return _stat(m_directory.c_str(), &st) == 0;
+#else
+  struct stat st;
+  if (stat(m_directory.c_str(), &st) != 0) {
+    return mkdir(m_directory.c_str(), 0755) == 0;
+  }
+  return true;
+#endif
+}
+
+void MagdaAnalysisCache::LoadIndex() {
+  if (m_loaded) {
+    return;
+  }
+  m_loaded = true;
+
+  FILE *f = fopen((m_directory + "/index.txt").c_str(), "r");
+  if (!f) {
+    return;
+  }
+
+  // One line per entry: <hash hex> <bytes> <last use>
+  unsigned long long hash;
+  long long bytes, lastUse;
+  while (fscanf(f, "%llx %lld %lld", &hash, &bytes, &lastUse) == 3) {
+    m_entries[hash] = {bytes, lastUse};
+    m_totalBytes += bytes;
+    if (lastUse > m_useCounter) {
+      m_useCounter = lastUse;
+    }
+  }
+  fclose(f);
+}
+
+void MagdaAnalysisCache::SaveIndex() const {
+  std::string path = m_directory + "/index.txt";
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) {
+    return;
+  }
+  for (const auto &entry : m_entries) {
+    fprintf(f, "%016llx %lld %lld\n", entry.first, entry.second.bytes, entry.second.lastUse);
+  }
+  fclose(f);
+}
+
+void MagdaAnalysisCache::RemoveEntry(unsigned long long hash) {
+  auto it = m_entries.find(hash);
+  if (it == m_entries.end()) {
+    return;
+  }
+  m_totalBytes -= it->second.bytes;
+  m_entries.erase(it);
+  remove(EntryPath(hash).c_str());
+}
+
+void MagdaAnalysisCache::EvictToFit() {
+  while (m_totalBytes > m_maxBytes && !m_entries.empty()) {
+    auto oldest = m_entries.begin();
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+      if (it->second.lastUse < oldest->second.lastUse) {
+        oldest = it;
+      }
+    }
+    RemoveEntry(oldest->first);
+  }
+}
+
+bool MagdaAnalysisCache::Lookup(const std::string &key, DSPAnalysisResult &result) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadIndex();
+
+  unsigned long long hash = HashKey(key);
+  auto it = m_entries.find(hash);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  std::vector<char> data;
+  FILE *f = fopen(EntryPath(hash).c_str(), "rb");
+  if (f) {
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size > 0) {
+      data.resize(size);
+      if (fread(data.data(), 1, size, f) != (size_t)size) {
+        data.clear();
+      }
+    }
+    fclose(f);
+  }
+
+  if (!Deserialize(data, key, result)) {
+    // Missing, stale or colliding entry
+    RemoveEntry(hash);
+    SaveIndex();
+    return false;
+  }
+
+  it->second.lastUse = ++m_useCounter;
+  SaveIndex();
+  return true;
+}
+
+void MagdaAnalysisCache::Store(const std::string &key, const DSPAnalysisResult &result) {
+  if (!result.success) {
+    return;
+  }
+
+  std::vector<char> data;
+  Serialize(key, result, data);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadIndex();
+  if ((long long)data.size() > m_maxBytes || !EnsureDirectory()) {
+    return;
+  }
+
+  unsigned long long hash = HashKey(key);
+  RemoveEntry(hash);
+
+  // Write to a temp file first so a crash never leaves a torn entry
+  std::string path = EntryPath(hash);
+  std::string tempPath = path + ".tmp";
+  FILE *f = fopen(tempPath.c_str(), "wb");
+  if (!f) {
+    return;
+  }
+  bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+  fclose(f);
+#ifdef _WIN32
+  // rename() won't replace an existing file on Windows
+  remove(path.c_str());
+#endif
+  if (!written || rename(tempPath.c_str(), path.c_str()) != 0) {
+    remove(tempPath.c_str());
+    return;
+  }
+
+  m_entries[hash] = {(long long)data.size(), ++m_useCounter};
+  m_totalBytes += (long long)data.size();
+  EvictToFit();
+  SaveIndex();
+}
+
+void MagdaAnalysisCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadIndex();
+  while (!m_entries.empty()) {
+    RemoveEntry(m_entries.begin()->first);
+  }
+  SaveIndex();
+}
+
+long long MagdaAnalysisCache::GetTotalBytes() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadIndex();
+  return m_totalBytes;
+}
+
+int MagdaAnalysisCache::GetNumEntries() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadIndex();
+  return (int)m_entries.size();
+}
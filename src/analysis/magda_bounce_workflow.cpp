@@ -2,13 +2,22 @@
 #include "../WDL/WDL/jsonparse.h"
 #include "../api/magda_openai.h"
 #include "magda_api_client.h"
+#include "magda_chunked_analysis.h"
+#include "magda_compact_json.h"
 #include "magda_dsp_analyzer.h"
 #include "magda_imgui_login.h"
+#include "magda_live_meter.h"
+#include "magda_main_thread_queue.h"
+#include "magda_masking.h"
+#include "magda_worker_pool.h"
 #include "reaper_plugin.h"
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -18,25 +27,71 @@ extern reaper_plugin_info_t *g_rec;
 // Static HTTP client instance for API calls
 static MagdaHTTPClient s_httpClient;
 
-// Cleanup queue for tracks to delete (must be done on main thread)
-static std::vector<int> s_tracksToDelete;
-static std::mutex s_cleanupMutex;
+// Analysis JSON sent to the mix API: spectrum as log bands, whole payload
+// capped so prompts stay small
+static DSPJSONOptions GetMixPromptJSONOptions() {
+  DSPJSONOptions options;
+  options.spectrumBands = 32;
+  options.maxBytes = 8192;
+  return options;
+}
+
+// Per-track analysis JSON in a comparison: all tracks share a 16 KB budget,
+// with a floor so each track keeps its summary and a coarse spectrum
+static DSPJSONOptions GetComparisonJSONOptions(int numTracks) {
+  DSPJSONOptions options;
+  options.spectrumBands = 24;
+  options.maxBytes = 16384 / (numTracks > 0 ? numTracks : 1);
+  if (options.maxBytes < 2048) {
+    options.maxBytes = 2048;
+  }
+  return options;
+}
+
+// Most tracks one comparison request covers
+static const int kMaxComparisonTracks = 16;
+// Masking conflicts reported per comparison, and the overlap a band needs
+// to count as one
+static const int kMaxMaskingConflicts = 24;
+static const float kMinMaskingOverlap = 0.3f;
+
+// One multi-track comparison in flight
+// Renders run one per timer tick on the main thread. Each finished render is
+// read on the main thread and analyzed on the worker pool while the next
+// render proceeds; whichever analysis finishes last sends the combined
+// request.
+struct MultiTrackComparison {
+  struct Track {
+    int trackIndex = -1;
+    std::string name;
+    std::string fxJson;
+    std::string analysisJson; // Empty if the track couldn't be analyzed
+    FeatureFrames frames;     // Critical-band frames for the masking matrix
+    double startTime = 0.0;   // Project time of the rendered item
+  };
+
+  std::mutex mutex;
+  std::vector<Track> tracks;
+  int pending = 0; // Tracks still being rendered or analyzed (guarded by mutex)
+  std::string userRequest;
+};
 
-// Command queue for Reaper operations that must run on main thread (outside
-// callbacks)
+// Reaper operations that must run on the main thread (outside callbacks).
+// Each command is a polling task on the main-thread queue: it runs once per
+// tick until it reports that it's done.
 enum ReaperCommandType {
   CMD_RENDER_ITEM = 0,
   CMD_DELETE_TRACK = 1,
   CMD_DELETE_TAKE = 2,
   CMD_DSP_ANALYZE = 3,
-  CMD_MULTI_TRACK_COMPARE = 4
+  CMD_MULTI_TRACK_COMPARE = 4,
+  CMD_ANALYZE_TRACK_OUTPUT = 5
 };
 
 struct ReaperCommand {
   ReaperCommandType type;
   int trackIndex;
   int itemIndex; // For render command
-  bool completed;
   // For render command: start async thread after render completes
   bool startAsyncAfterRender;
   int selectedTrackIndex; // For async thread
@@ -52,10 +107,28 @@ struct ReaperCommand {
   int stableCount;   // How many ticks file size has been stable
   // For stem track cleanup
   bool deleteTrackAfterAnalysis; // If true, delete entire track (not just take) after analysis
+  // For track output analysis: project time range (end <= start = whole track)
+  double rangeStart;
+  double rangeEnd;
+  // For multi-track comparison: shared job state and this track's slot
+  std::shared_ptr<MultiTrackComparison> comparison;
+  int comparisonSlot;
+  // For DSP analysis commands: the read in progress, stepped once per tick
+  std::shared_ptr<MagdaChunkedAnalysis> analysis;
 };
 
-static std::vector<ReaperCommand> s_reaperCommandQueue;
-static std::mutex s_commandQueueMutex;
+// Main-thread time one tick spends reading samples for an analysis
+static const double kReadStepBudgetMs = 4.0;
+
+// Playback the live meter must have analyzed before #master uses it instead
+// of rendering, and how recent that analysis must be. The meter re-analyzes
+// about once a second while audio plays.
+static const double kMinLiveSeconds = 5.0;
+static const double kMaxLiveAgeSeconds = 3.0;
+
+// Renders block the main thread, so run at most one per tick; analyses of
+// earlier renders are dispatched in between
+static long long s_lastRenderTick = -1;
 
 // Result storage for async mix analysis
 static std::mutex s_resultMutex;
@@ -126,6 +199,7 @@ void MagdaBounceWorkflow::ClearStreamingState() {
 // Phase tracking for UI status display
 static std::mutex s_phaseMutex;
 static MixAnalysisPhase s_currentPhase = MIX_PHASE_IDLE;
+static float s_phaseProgress = -1.0f;
 
 MixAnalysisPhase MagdaBounceWorkflow::GetCurrentPhase() {
   std::lock_guard<std::mutex> lock(s_phaseMutex);
@@ -135,6 +209,17 @@ MixAnalysisPhase MagdaBounceWorkflow::GetCurrentPhase() {
 void MagdaBounceWorkflow::SetCurrentPhase(MixAnalysisPhase phase) {
   std::lock_guard<std::mutex> lock(s_phaseMutex);
   s_currentPhase = phase;
+  s_phaseProgress = -1.0f;
+}
+
+float MagdaBounceWorkflow::GetPhaseProgress() {
+  std::lock_guard<std::mutex> lock(s_phaseMutex);
+  return s_phaseProgress;
+}
+
+void MagdaBounceWorkflow::SetPhaseProgress(float progress) {
+  std::lock_guard<std::mutex> lock(s_phaseMutex);
+  s_phaseProgress = progress;
 }
 
 // Helper to store result (called from background thread)
@@ -166,6 +251,26 @@ void MagdaBounceWorkflow::SetBounceModePreference(BounceMode mode) {
   (void)mode; // Suppress unused warning
 }
 
+MixCaptureMode MagdaBounceWorkflow::GetCaptureModePreference() {
+  const char *(*GetExtState)(const char *section, const char *key) =
+      (const char *(*)(const char *, const char *))g_rec->GetFunc("GetExtState");
+  const char *value = GetExtState ? GetExtState("MAGDA", "mix_capture_mode") : nullptr;
+  if (value && atoi(value) == MIX_CAPTURE_BOUNCE) {
+    return MIX_CAPTURE_BOUNCE;
+  }
+  return MIX_CAPTURE_TRACK_ACCESSOR;
+}
+
+void MagdaBounceWorkflow::SetCaptureModePreference(MixCaptureMode mode) {
+  void (*SetExtState)(const char *section, const char *key, const char *value, bool persist) =
+      (void (*)(const char *, const char *, const char *, bool))g_rec->GetFunc("SetExtState");
+  if (SetExtState) {
+    char value[16];
+    snprintf(value, sizeof(value), "%d", (int)mode);
+    SetExtState("MAGDA", "mix_capture_mode", value, true);
+  }
+}
+
 bool MagdaBounceWorkflow::ExecuteWorkflow(BounceMode bounceMode, const char *trackType,
                                           const char *userRequest, WDL_FastString &error_msg) {
   void (*ShowConsoleMsg)(const char *msg) =
@@ -304,6 +409,44 @@ bool MagdaBounceWorkflow::ExecuteWorkflow(BounceMode bounceMode, const char *tra
     return false;
   }
 
+  // Preferred path: read the track output through a track audio accessor
+  // on the next timer tick (only without active track FX, which the
+  // accessor doesn't hear). No render, no new take, nothing to clean up.
+  WDL_FastString accessorReason;
+  if (GetCaptureModePreference() == MIX_CAPTURE_TRACK_ACCESSOR &&
+      MagdaDSPAnalyzer::CanAnalyzeTrackOutput(selectedTrackIndex, accessorReason)) {
+    SetCurrentPhase(MIX_PHASE_DSP_ANALYSIS);
+
+    ReaperCommand cmd = {};
+    cmd.type = CMD_ANALYZE_TRACK_OUTPUT;
+    cmd.trackIndex = selectedTrackIndex;
+    cmd.selectedTrackIndex = selectedTrackIndex;
+    cmd.rangeStart = needTimeSelection ? bounceStart : 0.0;
+    cmd.rangeEnd = needTimeSelection ? bounceEnd : 0.0;
+    strncpy(cmd.trackName, trackName, sizeof(cmd.trackName) - 1);
+    if (trackType) {
+      strncpy(cmd.trackType, trackType, sizeof(cmd.trackType) - 1);
+    }
+    if (userRequest) {
+      strncpy(cmd.userRequest, userRequest, sizeof(cmd.userRequest) - 1);
+    }
+    QueueCommand(cmd);
+
+    if (ShowConsoleMsg) {
+      char msg[256];
+      snprintf(msg, sizeof(msg), "MAGDA: Queued track output analysis for track %d (no render)\n",
+               selectedTrackIndex);
+      ShowConsoleMsg(msg);
+    }
+    return true;
+  }
+  if (accessorReason.GetLength() > 0 && ShowConsoleMsg) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "MAGDA: Track accessor can't capture this track (%s), bouncing\n",
+             accessorReason.Get());
+    ShowConsoleMsg(msg);
+  }
+
   // Select only this item
   if (SetMediaItemSelected && CountMediaItems && GetMediaItem) {
     int totalItems = CountMediaItems(nullptr);
@@ -327,12 +470,10 @@ bool MagdaBounceWorkflow::ExecuteWorkflow(BounceMode bounceMode, const char *tra
   // callback) After render completes, async thread will be started for DSP +
   // API - works on ORIGINAL track, not a copy
   {
-    std::lock_guard<std::mutex> lock(s_commandQueueMutex);
     ReaperCommand cmd;
     cmd.type = CMD_RENDER_ITEM;
     cmd.trackIndex = selectedTrackIndex; // Use original track, not a copy
     cmd.itemIndex = 0;                   // First item on the track
-    cmd.completed = false;
     cmd.startAsyncAfterRender = true;
     cmd.selectedTrackIndex = selectedTrackIndex;
     cmd.deleteTrackAfterAnalysis = false; // Single track workflow only deletes take, not track
@@ -350,11 +491,11 @@ bool MagdaBounceWorkflow::ExecuteWorkflow(BounceMode bounceMode, const char *tra
     } else {
       cmd.userRequest[0] = '\0';
     }
-    s_reaperCommandQueue.push_back(cmd);
+    QueueCommand(cmd);
   }
 
-  // Return immediately - render will be executed in ProcessCommandQueue
-  // which is called from timer callback on next tick
+  // Return immediately - the render runs on the main-thread queue from the
+  // next timer tick
   return true;
 }
 
@@ -367,6 +508,44 @@ bool MagdaBounceWorkflow::ExecuteMasterWorkflow(const char *userRequest,
     ShowConsoleMsg("MAGDA: Starting master analysis workflow...\n");
   }
 
+  // Live meter running during playback: use its analysis of the last seconds
+  // played, no render. A stopped transport or a stale result means the live
+  // audio may not reflect the project any more.
+  DSPAnalysisResult liveResult;
+  double liveSeconds = 0.0;
+  bool useLive = false;
+  if (MagdaLiveMeter::Get().IsRunning()) {
+    int (*GetPlayState)() = (int (*)())g_rec->GetFunc("GetPlayState");
+    const char *reason = nullptr;
+    if (!GetPlayState || (GetPlayState() & 1) == 0) {
+      reason = "playback is stopped";
+    } else if (!MagdaLiveMeter::Get().GetLatestResult(kMinLiveSeconds, kMaxLiveAgeSeconds,
+                                                      liveResult, liveSeconds)) {
+      reason = "no recent live analysis";
+    } else {
+      useLive = true;
+    }
+    if (reason && ShowConsoleMsg) {
+      char msg[256];
+      snprintf(msg, sizeof(msg), "MAGDA: Live meter running but %s, rendering instead\n",
+               reason);
+      ShowConsoleMsg(msg);
+    }
+  }
+  if (useLive) {
+    if (ShowConsoleMsg) {
+      char msg[256];
+      snprintf(msg, sizeof(msg), "MAGDA: Using live analysis of the last %.1f s of playback\n",
+               liveSeconds);
+      ShowConsoleMsg(msg);
+    }
+    WDL_FastString analysisJson;
+    MagdaDSPAnalyzer::ToJSON(liveResult, analysisJson, GetMixPromptJSONOptions());
+    StartMixAPIThread(analysisJson.Get(), "[]", "Master", "master", userRequest ? userRequest : "",
+                      -1);
+    return true;
+  }
+
   // For master analysis, we need to:
   // 1. Get the project time range
   // 2. Create a temporary track
@@ -590,12 +769,10 @@ bool MagdaBounceWorkflow::ExecuteMasterWorkflow(const char *userRequest,
 
   // Queue the DSP analysis command
   {
-    std::lock_guard<std::mutex> lock(s_commandQueueMutex);
     ReaperCommand cmd;
     cmd.type = CMD_DSP_ANALYZE;
     cmd.trackIndex = stemTrackIndex;
     cmd.itemIndex = 0;
-    cmd.completed = false;
     cmd.startAsyncAfterRender = true;
     cmd.selectedTrackIndex = stemTrackIndex;
     cmd.itemPtr = (void *)stemItem;
@@ -614,7 +791,7 @@ bool MagdaBounceWorkflow::ExecuteMasterWorkflow(const char *userRequest,
     } else {
       cmd.userRequest[0] = '\0';
     }
-    s_reaperCommandQueue.push_back(cmd);
+    QueueCommand(cmd);
   }
 
   if (ShowConsoleMsg) {
@@ -762,105 +939,164 @@ bool MagdaBounceWorkflow::ExecuteMultiTrackWorkflow(const char *compareArgs,
     ShowConsoleMsg(msg);
   }
 
-  // For now, we'll queue each track for analysis sequentially
-  // TODO: Could optimize to do parallel analysis in the future
-  // Store track indices for sequential processing
-  // This is a simplified implementation - in practice, you'd want to
-  // queue all tracks and process them together
-
-  // For MVP, let's analyze tracks one by one and collect results
-  // We'll store the analysis results and send them all together at the end
-  // This requires modifying the workflow to support collecting multiple results
-
-  // For now, let's just analyze the first two tracks and send them together
-  // as a proof of concept
-  if (trackIndices.size() > 2) {
+  if ((int)trackIndices.size() > kMaxComparisonTracks) {
     if (ShowConsoleMsg) {
-      ShowConsoleMsg("MAGDA: Warning - comparing first 2 tracks (full "
-                     "multi-track support coming soon)\n");
-    }
-    trackIndices.resize(2);
-  }
-
-  // For MVP, queue the first track for analysis with a note that it's a
-  // comparison Future: Implement full multi-track analysis that collects all
-  // results and sends together For now, we'll analyze tracks sequentially and
-  // the user can compare them or we can enhance the backend to accept multiple
-  // tracks in one request
-
-  if (trackIndices.size() > 2 && ShowConsoleMsg) {
-    ShowConsoleMsg("MAGDA: Comparing first 2 tracks (analyzing sequentially)\n");
-  }
-
-  // Queue each track for analysis - they'll be processed sequentially
-  // TODO: Enhance to collect all results and send in one multi_track API call
-  for (size_t i = 0; i < trackIndices.size() && i < 2; i++) {
-    int trackIdx = trackIndices[i];
-    MediaTrack *track = GetTrack(nullptr, trackIdx);
-    if (!track) {
-      continue;
+      char msg[128];
+      snprintf(msg, sizeof(msg), "MAGDA: Warning - comparing the first %d tracks\n",
+               kMaxComparisonTracks);
+      ShowConsoleMsg(msg);
     }
-
-    // Get track name
-    char trackName[256] = "Track";
-    if (GetSetMediaTrackInfo_String) {
-      char name[256] = {0};
+    trackIndices.resize(kMaxComparisonTracks);
+  }
+
+  // Job graph: one render per track (main thread, one per timer tick), each
+  // followed by a read and a pooled analysis; the last analysis sends one
+  // request covering every track
+  auto comparison = std::make_shared<MultiTrackComparison>();
+  comparison->tracks.resize(trackIndices.size());
+  comparison->pending = (int)trackIndices.size();
+  comparison->userRequest = "Compare these tracks: ";
+
+  for (size_t i = 0; i < trackIndices.size(); i++) {
+    MediaTrack *track = GetTrack(nullptr, trackIndices[i]);
+    std::string name = "Track " + std::to_string(trackIndices[i] + 1);
+    if (track && GetSetMediaTrackInfo_String) {
+      char trackName[256] = {0};
       bool setValue = false;
-      GetSetMediaTrackInfo_String((INT_PTR)track, "P_NAME", name, &setValue);
-      if (name[0]) {
-        strncpy(trackName, name, sizeof(trackName) - 1);
-        trackName[sizeof(trackName) - 1] = '\0';
+      GetSetMediaTrackInfo_String((INT_PTR)track, "P_NAME", trackName, &setValue);
+      if (trackName[0]) {
+        name = trackName;
       }
     }
+    comparison->tracks[i].trackIndex = trackIndices[i];
+    comparison->tracks[i].name = name;
+    comparison->userRequest += (i > 0 ? ", " : "") + name;
+  }
 
-    // Queue render command for this track
-    {
-      std::lock_guard<std::mutex> lock(s_commandQueueMutex);
+  SetCurrentPhase(MIX_PHASE_RENDERING);
+  {
+    for (size_t i = 0; i < trackIndices.size(); i++) {
       ReaperCommand cmd;
       cmd.type = CMD_RENDER_ITEM;
-      cmd.trackIndex = trackIdx;
+      cmd.trackIndex = trackIndices[i];
       cmd.itemIndex = 0;
-      cmd.completed = false;
       cmd.startAsyncAfterRender = true;
-      cmd.selectedTrackIndex = trackIdx;
+      cmd.selectedTrackIndex = trackIndices[i];
       cmd.deleteTrackAfterAnalysis = false; // Multi-track workflow only deletes take, not track
-      strncpy(cmd.trackName, trackName, sizeof(cmd.trackName) - 1);
+      strncpy(cmd.trackName, comparison->tracks[i].name.c_str(), sizeof(cmd.trackName) - 1);
       cmd.trackName[sizeof(cmd.trackName) - 1] = '\0';
-      strncpy(cmd.trackType, i == 0 ? "compare_track1" : "compare_track2",
-              sizeof(cmd.trackType) - 1);
+      strncpy(cmd.trackType, "comparison", sizeof(cmd.trackType) - 1);
       cmd.trackType[sizeof(cmd.trackType) - 1] = '\0';
-      // Add note that this is a comparison
-      std::string userReq = "Compare this track with ";
-      if (trackIndices.size() > 1) {
-        MediaTrack *otherTrack = GetTrack(nullptr, trackIndices[1 - i]);
-        if (otherTrack && GetSetMediaTrackInfo_String) {
-          char otherName[256] = {0};
-          bool setValue = false;
-          GetSetMediaTrackInfo_String((INT_PTR)otherTrack, "P_NAME", otherName, &setValue);
-          if (otherName[0]) {
-            userReq += otherName;
-          } else {
-            userReq += "track ";
-            userReq += std::to_string(trackIndices[1 - i]);
-          }
-        }
-      }
-      strncpy(cmd.userRequest, userReq.c_str(), sizeof(cmd.userRequest) - 1);
+      strncpy(cmd.userRequest, comparison->userRequest.c_str(), sizeof(cmd.userRequest) - 1);
       cmd.userRequest[sizeof(cmd.userRequest) - 1] = '\0';
-      s_reaperCommandQueue.push_back(cmd);
+      cmd.comparison = comparison;
+      cmd.comparisonSlot = (int)i;
+      QueueCommand(cmd);
     }
+  }
 
-    if (ShowConsoleMsg) {
-      char msg[256];
-      snprintf(msg, sizeof(msg), "MAGDA: Queued track %d (%s) for comparison\n", trackIdx,
-               trackName);
-      ShowConsoleMsg(msg);
-    }
+  if (ShowConsoleMsg) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "MAGDA: Queued %zu tracks for comparison\n", trackIndices.size());
+    ShowConsoleMsg(msg);
   }
 
   return true;
 }
 
+void MagdaBounceWorkflow::FinishComparisonTrack(
+    const std::shared_ptr<MultiTrackComparison> &comparison, int slot,
+    const std::string &analysisJson) {
+  {
+    std::lock_guard<std::mutex> lock(comparison->mutex);
+    comparison->tracks[slot].analysisJson = analysisJson;
+    if (--comparison->pending > 0) {
+      return;
+    }
+  }
+
+  // Every track is in, so nothing else touches the comparison any more
+  void (*ShowConsoleMsg)(const char *msg) =
+      (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+
+  WDL_FastString payload;
+  std::string trackNames;
+  int firstTrackIndex = -1;
+  int analyzed = 0;
+  std::vector<MaskingTrack> maskingTracks;
+  std::vector<std::string> maskingNames;
+  payload.Set("{\"tracks\":[");
+  for (const MultiTrackComparison::Track &track : comparison->tracks) {
+    if (track.analysisJson.empty()) {
+      continue;
+    }
+    MaskingTrack maskingTrack;
+    maskingTrack.frames = &track.frames;
+    maskingTrack.startTime = track.startTime;
+    maskingTracks.push_back(maskingTrack);
+    maskingNames.push_back(track.name);
+
+    if (analyzed > 0) {
+      payload.Append(",");
+      trackNames += ", ";
+    }
+    payload.AppendFormatted(64, "{\"track_index\":%d,\"track_name\":", track.trackIndex);
+    MagdaCompactJSON::AppendString(payload, track.name.c_str());
+    if (!track.fxJson.empty()) {
+      payload.Append(",\"existing_fx\":");
+      payload.Append(track.fxJson.c_str());
+    }
+    payload.Append(",\"analysis\":");
+    payload.Append(track.analysisJson.c_str());
+    payload.Append("}");
+    trackNames += track.name;
+    if (firstTrackIndex < 0) {
+      firstTrackIndex = track.trackIndex;
+    }
+    analyzed++;
+  }
+  payload.Append("]");
+
+  // Pre-digested "A vs B at low-high Hz" facts instead of raw band arrays
+  MaskingMatrix masking;
+  if (MagdaMaskingAnalyzer::Compute(maskingTracks, masking)) {
+    std::vector<MaskingConflict> conflicts;
+    MagdaMaskingAnalyzer::FindConflicts(masking, kMinMaskingOverlap, kMaxMaskingConflicts,
+                                        conflicts);
+    MagdaMaskingAnalyzer::AppendJSON(payload, conflicts, maskingNames);
+  }
+  payload.Append("}");
+
+  if (analyzed == 0) {
+    StoreResult(false, "Multi-track comparison failed: no track could be analyzed");
+    return;
+  }
+
+  if (ShowConsoleMsg) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "MAGDA: Analyzed %d of %zu tracks, sending comparison...\n",
+             analyzed, comparison->tracks.size());
+    ShowConsoleMsg(msg);
+  }
+
+  // The API call streams for a while; keep it off the worker pool
+  std::string payloadStr = payload.Get();
+  std::string userRequest = comparison->userRequest;
+  std::thread([payloadStr, userRequest, trackNames, firstTrackIndex]() {
+    WDL_FastString responseJson, error_msg;
+    if (!SendToMixAPI(payloadStr.c_str(), "", "comparison", userRequest.c_str(),
+                      firstTrackIndex, trackNames.c_str(), responseJson, error_msg)) {
+      void (*ShowConsoleMsg)(const char *msg) =
+          (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+      if (ShowConsoleMsg) {
+        char msg[512];
+        snprintf(msg, sizeof(msg), "MAGDA: Comparison API call failed: %s\n", error_msg.Get());
+        ShowConsoleMsg(msg);
+      }
+    }
+  }).detach();
+}
+
 int MagdaBounceWorkflow::BounceTrackToNewTrack(int sourceTrackIndex, BounceMode mode,
                                                WDL_FastString &error_msg) {
   // New approach: Copy track, hide it, render item, analyze, then delete
@@ -1014,7 +1250,7 @@ int MagdaBounceWorkflow::BounceTrackToNewTrack(int sourceTrackIndex, BounceMode
     }
   }
 
-  // Step 8: Render is now queued and will be executed in ProcessCommandQueue
+  // Step 8: Render is now queued on the main-thread queue
   // (Render must not be called from callback context)
 
   if (ShowConsoleMsg) {
@@ -1099,7 +1335,7 @@ bool MagdaBounceWorkflow::RunDSPAnalysis(int trackIndex, const char *trackName,
   }
 
   // Convert to JSON - this contains the analysis_data structure
-  MagdaDSPAnalyzer::ToJSON(result, analysisJson);
+  MagdaDSPAnalyzer::ToJSON(result, analysisJson, GetMixPromptJSONOptions());
 
   // Get FX info separately - it will be added to context
   MagdaDSPAnalyzer::GetTrackFXInfo(trackIndex, fxJson);
@@ -1107,6 +1343,32 @@ bool MagdaBounceWorkflow::RunDSPAnalysis(int trackIndex, const char *trackName,
   return true;
 }
 
+void MagdaBounceWorkflow::StartMixAPIThread(const std::string &analysisJson,
+                                            const std::string &fxJson,
+                                            const std::string &trackName,
+                                            const std::string &trackType,
+                                            const std::string &userRequest,
+                                            int selectedTrackIndex) {
+  std::thread([analysisJson, fxJson, trackName, trackType, userRequest, selectedTrackIndex]() {
+    void (*ShowConsoleMsg)(const char *msg) =
+        (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+
+    // Streams into the UI and reports errors via CompleteStreaming
+    WDL_FastString responseJson, error_msg;
+    if (!SendToMixAPI(analysisJson.c_str(), fxJson.c_str(), trackType.c_str(),
+                      userRequest.c_str(), selectedTrackIndex, trackName.c_str(), responseJson,
+                      error_msg)) {
+      if (ShowConsoleMsg) {
+        char msg[512];
+        snprintf(msg, sizeof(msg), "MAGDA: Mix API call failed: %s\n", error_msg.Get());
+        ShowConsoleMsg(msg);
+      }
+    } else if (ShowConsoleMsg) {
+      ShowConsoleMsg("MAGDA: Mix analysis streaming completed successfully!\n");
+    }
+  }).detach();
+}
+
 bool MagdaBounceWorkflow::SendToMixAPI(const char *analysisJson, const char *fxJson,
                                        const char *trackType, const char *userRequest,
                                        int trackIndex, const char *trackName,
@@ -1235,13 +1497,12 @@ bool MagdaBounceWorkflow::SendToMixAPI(const char *analysisJson, const char *fxJ
   return false;
 }
 
-bool MagdaBounceWorkflow::ProcessCommandQueue() {
-  std::lock_guard<std::mutex> lock(s_commandQueueMutex);
-
-  if (s_reaperCommandQueue.empty()) {
-    return false;
-  }
+void MagdaBounceWorkflow::QueueCommand(const ReaperCommand &cmd) {
+  auto state = std::make_shared<ReaperCommand>(cmd);
+  MagdaMainThreadQueue::Get().PostPolling([state]() { return RunCommand(*state); });
+}
 
+bool MagdaBounceWorkflow::RunCommand(ReaperCommand &cmd) {
   void (*ShowConsoleMsg)(const char *msg) =
       (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
   void (*Main_OnCommand)(int command, int flag) =
@@ -1263,522 +1524,501 @@ bool MagdaBounceWorkflow::ProcessCommandQueue() {
   void (*SetActiveTake)(MediaItem_Take *) =
       (void (*)(MediaItem_Take *))g_rec->GetFunc("SetActiveTake");
 
-  bool processedAny = false;
-
-  // Collect new commands to add after the loop (to avoid iterator invalidation)
-  std::vector<ReaperCommand> commandsToAdd;
-
-  // Process commands one at a time (to avoid blocking)
-  for (auto it = s_reaperCommandQueue.begin(); it != s_reaperCommandQueue.end();) {
-    ReaperCommand &cmd = *it;
+  // Hand a dropped comparison track back so the comparison can still finish
+  auto abandonComparisonTrack = [](const ReaperCommand &dropped) {
+    if (dropped.comparison) {
+      FinishComparisonTrack(dropped.comparison, dropped.comparisonSlot, "");
+    }
+  };
 
-    if (cmd.completed) {
-      // Remove completed commands
-      it = s_reaperCommandQueue.erase(it);
-      continue;
+  if (cmd.type == CMD_RENDER_ITEM) {
+    MagdaMainThreadQueue &queue = MagdaMainThreadQueue::Get();
+    if (s_lastRenderTick == queue.GetTick()) {
+      return false;
     }
 
-    if (cmd.type == CMD_RENDER_ITEM) {
-      // Execute render command
-      if (!Main_OnCommand) {
-        it = s_reaperCommandQueue.erase(it);
-        continue;
-      }
+    // Execute render command
+    if (!Main_OnCommand) {
+      abandonComparisonTrack(cmd);
+      return true;
+    }
 
-      // Get the track and item
-      MediaTrack *track = GetTrack ? GetTrack(nullptr, cmd.trackIndex) : nullptr;
-      if (!track) {
-        if (ShowConsoleMsg) {
-          char msg[256];
-          snprintf(msg, sizeof(msg), "MAGDA: Track %d not found for render\n", cmd.trackIndex);
-          ShowConsoleMsg(msg);
-        }
-        it = s_reaperCommandQueue.erase(it);
-        continue;
+    // Get the track and item
+    MediaTrack *track = GetTrack ? GetTrack(nullptr, cmd.trackIndex) : nullptr;
+    if (!track) {
+      if (ShowConsoleMsg) {
+        char msg[256];
+        snprintf(msg, sizeof(msg), "MAGDA: Track %d not found for render\n", cmd.trackIndex);
+        ShowConsoleMsg(msg);
       }
+      abandonComparisonTrack(cmd);
+      return true;
+    }
 
-      // Get the media item
-      int itemCount = CountTrackMediaItems ? CountTrackMediaItems(track) : 0;
-      if (itemCount == 0) {
-        if (ShowConsoleMsg) {
-          char msg[256];
-          snprintf(msg, sizeof(msg), "MAGDA: Track %d has no items for render\n", cmd.trackIndex);
-          ShowConsoleMsg(msg);
-        }
-        it = s_reaperCommandQueue.erase(it);
-        continue;
+    // Get the media item
+    int itemCount = CountTrackMediaItems ? CountTrackMediaItems(track) : 0;
+    if (itemCount == 0) {
+      if (ShowConsoleMsg) {
+        char msg[256];
+        snprintf(msg, sizeof(msg), "MAGDA: Track %d has no items for render\n", cmd.trackIndex);
+        ShowConsoleMsg(msg);
       }
+      abandonComparisonTrack(cmd);
+      return true;
+    }
 
-      MediaItem *item = GetTrackMediaItem ? GetTrackMediaItem(track, cmd.itemIndex) : nullptr;
-      if (!item) {
-        it = s_reaperCommandQueue.erase(it);
-        continue;
-      }
+    MediaItem *item = GetTrackMediaItem ? GetTrackMediaItem(track, cmd.itemIndex) : nullptr;
+    if (!item) {
+      abandonComparisonTrack(cmd);
+      return true;
+    }
 
-      // Select only this item
-      if (SetMediaItemSelected) {
-        // Deselect all items first
-        if (CountMediaItems && GetMediaItem) {
-          int totalItems = CountMediaItems(nullptr);
-          for (int i = 0; i < totalItems; i++) {
-            MediaItem *otherItem = GetMediaItem(nullptr, i);
-            if (otherItem) {
-              SetMediaItemSelected(otherItem, false);
-            }
+    // Select only this item
+    if (SetMediaItemSelected) {
+      // Deselect all items first
+      if (CountMediaItems && GetMediaItem) {
+        int totalItems = CountMediaItems(nullptr);
+        for (int i = 0; i < totalItems; i++) {
+          MediaItem *otherItem = GetMediaItem(nullptr, i);
+          if (otherItem) {
+            SetMediaItemSelected(otherItem, false);
           }
         }
-        SetMediaItemSelected(item, true);
       }
+      SetMediaItemSelected(item, true);
+    }
 
-      // Ensure active take is set
-      if (GetActiveTake && SetActiveTake) {
-        MediaItem_Take *activeTake = GetActiveTake(item);
-        if (!activeTake) {
-          int (*CountTakes)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
-          MediaItem_Take *(*GetTake)(MediaItem *, int) =
-              (MediaItem_Take * (*)(MediaItem *, int)) g_rec->GetFunc("GetTake");
-          if (CountTakes && GetTake) {
-            int takeCount = CountTakes(item);
-            if (takeCount > 0) {
-              MediaItem_Take *firstTake = GetTake(item, 0);
-              if (firstTake) {
-                SetActiveTake(firstTake);
-              }
+    // Ensure active take is set
+    if (GetActiveTake && SetActiveTake) {
+      MediaItem_Take *activeTake = GetActiveTake(item);
+      if (!activeTake) {
+        int (*CountTakes)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
+        MediaItem_Take *(*GetTake)(MediaItem *, int) =
+            (MediaItem_Take * (*)(MediaItem *, int)) g_rec->GetFunc("GetTake");
+        if (CountTakes && GetTake) {
+          int takeCount = CountTakes(item);
+          if (takeCount > 0) {
+            MediaItem_Take *firstTake = GetTake(item, 0);
+            if (firstTake) {
+              SetActiveTake(firstTake);
             }
           }
         }
       }
+    }
 
-      // Count takes BEFORE render so we know which one is new
-      int (*CountTakesFunc)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
-      int takesBefore = CountTakesFunc ? CountTakesFunc(item) : 0;
-
-      // Ensure take has a valid name before rendering (prevents garbage
-      // filenames)
-      if (GetActiveTake) {
-        MediaItem_Take *activeTake = GetActiveTake(item);
-        if (activeTake) {
-          bool (*GetSetMediaItemTakeInfo_String)(MediaItem_Take *, const char *, char *, bool) =
-              (bool (*)(MediaItem_Take *, const char *, char *, bool))g_rec->GetFunc(
-                  "GetSetMediaItemTakeInfo_String");
-
-          if (GetSetMediaItemTakeInfo_String) {
-            // Check if take has a name
-            char takeName[512] = {0};
-            GetSetMediaItemTakeInfo_String(activeTake, "P_NAME", takeName, false);
-
-            // If no name, set a default based on track name or generic name
-            if (takeName[0] == '\0') {
-              char defaultName[256];
-              if (cmd.trackName[0] != '\0') {
-                snprintf(defaultName, sizeof(defaultName), "%s", cmd.trackName);
-              } else {
-                snprintf(defaultName, sizeof(defaultName), "Track_%d", cmd.trackIndex + 1);
-              }
-              GetSetMediaItemTakeInfo_String(activeTake, "P_NAME", defaultName, true);
-              if (ShowConsoleMsg) {
-                char msg[512];
-                snprintf(msg, sizeof(msg), "MAGDA: Set default take name: '%s'\n", defaultName);
-                ShowConsoleMsg(msg);
-              }
+    // Count takes BEFORE render so we know which one is new
+    int (*CountTakesFunc)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
+    int takesBefore = CountTakesFunc ? CountTakesFunc(item) : 0;
+
+    // Ensure take has a valid name before rendering (prevents garbage
+    // filenames)
+    if (GetActiveTake) {
+      MediaItem_Take *activeTake = GetActiveTake(item);
+      if (activeTake) {
+        bool (*GetSetMediaItemTakeInfo_String)(MediaItem_Take *, const char *, char *, bool) =
+            (bool (*)(MediaItem_Take *, const char *, char *, bool))g_rec->GetFunc(
+                "GetSetMediaItemTakeInfo_String");
+
+        if (GetSetMediaItemTakeInfo_String) {
+          // Check if take has a name
+          char takeName[512] = {0};
+          GetSetMediaItemTakeInfo_String(activeTake, "P_NAME", takeName, false);
+
+          // If no name, set a default based on track name or generic name
+          if (takeName[0] == '\0') {
+            char defaultName[256];
+            if (cmd.trackName[0] != '\0') {
+              snprintf(defaultName, sizeof(defaultName), "%s", cmd.trackName);
+            } else {
+              snprintf(defaultName, sizeof(defaultName), "Track_%d", cmd.trackIndex + 1);
+            }
+            GetSetMediaItemTakeInfo_String(activeTake, "P_NAME", defaultName, true);
+            if (ShowConsoleMsg) {
+              char msg[512];
+              snprintf(msg, sizeof(msg), "MAGDA: Set default take name: '%s'\n", defaultName);
+              ShowConsoleMsg(msg);
             }
           }
         }
       }
+    }
 
-      // Render the item (apply FX to create new take)
-      // Use action 40209: "Item: Apply track FX to items as new take"
-      Main_OnCommand(40209, 0);
-      if (UpdateArrange) {
-        UpdateArrange();
-      }
+    // Render the item (apply FX to create new take)
+    // Use action 40209: "Item: Apply track FX to items as new take"
+    Main_OnCommand(40209, 0);
+    s_lastRenderTick = queue.GetTick();
+    if (UpdateArrange) {
+      UpdateArrange();
+    }
 
-      if (ShowConsoleMsg) {
-        char msg[256];
-        int takesAfter = CountTakesFunc ? CountTakesFunc(item) : 0;
-        snprintf(msg, sizeof(msg), "MAGDA: Applied FX to item (takes: %d -> %d)\n", takesBefore,
-                 takesAfter);
-        ShowConsoleMsg(msg);
-      }
+    if (ShowConsoleMsg) {
+      char msg[256];
+      int takesAfter = CountTakesFunc ? CountTakesFunc(item) : 0;
+      snprintf(msg, sizeof(msg), "MAGDA: Applied FX to item (takes: %d -> %d)\n", takesBefore,
+               takesAfter);
+      ShowConsoleMsg(msg);
+    }
 
-      // Mark as completed
-      cmd.completed = true;
-      processedAny = true;
-
-      // If this render should continue with DSP analysis, queue it
-      // DSP must run on main thread because audio accessor API is not
-      // thread-safe
-      if (cmd.startAsyncAfterRender) {
-        // Queue DSP analysis command (runs on main thread)
-        // Note: Active take will be set in CMD_DSP_ANALYZE right before
-        // analysis
-        ReaperCommand dspCmd;
-        dspCmd.type = CMD_DSP_ANALYZE;
-        dspCmd.trackIndex = cmd.trackIndex;
-        dspCmd.selectedTrackIndex = cmd.selectedTrackIndex;
-        dspCmd.itemPtr = (void *)item;
-        dspCmd.takeIndex = takesBefore;
-        dspCmd.completed = false;
-        dspCmd.deferCount = 100; // Max 100 attempts (~3-5 seconds)
-        dspCmd.lastFileSize = 0; // Will check file size stability
-        dspCmd.stableCount = 0;  // Need 3 stable readings
-        dspCmd.deleteTrackAfterAnalysis = cmd.deleteTrackAfterAnalysis; // Propagate cleanup flag
-        strncpy(dspCmd.trackName, cmd.trackName, sizeof(dspCmd.trackName) - 1);
-        dspCmd.trackName[sizeof(dspCmd.trackName) - 1] = '\0';
-        strncpy(dspCmd.trackType, cmd.trackType, sizeof(dspCmd.trackType) - 1);
-        dspCmd.trackType[sizeof(dspCmd.trackType) - 1] = '\0';
-        strncpy(dspCmd.userRequest, cmd.userRequest, sizeof(dspCmd.userRequest) - 1);
-        dspCmd.userRequest[sizeof(dspCmd.userRequest) - 1] = '\0';
-        commandsToAdd.push_back(dspCmd);
+    // If this render should continue with DSP analysis, queue it
+    // DSP must run on main thread because audio accessor API is not
+    // thread-safe
+    if (cmd.startAsyncAfterRender) {
+      // Queue DSP analysis command (runs on main thread)
+      // Note: Active take will be set in CMD_DSP_ANALYZE right before
+      // analysis
+      ReaperCommand dspCmd;
+      dspCmd.type = CMD_DSP_ANALYZE;
+      dspCmd.trackIndex = cmd.trackIndex;
+      dspCmd.selectedTrackIndex = cmd.selectedTrackIndex;
+      dspCmd.itemPtr = (void *)item;
+      dspCmd.takeIndex = takesBefore;
+      dspCmd.deferCount = 100; // Max 100 attempts (~3-5 seconds)
+      dspCmd.lastFileSize = 0; // Will check file size stability
+      dspCmd.stableCount = 0;  // Need 3 stable readings
+      dspCmd.deleteTrackAfterAnalysis = cmd.deleteTrackAfterAnalysis; // Propagate cleanup flag
+      dspCmd.comparison = cmd.comparison;
+      dspCmd.comparisonSlot = cmd.comparisonSlot;
+      strncpy(dspCmd.trackName, cmd.trackName, sizeof(dspCmd.trackName) - 1);
+      dspCmd.trackName[sizeof(dspCmd.trackName) - 1] = '\0';
+      strncpy(dspCmd.trackType, cmd.trackType, sizeof(dspCmd.trackType) - 1);
+      dspCmd.trackType[sizeof(dspCmd.trackType) - 1] = '\0';
+      strncpy(dspCmd.userRequest, cmd.userRequest, sizeof(dspCmd.userRequest) - 1);
+      dspCmd.userRequest[sizeof(dspCmd.userRequest) - 1] = '\0';
+      QueueCommand(dspCmd);
+    }
+    return true;
+  } else if (cmd.type == CMD_DELETE_TRACK) {
+    // Execute delete command
+    bool (*DeleteTrack)(MediaTrack *) = (bool (*)(MediaTrack *))g_rec->GetFunc("DeleteTrack");
+
+    if (DeleteTrack) {
+      MediaTrack *track = GetTrack ? GetTrack(nullptr, cmd.trackIndex) : nullptr;
+      if (track) {
+        DeleteTrack(track);
+        if (UpdateArrange) {
+          UpdateArrange();
+        }
+        if (ShowConsoleMsg) {
+          char msg[256];
+          snprintf(msg, sizeof(msg), "MAGDA: Deleted track %d\n", cmd.trackIndex);
+          ShowConsoleMsg(msg);
+        }
       }
+    }
+
+    return true;
+  } else if (cmd.type == CMD_DELETE_TAKE) {
+    // Delete the rendered take from the item by index
+    MediaItem *item = (MediaItem *)cmd.itemPtr;
+    if (item) {
+      int (*CountTakes)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
+      MediaItem_Take *(*GetTake)(MediaItem *, int) =
+          (MediaItem_Take * (*)(MediaItem *, int)) g_rec->GetFunc("GetTake");
+      void (*SetActiveTake)(MediaItem_Take *) =
+          (void (*)(MediaItem_Take *))g_rec->GetFunc("SetActiveTake");
+
+      if (CountTakes && GetTake && SetActiveTake) {
+        int takeCount = CountTakes(item);
+        int takeToDelete = cmd.takeIndex;
+
+        if (takeCount > 1 && takeToDelete < takeCount) {
+          // Select only this item for the delete action
+          bool (*SetMediaItemSelected)(MediaItem *, bool) =
+              (bool (*)(MediaItem *, bool))g_rec->GetFunc("SetMediaItemSelected");
+          if (SetMediaItemSelected && CountMediaItems && GetMediaItem) {
+            int totalItems = CountMediaItems(nullptr);
+            for (int i = 0; i < totalItems; i++) {
+              MediaItem *otherItem = GetMediaItem(nullptr, i);
+              if (otherItem) {
+                SetMediaItemSelected(otherItem, false);
+              }
+            }
+            SetMediaItemSelected(item, true);
+          }
 
-      // Move to next command
-      ++it;
-    } else if (cmd.type == CMD_DELETE_TRACK) {
-      // Execute delete command
-      bool (*DeleteTrack)(MediaTrack *) = (bool (*)(MediaTrack *))g_rec->GetFunc("DeleteTrack");
+          // The rendered take is currently active (REAPER made it active
+          // after render) Delete the active take
+          Main_OnCommand(40129, 0); // Take: Delete active take from items
+
+          // Set the original take (index 0) as active so user sees original
+          MediaItem_Take *originalTake = GetTake(item, 0);
+          if (originalTake) {
+            SetActiveTake(originalTake);
+          }
 
-      if (DeleteTrack) {
-        MediaTrack *track = GetTrack ? GetTrack(nullptr, cmd.trackIndex) : nullptr;
-        if (track) {
-          DeleteTrack(track);
           if (UpdateArrange) {
             UpdateArrange();
           }
           if (ShowConsoleMsg) {
-            char msg[256];
-            snprintf(msg, sizeof(msg), "MAGDA: Deleted track %d\n", cmd.trackIndex);
-            ShowConsoleMsg(msg);
+            ShowConsoleMsg("MAGDA: Deleted rendered take, restored original\n");
+          }
+        } else {
+          if (ShowConsoleMsg) {
+            ShowConsoleMsg("MAGDA: Only one take, skipping take deletion\n");
           }
         }
       }
+    }
 
-      cmd.completed = true;
-      processedAny = true;
-      ++it;
-    } else if (cmd.type == CMD_DELETE_TAKE) {
-      // Delete the rendered take from the item by index
-      MediaItem *item = (MediaItem *)cmd.itemPtr;
-      if (item) {
-        int (*CountTakes)(MediaItem *) = (int (*)(MediaItem *))g_rec->GetFunc("CountTakes");
-        MediaItem_Take *(*GetTake)(MediaItem *, int) =
-            (MediaItem_Take * (*)(MediaItem *, int)) g_rec->GetFunc("GetTake");
-        void (*SetActiveTake)(MediaItem_Take *) =
-            (void (*)(MediaItem_Take *))g_rec->GetFunc("SetActiveTake");
-
-        if (CountTakes && GetTake && SetActiveTake) {
-          int takeCount = CountTakes(item);
-          int takeToDelete = cmd.takeIndex;
-
-          if (takeCount > 1 && takeToDelete < takeCount) {
-            // Select only this item for the delete action
-            bool (*SetMediaItemSelected)(MediaItem *, bool) =
-                (bool (*)(MediaItem *, bool))g_rec->GetFunc("SetMediaItemSelected");
-            if (SetMediaItemSelected && CountMediaItems && GetMediaItem) {
-              int totalItems = CountMediaItems(nullptr);
-              for (int i = 0; i < totalItems; i++) {
-                MediaItem *otherItem = GetMediaItem(nullptr, i);
-                if (otherItem) {
-                  SetMediaItemSelected(otherItem, false);
-                }
-              }
-              SetMediaItemSelected(item, true);
-            }
+    return true;
+  } else if (cmd.type == CMD_DSP_ANALYZE) {
+    // Rendered take (single track) or temp stem track (master) once the
+    // samples are all read
+    auto queueCleanup = [&cmd]() {
+      ReaperCommand deleteCmd;
+      if (cmd.deleteTrackAfterAnalysis) {
+        // For stem workflows, delete the entire temp track
+        deleteCmd.type = CMD_DELETE_TRACK;
+        deleteCmd.trackIndex = cmd.trackIndex;
+      } else {
+        // For single track workflows, just delete the rendered take
+        deleteCmd.type = CMD_DELETE_TAKE;
+        deleteCmd.trackIndex = cmd.trackIndex;
+        deleteCmd.itemPtr = cmd.itemPtr;
+        deleteCmd.takeIndex = cmd.takeIndex;
+      }
+      QueueCommand(deleteCmd);
+    };
+
+    if (cmd.analysis) {
+      // Reading: one budgeted step per tick, the analysis runs on the pool
+      bool readDone = cmd.analysis->Step(kReadStepBudgetMs);
+      if (!cmd.comparison) {
+        SetPhaseProgress(cmd.analysis->GetProgress());
+      }
+      if (!readDone) {
+        return false;
+      }
+      queueCleanup();
+      return true;
+    }
 
-            // The rendered take is currently active (REAPER made it active
-            // after render) Delete the active take
-            Main_OnCommand(40129, 0); // Take: Delete active take from items
+    // Set phase to DSP analysis
+    SetCurrentPhase(MIX_PHASE_DSP_ANALYSIS);
 
-            // Set the original take (index 0) as active so user sees original
-            MediaItem_Take *originalTake = GetTake(item, 0);
-            if (originalTake) {
-              SetActiveTake(originalTake);
-            }
+    // Check if rendered file is ready (size has stabilized)
+    MediaItem *dspItem = (MediaItem *)cmd.itemPtr;
+    bool fileReady = false;
 
-            if (UpdateArrange) {
-              UpdateArrange();
-            }
-            if (ShowConsoleMsg) {
-              ShowConsoleMsg("MAGDA: Deleted rendered take, restored original\n");
-            }
-          } else {
-            if (ShowConsoleMsg) {
-              ShowConsoleMsg("MAGDA: Only one take, skipping take deletion\n");
-            }
-          }
-        }
-      }
+    if (dspItem) {
+      MediaItem_Take *(*GetActiveTake)(MediaItem *) =
+          (MediaItem_Take * (*)(MediaItem *)) g_rec->GetFunc("GetActiveTake");
+      PCM_source *(*GetMediaItemTake_Source)(MediaItem_Take *) =
+          (PCM_source * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Source");
+      void (*GetMediaSourceFileName)(PCM_source *, char *, int) =
+          (void (*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceFileName");
 
-      cmd.completed = true;
-      processedAny = true;
-      ++it;
-    } else if (cmd.type == CMD_DSP_ANALYZE) {
-      // Set phase to DSP analysis
-      SetCurrentPhase(MIX_PHASE_DSP_ANALYSIS);
-
-      // Check if rendered file is ready (size has stabilized)
-      MediaItem *dspItem = (MediaItem *)cmd.itemPtr;
-      bool fileReady = false;
-
-      if (dspItem) {
-        MediaItem_Take *(*GetActiveTake)(MediaItem *) =
-            (MediaItem_Take * (*)(MediaItem *)) g_rec->GetFunc("GetActiveTake");
-        PCM_source *(*GetMediaItemTake_Source)(MediaItem_Take *) =
-            (PCM_source * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Source");
-        void (*GetMediaSourceFileName)(PCM_source *, char *, int) =
-            (void (*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceFileName");
-
-        if (GetActiveTake && GetMediaItemTake_Source && GetMediaSourceFileName) {
-          MediaItem_Take *activeTake = GetActiveTake(dspItem);
-          if (activeTake) {
-            PCM_source *src = GetMediaItemTake_Source(activeTake);
-            if (src) {
-              char filename[512] = {0};
-              GetMediaSourceFileName(src, filename, sizeof(filename));
-
-              if (filename[0]) {
-                FILE *f = fopen(filename, "rb");
-                if (f) {
-                  fseek(f, 0, SEEK_END);
-                  long currentSize = ftell(f);
-                  fclose(f);
-
-                  if (currentSize > 0 && currentSize == cmd.lastFileSize) {
-                    cmd.stableCount++;
-                    if (cmd.stableCount >= 3) {
-                      fileReady = true;
-                      if (ShowConsoleMsg) {
-                        char msg[256];
-                        snprintf(msg, sizeof(msg),
-                                 "MAGDA: File ready (%ld bytes, stable for %d "
-                                 "ticks)\n",
-                                 currentSize, cmd.stableCount);
-                        ShowConsoleMsg(msg);
-                      }
+      if (GetActiveTake && GetMediaItemTake_Source && GetMediaSourceFileName) {
+        MediaItem_Take *activeTake = GetActiveTake(dspItem);
+        if (activeTake) {
+          PCM_source *src = GetMediaItemTake_Source(activeTake);
+          if (src) {
+            char filename[512] = {0};
+            GetMediaSourceFileName(src, filename, sizeof(filename));
+
+            if (filename[0]) {
+              FILE *f = fopen(filename, "rb");
+              if (f) {
+                fseek(f, 0, SEEK_END);
+                long currentSize = ftell(f);
+                fclose(f);
+
+                if (currentSize > 0 && currentSize == cmd.lastFileSize) {
+                  cmd.stableCount++;
+                  if (cmd.stableCount >= 3) {
+                    fileReady = true;
+                    if (ShowConsoleMsg) {
+                      char msg[256];
+                      snprintf(msg, sizeof(msg),
+                               "MAGDA: File ready (%ld bytes, stable for %d ticks)\n", currentSize,
+                               cmd.stableCount);
+                      ShowConsoleMsg(msg);
                     }
-                  } else {
-                    cmd.stableCount = 0;
                   }
-                  cmd.lastFileSize = currentSize;
+                } else {
+                  cmd.stableCount = 0;
                 }
+                cmd.lastFileSize = currentSize;
               }
             }
           }
         }
       }
+    }
 
-      // If file not ready, defer (up to max attempts)
-      if (!fileReady && cmd.deferCount > 0) {
-        cmd.deferCount--;
-        ++it;
-        continue; // Skip this command for now, process on next tick
-      }
-
-      if (!fileReady) {
-        if (ShowConsoleMsg) {
-          ShowConsoleMsg("MAGDA: Warning - proceeding with DSP despite file "
-                         "not stabilizing\n");
-        }
-      }
+    // If file not ready, defer (up to max attempts)
+    if (!fileReady && cmd.deferCount > 0) {
+      cmd.deferCount--;
+      return false; // Try again on the next tick
+    }
 
-      // Read audio samples on main thread (audio accessor requires main thread)
-      // Then do DSP analysis + API call on background thread
+    if (!fileReady) {
       if (ShowConsoleMsg) {
-        ShowConsoleMsg("MAGDA: Reading audio samples on main thread...\n");
+        ShowConsoleMsg("MAGDA: Warning - proceeding with DSP despite file "
+                       "not stabilizing\n");
       }
+    }
 
-      // Configure and read samples (main thread only)
-      DSPAnalysisConfig dspConfig;
-      dspConfig.fftSize = 4096;
-      dspConfig.analyzeFullItem = true;
-
-      RawAudioData audioData = MagdaDSPAnalyzer::ReadTrackSamples(cmd.trackIndex, dspConfig);
-
-      if (!audioData.valid || audioData.samples.empty()) {
-        if (ShowConsoleMsg) {
-          ShowConsoleMsg("MAGDA: Failed to read audio samples\n");
-        }
-        // Still queue cleanup even on failure
-        ReaperCommand deleteCmd;
-        if (cmd.deleteTrackAfterAnalysis) {
-          // For stem workflows, delete the entire temp track
-          deleteCmd.type = CMD_DELETE_TRACK;
-          deleteCmd.trackIndex = cmd.trackIndex;
-        } else {
-          // For single track workflows, just delete the rendered take
-          deleteCmd.type = CMD_DELETE_TAKE;
-          deleteCmd.trackIndex = cmd.trackIndex;
-          deleteCmd.itemPtr = cmd.itemPtr;
-          deleteCmd.takeIndex = cmd.takeIndex;
-        }
-        deleteCmd.completed = false;
-        commandsToAdd.push_back(deleteCmd);
-      } else {
-        if (ShowConsoleMsg) {
-          char msg[256];
-          snprintf(msg, sizeof(msg), "MAGDA: Read %zu samples, starting background analysis...\n",
-                   audioData.samples.size());
-          ShowConsoleMsg(msg);
+    // Read the take a step per tick on the main thread (audio accessor
+    // requires main thread) while the pool analyzes what has been read
+    DSPAnalysisConfig dspConfig;
+    dspConfig.fftSize = 4096;
+    dspConfig.analyzeFullItem = true;
+
+    WDL_FastString fxJson;
+    MagdaDSPAnalyzer::GetTrackFXInfo(cmd.trackIndex, fxJson);
+
+    MagdaChunkedAnalysis::DoneCallback onDone;
+    if (cmd.comparison) {
+      std::shared_ptr<MultiTrackComparison> comparison = cmd.comparison;
+      int slot = cmd.comparisonSlot;
+      double (*GetMediaItemInfo_Value)(MediaItem *, const char *) =
+          (double (*)(MediaItem *, const char *))g_rec->GetFunc("GetMediaItemInfo_Value");
+      {
+        std::lock_guard<std::mutex> comparisonLock(comparison->mutex);
+        comparison->tracks[slot].fxJson = fxJson.Get();
+        if (GetMediaItemInfo_Value && cmd.itemPtr) {
+          comparison->tracks[slot].startTime =
+              GetMediaItemInfo_Value((MediaItem *)cmd.itemPtr, "D_POSITION");
         }
+      }
 
-        // Get FX info on main thread (needs REAPER API)
-        WDL_FastString fxJson;
-        MagdaDSPAnalyzer::GetTrackFXInfo(cmd.trackIndex, fxJson);
-        std::string fxStr = fxJson.Get();
-
-        // Copy data for background thread
-        int trackIndex = cmd.trackIndex;
-        int selectedTrackIndex = cmd.selectedTrackIndex;
-        void *itemPtr = cmd.itemPtr;
-        int takeIndex = cmd.takeIndex;
-        bool deleteTrackAfter = cmd.deleteTrackAfterAnalysis;
-        char trackName[256];
-        char trackType[256];
-        char userRequest[1024];
-        strncpy(trackName, cmd.trackName, sizeof(trackName) - 1);
-        trackName[sizeof(trackName) - 1] = '\0';
-        strncpy(trackType, cmd.trackType, sizeof(trackType) - 1);
-        trackType[sizeof(trackType) - 1] = '\0';
-        strncpy(userRequest, cmd.userRequest, sizeof(userRequest) - 1);
-        userRequest[sizeof(userRequest) - 1] = '\0';
-
-        // Move audio data to background thread for processing
-        std::thread([trackIndex, selectedTrackIndex, itemPtr, takeIndex, deleteTrackAfter,
-                     trackName, trackType, userRequest, fxStr, audioData = std::move(audioData),
-                     dspConfig]() mutable {
+      // Critical-band frames feed the cross-track masking matrix
+      dspConfig.analyzeFeatureFrames = true;
+      dspConfig.criticalBandFrames = true;
+
+      onDone = [comparison, slot](DSPAnalysisResult &analysisResult) {
+        WDL_FastString analysisJson;
+        if (analysisResult.success) {
+          // The frames go into the masking matrix rather than the prompt
+          {
+            std::lock_guard<std::mutex> comparisonLock(comparison->mutex);
+            comparison->tracks[slot].frames = std::move(analysisResult.featureFrames);
+          }
+          analysisResult.featureFrames = FeatureFrames();
+          MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson,
+                                   GetComparisonJSONOptions((int)comparison->tracks.size()));
+        }
+        FinishComparisonTrack(comparison, slot, analysisJson.Get());
+      };
+    } else {
+      std::string fxStr = fxJson.Get();
+      std::string trackName = cmd.trackName;
+      std::string trackType = cmd.trackType[0] ? cmd.trackType : "other";
+      std::string userRequest = cmd.userRequest;
+      int selectedTrackIndex = cmd.selectedTrackIndex;
+      onDone = [fxStr, trackName, trackType, userRequest,
+                selectedTrackIndex](DSPAnalysisResult &analysisResult) {
+        if (!analysisResult.success) {
           void (*ShowConsoleMsg)(const char *msg) =
               (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
-
-          // Run DSP analysis on background thread
           if (ShowConsoleMsg) {
-            ShowConsoleMsg("MAGDA: Running DSP analysis on background thread...\n");
-          }
-
-          DSPAnalysisResult analysisResult = MagdaDSPAnalyzer::AnalyzeSamples(audioData, dspConfig);
-
-          if (!analysisResult.success) {
-            if (ShowConsoleMsg) {
-              char msg[512];
-              snprintf(msg, sizeof(msg), "MAGDA: DSP analysis failed: %s\n",
-                       analysisResult.errorMessage.Get());
-              ShowConsoleMsg(msg);
-            }
-            StoreResult(false,
-                        std::string("DSP analysis failed: ") + analysisResult.errorMessage.Get());
-          } else {
-            // Convert to JSON
-            WDL_FastString analysisJson;
-            MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson);
-
-            // Queue cleanup BEFORE API call (must be done on main thread)
-            {
-              std::lock_guard<std::mutex> cmdLock(s_commandQueueMutex);
-
-              if (deleteTrackAfter) {
-                // For stem workflows (master analysis), delete the entire temp track
-                ReaperCommand deleteCmd;
-                deleteCmd.type = CMD_DELETE_TRACK;
-                deleteCmd.trackIndex = trackIndex;
-                deleteCmd.completed = false;
-                s_reaperCommandQueue.push_back(deleteCmd);
-              } else {
-                // For single track workflows, just delete the rendered take
-                ReaperCommand deleteCmd;
-                deleteCmd.type = CMD_DELETE_TAKE;
-                deleteCmd.trackIndex = trackIndex;
-                deleteCmd.itemPtr = itemPtr;
-                deleteCmd.takeIndex = takeIndex;
-                deleteCmd.completed = false;
-                s_reaperCommandQueue.push_back(deleteCmd);
-              }
-            }
-
-            if (ShowConsoleMsg) {
-              ShowConsoleMsg(deleteTrackAfter
-                                 ? "MAGDA: Queued track deletion, calling Mix API...\n"
-                                 : "MAGDA: Queued take deletion, calling Mix API...\n");
-            }
-
-            // Send to mix API with TRUE STREAMING
-            // Text is streamed to the UI in real-time via
-            // MagdaBounceWorkflow::AppendStreamText
-            WDL_FastString responseJson, error_msg;
-            if (!SendToMixAPI(analysisJson.Get(), fxStr.c_str(), trackType[0] ? trackType : "other",
-                              userRequest[0] ? userRequest : "", selectedTrackIndex, trackName,
-                              responseJson, error_msg)) {
-              if (ShowConsoleMsg) {
-                char msg[512];
-                snprintf(msg, sizeof(msg), "MAGDA: Mix API call failed: %s\n", error_msg.Get());
-                ShowConsoleMsg(msg);
-              }
-              // Error already reported via CompleteStreaming in SendToMixAPI
-            } else {
-              if (ShowConsoleMsg) {
-                ShowConsoleMsg("MAGDA: Mix analysis streaming completed successfully!\n");
-              }
-              // Success already handled by streaming - text was streamed to UI
-              // in real-time and CompleteStreaming was called
-            }
+            char msg[512];
+            snprintf(msg, sizeof(msg), "MAGDA: DSP analysis failed: %s\n",
+                     analysisResult.errorMessage.Get());
+            ShowConsoleMsg(msg);
           }
-          // Take deletion already queued before API call
-        }).detach();
-      }
+          StoreResult(false,
+                      std::string("DSP analysis failed: ") + analysisResult.errorMessage.Get());
+          return;
+        }
 
-      cmd.completed = true;
-      processedAny = true;
-      ++it;
-    } else {
-      // Unknown command type, remove it
-      it = s_reaperCommandQueue.erase(it);
+        WDL_FastString analysisJson;
+        MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson, GetMixPromptJSONOptions());
+        StartMixAPIThread(analysisJson.Get(), fxStr, trackName, trackType, userRequest,
+                          selectedTrackIndex);
+      };
     }
-  }
-
-  // Add any new commands that were queued during processing
-  // (done after loop to avoid iterator invalidation)
-  for (const auto &newCmd : commandsToAdd) {
-    s_reaperCommandQueue.push_back(newCmd);
-  }
-
-  return processedAny;
-}
-
-bool MagdaBounceWorkflow::ProcessCleanupQueue() {
-  std::lock_guard<std::mutex> lock(s_cleanupMutex);
-
-  if (s_tracksToDelete.empty()) {
-    return false;
-  }
-
-  void (*ShowConsoleMsg)(const char *msg) =
-      (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
-  bool (*DeleteTrack)(MediaTrack *) = (bool (*)(MediaTrack *))g_rec->GetFunc("DeleteTrack");
-  MediaTrack *(*GetTrack)(ReaProject *, int) =
-      (MediaTrack * (*)(ReaProject *, int)) g_rec->GetFunc("GetTrack");
-  void (*UpdateArrange)() = (void (*)())g_rec->GetFunc("UpdateArrange");
-
-  if (!DeleteTrack || !GetTrack) {
-    s_tracksToDelete.clear();
-    return false;
-  }
 
-  // Delete tracks one at a time
-  for (int trackIndex : s_tracksToDelete) {
-    MediaTrack *track = GetTrack(nullptr, trackIndex);
-    if (track) {
-      DeleteTrack(track);
+    WDL_FastString openError;
+    std::unique_ptr<MagdaBlockSource> source =
+        MagdaDSPAnalyzer::OpenTakeSource(cmd.trackIndex, dspConfig, openError);
+    cmd.analysis = MagdaChunkedAnalysis::Start(std::move(source), dspConfig, onDone);
+    if (!cmd.analysis) {
       if (ShowConsoleMsg) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "MAGDA: Deleted track %d\n", trackIndex);
+        char msg[512];
+        snprintf(msg, sizeof(msg), "MAGDA: Failed to read audio samples: %s\n", openError.Get());
         ShowConsoleMsg(msg);
       }
+      if (cmd.comparison) {
+        FinishComparisonTrack(cmd.comparison, cmd.comparisonSlot, "");
+      } else {
+        StoreResult(false, std::string("Failed to read audio samples: ") + openError.Get());
+      }
+      // Still queue cleanup even on failure
+      queueCleanup();
+      return true;
     }
-  }
 
-  s_tracksToDelete.clear();
+    if (ShowConsoleMsg) {
+      ShowConsoleMsg("MAGDA: Reading audio samples in steps, analyzing on pool...\n");
+    }
+    return false; // First read step on the next tick
+  } else if (cmd.type == CMD_ANALYZE_TRACK_OUTPUT) {
+    // Stream the track's output through the analyzer a step per
+    // tick (accessor reads must happen on the main thread) while the pool
+    // analyzes it; the finished JSON goes to the API from a background
+    // thread
+    if (!cmd.analysis) {
+      DSPAnalysisConfig dspConfig;
+      dspConfig.fftSize = 4096;
+      dspConfig.analyzeFullItem = true;
 
-  if (UpdateArrange) {
-    UpdateArrange();
+      // The accessor couldn't deliver the signal: bounce instead
+      ReaperCommand renderCmd = cmd;
+      renderCmd.type = CMD_RENDER_ITEM;
+      renderCmd.itemIndex = 0;
+      renderCmd.startAsyncAfterRender = true;
+      renderCmd.deleteTrackAfterAnalysis = false;
+      auto fallBackToBounce = [renderCmd](const char *reason) {
+        void (*ShowConsoleMsg)(const char *msg) =
+            (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+        if (ShowConsoleMsg) {
+          char msg[512];
+          snprintf(msg, sizeof(msg), "MAGDA: Track output analysis failed (%s), bouncing\n",
+                   reason);
+          ShowConsoleMsg(msg);
+        }
+        SetCurrentPhase(MIX_PHASE_RENDERING);
+        QueueCommand(renderCmd);
+      };
+
+      WDL_FastString fxJson;
+      MagdaDSPAnalyzer::GetTrackFXInfo(cmd.trackIndex, fxJson);
+      std::string fxStr = fxJson.Get();
+      std::string trackName = cmd.trackName;
+      std::string trackType = cmd.trackType[0] ? cmd.trackType : "other";
+      std::string userRequest = cmd.userRequest;
+      int selectedTrackIndex = cmd.selectedTrackIndex;
+      auto onDone = [fallBackToBounce, fxStr, trackName, trackType, userRequest,
+                     selectedTrackIndex](DSPAnalysisResult &analysisResult) {
+        if (!analysisResult.success) {
+          fallBackToBounce(analysisResult.errorMessage.Get());
+          return;
+        }
+        WDL_FastString analysisJson;
+        MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson, GetMixPromptJSONOptions());
+        StartMixAPIThread(analysisJson.Get(), fxStr, trackName, trackType, userRequest,
+                          selectedTrackIndex);
+      };
+
+      // Track output depends on live FX state, so it is never cached
+      WDL_FastString openError;
+      std::unique_ptr<MagdaBlockSource> source = MagdaDSPAnalyzer::OpenTrackOutputSource(
+          cmd.trackIndex, dspConfig, cmd.rangeStart, cmd.rangeEnd, openError);
+      cmd.analysis = MagdaChunkedAnalysis::Start(std::move(source), dspConfig, onDone);
+      if (!cmd.analysis) {
+        fallBackToBounce(openError.Get());
+        return true;
+      }
+    }
+
+    bool readDone = cmd.analysis->Step(kReadStepBudgetMs);
+    SetPhaseProgress(cmd.analysis->GetProgress());
+    return readDone;
   }
 
+  // Unknown command type, drop it
   return true;
 }
@@ -0,0 +1,164 @@
+#include "magda_chunked_analysis.h"
+#include "magda_dsp_stream.h"
+#include "magda_worker_pool.h"
+#include <chrono>
+
+// Ring size in blocks: enough for the reader to stay ahead of the analysis
+// for a few ticks without holding much audio in memory
+static const int kRingBlocks = 8;
+
+std::shared_ptr<MagdaChunkedAnalysis>
+MagdaChunkedAnalysis::Start(std::unique_ptr<MagdaBlockSource> source,
+                            const DSPAnalysisConfig &config, DoneCallback onDone) {
+  if (!source || source->GetChannels() <= 0 || source->GetSampleRate() <= 0) {
+    return nullptr;
+  }
+  bool offThread = !source->NeedsMainThread();
+  std::shared_ptr<MagdaChunkedAnalysis> analysis(
+      new MagdaChunkedAnalysis(std::move(source), config, std::move(onDone)));
+  if (offThread) {
+    // Nothing ties the reads to the main thread: one pool task does it all
+    analysis->m_offThread = true;
+    MagdaWorkerPool::Get().Submit([analysis]() { analysis->ReadOffThread(); });
+  }
+  return analysis;
+}
+
+MagdaChunkedAnalysis::MagdaChunkedAnalysis(std::unique_ptr<MagdaBlockSource> source,
+                                           const DSPAnalysisConfig &config, DoneCallback onDone)
+    : m_config(config), m_onDone(std::move(onDone)), m_channels(source->GetChannels()),
+      m_blockFrames(config.streamBlockSize > 0 ? config.streamBlockSize : 16384),
+      m_totalFrames(source->GetTotalFrames()), m_source(std::move(source)), m_framesRead(0),
+      m_ring((size_t)kRingBlocks * m_blockFrames * m_channels), m_readDone(false),
+      m_readFailed(false), m_draining(false), m_done(false), m_framesAnalyzed(0),
+      m_offThread(false) {
+  m_readBlock.resize((size_t)m_blockFrames * m_channels);
+  m_drainBlock.resize((size_t)m_blockFrames * m_channels);
+  m_stream.reset(new MagdaDSPStream(m_source->GetSampleRate(), m_channels, m_config,
+                                    m_totalFrames));
+}
+
+MagdaChunkedAnalysis::~MagdaChunkedAnalysis() {}
+
+bool MagdaChunkedAnalysis::Step(double budgetMs, long long maxFrames) {
+  if (m_offThread || m_readDone.load()) {
+    return m_readDone.load();
+  }
+
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  long long framesThisStep = 0;
+  while (true) {
+    long long frames = (long long)(m_ring.GetWriteAvailable() / m_channels);
+    frames = frames < m_blockFrames ? frames : m_blockFrames;
+    if (maxFrames > 0 && frames > maxFrames - framesThisStep) {
+      frames = maxFrames - framesThisStep;
+    }
+    if (frames <= 0) {
+      break;
+    }
+
+    int framesRead = m_source->ReadBlock(m_readBlock.data(), (int)frames);
+    if (framesRead <= 0) {
+      FinishReading(framesRead < 0 || !m_source->HadAudio());
+      return true;
+    }
+    m_ring.Write(m_readBlock.data(), (size_t)framesRead * m_channels);
+    framesThisStep += framesRead;
+    m_framesRead += framesRead;
+
+    if (m_framesRead >= m_totalFrames) {
+      FinishReading(!m_source->HadAudio());
+      return true;
+    }
+    if (std::chrono::duration<double, std::milli>(Clock::now() - start).count() >= budgetMs) {
+      break;
+    }
+  }
+
+  if (framesThisStep > 0) {
+    ScheduleDrain();
+  }
+  return false;
+}
+
+float MagdaChunkedAnalysis::GetProgress() const {
+  if (m_done.load()) {
+    return 1.0f;
+  }
+  return m_totalFrames > 0 ? (float)m_framesAnalyzed.load() / m_totalFrames : 0.0f;
+}
+
+void MagdaChunkedAnalysis::FinishReading(bool failed) {
+  // Accessors must be destroyed on the main thread
+  m_source.reset();
+  m_readFailed.store(failed);
+  m_readDone.store(true);
+  ScheduleDrain();
+}
+
+void MagdaChunkedAnalysis::ScheduleDrain() {
+  if (m_draining.exchange(true)) {
+    return;
+  }
+  std::shared_ptr<MagdaChunkedAnalysis> self = shared_from_this();
+  MagdaWorkerPool::Get().Submit([self]() { self->Drain(); });
+}
+
+void MagdaChunkedAnalysis::ReadOffThread() {
+  int framesRead = 0;
+  while ((framesRead = m_source->ReadBlock(m_drainBlock.data(), m_blockFrames)) > 0) {
+    m_stream->Process(m_drainBlock.data(), framesRead);
+    m_framesAnalyzed += framesRead;
+  }
+  bool failed = framesRead < 0 || !m_source->HadAudio();
+  m_source.reset();
+  m_readDone.store(true);
+
+  DSPAnalysisResult result;
+  if (failed) {
+    result.errorMessage.Set("Failed to read audio samples");
+  } else {
+    result = m_stream->Finish();
+  }
+  m_stream.reset();
+  m_onDone(result);
+  m_done.store(true);
+}
+
+void MagdaChunkedAnalysis::Drain() {
+  while (true) {
+    size_t count = 0;
+    while ((count = m_ring.Read(m_drainBlock.data(), m_drainBlock.size())) > 0) {
+      int frames = (int)(count / m_channels);
+      m_stream->Process(m_drainBlock.data(), frames);
+      m_framesAnalyzed += frames;
+    }
+
+    // Everything the reader will ever write is in the ring once m_readDone
+    // is set, so an empty ring now means the end. This task keeps
+    // m_draining so no other drain can start.
+    if (m_readDone.load() && m_ring.GetReadAvailable() == 0) {
+      DSPAnalysisResult result;
+      if (m_readFailed.load()) {
+        result.errorMessage.Set("Failed to read audio samples");
+      } else {
+        result = m_stream->Finish();
+      }
+      m_stream.reset();
+      m_onDone(result);
+      m_done.store(true);
+      return;
+    }
+
+    // Hand the consumer side back, then take it again if the reader added
+    // something in between (its ScheduleDrain() may have seen us still busy)
+    m_draining.store(false);
+    if (m_ring.GetReadAvailable() == 0 && !m_readDone.load()) {
+      return;
+    }
+    if (m_draining.exchange(true)) {
+      return;
+    }
+  }
+}
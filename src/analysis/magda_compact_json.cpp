@@ -0,0 +1,164 @@
+#include "magda_compact_json.h"
+#include <cmath>
+
+static const double kPowersOfTen[] = {1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0};
+static const int kMaxDecimals = 6;
+// Beyond this the scaled value no longer fits the integer path
+static const double kMaxScaled = 9.0e15;
+
+int MagdaCompactJSON::FormatFixed(double value, int decimals, char *out) {
+  if (decimals < 0) {
+    decimals = 0;
+  } else if (decimals > kMaxDecimals) {
+    decimals = kMaxDecimals;
+  }
+
+  double scaled = value * kPowersOfTen[decimals];
+  if (!std::isfinite(scaled) || fabs(scaled) >= kMaxScaled) {
+    if (!std::isfinite(scaled)) {
+      out[0] = '0';
+      return 1;
+    }
+    // Huge but finite: clamp rather than lose the sign and magnitude
+    scaled = scaled < 0 ? -kMaxScaled : kMaxScaled;
+  }
+
+  long long rounded = llround(scaled);
+  int length = 0;
+  if (rounded < 0) {
+    out[length++] = '-';
+    rounded = -rounded;
+  }
+
+  // Drop trailing zeros of the fraction
+  while (decimals > 0 && rounded % 10 == 0) {
+    rounded /= 10;
+    decimals--;
+  }
+
+  // Digits in reverse, with the decimal point and at least one integer digit
+  char digits[kMaxNumberChars];
+  int numDigits = 0;
+  do {
+    if (numDigits == decimals && decimals > 0) {
+      digits[numDigits++] = '.';
+    }
+    digits[numDigits++] = (char)('0' + rounded % 10);
+    rounded /= 10;
+  } while (rounded > 0 || numDigits <= decimals);
+
+  for (int i = numDigits - 1; i >= 0; i--) {
+    out[length++] = digits[i];
+  }
+
+  // "-0" after rounding is just 0
+  if (length == 2 && out[0] == '-' && out[1] == '0') {
+    out[0] = '0';
+    length = 1;
+  }
+  return length;
+}
+
+void MagdaCompactJSON::AppendNumber(WDL_FastString &json, double value, int decimals) {
+  char buf[kMaxNumberChars];
+  int length = FormatFixed(value, decimals, buf);
+  json.Append(buf, length);
+}
+
+void MagdaCompactJSON::AppendString(WDL_FastString &json, const char *text) {
+  json.Append("\"");
+  for (const char *p = text; p && *p; p++) {
+    switch (*p) {
+    case '"':
+      json.Append("\\\"");
+      break;
+    case '\\':
+      json.Append("\\\\");
+      break;
+    case '\n':
+      json.Append("\\n");
+      break;
+    default:
+      if ((unsigned char)*p >= 0x20) {
+        json.Append(p, 1);
+      }
+      break;
+    }
+  }
+  json.Append("\"");
+}
+
+void MagdaCompactJSON::AppendArray(WDL_FastString &json, const char *name, const float *values,
+                                   int count, int decimals, bool first) {
+  if (!first) {
+    json.Append(",");
+  }
+  json.Append("\"");
+  json.Append(name);
+  json.Append("\":[");
+
+  // Format runs of values into a local buffer so the string grows in a few
+  // large appends rather than one per number
+  char buf[1024];
+  int used = 0;
+  for (int i = 0; i < count; i++) {
+    if (used > (int)sizeof(buf) - kMaxNumberChars - 1) {
+      json.Append(buf, used);
+      used = 0;
+    }
+    if (i > 0) {
+      buf[used++] = ',';
+    }
+    used += FormatFixed(values[i], decimals, buf + used);
+  }
+  if (used > 0) {
+    json.Append(buf, used);
+  }
+  json.Append("]");
+}
+
+void MagdaCompactJSON::LogBinSpectrum(const std::vector<float> &frequencies,
+                                      const std::vector<float> &magnitudesDb, int numBands,
+                                      float minHz, float maxHz, std::vector<float> &centresHz,
+                                      std::vector<float> &levelsDb) {
+  centresHz.clear();
+  levelsDb.clear();
+  size_t numBins = frequencies.size() < magnitudesDb.size() ? frequencies.size()
+                                                            : magnitudesDb.size();
+  if (numBands <= 0 || numBins == 0 || minHz <= 0.0f || maxHz <= minHz) {
+    return;
+  }
+
+  centresHz.resize(numBands);
+  levelsDb.resize(numBands);
+  float ratio = maxHz / minHz;
+  size_t bin = 0;
+  for (int b = 0; b < numBands; b++) {
+    float low = minHz * powf(ratio, (float)b / numBands);
+    float high = minHz * powf(ratio, (float)(b + 1) / numBands);
+    centresHz[b] = sqrtf(low * high);
+
+    // Bins are sorted, so one forward scan covers all bands
+    while (bin < numBins && frequencies[bin] < low) {
+      bin++;
+    }
+    double energy = 0.0;
+    int count = 0;
+    for (size_t k = bin; k < numBins && frequencies[k] < high; k++) {
+      energy += pow(10.0, magnitudesDb[k] / 10.0);
+      count++;
+    }
+
+    if (count > 0) {
+      levelsDb[b] = (float)(10.0 * log10(energy / count));
+    } else {
+      // Band narrower than a bin: take the bin nearest the centre
+      size_t nearest = bin < numBins ? bin : numBins - 1;
+      if (nearest > 0 && fabsf(frequencies[nearest - 1] - centresHz[b]) <
+                             fabsf(frequencies[nearest] - centresHz[b])) {
+        nearest--;
+      }
+      levelsDb[b] = magnitudesDb[nearest];
+    }
+  }
+}
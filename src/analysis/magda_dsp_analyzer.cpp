@@ -1,4 +1,11 @@
 #include "magda_dsp_analyzer.h"
+#include "magda_analysis_cache.h"
+#include "magda_compact_json.h"
+#include "magda_dsp_stream.h"
+#include "magda_multires_spectrum.h"
+#include "magda_pcm_file.h"
+#include "magda_plugin_scanner.h"
+#include "reaper_plugin.h"
 // Workaround for typo in reaper_plugin_functions.h line 6475 (Reaproject ->
 // ReaProject) This is a typo in the REAPER SDK itself, not our code
 typedef ReaProject Reaproject;
@@ -7,6 +14,7 @@ typedef ReaProject Reaproject;
 #include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <sys/stat.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -32,6 +40,488 @@ static void LogMessage(const char *msg) {
   }
 }
 
+// Size cap for the on-disk analysis cache (~/.magda/analysis_cache)
+static const long long kAnalysisCacheMaxBytes = 64LL * 1024 * 1024;
+// Takes whose envelope state chunks are larger are not cached
+static const int kMaxEnvelopeChunkBytes = 256 * 1024;
+
+static std::string GetAnalysisCacheDirectory() {
+  MagdaPluginScanner::EnsureConfigDirectory();
+  return std::string(MagdaPluginScanner::GetConfigDirectory()) + "/analysis_cache";
+}
+
+static MagdaAnalysisCache &GetAnalysisCache() {
+  static MagdaAnalysisCache cache(GetAnalysisCacheDirectory(), kAnalysisCacheMaxBytes);
+  return cache;
+}
+
+// Fixed-size block reads from an audio accessor. Subclasses create the
+// accessor and set the format and range it covers.
+class AccessorBlockReader : public MagdaBlockSource {
+public:
+  AccessorBlockReader()
+      : m_accessor(nullptr), m_sampleRate(0), m_channels(0), m_startTime(0.0), m_totalFrames(0),
+        m_position(0), m_hadAudio(false), m_GetAudioAccessorSamples(nullptr) {}
+
+  int ReadBlock(float *out, int maxFrames) override {
+    if (!m_accessor || m_position >= m_totalFrames) {
+      return 0;
+    }
+
+    int frames = (int)(std::min)((long long)maxFrames, m_totalFrames - m_position);
+    size_t count = (size_t)frames * m_channels;
+    if (m_buffer.size() < count) {
+      m_buffer.resize(count);
+    }
+
+    // NOTE: Return value is status (0=no audio, 1=success, -1=error), NOT
+    // sample count!
+    double blockStart = m_startTime + (double)m_position / m_sampleRate;
+    int status = m_GetAudioAccessorSamples(m_accessor, m_sampleRate, m_channels, blockStart,
+                                           frames, m_buffer.data());
+    if (status < 0) {
+      char logBuf[128];
+      snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Failed to read samples (status=%d)\n",
+               status);
+      LogMessage(logBuf);
+      return -1;
+    }
+
+    if (status == 1) {
+      m_hadAudio = true;
+      for (size_t i = 0; i < count; i++) {
+        out[i] = (float)m_buffer[i];
+      }
+    } else {
+      // No audio in this block (e.g. a gap) - treat as silence
+      memset(out, 0, count * sizeof(float));
+    }
+
+    m_position += frames;
+    return frames;
+  }
+
+  int GetSampleRate() const override { return m_sampleRate; }
+  int GetChannels() const override { return m_channels; }
+  long long GetTotalFrames() const override { return m_totalFrames; }
+  // status=1 from the accessor
+  bool HadAudio() const override { return m_hadAudio; }
+
+protected:
+  void DestroyAccessor() {
+    if (m_accessor) {
+      void (*DestroyAudioAccessor)(AudioAccessor *) =
+          (void (*)(AudioAccessor *))g_rec->GetFunc("DestroyAudioAccessor");
+      if (DestroyAudioAccessor) {
+        DestroyAudioAccessor(m_accessor);
+      }
+      m_accessor = nullptr;
+    }
+  }
+
+  AudioAccessor *m_accessor;
+  int m_sampleRate;
+  int m_channels;
+  double m_startTime;
+  long long m_totalFrames;
+  long long m_position;
+  bool m_hadAudio;
+  std::vector<double> m_buffer; // Reused accessor block (interleaved doubles)
+  int (*m_GetAudioAccessorSamples)(AudioAccessor *, int, int, double, int, double *);
+};
+
+// Reads a take through an audio accessor in fixed-size blocks. Handles the
+// fresh-source swap (forces REAPER to load newly rendered files) and restores
+// the original source on Close(). MUST be used from the main thread.
+class TakeBlockReader : public AccessorBlockReader {
+public:
+  TakeBlockReader()
+      : m_take(nullptr), m_originalSource(nullptr), m_freshSource(nullptr),
+        m_swappedSource(false) {}
+
+  ~TakeBlockReader() { Close(); }
+
+  // maxSeconds > 0 caps the number of frames read
+  bool Open(MediaItem_Take *take, const DSPAnalysisConfig &config, double maxSeconds) {
+    if (!g_rec || !take) {
+      return false;
+    }
+
+    AudioAccessor *(*CreateTakeAudioAccessor)(MediaItem_Take *) =
+        (AudioAccessor * (*)(MediaItem_Take *)) g_rec->GetFunc("CreateTakeAudioAccessor");
+    m_GetAudioAccessorSamples = (int (*)(AudioAccessor *, int, int, double, int, double *))
+        g_rec->GetFunc("GetAudioAccessorSamples");
+    double (*GetAudioAccessorStartTime)(AudioAccessor *) =
+        (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorStartTime");
+    double (*GetAudioAccessorEndTime)(AudioAccessor *) =
+        (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorEndTime");
+
+    if (!CreateTakeAudioAccessor || !m_GetAudioAccessorSamples || !GetAudioAccessorStartTime ||
+        !GetAudioAccessorEndTime) {
+      LogMessage("MAGDA DSP: Audio accessor functions not available\n");
+      return false;
+    }
+
+    PCM_source *(*GetMediaItemTake_Source)(MediaItem_Take *) =
+        (PCM_source * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Source");
+    if (!GetMediaItemTake_Source) {
+      LogMessage("MAGDA DSP: GetMediaItemTake_Source not available\n");
+      return false;
+    }
+
+    m_take = take;
+    m_originalSource = GetMediaItemTake_Source(take);
+    if (!m_originalSource) {
+      LogMessage("MAGDA DSP: Take has no source\n");
+      return false;
+    }
+
+    // Get source filename
+    const char *(*GetMediaSourceFileName)(PCM_source *, char *, int) =
+        (const char *(*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceFileName");
+    char filename[512] = {0};
+    if (GetMediaSourceFileName) {
+      GetMediaSourceFileName(m_originalSource, filename, sizeof(filename));
+      char logBuf[600];
+      snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Analyzing file: %s\n",
+               filename[0] ? filename : "(no filename)");
+      LogMessage(logBuf);
+    }
+
+    // Create a FRESH source from the file and swap it into the take
+    // This forces REAPER to fully load the audio data
+    PCM_source *(*PCM_Source_CreateFromFile)(const char *) =
+        (PCM_source * (*)(const char *)) g_rec->GetFunc("PCM_Source_CreateFromFile");
+    bool (*SetMediaItemTake_Source)(MediaItem_Take *, PCM_source *) =
+        (bool (*)(MediaItem_Take *, PCM_source *))g_rec->GetFunc("SetMediaItemTake_Source");
+
+    if (filename[0] && PCM_Source_CreateFromFile && SetMediaItemTake_Source) {
+      m_freshSource = PCM_Source_CreateFromFile(filename);
+      if (m_freshSource) {
+        SetMediaItemTake_Source(take, m_freshSource);
+        m_swappedSource = true;
+        LogMessage("MAGDA DSP: Swapped in fresh source from file\n");
+      }
+    }
+
+    // Use whichever source is now on the take
+    PCM_source *source = GetMediaItemTake_Source(take);
+    if (!source) {
+      LogMessage("MAGDA DSP: Take lost its source after swap!\n");
+      return false;
+    }
+
+    int (*GetMediaSourceNumChannels)(PCM_source *) =
+        (int (*)(PCM_source *))g_rec->GetFunc("GetMediaSourceNumChannels");
+    int (*GetMediaSourceSampleRate)(PCM_source *) =
+        (int (*)(PCM_source *))g_rec->GetFunc("GetMediaSourceSampleRate");
+    double (*GetMediaSourceLength)(PCM_source *, bool *) =
+        (double (*)(PCM_source *, bool *))g_rec->GetFunc("GetMediaSourceLength");
+
+    m_channels = GetMediaSourceNumChannels ? GetMediaSourceNumChannels(source) : 2;
+    m_sampleRate = GetMediaSourceSampleRate ? GetMediaSourceSampleRate(source) : 44100;
+    if (m_channels <= 0) {
+      m_channels = 2;
+    }
+    if (m_sampleRate <= 0) {
+      m_sampleRate = 44100;
+    }
+    double sourceLength = GetMediaSourceLength ? GetMediaSourceLength(source, nullptr) : 0.0;
+
+    {
+      char logBuf[256];
+      snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Source reports: %.2f sec, %d Hz, %d ch\n",
+               sourceLength, m_sampleRate, m_channels);
+      LogMessage(logBuf);
+    }
+
+    m_accessor = CreateTakeAudioAccessor(take);
+    if (!m_accessor) {
+      LogMessage("MAGDA DSP: Failed to create audio accessor\n");
+      return false;
+    }
+
+    // CRITICAL: Force accessor to update after source swap
+    void (*AudioAccessorUpdate)(AudioAccessor *) =
+        (void (*)(AudioAccessor *))g_rec->GetFunc("AudioAccessorUpdate");
+    if (AudioAccessorUpdate) {
+      AudioAccessorUpdate(m_accessor);
+      LogMessage("MAGDA DSP: Called AudioAccessorUpdate\n");
+    }
+
+    m_startTime = GetAudioAccessorStartTime(m_accessor);
+    double endTime = GetAudioAccessorEndTime(m_accessor);
+    double duration = endTime - m_startTime;
+
+    {
+      char logBuf[256];
+      snprintf(logBuf, sizeof(logBuf),
+               "MAGDA DSP: Accessor reports: start=%.3f, end=%.3f, duration=%.3f "
+               "sec\n",
+               m_startTime, endTime, duration);
+      LogMessage(logBuf);
+    }
+
+    // Limit analysis length if configured
+    if (!config.analyzeFullItem && config.analysisLength > 0 && duration > config.analysisLength) {
+      duration = config.analysisLength;
+    }
+    if (maxSeconds > 0.0 && duration > maxSeconds) {
+      duration = maxSeconds;
+    }
+
+    m_totalFrames = (long long)(duration * m_sampleRate);
+    if (m_totalFrames <= 0) {
+      LogMessage("MAGDA DSP: No samples to analyze\n");
+      return false;
+    }
+
+    return true;
+  }
+
+  // Destroy the accessor and put the take's original source back
+  void Close() {
+    DestroyAccessor();
+
+    if (m_swappedSource && m_originalSource) {
+      bool (*SetMediaItemTake_Source)(MediaItem_Take *, PCM_source *) =
+          (bool (*)(MediaItem_Take *, PCM_source *))g_rec->GetFunc("SetMediaItemTake_Source");
+      if (SetMediaItemTake_Source) {
+        SetMediaItemTake_Source(m_take, m_originalSource);
+        LogMessage("MAGDA DSP: Restored original source\n");
+      }
+      m_swappedSource = false;
+    }
+
+    if (m_freshSource) {
+      void (*PCM_Source_Destroy)(PCM_source *) =
+          (void (*)(PCM_source *))g_rec->GetFunc("PCM_Source_Destroy");
+      if (PCM_Source_Destroy) {
+        PCM_Source_Destroy(m_freshSource);
+      }
+      m_freshSource = nullptr;
+    }
+  }
+
+private:
+  MediaItem_Take *m_take;
+  PCM_source *m_originalSource;
+  PCM_source *m_freshSource;
+  bool m_swappedSource;
+};
+
+// Reads a track's items as mixed on the track, through a track audio
+// accessor, so nothing has to be rendered. REAPER takes accessor samples
+// before the track FX chain, and signal arriving through receives is not
+// part of them. MUST be used from the main thread.
+class TrackBlockReader : public AccessorBlockReader {
+public:
+  ~TrackBlockReader() { Close(); }
+
+  // Read [startTime, endTime) in project time; endTime <= startTime reads
+  // everything the accessor covers
+  bool Open(MediaTrack *track, const DSPAnalysisConfig &config, double startTime, double endTime) {
+    if (!g_rec || !track) {
+      return false;
+    }
+
+    AudioAccessor *(*CreateTrackAudioAccessor)(MediaTrack *) =
+        (AudioAccessor * (*)(MediaTrack *)) g_rec->GetFunc("CreateTrackAudioAccessor");
+    m_GetAudioAccessorSamples = (int (*)(AudioAccessor *, int, int, double, int, double *))
+        g_rec->GetFunc("GetAudioAccessorSamples");
+    double (*GetAudioAccessorStartTime)(AudioAccessor *) =
+        (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorStartTime");
+    double (*GetAudioAccessorEndTime)(AudioAccessor *) =
+        (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorEndTime");
+    double (*GetSetProjectInfo)(ReaProject *, const char *, double, bool) =
+        (double (*)(ReaProject *, const char *, double, bool))g_rec->GetFunc("GetSetProjectInfo");
+
+    if (!CreateTrackAudioAccessor || !m_GetAudioAccessorSamples || !GetAudioAccessorStartTime ||
+        !GetAudioAccessorEndTime) {
+      LogMessage("MAGDA DSP: Track audio accessor functions not available\n");
+      return false;
+    }
+
+    // The accessor resamples to whatever rate is asked for; use the project
+    // rate so the FX chain runs as it does on playback
+    m_sampleRate =
+        GetSetProjectInfo ? (int)GetSetProjectInfo(nullptr, "PROJECT_SRATE", 0.0, false) : 0;
+    if (m_sampleRate <= 0) {
+      m_sampleRate = 44100;
+    }
+    m_channels = 2;
+
+    m_accessor = CreateTrackAudioAccessor(track);
+    if (!m_accessor) {
+      LogMessage("MAGDA DSP: Failed to create track audio accessor\n");
+      return false;
+    }
+
+    double accessorStart = GetAudioAccessorStartTime(m_accessor);
+    double accessorEnd = GetAudioAccessorEndTime(m_accessor);
+    m_startTime = accessorStart;
+    double end = accessorEnd;
+    if (endTime > startTime) {
+      m_startTime = startTime > accessorStart ? startTime : accessorStart;
+      end = endTime < accessorEnd ? endTime : accessorEnd;
+    }
+    double duration = end - m_startTime;
+
+    {
+      char logBuf[256];
+      snprintf(logBuf, sizeof(logBuf),
+               "MAGDA DSP: Track accessor covers %.3f-%.3f, reading %.3f sec at %d Hz\n",
+               accessorStart, accessorEnd, duration > 0.0 ? duration : 0.0, m_sampleRate);
+      LogMessage(logBuf);
+    }
+
+    if (!config.analyzeFullItem && config.analysisLength > 0 && duration > config.analysisLength) {
+      duration = config.analysisLength;
+    }
+
+    m_totalFrames = (long long)(duration * m_sampleRate);
+    if (m_totalFrames <= 0) {
+      LogMessage("MAGDA DSP: No samples to analyze\n");
+      return false;
+    }
+
+    return true;
+  }
+
+  void Close() { DestroyAccessor(); }
+};
+
+// Decode a take straight from its memory-mapped WAV/AIFF file, skipping the
+// source swap and audio accessor. Only for takes whose sound is just the
+// file played at a rate: no take FX or envelopes, no pitch shift or
+// time-stretch, normal channel mode, unity item and take volume, centered
+// take pan, no fades, and a plain file source (not a section or reversed
+// source). nullptr if the take doesn't qualify; the caller falls
+// back to the accessor. Opening needs the main thread, reading doesn't.
+static std::unique_ptr<MagdaBlockSource> OpenMappedTake(MediaItem_Take *take,
+                                                        const DSPAnalysisConfig &config) {
+  if (!g_rec || !take) {
+    return nullptr;
+  }
+
+  MediaItem *(*GetMediaItemTake_Item)(MediaItem_Take *) =
+      (MediaItem * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Item");
+  PCM_source *(*GetMediaItemTake_Source)(MediaItem_Take *) =
+      (PCM_source * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Source");
+  void (*GetMediaSourceType)(PCM_source *, char *, int) =
+      (void (*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceType");
+  const char *(*GetMediaSourceFileName)(PCM_source *, char *, int) =
+      (const char *(*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceFileName");
+  double (*GetMediaItemInfo_Value)(MediaItem *, const char *) =
+      (double (*)(MediaItem *, const char *))g_rec->GetFunc("GetMediaItemInfo_Value");
+  double (*GetMediaItemTakeInfo_Value)(MediaItem_Take *, const char *) =
+      (double (*)(MediaItem_Take *, const char *))g_rec->GetFunc("GetMediaItemTakeInfo_Value");
+  int (*TakeFX_GetCount)(MediaItem_Take *) =
+      (int (*)(MediaItem_Take *))g_rec->GetFunc("TakeFX_GetCount");
+  int (*CountTakeEnvelopes)(MediaItem_Take *) =
+      (int (*)(MediaItem_Take *))g_rec->GetFunc("CountTakeEnvelopes");
+
+  if (!GetMediaItemTake_Item || !GetMediaItemTake_Source || !GetMediaSourceType ||
+      !GetMediaSourceFileName || !GetMediaItemInfo_Value || !GetMediaItemTakeInfo_Value ||
+      !TakeFX_GetCount || !CountTakeEnvelopes) {
+    return nullptr;
+  }
+
+  MediaItem *item = GetMediaItemTake_Item(take);
+  PCM_source *source = GetMediaItemTake_Source(take);
+  if (!item || !source || TakeFX_GetCount(take) > 0 || CountTakeEnvelopes(take) > 0) {
+    return nullptr;
+  }
+
+  double playrate = GetMediaItemTakeInfo_Value(take, "D_PLAYRATE");
+  bool preservePitch = GetMediaItemTakeInfo_Value(take, "B_PPITCH") != 0.0;
+  if (GetMediaItemTakeInfo_Value(take, "D_PITCH") != 0.0 ||
+      GetMediaItemTakeInfo_Value(take, "I_CHANMODE") != 0.0 || playrate <= 0.0 ||
+      (preservePitch && playrate != 1.0)) {
+    return nullptr;
+  }
+
+  // The accessor hears volume, pan and fades; the file doesn't have them.
+  // Automatic fade lengths are negative when unused.
+  if (GetMediaItemInfo_Value(item, "D_VOL") != 1.0 ||
+      GetMediaItemTakeInfo_Value(take, "D_VOL") != 1.0 ||
+      GetMediaItemTakeInfo_Value(take, "D_PAN") != 0.0 ||
+      GetMediaItemInfo_Value(item, "D_FADEINLEN") > 0.0 ||
+      GetMediaItemInfo_Value(item, "D_FADEOUTLEN") > 0.0 ||
+      GetMediaItemInfo_Value(item, "D_FADEINLEN_AUTO") > 0.0 ||
+      GetMediaItemInfo_Value(item, "D_FADEOUTLEN_AUTO") > 0.0) {
+    return nullptr;
+  }
+
+  char type[64] = {0};
+  GetMediaSourceType(source, type, sizeof(type));
+  if (strcmp(type, "WAVE") != 0 && strcmp(type, "AIFF") != 0) {
+    return nullptr;
+  }
+  char filename[512] = {0};
+  GetMediaSourceFileName(source, filename, sizeof(filename));
+
+  std::unique_ptr<MagdaPCMFile> file(new MagdaPCMFile());
+  WDL_FastString error_msg;
+  if (!file->Open(filename, error_msg)) {
+    char logBuf[700];
+    snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Not decoding %s directly: %s\n", filename,
+             error_msg.Get());
+    LogMessage(logBuf);
+    return nullptr;
+  }
+
+  double length = GetMediaItemInfo_Value(item, "D_LENGTH");
+  if (!config.analyzeFullItem && config.analysisLength > 0 && length > config.analysisLength) {
+    length = config.analysisLength;
+  }
+  if (length <= 0.0) {
+    return nullptr;
+  }
+
+  char logBuf[700];
+  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Decoding mapped file: %s (%d Hz, %d ch)\n",
+           filename, file->GetSampleRate(), file->GetChannels());
+  LogMessage(logBuf);
+
+  return std::unique_ptr<MagdaBlockSource>(new MagdaPCMFileSource(
+      std::move(file), GetMediaItemTakeInfo_Value(take, "D_STARTOFFS"), length, playrate,
+      (float)GetMediaItemTakeInfo_Value(take, "D_VOL"),
+      GetMediaItemInfo_Value(item, "B_LOOPSRC") != 0.0));
+}
+
+// Pull fixed-size blocks from reader into one reused buffer and feed every
+// stage. Fails if the source errored or never returned audio.
+static bool StreamSource(MagdaBlockSource &reader, const DSPAnalysisConfig &config,
+                         DSPAnalysisResult &result) {
+  {
+    char logBuf[256];
+    snprintf(logBuf, sizeof(logBuf),
+             "MAGDA DSP: Streaming %lld frames, %d Hz, %d ch, %.2f sec (block %d)\n",
+             reader.GetTotalFrames(), reader.GetSampleRate(), reader.GetChannels(),
+             (double)reader.GetTotalFrames() / reader.GetSampleRate(), config.streamBlockSize);
+    LogMessage(logBuf);
+  }
+
+  MagdaDSPStream stream(reader.GetSampleRate(), reader.GetChannels(), config,
+                        reader.GetTotalFrames());
+  int blockFrames = config.streamBlockSize > 0 ? config.streamBlockSize : 16384;
+  std::vector<float> block((size_t)blockFrames * reader.GetChannels());
+
+  int framesRead = 0;
+  while ((framesRead = reader.ReadBlock(block.data(), blockFrames)) > 0) {
+    stream.Process(block.data(), framesRead);
+  }
+
+  if (framesRead < 0 || !reader.HadAudio()) {
+    result.errorMessage.Set("Failed to read audio samples");
+    return false;
+  }
+
+  result = stream.Finish();
+  return result.success;
+}
+
 DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeTrack(int trackIndex, const DSPAnalysisConfig &config) {
   DSPAnalysisResult result;
 
@@ -117,521 +607,410 @@ DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeItem(MediaItem *item, const DSPAnalys
     LogMessage(logBuf);
   }
 
-  // Get audio samples
-  std::vector<float> samples;
-  int sampleRate = 0;
-  int channels = 0;
-
-  if (!GetAudioSamples(take, samples, sampleRate, channels, config)) {
-    result.errorMessage.Set("Failed to read audio samples");
+  std::string cacheKey;
+  bool cacheable = config.useCache && BuildCacheKey(item, take, config, cacheKey);
+  if (cacheable && GetAnalysisCache().Lookup(cacheKey, result)) {
+    LogMessage("MAGDA DSP: Using cached analysis (source unchanged)\n");
     return result;
   }
 
-  if (samples.empty()) {
-    result.errorMessage.Set("No audio samples found");
-    return result;
-  }
-
-  result.sampleRate = sampleRate;
-  result.channels = channels;
-  result.lengthSeconds = (double)samples.size() / (sampleRate * channels);
-
-  char logBuf[256];
-  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Analyzing %zu samples, %d Hz, %d ch, %.2f sec\n",
-           samples.size(), sampleRate, channels, result.lengthSeconds);
-  LogMessage(logBuf);
-
-  // Perform FFT analysis
-  if (config.analyzeFrequency) {
-    PerformFFT(samples, sampleRate, config.fftSize, result.fftFrequencies, result.fftMagnitudes);
-
-    // Calculate frequency bands
-    CalculateFrequencyBands(result.fftFrequencies, result.fftMagnitudes, result.bands);
-
-    // Calculate EQ profile (1/3 octave)
-    CalculateEQProfile(result.fftFrequencies, result.fftMagnitudes, result.eqProfileFreqs,
-                       result.eqProfileMags);
-
-    // Detect peaks
-    DetectPeaks(result.fftFrequencies, result.fftMagnitudes, result.peaks);
-  }
-
-  // Detect resonances
-  if (config.analyzeResonances && !result.peaks.empty()) {
-    DetectResonances(result.peaks, result.eqProfileMags, result.resonances);
-  }
-
-  // Calculate spectral features
-  if (config.analyzeSpectralFeatures && !result.fftFrequencies.empty()) {
-    result.spectralFeatures =
-        CalculateSpectralFeatures(result.fftFrequencies, result.fftMagnitudes);
-  }
-
-  // Calculate loudness
-  if (config.analyzeLoudness) {
-    result.loudness = CalculateLoudness(samples, sampleRate, channels);
-  }
-
-  // Calculate dynamics
-  if (config.analyzeDynamics) {
-    result.dynamics = CalculateDynamics(samples, channels);
-  }
-
-  // Calculate stereo analysis
-  if (config.analyzeStereo && channels >= 2) {
-    result.stereo = CalculateStereo(samples, channels);
+  bool ok = false;
+  if (std::unique_ptr<MagdaBlockSource> mapped = OpenMappedTake(take, config)) {
+    ok = StreamSource(*mapped, config, result);
+  } else {
+    TakeBlockReader reader;
+    if (!reader.Open(take, config, 0.0)) {
+      result.errorMessage.Set("Failed to read audio samples");
+      return result;
+    }
+    ok = StreamSource(reader, config, result);
+    reader.Close();
   }
-
-  // Calculate transients
-  if (config.analyzeTransients) {
-    result.transients = CalculateTransients(samples, sampleRate, channels);
+  if (ok) {
+    LogMessage("MAGDA DSP: Analysis complete\n");
+    if (cacheable) {
+      GetAnalysisCache().Store(cacheKey, result);
+    }
   }
-
-  result.success = true;
-  LogMessage("MAGDA DSP: Analysis complete\n");
   return result;
 }
 
-DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeMaster(const DSPAnalysisConfig &config) {
-  DSPAnalysisResult result;
-  result.errorMessage.Set("Master track analysis not yet implemented");
-  // TODO: Implement master track analysis using render or audio accessor
-  return result;
-}
-
-RawAudioData MagdaDSPAnalyzer::ReadTrackSamples(int trackIndex, const DSPAnalysisConfig &config) {
-  RawAudioData data;
-
+bool MagdaDSPAnalyzer::CanAnalyzeTrackOutput(int trackIndex, WDL_FastString &reason) {
   if (!g_rec) {
-    return data;
+    reason.Set("REAPER plugin context not available");
+    return false;
   }
 
   MediaTrack *(*GetTrack)(ReaProject *, int) =
       (MediaTrack * (*)(ReaProject *, int)) g_rec->GetFunc("GetTrack");
-  if (!GetTrack) {
-    return data;
+  int (*GetTrackNumSends)(MediaTrack *, int) =
+      (int (*)(MediaTrack *, int))g_rec->GetFunc("GetTrackNumSends");
+  double (*GetMediaTrackInfo_Value)(MediaTrack *, const char *) =
+      (double (*)(MediaTrack *, const char *))g_rec->GetFunc("GetMediaTrackInfo_Value");
+
+  if (!GetTrack || !GetTrackNumSends || !GetMediaTrackInfo_Value ||
+      !g_rec->GetFunc("CreateTrackAudioAccessor")) {
+    reason.Set("Track audio accessor not available");
+    return false;
   }
 
   MediaTrack *track = GetTrack(nullptr, trackIndex);
   if (!track) {
-    return data;
-  }
-
-  int (*CountTrackMediaItems)(MediaTrack *) =
-      (int (*)(MediaTrack *))g_rec->GetFunc("CountTrackMediaItems");
-  MediaItem *(*GetTrackMediaItem)(MediaTrack *, int) =
-      (MediaItem * (*)(MediaTrack *, int)) g_rec->GetFunc("GetTrackMediaItem");
-
-  if (!CountTrackMediaItems || !GetTrackMediaItem) {
-    return data;
-  }
-
-  int itemCount = CountTrackMediaItems(track);
-  if (itemCount == 0) {
-    return data;
+    reason.Set("Track not found");
+    return false;
   }
 
-  MediaItem *item = GetTrackMediaItem(track, 0);
-  if (!item) {
-    return data;
+  // The accessor only plays the track's own items through its FX, so
+  // anything routed in from other tracks would be missing
+  if (GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH") > 0.0) {
+    reason.Set("Track is a folder parent");
+    return false;
   }
-
-  MediaItem_Take *(*GetActiveTake)(MediaItem *) =
-      (MediaItem_Take * (*)(MediaItem *)) g_rec->GetFunc("GetActiveTake");
-  if (!GetActiveTake) {
-    return data;
+  if (GetTrackNumSends(track, -1) > 0) {
+    reason.Set("Track has receives");
+    return false;
   }
 
-  MediaItem_Take *take = GetActiveTake(item);
-  if (!take) {
-    return data;
+  // Track accessor samples are taken before the track FX chain, so they only
+  // match the track's output when no FX is processing it
+  int (*TrackFX_GetCount)(MediaTrack *) =
+      (int (*)(MediaTrack *))g_rec->GetFunc("TrackFX_GetCount");
+  bool (*TrackFX_GetEnabled)(MediaTrack *, int) =
+      (bool (*)(MediaTrack *, int))g_rec->GetFunc("TrackFX_GetEnabled");
+  if (!TrackFX_GetCount || !TrackFX_GetEnabled) {
+    reason.Set("Track FX API not available");
+    return false;
   }
-
-  if (GetAudioSamples(take, data.samples, data.sampleRate, data.channels, config)) {
-    data.valid = true;
+  if (GetMediaTrackInfo_Value(track, "I_FXEN") != 0.0) {
+    int numFX = TrackFX_GetCount(track);
+    for (int i = 0; i < numFX; i++) {
+      if (TrackFX_GetEnabled(track, i)) {
+        reason.Set("Track has active FX, which the accessor doesn't hear");
+        return false;
+      }
+    }
   }
 
-  return data;
+  return true;
 }
 
-DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeSamples(const RawAudioData &audioData,
-                                                   const DSPAnalysisConfig &config) {
+DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeTrackOutput(int trackIndex,
+                                                       const DSPAnalysisConfig &config,
+                                                       double startTime, double endTime) {
   DSPAnalysisResult result;
 
-  if (!audioData.valid || audioData.samples.empty()) {
-    result.errorMessage.Set("Invalid audio data");
+  if (!g_rec) {
+    result.errorMessage.Set("REAPER plugin context not available");
     return result;
   }
 
-  result.sampleRate = audioData.sampleRate;
-  result.channels = audioData.channels;
-  result.lengthSeconds =
-      (double)audioData.samples.size() / (audioData.sampleRate * audioData.channels);
-
-  char logBuf[256];
-  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Analyzing %zu samples, %d Hz, %d ch, %.2f sec\n",
-           audioData.samples.size(), audioData.sampleRate, audioData.channels,
-           result.lengthSeconds);
-  LogMessage(logBuf);
-
-  if (config.analyzeFrequency) {
-    PerformFFT(audioData.samples, audioData.sampleRate, config.fftSize, result.fftFrequencies,
-               result.fftMagnitudes);
-    CalculateFrequencyBands(result.fftFrequencies, result.fftMagnitudes, result.bands);
-    CalculateEQProfile(result.fftFrequencies, result.fftMagnitudes, result.eqProfileFreqs,
-                       result.eqProfileMags);
-    DetectPeaks(result.fftFrequencies, result.fftMagnitudes, result.peaks);
-  }
-
-  if (config.analyzeResonances && !result.peaks.empty()) {
-    DetectResonances(result.peaks, result.eqProfileMags, result.resonances);
-  }
-
-  if (config.analyzeSpectralFeatures && !result.fftFrequencies.empty()) {
-    result.spectralFeatures =
-        CalculateSpectralFeatures(result.fftFrequencies, result.fftMagnitudes);
-  }
-
-  if (config.analyzeLoudness) {
-    result.loudness =
-        CalculateLoudness(audioData.samples, audioData.sampleRate, audioData.channels);
-  }
-
-  if (config.analyzeDynamics) {
-    result.dynamics = CalculateDynamics(audioData.samples, audioData.channels);
+  MediaTrack *(*GetTrack)(ReaProject *, int) =
+      (MediaTrack * (*)(ReaProject *, int)) g_rec->GetFunc("GetTrack");
+  MediaTrack *track = GetTrack ? GetTrack(nullptr, trackIndex) : nullptr;
+  if (!track) {
+    result.errorMessage.Set("Track not found");
+    return result;
   }
 
-  if (config.analyzeStereo && audioData.channels >= 2) {
-    result.stereo = CalculateStereo(audioData.samples, audioData.channels);
+  TrackBlockReader reader;
+  if (!reader.Open(track, config, startTime, endTime)) {
+    result.errorMessage.Set("Failed to open track audio accessor");
+    return result;
   }
 
-  if (config.analyzeTransients) {
-    result.transients =
-        CalculateTransients(audioData.samples, audioData.sampleRate, audioData.channels);
+  // Track output depends on live FX state, so it is never cached
+  if (StreamSource(reader, config, result)) {
+    LogMessage("MAGDA DSP: Track output analysis complete\n");
   }
-
-  result.success = true;
-  LogMessage("MAGDA DSP: Analysis complete\n");
+  reader.Close();
   return result;
 }
 
-bool MagdaDSPAnalyzer::GetAudioSamples(MediaItem_Take *take, std::vector<float> &samples,
-                                       int &sampleRate, int &channels,
-                                       const DSPAnalysisConfig &config) {
-  if (!g_rec || !take) {
-    return false;
-  }
-
-  // Get audio accessor
-  AudioAccessor *(*CreateTakeAudioAccessor)(MediaItem_Take *) =
-      (AudioAccessor * (*)(MediaItem_Take *)) g_rec->GetFunc("CreateTakeAudioAccessor");
-  void (*DestroyAudioAccessor)(AudioAccessor *) =
-      (void (*)(AudioAccessor *))g_rec->GetFunc("DestroyAudioAccessor");
-  int (*GetAudioAccessorSamples)(AudioAccessor *, int, int, double, int, double *) = (int (*)(
-      AudioAccessor *, int, int, double, int, double *))g_rec->GetFunc("GetAudioAccessorSamples");
-  double (*GetAudioAccessorStartTime)(AudioAccessor *) =
-      (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorStartTime");
-  double (*GetAudioAccessorEndTime)(AudioAccessor *) =
-      (double (*)(AudioAccessor *))g_rec->GetFunc("GetAudioAccessorEndTime");
-
-  if (!CreateTakeAudioAccessor || !DestroyAudioAccessor || !GetAudioAccessorSamples ||
-      !GetAudioAccessorStartTime || !GetAudioAccessorEndTime) {
-    LogMessage("MAGDA DSP: Audio accessor functions not available\n");
-    return false;
-  }
-
-  // Get take source info
+bool MagdaDSPAnalyzer::BuildCacheKey(MediaItem *item, MediaItem_Take *take,
+                                     const DSPAnalysisConfig &config, std::string &key) {
   PCM_source *(*GetMediaItemTake_Source)(MediaItem_Take *) =
       (PCM_source * (*)(MediaItem_Take *)) g_rec->GetFunc("GetMediaItemTake_Source");
-  if (!GetMediaItemTake_Source) {
-    LogMessage("MAGDA DSP: GetMediaItemTake_Source not available\n");
-    return false;
-  }
-
-  PCM_source *originalSource = GetMediaItemTake_Source(take);
-  if (!originalSource) {
-    LogMessage("MAGDA DSP: Take has no source\n");
-    return false;
-  }
-
-  // Get source filename
   const char *(*GetMediaSourceFileName)(PCM_source *, char *, int) =
       (const char *(*)(PCM_source *, char *, int))g_rec->GetFunc("GetMediaSourceFileName");
-  char filename[512] = {0};
-  if (GetMediaSourceFileName) {
-    GetMediaSourceFileName(originalSource, filename, sizeof(filename));
-    char logBuf[600];
-    snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Analyzing file: %s\n",
-             filename[0] ? filename : "(no filename)");
-    LogMessage(logBuf);
+  double (*GetMediaItemInfo_Value)(MediaItem *, const char *) =
+      (double (*)(MediaItem *, const char *))g_rec->GetFunc("GetMediaItemInfo_Value");
+  double (*GetMediaItemTakeInfo_Value)(MediaItem_Take *, const char *) =
+      (double (*)(MediaItem_Take *, const char *))g_rec->GetFunc("GetMediaItemTakeInfo_Value");
+  int (*TakeFX_GetCount)(MediaItem_Take *) =
+      (int (*)(MediaItem_Take *))g_rec->GetFunc("TakeFX_GetCount");
+  int (*CountTakeEnvelopes)(MediaItem_Take *) =
+      (int (*)(MediaItem_Take *))g_rec->GetFunc("CountTakeEnvelopes");
+  TrackEnvelope *(*GetTakeEnvelope)(MediaItem_Take *, int) =
+      (TrackEnvelope * (*)(MediaItem_Take *, int)) g_rec->GetFunc("GetTakeEnvelope");
+  bool (*GetEnvelopeStateChunk)(TrackEnvelope *, char *, int, bool) =
+      (bool (*)(TrackEnvelope *, char *, int, bool))g_rec->GetFunc("GetEnvelopeStateChunk");
+
+  if (!GetMediaItemTake_Source || !GetMediaSourceFileName || !GetMediaItemInfo_Value ||
+      !GetMediaItemTakeInfo_Value || !TakeFX_GetCount || !CountTakeEnvelopes) {
+    return false;
   }
 
-  // Create a FRESH source from the file and swap it into the take
-  // This forces REAPER to fully load the audio data
-  PCM_source *(*PCM_Source_CreateFromFile)(const char *) =
-      (PCM_source * (*)(const char *)) g_rec->GetFunc("PCM_Source_CreateFromFile");
-  bool (*SetMediaItemTake_Source)(MediaItem_Take *, PCM_source *) =
-      (bool (*)(MediaItem_Take *, PCM_source *))g_rec->GetFunc("SetMediaItemTake_Source");
-  void (*PCM_Source_Destroy)(PCM_source *) =
-      (void (*)(PCM_source *))g_rec->GetFunc("PCM_Source_Destroy");
-
-  PCM_source *freshSource = nullptr;
-  bool swappedSource = false;
-
-  if (filename[0] && PCM_Source_CreateFromFile && SetMediaItemTake_Source) {
-    freshSource = PCM_Source_CreateFromFile(filename);
-    if (freshSource) {
-      // Swap in the fresh source
-      SetMediaItemTake_Source(take, freshSource);
-      swappedSource = true;
-      LogMessage("MAGDA DSP: Swapped in fresh source from file\n");
-    }
+  // Take FX change the accessor output without touching the source file
+  if (TakeFX_GetCount(take) > 0) {
+    return false;
   }
 
-  // Use whichever source is now on the take
   PCM_source *source = GetMediaItemTake_Source(take);
+  char filename[512] = {0};
   if (!source) {
-    LogMessage("MAGDA DSP: Take lost its source after swap!\n");
     return false;
   }
-
-  // Get source properties
-  int (*GetMediaSourceNumChannels)(PCM_source *) =
-      (int (*)(PCM_source *))g_rec->GetFunc("GetMediaSourceNumChannels");
-  int (*GetMediaSourceSampleRate)(PCM_source *) =
-      (int (*)(PCM_source *))g_rec->GetFunc("GetMediaSourceSampleRate");
-  double (*GetMediaSourceLength)(PCM_source *, bool *) =
-      (double (*)(PCM_source *, bool *))g_rec->GetFunc("GetMediaSourceLength");
-
-  if (GetMediaSourceNumChannels) {
-    channels = GetMediaSourceNumChannels(source);
-  } else {
-    channels = 2; // Default to stereo
+  GetMediaSourceFileName(source, filename, sizeof(filename));
+  if (!filename[0]) {
+    return false;
   }
 
-  if (GetMediaSourceSampleRate) {
-    sampleRate = GetMediaSourceSampleRate(source);
-  } else {
-    sampleRate = 44100; // Default
+  // Source identity: path + size + modification time
+#ifdef _WIN32
+  struct _stat64 st;
+  if (_stat64(filename, &st) != 0) {
+    return false;
   }
-
-  double sourceLength = 0.0;
-  if (GetMediaSourceLength) {
-    sourceLength = GetMediaSourceLength(source, nullptr);
+#else
+  struct stat st;
+  if (stat(filename, &st) != 0) {
+    return false;
   }
+#endif
 
-  {
-    char logBuf[256];
-    snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Source reports: %.2f sec, %d Hz, %d ch\n",
-             sourceLength, sampleRate, channels);
-    LogMessage(logBuf);
+  char buf[768];
+  snprintf(buf, sizeof(buf), "%s|size=%lld|mtime=%lld", filename, (long long)st.st_size,
+           (long long)st.st_mtime);
+  key = buf;
+
+  // Every item/take setting the accessor applies on top of the source
+  static const char *const kItemFields[] = {"D_LENGTH",         "D_VOL",
+                                            "D_FADEINLEN",      "D_FADEOUTLEN",
+                                            "D_FADEINLEN_AUTO", "D_FADEOUTLEN_AUTO",
+                                            "C_FADEINSHAPE",    "C_FADEOUTSHAPE",
+                                            "D_FADEINDIR",      "D_FADEOUTDIR",
+                                            "B_LOOPSRC"};
+  static const char *const kTakeFields[] = {"D_STARTOFFS", "D_PLAYRATE", "D_PITCH",
+                                            "B_PPITCH",    "D_VOL",      "D_PAN",
+                                            "D_PANLAW",    "I_CHANMODE"};
+  for (const char *field : kItemFields) {
+    snprintf(buf, sizeof(buf), "|item.%s=%.6f", field, GetMediaItemInfo_Value(item, field));
+    key += buf;
+  }
+  for (const char *field : kTakeFields) {
+    snprintf(buf, sizeof(buf), "|take.%s=%.6f", field, GetMediaItemTakeInfo_Value(take, field));
+    key += buf;
+  }
+
+  // Take envelopes (volume, pan, mute, pitch) shape the output as well. Their
+  // state chunks hold the points and the active/bypass flags, so a hash of
+  // the chunks changes whenever the envelopes do.
+  int numEnvelopes = CountTakeEnvelopes(take);
+  if (numEnvelopes > 0) {
+    if (!GetTakeEnvelope || !GetEnvelopeStateChunk) {
+      return false;
+    }
+    std::vector<char> chunk(kMaxEnvelopeChunkBytes);
+    unsigned long long hash = 14695981039346656037ULL; // FNV-1a (64-bit)
+    for (int i = 0; i < numEnvelopes; i++) {
+      TrackEnvelope *envelope = GetTakeEnvelope(take, i);
+      chunk[0] = '\0';
+      if (!envelope || !GetEnvelopeStateChunk(envelope, chunk.data(), (int)chunk.size(), false)) {
+        return false;
+      }
+      const char *end = (const char *)memchr(chunk.data(), '\0', chunk.size() - 1);
+      if (!end) {
+        return false; // Truncated; a partial chunk could miss a change
+      }
+      for (const char *p = chunk.data(); p <= end; p++) {
+        hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+      }
+    }
+    snprintf(buf, sizeof(buf), "|envelopes=%d:%016llx", numEnvelopes, hash);
+    key += buf;
   }
 
-  // Create audio accessor
-  AudioAccessor *accessor = CreateTakeAudioAccessor(take);
-  if (!accessor) {
-    LogMessage("MAGDA DSP: Failed to create audio accessor\n");
-    return false;
-  }
+  MagdaAnalysisCache::AppendConfigKey(config, key);
+  return true;
+}
 
-  // CRITICAL: Force accessor to update after source swap
-  void (*AudioAccessorUpdate)(AudioAccessor *) =
-      (void (*)(AudioAccessor *))g_rec->GetFunc("AudioAccessorUpdate");
+DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeMaster(const DSPAnalysisConfig &config) {
+  DSPAnalysisResult result;
+  result.errorMessage.Set("Master track analysis not yet implemented");
+  // TODO: Implement master track analysis using render or audio accessor
+  return result;
+}
 
-  // Always call update after swapping source
-  if (AudioAccessorUpdate) {
-    AudioAccessorUpdate(accessor);
-    LogMessage("MAGDA DSP: Called AudioAccessorUpdate\n");
+MediaItem_Take *MagdaDSPAnalyzer::GetFirstItemTake(int trackIndex) {
+  if (!g_rec) {
+    return nullptr;
   }
 
-  double startTime = GetAudioAccessorStartTime(accessor);
-  double endTime = GetAudioAccessorEndTime(accessor);
-  double duration = endTime - startTime;
+  MediaTrack *(*GetTrack)(ReaProject *, int) =
+      (MediaTrack * (*)(ReaProject *, int)) g_rec->GetFunc("GetTrack");
+  int (*CountTrackMediaItems)(MediaTrack *) =
+      (int (*)(MediaTrack *))g_rec->GetFunc("CountTrackMediaItems");
+  MediaItem *(*GetTrackMediaItem)(MediaTrack *, int) =
+      (MediaItem * (*)(MediaTrack *, int)) g_rec->GetFunc("GetTrackMediaItem");
+  MediaItem_Take *(*GetActiveTake)(MediaItem *) =
+      (MediaItem_Take * (*)(MediaItem *)) g_rec->GetFunc("GetActiveTake");
 
-  {
-    char logBuf[256];
-    snprintf(logBuf, sizeof(logBuf),
-             "MAGDA DSP: Accessor reports: start=%.3f, end=%.3f, duration=%.3f "
-             "sec\n",
-             startTime, endTime, duration);
-    LogMessage(logBuf);
+  if (!GetTrack || !CountTrackMediaItems || !GetTrackMediaItem || !GetActiveTake) {
+    return nullptr;
   }
 
-  // Limit analysis length if configured
-  if (!config.analyzeFullItem && config.analysisLength > 0 && duration > config.analysisLength) {
-    duration = config.analysisLength;
+  MediaTrack *track = GetTrack(nullptr, trackIndex);
+  if (!track || CountTrackMediaItems(track) == 0) {
+    return nullptr;
   }
 
-  // Calculate number of samples to read
-  int totalSamples = (int)(duration * sampleRate);
-  if (totalSamples <= 0) {
-    DestroyAudioAccessor(accessor);
-    LogMessage("MAGDA DSP: No samples to analyze\n");
-    return false;
-  }
+  MediaItem *item = GetTrackMediaItem(track, 0);
+  return item ? GetActiveTake(item) : nullptr;
+}
 
-  // Limit to reasonable amount (e.g., 30 seconds max for performance)
-  const int maxSamples = sampleRate * 30;
-  if (totalSamples > maxSamples) {
-    totalSamples = maxSamples;
-    duration = (double)totalSamples / sampleRate;
-  }
+RawAudioData MagdaDSPAnalyzer::ReadTrackSamples(int trackIndex, const DSPAnalysisConfig &config) {
+  RawAudioData data;
 
-  {
-    char logBuf[256];
-    snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Requesting %d samples\n", totalSamples);
-    LogMessage(logBuf);
+  MediaItem_Take *take = GetFirstItemTake(trackIndex);
+  if (!take) {
+    return data;
   }
 
-  // Allocate buffer (interleaved)
-  std::vector<double> buffer(totalSamples * channels);
-
-  // Read samples
-  // NOTE: Return value is status (0=no audio, 1=success, -1=error), NOT sample
-  // count!
-  int status = GetAudioAccessorSamples(accessor, sampleRate, channels, startTime, totalSamples,
-                                       buffer.data());
+  if (GetAudioSamples(take, data.samples, data.sampleRate, data.channels, config)) {
+    data.valid = true;
+  }
 
-  DestroyAudioAccessor(accessor);
+  return data;
+}
 
-  {
-    char logBuf[256];
-    snprintf(logBuf, sizeof(logBuf),
-             "MAGDA DSP: GetAudioAccessorSamples status=%d (0=no audio, "
-             "1=success, -1=error)\n",
-             status);
-    LogMessage(logBuf);
+std::unique_ptr<MagdaBlockSource> MagdaDSPAnalyzer::OpenTakeSource(int trackIndex,
+                                                                   const DSPAnalysisConfig &config,
+                                                                   WDL_FastString &error_msg) {
+  MediaItem_Take *take = GetFirstItemTake(trackIndex);
+  if (!take) {
+    error_msg.Set("Track has no item to analyze");
+    return nullptr;
   }
 
-  // Restore original source if we swapped it
-  if (swappedSource && SetMediaItemTake_Source && originalSource) {
-    SetMediaItemTake_Source(take, originalSource);
-    LogMessage("MAGDA DSP: Restored original source\n");
+  if (std::unique_ptr<MagdaBlockSource> mapped = OpenMappedTake(take, config)) {
+    return mapped;
   }
 
-  // Clean up fresh source if we created one
-  if (freshSource && PCM_Source_Destroy) {
-    PCM_Source_Destroy(freshSource);
+  std::unique_ptr<TakeBlockReader> reader(new TakeBlockReader());
+  if (!reader->Open(take, config, 0.0)) {
+    error_msg.Set("Failed to open take audio accessor");
+    return nullptr;
   }
+  return reader;
+}
 
-  if (status != 1) {
-    char logBuf[128];
-    snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Failed to read samples (status=%d)\n", status);
-    LogMessage(logBuf);
-    return false;
+std::unique_ptr<MagdaBlockSource>
+MagdaDSPAnalyzer::OpenTrackOutputSource(int trackIndex, const DSPAnalysisConfig &config,
+                                        double startTime, double endTime,
+                                        WDL_FastString &error_msg) {
+  MediaTrack *(*GetTrack)(ReaProject *, int) =
+      g_rec ? (MediaTrack * (*)(ReaProject *, int)) g_rec->GetFunc("GetTrack") : nullptr;
+  MediaTrack *track = GetTrack ? GetTrack(nullptr, trackIndex) : nullptr;
+  if (!track) {
+    error_msg.Set("Track not found");
+    return nullptr;
   }
 
-  // Convert to float - use the REQUESTED sample count since status=1 means
-  // success
-  samples.resize(totalSamples * channels);
-  for (int i = 0; i < totalSamples * channels; i++) {
-    samples[i] = (float)buffer[i];
+  std::unique_ptr<TrackBlockReader> reader(new TrackBlockReader());
+  if (!reader->Open(track, config, startTime, endTime)) {
+    error_msg.Set("Failed to open track audio accessor");
+    return nullptr;
   }
-
-  char logBuf[128];
-  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Read %d samples successfully\n", totalSamples);
-  LogMessage(logBuf);
-
-  return true;
+  return reader;
 }
 
-void MagdaDSPAnalyzer::SimpleDFT(const float *input, int N, float *realOut, float *imagOut) {
-  // Simple DFT - O(N^2) but works for small windows
-  for (int k = 0; k < N / 2 + 1; k++) {
-    float sumReal = 0.0f;
-    float sumImag = 0.0f;
-    for (int n = 0; n < N; n++) {
-      float angle = 2.0f * M_PI * k * n / N;
-      sumReal += input[n] * cosf(angle);
-      sumImag -= input[n] * sinf(angle);
-    }
-    realOut[k] = sumReal;
-    imagOut[k] = sumImag;
-  }
-}
+DSPAnalysisResult MagdaDSPAnalyzer::AnalyzeSamples(const RawAudioData &audioData,
+                                                   const DSPAnalysisConfig &config) {
+  DSPAnalysisResult result;
 
-void MagdaDSPAnalyzer::PerformFFT(const std::vector<float> &samples, int sampleRate, int fftSize,
-                                  std::vector<float> &frequencies, std::vector<float> &magnitudes) {
-  if (samples.empty() || fftSize <= 0) {
-    return;
+  if (!audioData.valid || audioData.samples.empty() || audioData.channels <= 0) {
+    result.errorMessage.Set("Invalid audio data");
+    return result;
   }
 
-  // Number of output bins
-  int numBins = fftSize / 2 + 1;
+  long long totalFrames = (long long)(audioData.samples.size() / audioData.channels);
 
-  frequencies.resize(numBins);
-  magnitudes.resize(numBins, -96.0f);
+  char logBuf[256];
+  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Analyzing %zu samples, %d Hz, %d ch, %.2f sec\n",
+           audioData.samples.size(), audioData.sampleRate, audioData.channels,
+           (double)totalFrames / audioData.sampleRate);
+  LogMessage(logBuf);
 
-  // Fill frequency bins
-  for (int i = 0; i < numBins; i++) {
-    frequencies[i] = (float)i * sampleRate / fftSize;
+  MagdaDSPStream stream(audioData.sampleRate, audioData.channels, config, totalFrames);
+  int blockFrames = config.streamBlockSize > 0 ? config.streamBlockSize : 16384;
+  for (long long pos = 0; pos < totalFrames; pos += blockFrames) {
+    int frames = (int)(std::min)((long long)blockFrames, totalFrames - pos);
+    stream.Process(audioData.samples.data() + pos * audioData.channels, frames);
   }
 
-  // Mix down to mono if stereo (average L+R)
-  std::vector<float> mono;
-  int numChannels = 2; // Assume stereo
-  int numFrames = samples.size() / numChannels;
-
-  if (numFrames < fftSize) {
-    // Not enough samples
-    return;
+  result = stream.Finish();
+  if (result.success) {
+    LogMessage("MAGDA DSP: Analysis complete\n");
   }
+  return result;
+}
 
-  mono.resize(numFrames);
-  for (int i = 0; i < numFrames; i++) {
-    float sum = 0.0f;
-    for (int ch = 0; ch < numChannels; ch++) {
-      sum += samples[i * numChannels + ch];
-    }
-    mono[i] = sum / numChannels;
+bool MagdaDSPAnalyzer::GetAudioSamples(MediaItem_Take *take, std::vector<float> &samples,
+                                       int &sampleRate, int &channels,
+                                       const DSPAnalysisConfig &config) {
+  // The whole take is materialized here, so keep the 30 second safety cap.
+  // Use AnalyzeItem() for full-length analysis.
+  TakeBlockReader reader;
+  if (!reader.Open(take, config, 30.0)) {
+    return false;
   }
 
-  // Prepare windowed buffer
-  std::vector<float> windowed(fftSize);
-  std::vector<float> realOut(numBins);
-  std::vector<float> imagOut(numBins);
-  std::vector<double> magnitudeAccum(numBins, 0.0);
+  sampleRate = reader.GetSampleRate();
+  channels = reader.GetChannels();
+  samples.resize((size_t)reader.GetTotalFrames() * channels);
 
-  // Process multiple windows and average
-  int numWindows = 0;
-  int hopSize = fftSize / 2;
-
-  for (int start = 0; start + fftSize <= (int)mono.size(); start += hopSize) {
-    // Apply Hann window
-    for (int i = 0; i < fftSize; i++) {
-      windowed[i] = mono[start + i] * HannWindow(i, fftSize);
-    }
-
-    // Perform DFT (simple version - for production, use FFTW or REAPER's FFT)
-    SimpleDFT(windowed.data(), fftSize, realOut.data(), imagOut.data());
-
-    // Accumulate magnitudes
-    for (int i = 0; i < numBins; i++) {
-      float mag = sqrtf(realOut[i] * realOut[i] + imagOut[i] * imagOut[i]);
-      magnitudeAccum[i] += mag;
-    }
-    numWindows++;
+  int blockFrames = config.streamBlockSize > 0 ? config.streamBlockSize : 16384;
+  size_t offset = 0;
+  int framesRead = 0;
+  while (offset < samples.size() &&
+         (framesRead = reader.ReadBlock(samples.data() + offset, blockFrames)) > 0) {
+    offset += (size_t)framesRead * channels;
   }
+  reader.Close();
 
-  // Average and convert to dB
-  if (numWindows > 0) {
-    for (int i = 0; i < numBins; i++) {
-      float avgMag = (float)(magnitudeAccum[i] / numWindows);
-      // Normalize by FFT size and convert to dB
-      avgMag /= (fftSize / 2.0f);
-      magnitudes[i] = LinearToDb(avgMag);
-    }
+  if (framesRead < 0 || !reader.HadAudio()) {
+    samples.clear();
+    return false;
   }
+
+  char logBuf[128];
+  snprintf(logBuf, sizeof(logBuf), "MAGDA DSP: Read %lld samples successfully\n",
+           reader.GetTotalFrames());
+  LogMessage(logBuf);
+
+  return true;
 }
 
 void MagdaDSPAnalyzer::CalculateFrequencyBands(const std::vector<float> &frequencies,
                                                const std::vector<float> &magnitudes,
-                                               FrequencyBands &bands) {
+                                               FrequencyBands &bands,
+                                               const MagdaMultiResSpectrum *multiRes) {
 
   if (frequencies.empty() || magnitudes.empty()) {
     return;
   }
 
+  if (multiRes) {
+    bands.sub = multiRes->GetBandLevel(20, 60, frequencies, magnitudes);
+    bands.bass = multiRes->GetBandLevel(60, 250, frequencies, magnitudes);
+    bands.lowMid = multiRes->GetBandLevel(250, 500, frequencies, magnitudes);
+    bands.mid = multiRes->GetBandLevel(500, 2000, frequencies, magnitudes);
+    bands.highMid = multiRes->GetBandLevel(2000, 4000, frequencies, magnitudes);
+    bands.presence = multiRes->GetBandLevel(4000, 6000, frequencies, magnitudes);
+    bands.brilliance = multiRes->GetBandLevel(6000, 20000, frequencies, magnitudes);
+    return;
+  }
+
   // Accumulate energy in each band
   double subEnergy = 0, bassEnergy = 0, lowMidEnergy = 0, midEnergy = 0;
   double highMidEnergy = 0, presenceEnergy = 0, brillianceEnergy = 0;
@@ -680,7 +1059,8 @@ void MagdaDSPAnalyzer::CalculateFrequencyBands(const std::vector<float> &frequen
 
 void MagdaDSPAnalyzer::CalculateEQProfile(const std::vector<float> &frequencies,
                                           const std::vector<float> &magnitudes,
-                                          std::vector<float> &eqFreqs, std::vector<float> &eqMags) {
+                                          std::vector<float> &eqFreqs, std::vector<float> &eqMags,
+                                          const MagdaMultiResSpectrum *multiRes) {
 
   eqFreqs.resize(kNumThirdOctaveBands);
   eqMags.resize(kNumThirdOctaveBands, -96.0f);
@@ -693,6 +1073,11 @@ void MagdaDSPAnalyzer::CalculateEQProfile(const std::vector<float> &frequencies,
     float lowFreq = kThirdOctaveFreqs[b] / ratio;
     float highFreq = kThirdOctaveFreqs[b] * ratio;
 
+    if (multiRes) {
+      eqMags[b] = multiRes->GetBandLevel(lowFreq, highFreq, frequencies, magnitudes);
+      continue;
+    }
+
     // Accumulate energy in band
     double energy = 0;
     int count = 0;
@@ -912,228 +1297,99 @@ SpectralFeatures MagdaDSPAnalyzer::CalculateSpectralFeatures(const std::vector<f
   return features;
 }
 
-LoudnessAnalysis MagdaDSPAnalyzer::CalculateLoudness(const std::vector<float> &samples,
-                                                     int sampleRate, int channels) {
-
-  LoudnessAnalysis result = {};
-
-  if (samples.empty()) {
-    result.rms = -96.0f;
-    result.peak = -96.0f;
-    result.truePeak = -96.0f;
-    result.lufs = -96.0f;
-    result.lufsShortTerm = -96.0f;
-    return result;
-  }
-
-  int numFrames = samples.size() / channels;
-
-  // Calculate RMS and peak
-  double sumSquares = 0;
-  float peakSample = 0;
-
-  for (size_t i = 0; i < samples.size(); i++) {
-    float absSample = fabsf(samples[i]);
-    sumSquares += samples[i] * samples[i];
-    if (absSample > peakSample) {
-      peakSample = absSample;
-    }
-  }
-
-  float rms = sqrtf(sumSquares / samples.size());
-  result.rms = LinearToDb(rms);
-  result.peak = LinearToDb(peakSample);
-
-  // True peak (simple 4x oversampling approximation)
-  // For real implementation, use proper interpolation
-  result.truePeak = result.peak + 0.5f; // Approximate
-
-  // LUFS approximation
-  // Real LUFS requires K-weighting filter, this is simplified
-  // Roughly LUFS = RMS - 0.691 for dialogue, varies for music
-  result.lufs = result.rms - 0.7f;
-  result.lufsShortTerm = result.lufs; // Simplified
-
-  return result;
-}
-
-DynamicsAnalysis MagdaDSPAnalyzer::CalculateDynamics(const std::vector<float> &samples,
-                                                     int channels) {
-  DynamicsAnalysis result = {};
-
-  if (samples.empty()) {
-    return result;
-  }
-
-  // Calculate peak and RMS
-  double sumSquares = 0;
-  float peak = 0;
-
-  for (size_t i = 0; i < samples.size(); i++) {
-    float absSample = fabsf(samples[i]);
-    sumSquares += samples[i] * samples[i];
-    if (absSample > peak) {
-      peak = absSample;
-    }
-  }
-
-  float rms = sqrtf(sumSquares / samples.size());
-
-  // Crest factor = Peak/RMS (in dB)
-  if (rms > 0) {
-    result.crestFactor = LinearToDb(peak) - LinearToDb(rms);
-  }
-
-  // Dynamic range (simplified - difference between loud and quiet parts)
-  // For real implementation, calculate percentiles
-  result.dynamicRange = result.crestFactor * 1.5f; // Approximation
-
-  // Compression ratio estimation (based on crest factor)
-  // Lower crest factor = more compressed
-  if (result.crestFactor < 6.0f) {
-    result.compressionRatio = 4.0f; // Heavy compression
-  } else if (result.crestFactor < 10.0f) {
-    result.compressionRatio = 2.0f; // Moderate compression
-  } else {
-    result.compressionRatio = 1.0f; // Little/no compression
-  }
-
-  return result;
-}
-
-StereoAnalysis MagdaDSPAnalyzer::CalculateStereo(const std::vector<float> &samples, int channels) {
-  StereoAnalysis result = {};
-
-  if (channels < 2 || samples.empty()) {
-    return result;
-  }
-
-  int numFrames = samples.size() / channels;
-
-  double sumL = 0, sumR = 0, sumLR = 0;
-  double sumL2 = 0, sumR2 = 0;
-  double sumMid2 = 0, sumSide2 = 0;
-
-  for (int i = 0; i < numFrames; i++) {
-    float L = samples[i * channels];
-    float R = samples[i * channels + 1];
-    float mid = (L + R) / 2.0f;
-    float side = (L - R) / 2.0f;
-
-    sumL += L;
-    sumR += R;
-    sumL2 += L * L;
-    sumR2 += R * R;
-    sumLR += L * R;
-    sumMid2 += mid * mid;
-    sumSide2 += side * side;
-  }
-
-  // Correlation coefficient
-  double denom = sqrt(sumL2 * sumR2);
-  if (denom > 0) {
-    result.correlation = sumLR / denom;
-  }
-
-  // Stereo width (side/mid ratio)
-  if (sumMid2 > 0) {
-    result.width = sqrtf(sumSide2 / sumMid2);
-    if (result.width > 1.0f)
-      result.width = 1.0f;
-  }
-
-  // Balance
-  double totalEnergy = sumL2 + sumR2;
-  if (totalEnergy > 0) {
-    result.balance = (sumR2 - sumL2) / totalEnergy;
-  }
-
-  return result;
-}
-
-TransientAnalysis MagdaDSPAnalyzer::CalculateTransients(const std::vector<float> &samples,
-                                                        int sampleRate, int channels) {
-  TransientAnalysis result = {};
-
-  if (samples.empty()) {
-    return result;
-  }
-
-  int numFrames = samples.size() / channels;
-
-  // Mix to mono
-  std::vector<float> mono(numFrames);
-  for (int i = 0; i < numFrames; i++) {
-    float sum = 0;
-    for (int ch = 0; ch < channels; ch++) {
-      sum += fabsf(samples[i * channels + ch]);
-    }
-    mono[i] = sum / channels;
-  }
-
-  // Simple envelope follower to detect attack
-  float envelope = 0;
-  float attack = 0.001f; // Fast attack
-  float release = 0.01f; // Slow release
-
-  float maxDerivative = 0;
-  int attackSample = 0;
-
-  for (int i = 1; i < numFrames; i++) {
-    float input = mono[i];
-
-    if (input > envelope) {
-      envelope = envelope + attack * (input - envelope);
+// How much of each variable-size section the JSON writer emits
+struct JSONDetail {
+  int spectrumBands; // Log-spaced spectrum bands (0 = leave out)
+  int maxOnsets;     // Strongest onsets listed (0 = leave out)
+  int frameFactor;   // Feature frames merged per written frame (0 = leave out)
+};
+
+// Drop detail from the largest section first. Returns false when nothing is
+// left to trim.
+static bool ThinJSONDetail(const DSPAnalysisResult &result, JSONDetail &detail) {
+  const int kMinItems = 8;
+  int numFrames = result.featureFrames.GetNumFrames();
+  if (detail.frameFactor > 0) {
+    if (numFrames / detail.frameFactor > kMinItems) {
+      detail.frameFactor *= 2;
     } else {
-      envelope = envelope + release * (input - envelope);
-    }
-
-    // Track derivative (rate of change)
-    float derivative = envelope - mono[i - 1];
-    if (derivative > maxDerivative) {
-      maxDerivative = derivative;
-      attackSample = i;
+      detail.frameFactor = 0;
     }
+    return true;
   }
-
-  // Attack time (time to reach peak from quiet)
-  if (attackSample > 0) {
-    result.attackTime = (float)attackSample / sampleRate;
+  if (detail.maxOnsets > 0) {
+    detail.maxOnsets = detail.maxOnsets > kMinItems ? detail.maxOnsets / 2 : 0;
+    return true;
   }
-
-  // Transient energy (ratio of high-derivative samples)
-  int transientSamples = 0;
-  float threshold = maxDerivative * 0.5f;
-
-  for (int i = 1; i < numFrames; i++) {
-    float derivative = fabsf(mono[i] - mono[i - 1]);
-    if (derivative > threshold) {
-      transientSamples++;
-    }
+  if (detail.spectrumBands > kMinItems) {
+    detail.spectrumBands /= 2;
+    return true;
   }
-
-  result.transientEnergy = (float)transientSamples / numFrames;
-
-  return result;
+  return false;
 }
 
-void MagdaDSPAnalyzer::AppendFloatArray(WDL_FastString &json, const char *name,
-                                        const std::vector<float> &arr, bool first) {
-  if (!first) {
-    json.Append(",");
+static void AppendOnsets(WDL_FastString &json, const std::vector<Onset> &onsets, int maxOnsets) {
+  // Keep the strongest onsets, listed in time order
+  std::vector<int> order(onsets.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = (int)i;
+  }
+  if ((int)order.size() > maxOnsets) {
+    std::nth_element(order.begin(), order.begin() + maxOnsets, order.end(),
+                     [&onsets](int a, int b) { return onsets[a].strength > onsets[b].strength; });
+    order.resize(maxOnsets);
+    std::sort(order.begin(), order.end());
+  }
+
+  json.Append(",\"onsets\":[");
+  for (size_t i = 0; i < order.size(); i++) {
+    const Onset &onset = onsets[order[i]];
+    json.Append(i > 0 ? ",{\"time\":" : "{\"time\":");
+    MagdaCompactJSON::AppendNumber(json, onset.time, 3);
+    json.Append(",\"strength\":");
+    MagdaCompactJSON::AppendNumber(json, onset.strength, 2);
+    json.Append(",\"attack\":");
+    MagdaCompactJSON::AppendNumber(json, onset.attack, 4);
+    json.Append("}");
   }
-  json.AppendFormatted(256, "\"%s\":[", name);
+  json.Append("]");
+}
 
-  for (size_t i = 0; i < arr.size(); i++) {
-    if (i > 0)
+static void AppendFeatureFrames(WDL_FastString &json, const FeatureFrames &source, int factor) {
+  FeatureFrames decimated;
+  const FeatureFrames *frames = &source;
+  if (factor > 1) {
+    MagdaFeatureFrameBuilder::Decimate(source, factor, decimated);
+    frames = &decimated;
+  }
+
+  int numFrames = frames->GetNumFrames();
+  json.Append(",\"feature_frames\":{");
+  json.AppendFormatted(128, "\"num_frames\":%d,\"start\":%.3f,\"frame_seconds\":%.3f", numFrames,
+                       frames->startSeconds, frames->frameSeconds);
+  MagdaCompactJSON::AppendArray(json, "band_edges", frames->bandEdges.data(),
+                                (int)frames->bandEdges.size(), 0, false);
+  MagdaCompactJSON::AppendArray(json, "rms", frames->rms.data(), numFrames, 1, false);
+  MagdaCompactJSON::AppendArray(json, "centroid", frames->centroid.data(), numFrames, 0, false);
+  MagdaCompactJSON::AppendArray(json, "flatness", frames->flatness.data(), numFrames, 3, false);
+  json.Append(",\"band_energies\":[");
+  for (int b = 0; b < frames->GetNumBands(); b++) {
+    if (b > 0)
       json.Append(",");
-    json.AppendFormatted(32, "%.2f", arr[i]);
+    json.Append("[");
+    const float *band = frames->bandEnergies.data() + (size_t)b * numFrames;
+    for (int f = 0; f < numFrames; f++) {
+      if (f > 0)
+        json.Append(",");
+      MagdaCompactJSON::AppendNumber(json, band[f], 1);
+    }
+    json.Append("]");
   }
-
-  json.Append("]");
+  json.Append("]}");
 }
 
-void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &json) {
+static void AppendAnalysisJSON(const DSPAnalysisResult &result, const JSONDetail &detail,
+                               WDL_FastString &json) {
   json.Append("{");
 
   // Success status
@@ -1150,8 +1406,10 @@ void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &j
   }
 
   // Sample info
-  json.AppendFormatted(128, ",\"sample_rate\":%d,\"channels\":%d,\"length\":%.3f",
-                       result.sampleRate, result.channels, result.lengthSeconds);
+  json.AppendFormatted(160,
+                       ",\"sample_rate\":%d,\"channels\":%d,\"length\":%.3f,\"active_length\":%.3f",
+                       result.sampleRate, result.channels, result.lengthSeconds,
+                       result.activeSeconds);
 
   // Frequency spectrum
   json.Append(",\"frequency_spectrum\":{");
@@ -1168,12 +1426,26 @@ void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &j
   json.AppendFormatted(64, ",\"brilliance\":%.2f", result.bands.brilliance);
   json.Append("}");
 
+  // Averaged spectrum reduced to log-spaced bands
+  if (detail.spectrumBands > 0 && !result.fftFrequencies.empty()) {
+    float maxHz = result.sampleRate * 0.5f < 20000.0f ? result.sampleRate * 0.5f : 20000.0f;
+    std::vector<float> centres, levels;
+    MagdaCompactJSON::LogBinSpectrum(result.fftFrequencies, result.fftMagnitudes,
+                                     detail.spectrumBands, 20.0f, maxHz, centres, levels);
+    json.Append(",\"spectrum\":{");
+    MagdaCompactJSON::AppendArray(json, "hz", centres.data(), (int)centres.size(), 0, true);
+    MagdaCompactJSON::AppendArray(json, "db", levels.data(), (int)levels.size(), 1, false);
+    json.Append("}");
+  }
+
   // EQ Profile
   if (!result.eqProfileFreqs.empty()) {
     json.Append(",\"eq_profile\":{");
     json.Append("\"resolution\":\"1/3_octave\"");
-    AppendFloatArray(json, "frequencies", result.eqProfileFreqs, false);
-    AppendFloatArray(json, "magnitudes", result.eqProfileMags, false);
+    MagdaCompactJSON::AppendArray(json, "frequencies", result.eqProfileFreqs.data(),
+                                  (int)result.eqProfileFreqs.size(), 1, false);
+    MagdaCompactJSON::AppendArray(json, "magnitudes", result.eqProfileMags.data(),
+                                  (int)result.eqProfileMags.size(), 1, false);
     json.Append("}");
   }
 
@@ -1224,8 +1496,21 @@ void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &j
   json.AppendFormatted(64, "\"rms\":%.2f", result.loudness.rms);
   json.AppendFormatted(64, ",\"lufs\":%.2f", result.loudness.lufs);
   json.AppendFormatted(64, ",\"lufs_short_term\":%.2f", result.loudness.lufsShortTerm);
+  json.AppendFormatted(64, ",\"lufs_momentary_max\":%.2f", result.loudness.lufsMomentaryMax);
+  json.AppendFormatted(64, ",\"loudness_range\":%.2f", result.loudness.loudnessRange);
   json.AppendFormatted(64, ",\"peak\":%.2f", result.loudness.peak);
   json.AppendFormatted(64, ",\"true_peak\":%.2f", result.loudness.truePeak);
+  if (!result.truePeakOvers.empty()) {
+    json.Append(",\"true_peak_overs\":[");
+    for (size_t i = 0; i < result.truePeakOvers.size(); i++) {
+      if (i > 0)
+        json.Append(",");
+      json.AppendFormatted(128, "{\"time\":%.3f,\"dbtp\":%.2f,\"channel\":%d}",
+                           result.truePeakOvers[i].time, result.truePeakOvers[i].level,
+                           result.truePeakOvers[i].channel);
+    }
+    json.Append("]");
+  }
   json.Append("}");
 
   // Dynamics
@@ -1240,17 +1525,67 @@ void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &j
   json.AppendFormatted(64, "\"width\":%.3f", result.stereo.width);
   json.AppendFormatted(64, ",\"correlation\":%.3f", result.stereo.correlation);
   json.AppendFormatted(64, ",\"balance\":%.3f", result.stereo.balance);
+  if (!result.stereoBands.empty()) {
+    json.AppendFormatted(64, ",\"low_end_correlation\":%.3f", result.stereo.lowEndCorrelation);
+    json.AppendFormatted(64, ",\"low_end_mono_compatible\":%s",
+                         result.stereo.lowEndMonoCompatible ? "true" : "false");
+    json.Append(",\"bands\":[");
+    for (size_t i = 0; i < result.stereoBands.size(); i++) {
+      const StereoBand &band = result.stereoBands[i];
+      if (i > 0)
+        json.Append(",");
+      json.AppendFormatted(192,
+                           "{\"low\":%.0f,\"high\":%.0f,\"mid\":%.1f,\"side\":%.1f,"
+                           "\"correlation\":%.3f,\"width\":%.3f}",
+                           band.lowFreq, band.highFreq, band.midLevel, band.sideLevel,
+                           band.correlation, band.width);
+    }
+    json.Append("]");
+  }
   json.Append("}");
 
   // Transients
   json.Append(",\"transients\":{");
   json.AppendFormatted(64, "\"attack_time\":%.4f", result.transients.attackTime);
   json.AppendFormatted(64, ",\"transient_energy\":%.3f", result.transients.transientEnergy);
+  json.AppendFormatted(64, ",\"onset_rate\":%.2f", result.transients.onsetRate);
+  json.AppendFormatted(64, ",\"onset_count\":%d", (int)result.onsets.size());
+  if (!result.onsets.empty() && detail.maxOnsets > 0) {
+    AppendOnsets(json, result.onsets, detail.maxOnsets);
+  }
   json.Append("}");
 
+  // Time-resolved features (one array per feature, band energies per band)
+  if (result.featureFrames.GetNumFrames() > 0 && detail.frameFactor > 0) {
+    AppendFeatureFrames(json, result.featureFrames, detail.frameFactor);
+  }
+
   json.Append("}");
 }
 
+void MagdaDSPAnalyzer::ToJSON(const DSPAnalysisResult &result, WDL_FastString &json,
+                              const DSPJSONOptions &options) {
+  JSONDetail detail;
+  detail.spectrumBands = options.spectrumBands;
+  detail.maxOnsets = (int)result.onsets.size();
+  detail.frameFactor = 1;
+
+  if (options.maxBytes <= 0) {
+    AppendAnalysisJSON(result, detail, json);
+    return;
+  }
+
+  // Render, and thin the detail sections until the output fits the budget
+  WDL_FastString body;
+  body.SetLen(options.maxBytes); // Reserve once; later renders reuse the buffer
+  do {
+    body.SetLen(0);
+    AppendAnalysisJSON(result, detail, body);
+  } while (body.GetLength() > options.maxBytes && ThinJSONDetail(result, detail));
+
+  json.Append(body.Get(), body.GetLength());
+}
+
 void MagdaDSPAnalyzer::GetTrackFXInfo(int trackIndex, WDL_FastString &json) {
   // Output only the array - caller adds the key name
   json.Append("[");
@@ -0,0 +1,467 @@
+#include "magda_dsp_kernels.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAGDA_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MAGDA_TARGET_AVX2
+#else
+#define MAGDA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MAGDA_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// SIMD lanes accumulate in float; they are flushed into the double totals
+// every kFlushFrames frames so long items don't lose precision
+static const int kFlushFrames = 256;
+
+typedef void (*TimeDomainKernel)(const float *x, int numFrames, TimeDomainStats &stats,
+                                 float *monoOut, float *monoAbsOut, float *sideOut);
+
+void MagdaDSPKernels::AccumulateTimeDomainScalar(const float *interleaved, int numFrames,
+                                                 int channels, TimeDomainStats &stats,
+                                                 float *monoOut, float *monoAbsOut,
+                                                 float *sideOut) {
+  if (numFrames <= 0 || channels <= 0) {
+    return;
+  }
+
+  const float channelScale = 1.0f / channels;
+  double sumSquares = 0.0;
+  double sumL2 = 0.0, sumR2 = 0.0, sumLR = 0.0;
+  float peak = stats.peak;
+
+  for (int i = 0; i < numFrames; i++) {
+    const float *frame = interleaved + (size_t)i * channels;
+    float sum = 0.0f;
+    float sumAbs = 0.0f;
+    for (int ch = 0; ch < channels; ch++) {
+      float s = frame[ch];
+      float absSample = fabsf(s);
+      sum += s;
+      sumAbs += absSample;
+      sumSquares += s * s;
+      if (absSample > peak) {
+        peak = absSample;
+      }
+    }
+    if (channels >= 2) {
+      sumL2 += frame[0] * frame[0];
+      sumR2 += frame[1] * frame[1];
+      sumLR += frame[0] * frame[1];
+    }
+    if (monoOut) {
+      monoOut[i] = sum * channelScale;
+    }
+    if (monoAbsOut) {
+      monoAbsOut[i] = sumAbs * channelScale;
+    }
+    if (sideOut) {
+      sideOut[i] = channels >= 2 ? (frame[0] - frame[1]) * 0.5f : 0.0f;
+    }
+  }
+
+  stats.sumSquares += sumSquares;
+  stats.peak = peak;
+  stats.sampleCount += (long long)numFrames * channels;
+  if (channels >= 2) {
+    stats.sumL2 += sumL2;
+    stats.sumR2 += sumR2;
+    stats.sumLR += sumLR;
+  }
+}
+
+// ============================================================================
+// x86: SSE2 (baseline) and AVX2 (runtime detected)
+// ============================================================================
+
+#ifdef MAGDA_KERNELS_X86
+
+static double HorizontalSum(__m128 v) {
+  float lanes[4];
+  _mm_storeu_ps(lanes, v);
+  return (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static float HorizontalMax(__m128 v) {
+  float lanes[4];
+  _mm_storeu_ps(lanes, v);
+  float m = lanes[0];
+  for (int i = 1; i < 4; i++) {
+    m = lanes[i] > m ? lanes[i] : m;
+  }
+  return m;
+}
+
+static void StereoSSE2(const float *x, int numFrames, TimeDomainStats &stats, float *monoOut,
+                       float *monoAbsOut, float *sideOut) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 half = _mm_set1_ps(0.5f);
+  __m128 peak = _mm_set1_ps(stats.peak);
+  const int vecFrames = numFrames & ~3;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    __m128 l2 = _mm_setzero_ps();
+    __m128 r2 = _mm_setzero_ps();
+    __m128 lr = _mm_setzero_ps();
+    for (; i < chunkEnd; i += 4) {
+      __m128 a = _mm_loadu_ps(x + i * 2);     // L0 R0 L1 R1
+      __m128 b = _mm_loadu_ps(x + i * 2 + 4); // L2 R2 L3 R3
+      __m128 L = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 R = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      l2 = _mm_add_ps(l2, _mm_mul_ps(L, L));
+      r2 = _mm_add_ps(r2, _mm_mul_ps(R, R));
+      lr = _mm_add_ps(lr, _mm_mul_ps(L, R));
+      __m128 absL = _mm_and_ps(L, absMask);
+      __m128 absR = _mm_and_ps(R, absMask);
+      peak = _mm_max_ps(peak, _mm_max_ps(absL, absR));
+      if (monoOut) {
+        _mm_storeu_ps(monoOut + i, _mm_mul_ps(_mm_add_ps(L, R), half));
+      }
+      if (monoAbsOut) {
+        _mm_storeu_ps(monoAbsOut + i, _mm_mul_ps(_mm_add_ps(absL, absR), half));
+      }
+      if (sideOut) {
+        _mm_storeu_ps(sideOut + i, _mm_mul_ps(_mm_sub_ps(L, R), half));
+      }
+    }
+    double sumL2 = HorizontalSum(l2);
+    double sumR2 = HorizontalSum(r2);
+    stats.sumL2 += sumL2;
+    stats.sumR2 += sumR2;
+    stats.sumLR += HorizontalSum(lr);
+    stats.sumSquares += sumL2 + sumR2;
+  }
+
+  stats.peak = HorizontalMax(peak);
+  stats.sampleCount += (long long)vecFrames * 2;
+
+  MagdaDSPKernels::AccumulateTimeDomainScalar(
+      x + (size_t)vecFrames * 2, numFrames - vecFrames, 2, stats,
+      monoOut ? monoOut + vecFrames : nullptr, monoAbsOut ? monoAbsOut + vecFrames : nullptr,
+      sideOut ? sideOut + vecFrames : nullptr);
+}
+
+static void MonoSSE2(const float *x, int numFrames, TimeDomainStats &stats, float *monoOut,
+                     float *monoAbsOut, float *sideOut) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 peak = _mm_set1_ps(stats.peak);
+  const int vecFrames = numFrames & ~3;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    __m128 sq = _mm_setzero_ps();
+    for (; i < chunkEnd; i += 4) {
+      __m128 v = _mm_loadu_ps(x + i);
+      __m128 absV = _mm_and_ps(v, absMask);
+      sq = _mm_add_ps(sq, _mm_mul_ps(v, v));
+      peak = _mm_max_ps(peak, absV);
+      if (monoOut) {
+        _mm_storeu_ps(monoOut + i, v);
+      }
+      if (monoAbsOut) {
+        _mm_storeu_ps(monoAbsOut + i, absV);
+      }
+    }
+    stats.sumSquares += HorizontalSum(sq);
+  }
+
+  stats.peak = HorizontalMax(peak);
+  stats.sampleCount += vecFrames;
+
+  MagdaDSPKernels::AccumulateTimeDomainScalar(x + vecFrames, numFrames - vecFrames, 1, stats,
+                                              monoOut ? monoOut + vecFrames : nullptr,
+                                              monoAbsOut ? monoAbsOut + vecFrames : nullptr,
+                                              sideOut ? sideOut + vecFrames : nullptr);
+}
+
+MAGDA_TARGET_AVX2 static double HorizontalSum256(__m256 v) {
+  return HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+MAGDA_TARGET_AVX2 static float HorizontalMax256(__m256 v) {
+  return HorizontalMax(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+MAGDA_TARGET_AVX2 static void StereoAVX2(const float *x, int numFrames, TimeDomainStats &stats,
+                                         float *monoOut, float *monoAbsOut, float *sideOut) {
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 half = _mm256_set1_ps(0.5f);
+  __m256 peak = _mm256_set1_ps(stats.peak);
+  const int vecFrames = numFrames & ~7;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    __m256 l2 = _mm256_setzero_ps();
+    __m256 r2 = _mm256_setzero_ps();
+    __m256 lr = _mm256_setzero_ps();
+    for (; i < chunkEnd; i += 8) {
+      __m256 a = _mm256_loadu_ps(x + i * 2);     // L0 R0 L1 R1 | L2 R2 L3 R3
+      __m256 b = _mm256_loadu_ps(x + i * 2 + 8); // L4 R4 L5 R5 | L6 R6 L7 R7
+      // Per-lane shuffle gives L0 L1 L4 L5 | L2 L3 L6 L7; the 64-bit permute
+      // restores frame order
+      __m256 L = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m256 R = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      L = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(L), 0xD8));
+      R = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(R), 0xD8));
+      l2 = _mm256_add_ps(l2, _mm256_mul_ps(L, L));
+      r2 = _mm256_add_ps(r2, _mm256_mul_ps(R, R));
+      lr = _mm256_add_ps(lr, _mm256_mul_ps(L, R));
+      __m256 absL = _mm256_and_ps(L, absMask);
+      __m256 absR = _mm256_and_ps(R, absMask);
+      peak = _mm256_max_ps(peak, _mm256_max_ps(absL, absR));
+      if (monoOut) {
+        _mm256_storeu_ps(monoOut + i, _mm256_mul_ps(_mm256_add_ps(L, R), half));
+      }
+      if (monoAbsOut) {
+        _mm256_storeu_ps(monoAbsOut + i, _mm256_mul_ps(_mm256_add_ps(absL, absR), half));
+      }
+      if (sideOut) {
+        _mm256_storeu_ps(sideOut + i, _mm256_mul_ps(_mm256_sub_ps(L, R), half));
+      }
+    }
+    double sumL2 = HorizontalSum256(l2);
+    double sumR2 = HorizontalSum256(r2);
+    stats.sumL2 += sumL2;
+    stats.sumR2 += sumR2;
+    stats.sumLR += HorizontalSum256(lr);
+    stats.sumSquares += sumL2 + sumR2;
+  }
+
+  stats.peak = HorizontalMax256(peak);
+  stats.sampleCount += (long long)vecFrames * 2;
+
+  StereoSSE2(x + (size_t)vecFrames * 2, numFrames - vecFrames, stats,
+             monoOut ? monoOut + vecFrames : nullptr, monoAbsOut ? monoAbsOut + vecFrames : nullptr,
+             sideOut ? sideOut + vecFrames : nullptr);
+}
+
+MAGDA_TARGET_AVX2 static void MonoAVX2(const float *x, int numFrames, TimeDomainStats &stats,
+                                       float *monoOut, float *monoAbsOut, float *sideOut) {
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 peak = _mm256_set1_ps(stats.peak);
+  const int vecFrames = numFrames & ~7;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    __m256 sq = _mm256_setzero_ps();
+    for (; i < chunkEnd; i += 8) {
+      __m256 v = _mm256_loadu_ps(x + i);
+      __m256 absV = _mm256_and_ps(v, absMask);
+      sq = _mm256_add_ps(sq, _mm256_mul_ps(v, v));
+      peak = _mm256_max_ps(peak, absV);
+      if (monoOut) {
+        _mm256_storeu_ps(monoOut + i, v);
+      }
+      if (monoAbsOut) {
+        _mm256_storeu_ps(monoAbsOut + i, absV);
+      }
+    }
+    stats.sumSquares += HorizontalSum256(sq);
+  }
+
+  stats.peak = HorizontalMax256(peak);
+  stats.sampleCount += vecFrames;
+
+  MonoSSE2(x + vecFrames, numFrames - vecFrames, stats, monoOut ? monoOut + vecFrames : nullptr,
+           monoAbsOut ? monoAbsOut + vecFrames : nullptr, sideOut ? sideOut + vecFrames : nullptr);
+}
+
+static bool CpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  // OS must save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // MAGDA_KERNELS_X86
+
+// ============================================================================
+// ARM: NEON
+// ============================================================================
+
+#ifdef MAGDA_KERNELS_NEON
+
+static double HorizontalSum(float32x4_t v) {
+  float lanes[4];
+  vst1q_f32(lanes, v);
+  return (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static float HorizontalMax(float32x4_t v) {
+  float lanes[4];
+  vst1q_f32(lanes, v);
+  float m = lanes[0];
+  for (int i = 1; i < 4; i++) {
+    m = lanes[i] > m ? lanes[i] : m;
+  }
+  return m;
+}
+
+static void StereoNEON(const float *x, int numFrames, TimeDomainStats &stats, float *monoOut,
+                       float *monoAbsOut, float *sideOut) {
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  float32x4_t peak = vdupq_n_f32(stats.peak);
+  const int vecFrames = numFrames & ~3;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    float32x4_t l2 = vdupq_n_f32(0.0f);
+    float32x4_t r2 = vdupq_n_f32(0.0f);
+    float32x4_t lr = vdupq_n_f32(0.0f);
+    for (; i < chunkEnd; i += 4) {
+      float32x4x2_t lrPair = vld2q_f32(x + i * 2); // Deinterleaves into L and R
+      float32x4_t L = lrPair.val[0];
+      float32x4_t R = lrPair.val[1];
+      l2 = vmlaq_f32(l2, L, L);
+      r2 = vmlaq_f32(r2, R, R);
+      lr = vmlaq_f32(lr, L, R);
+      float32x4_t absL = vabsq_f32(L);
+      float32x4_t absR = vabsq_f32(R);
+      peak = vmaxq_f32(peak, vmaxq_f32(absL, absR));
+      if (monoOut) {
+        vst1q_f32(monoOut + i, vmulq_f32(vaddq_f32(L, R), half));
+      }
+      if (monoAbsOut) {
+        vst1q_f32(monoAbsOut + i, vmulq_f32(vaddq_f32(absL, absR), half));
+      }
+      if (sideOut) {
+        vst1q_f32(sideOut + i, vmulq_f32(vsubq_f32(L, R), half));
+      }
+    }
+    double sumL2 = HorizontalSum(l2);
+    double sumR2 = HorizontalSum(r2);
+    stats.sumL2 += sumL2;
+    stats.sumR2 += sumR2;
+    stats.sumLR += HorizontalSum(lr);
+    stats.sumSquares += sumL2 + sumR2;
+  }
+
+  stats.peak = HorizontalMax(peak);
+  stats.sampleCount += (long long)vecFrames * 2;
+
+  MagdaDSPKernels::AccumulateTimeDomainScalar(
+      x + (size_t)vecFrames * 2, numFrames - vecFrames, 2, stats,
+      monoOut ? monoOut + vecFrames : nullptr, monoAbsOut ? monoAbsOut + vecFrames : nullptr,
+      sideOut ? sideOut + vecFrames : nullptr);
+}
+
+static void MonoNEON(const float *x, int numFrames, TimeDomainStats &stats, float *monoOut,
+                     float *monoAbsOut, float *sideOut) {
+  float32x4_t peak = vdupq_n_f32(stats.peak);
+  const int vecFrames = numFrames & ~3;
+
+  int i = 0;
+  while (i < vecFrames) {
+    int chunkEnd = i + kFlushFrames < vecFrames ? i + kFlushFrames : vecFrames;
+    float32x4_t sq = vdupq_n_f32(0.0f);
+    for (; i < chunkEnd; i += 4) {
+      float32x4_t v = vld1q_f32(x + i);
+      float32x4_t absV = vabsq_f32(v);
+      sq = vmlaq_f32(sq, v, v);
+      peak = vmaxq_f32(peak, absV);
+      if (monoOut) {
+        vst1q_f32(monoOut + i, v);
+      }
+      if (monoAbsOut) {
+        vst1q_f32(monoAbsOut + i, absV);
+      }
+    }
+    stats.sumSquares += HorizontalSum(sq);
+  }
+
+  stats.peak = HorizontalMax(peak);
+  stats.sampleCount += vecFrames;
+
+  MagdaDSPKernels::AccumulateTimeDomainScalar(x + vecFrames, numFrames - vecFrames, 1, stats,
+                                              monoOut ? monoOut + vecFrames : nullptr,
+                                              monoAbsOut ? monoAbsOut + vecFrames : nullptr,
+                                              sideOut ? sideOut + vecFrames : nullptr);
+}
+
+#endif // MAGDA_KERNELS_NEON
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+namespace {
+struct KernelTable {
+  TimeDomainKernel mono = nullptr;
+  TimeDomainKernel stereo = nullptr;
+  const char *isa = "scalar";
+};
+} // namespace
+
+static const KernelTable &GetKernels() {
+  // Resolved once; function-local statics are initialized thread-safely
+  static const KernelTable table = []() {
+    KernelTable t;
+#if defined(MAGDA_KERNELS_X86)
+    if (CpuHasAVX2()) {
+      t.mono = MonoAVX2;
+      t.stereo = StereoAVX2;
+      t.isa = "avx2";
+    } else {
+      t.mono = MonoSSE2;
+      t.stereo = StereoSSE2;
+      t.isa = "sse2";
+    }
+#elif defined(MAGDA_KERNELS_NEON)
+    t.mono = MonoNEON;
+    t.stereo = StereoNEON;
+    t.isa = "neon";
+#endif
+    return t;
+  }();
+  return table;
+}
+
+void MagdaDSPKernels::AccumulateTimeDomain(const float *interleaved, int numFrames, int channels,
+                                           TimeDomainStats &stats, float *monoOut,
+                                           float *monoAbsOut, float *sideOut) {
+  if (!interleaved || numFrames <= 0 || channels <= 0) {
+    return;
+  }
+
+  const KernelTable &kernels = GetKernels();
+  if (channels == 2 && kernels.stereo) {
+    kernels.stereo(interleaved, numFrames, stats, monoOut, monoAbsOut, sideOut);
+  } else if (channels == 1 && kernels.mono) {
+    // Mono input has no side signal
+    if (sideOut) {
+      memset(sideOut, 0, sizeof(float) * numFrames);
+    }
+    kernels.mono(interleaved, numFrames, stats, monoOut, monoAbsOut, nullptr);
+  } else {
+    AccumulateTimeDomainScalar(interleaved, numFrames, channels, stats, monoOut, monoAbsOut,
+                               sideOut);
+  }
+}
+
+const char *MagdaDSPKernels::GetActiveISA() { return GetKernels().isa; }
@@ -0,0 +1,241 @@
+#include "magda_dsp_stream.h"
+#include "magda_stereo_image.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+MagdaDSPStream::MagdaDSPStream(int sampleRate, int channels, const DSPAnalysisConfig &config,
+                               long long expectedFrames)
+    : m_config(config), m_sampleRate(sampleRate), m_channels(channels < 1 ? 1 : channels),
+      m_framesProcessed(0) {
+
+  if (m_config.analyzeFrequency || m_config.analyzeFeatureFrames || m_config.analyzeTransients) {
+    m_stft = std::make_unique<MagdaSTFT>(config.fftSize, config.hopSize, config.analysisThreads);
+    m_stft->SetSilenceGate(config.silenceGateDb);
+    if (m_config.analyzeStereo && m_channels >= 2) {
+      m_stft->EnableSideChannel();
+    }
+  }
+  if (m_stft && m_config.analyzeFrequency && m_config.multiResolutionBands) {
+    m_multiRes = std::make_unique<MagdaMultiResSpectrum>(m_sampleRate, m_stft->GetFFTSize(), 20.0f,
+                                                         config.analysisThreads);
+    m_multiRes->SetSilenceGate(config.silenceGateDb);
+  }
+
+  // Onsets and time-resolved features reuse the STFT windows instead of a
+  // second pass over the samples
+  if (m_stft) {
+    int fftSize = m_stft->GetFFTSize();
+    int hopSize = m_stft->GetHopSize();
+    if (m_config.analyzeFeatureFrames) {
+      long long expectedWindows =
+          expectedFrames >= fftSize ? (expectedFrames - fftSize) / hopSize + 1 : 0;
+      std::vector<float> bandEdges =
+          config.criticalBandFrames
+              ? MagdaFeatureFrameBuilder::CriticalBandEdges(m_sampleRate)
+              : MagdaFeatureFrameBuilder::LogBandEdges(m_sampleRate, config.featureFrameBands);
+      m_featureFrames = std::make_unique<MagdaFeatureFrameBuilder>(
+          m_sampleRate, fftSize, hopSize, bandEdges, config.featureFrameBudget, expectedWindows);
+    }
+    if (m_config.analyzeTransients) {
+      m_onsets =
+          std::make_unique<MagdaOnsetDetector>(m_sampleRate, fftSize, hopSize, config.maxOnsets);
+    }
+    if (m_featureFrames || m_onsets) {
+      m_stft->SetWindowCallback([this](const float *samples, const float *magnitudes) {
+        ProcessWindow(samples, magnitudes);
+      });
+    }
+  }
+
+  if (m_config.analyzeLoudness) {
+    m_loudness = std::make_unique<MagdaLoudnessMeter>(m_sampleRate, m_channels);
+    m_truePeak = std::make_unique<MagdaTruePeakDetector>(
+        m_sampleRate, m_channels, config.truePeakOversampling, config.truePeakOverThreshold);
+  }
+}
+
+MagdaDSPStream::~MagdaDSPStream() {}
+
+void MagdaDSPStream::Process(const float *interleaved, int numFrames) {
+  if (!interleaved || numFrames <= 0) {
+    return;
+  }
+
+  bool side = m_stft && m_stft->HasSideChannel();
+  if ((int)m_mono.size() < numFrames) {
+    m_mono.resize(numFrames);
+    if (side) {
+      m_side.resize(numFrames);
+    }
+  }
+
+  // Single pass over the interleaved block; later stages only touch the
+  // downmix and side signal
+  MagdaDSPKernels::AccumulateTimeDomain(interleaved, numFrames, m_channels, m_timeStats,
+                                        m_stft ? m_mono.data() : nullptr, nullptr,
+                                        side ? m_side.data() : nullptr);
+
+  if (m_loudness) {
+    m_loudness->Process(interleaved, numFrames);
+    m_truePeak->Process(interleaved, numFrames);
+  }
+  if (m_stft) {
+    m_stft->Process(m_mono.data(), numFrames, side ? m_side.data() : nullptr);
+  }
+  if (m_multiRes) {
+    m_multiRes->Process(m_mono.data(), numFrames);
+  }
+
+  m_framesProcessed += numFrames;
+}
+
+void MagdaDSPStream::ProcessWindow(const float *samples, const float *magnitudes) {
+  if (m_featureFrames) {
+    m_featureFrames->AddWindow(samples, magnitudes);
+  }
+  if (m_onsets) {
+    m_onsets->AddWindow(samples, magnitudes);
+  }
+}
+
+DSPAnalysisResult MagdaDSPStream::Finish() { return BuildResult(true); }
+
+DSPAnalysisResult MagdaDSPStream::Snapshot() { return BuildResult(false); }
+
+DSPAnalysisResult MagdaDSPStream::BuildResult(bool final) {
+  DSPAnalysisResult result;
+
+  if (m_framesProcessed <= 0) {
+    result.errorMessage.Set("No audio samples found");
+    return result;
+  }
+
+  result.sampleRate = m_sampleRate;
+  result.channels = m_channels;
+  result.lengthSeconds = (double)m_framesProcessed / m_sampleRate;
+  result.activeSeconds = result.lengthSeconds;
+
+  if (m_stft) {
+    m_stft->Flush();
+    // With windows gated, each active window stands for one hop of audio
+    long long activeWindows = m_stft->GetNumActiveWindows();
+    if (activeWindows < m_stft->GetNumWindows()) {
+      double active = (double)activeWindows * m_stft->GetHopSize() / m_sampleRate;
+      result.activeSeconds = std::min(active, result.lengthSeconds);
+    }
+  }
+  if (m_featureFrames) {
+    m_featureFrames->Finish(result.featureFrames);
+  }
+
+  // Spectrum: average magnitudes over the active (ungated) windows, so
+  // silence between phrases doesn't drag the levels down; normalize, to dB
+  if (m_stft && m_config.analyzeFrequency) {
+    int fftSize = m_stft->GetFFTSize();
+    int numBins = m_stft->GetNumBins();
+    long long numWindows = m_stft->GetNumActiveWindows();
+    const std::vector<double> &sums = m_stft->GetMagnitudeSums();
+
+    result.fftFrequencies.resize(numBins);
+    result.fftMagnitudes.resize(numBins, -96.0f);
+    for (int i = 0; i < numBins; i++) {
+      result.fftFrequencies[i] = (float)i * m_sampleRate / fftSize;
+    }
+    if (numWindows > 0) {
+      for (int i = 0; i < numBins; i++) {
+        float avgMag = (float)(sums[i] / numWindows);
+        avgMag /= (fftSize / 2.0f);
+        result.fftMagnitudes[i] = MagdaDSPAnalyzer::LinearToDb(avgMag);
+      }
+    }
+
+    if (m_multiRes) {
+      m_multiRes->Flush();
+    }
+    MagdaDSPAnalyzer::CalculateFrequencyBands(result.fftFrequencies, result.fftMagnitudes,
+                                              result.bands, m_multiRes.get());
+    MagdaDSPAnalyzer::CalculateEQProfile(result.fftFrequencies, result.fftMagnitudes,
+                                         result.eqProfileFreqs, result.eqProfileMags,
+                                         m_multiRes.get());
+    MagdaDSPAnalyzer::DetectPeaks(result.fftFrequencies, result.fftMagnitudes, result.peaks);
+  }
+
+  if (m_config.analyzeResonances && !result.peaks.empty()) {
+    MagdaDSPAnalyzer::DetectResonances(result.peaks, result.eqProfileMags, result.resonances);
+  }
+
+  if (m_config.analyzeSpectralFeatures && !result.fftFrequencies.empty()) {
+    result.spectralFeatures =
+        MagdaDSPAnalyzer::CalculateSpectralFeatures(result.fftFrequencies, result.fftMagnitudes);
+  }
+
+  const TimeDomainStats &ts = m_timeStats;
+  float rms = ts.sampleCount > 0 ? (float)sqrt(ts.sumSquares / ts.sampleCount) : 0.0f;
+
+  if (m_config.analyzeLoudness) {
+    result.loudness.rms = MagdaDSPAnalyzer::LinearToDb(rms);
+    result.loudness.peak = MagdaDSPAnalyzer::LinearToDb(ts.peak);
+    result.loudness.truePeak = MagdaDSPAnalyzer::LinearToDb(m_truePeak->GetTruePeak());
+    result.truePeakOvers = m_truePeak->GetOvers();
+    result.loudness.lufs = (float)m_loudness->GetIntegrated();
+    result.loudness.lufsShortTerm = (float)m_loudness->GetShortTermMax();
+    result.loudness.lufsMomentaryMax = (float)m_loudness->GetMomentaryMax();
+    result.loudness.loudnessRange = (float)m_loudness->GetLoudnessRange();
+  }
+
+  if (m_config.analyzeDynamics) {
+    // Crest factor = Peak/RMS (in dB)
+    if (rms > 0) {
+      result.dynamics.crestFactor =
+          MagdaDSPAnalyzer::LinearToDb(ts.peak) - MagdaDSPAnalyzer::LinearToDb(rms);
+    }
+    // Dynamic range (simplified - difference between loud and quiet parts)
+    result.dynamics.dynamicRange = result.dynamics.crestFactor * 1.5f;
+    // Lower crest factor = more compressed
+    if (result.dynamics.crestFactor < 6.0f) {
+      result.dynamics.compressionRatio = 4.0f;
+    } else if (result.dynamics.crestFactor < 10.0f) {
+      result.dynamics.compressionRatio = 2.0f;
+    } else {
+      result.dynamics.compressionRatio = 1.0f;
+    }
+  }
+
+  if (m_config.analyzeStereo && m_channels >= 2) {
+    double denom = sqrt(ts.sumL2 * ts.sumR2);
+    if (denom > 0) {
+      result.stereo.correlation = ts.sumLR / denom;
+    }
+    // Mid/side energies follow from the L/R sums: M = (L+R)/2, S = (L-R)/2
+    double sumMid2 = (ts.sumL2 + 2.0 * ts.sumLR + ts.sumR2) * 0.25;
+    double sumSide2 = (ts.sumL2 - 2.0 * ts.sumLR + ts.sumR2) * 0.25;
+    if (sumMid2 > 0) {
+      result.stereo.width = sqrtf((float)((sumSide2 > 0 ? sumSide2 : 0.0) / sumMid2));
+      if (result.stereo.width > 1.0f)
+        result.stereo.width = 1.0f;
+    }
+    double totalEnergy = ts.sumL2 + ts.sumR2;
+    if (totalEnergy > 0) {
+      result.stereo.balance = (ts.sumR2 - ts.sumL2) / totalEnergy;
+    }
+
+    // Per-band image from the STFT's mid/side sums
+    if (m_stft && m_stft->HasSideChannel()) {
+      MagdaStereoImage::Analyze(*m_stft, m_sampleRate, result.stereoBands, result.stereo);
+    }
+  }
+
+  if (m_onsets) {
+    if (final) {
+      m_onsets->Finish();
+    }
+    result.onsets = m_onsets->GetOnsetsSoFar();
+    result.transients.attackTime = m_onsets->GetMedianAttack();
+    result.transients.transientEnergy = m_onsets->GetOnsetFluxShare();
+    result.transients.onsetRate = (float)(m_onsets->GetTotalOnsets() / result.lengthSeconds);
+  }
+
+  result.success = true;
+  return result;
+}
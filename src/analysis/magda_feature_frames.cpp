@@ -0,0 +1,287 @@
+#include "magda_feature_frames.h"
+#include <cmath>
+#include <utility>
+
+static const float kFloorDb = -96.0f;
+static const float kLowestBandHz = 20.0f;
+static const float kHighestBandHz = 20000.0f;
+
+// Zwicker's critical band edges (Hz)
+static const float kCriticalBandEdges[] = {
+    20.0f,   100.0f,  200.0f,  300.0f,  400.0f,  510.0f,  630.0f,  770.0f,   920.0f,
+    1080.0f, 1270.0f, 1480.0f, 1720.0f, 2000.0f, 2320.0f, 2700.0f, 3150.0f,  3700.0f,
+    4400.0f, 5300.0f, 6400.0f, 7700.0f, 9500.0f, 12000.0f, 15500.0f, 20000.0f};
+static const int kNumCriticalBandEdges =
+    sizeof(kCriticalBandEdges) / sizeof(kCriticalBandEdges[0]);
+
+static double DbToPower(float db) { return pow(10.0, db / 10.0); }
+
+static float PowerToDb(double power) {
+  if (power <= 1e-12) {
+    return kFloorDb;
+  }
+  float db = 10.0f * (float)log10(power);
+  return db > kFloorDb ? db : kFloorDb;
+}
+
+MagdaFeatureFrameBuilder::MagdaFeatureFrameBuilder(int sampleRate, int fftSize, int hopSize,
+                                                   int numBands, int maxFrames,
+                                                   long long expectedWindows)
+    : MagdaFeatureFrameBuilder(sampleRate, fftSize, hopSize,
+                               LogBandEdges(sampleRate > 0 ? sampleRate : 44100,
+                                            numBands > 0 ? numBands : 1),
+                               maxFrames, expectedWindows) {}
+
+MagdaFeatureFrameBuilder::MagdaFeatureFrameBuilder(int sampleRate, int fftSize, int hopSize,
+                                                   const std::vector<float> &bandEdges,
+                                                   int maxFrames, long long expectedWindows)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 44100), m_fftSize(fftSize > 0 ? fftSize : 4096),
+      m_hopSize(hopSize > 0 ? hopSize : m_fftSize / 2), m_numBins(m_fftSize / 2 + 1),
+      m_numBands(bandEdges.size() > 1 ? (int)bandEdges.size() - 1 : 1),
+      m_maxFrames(maxFrames & ~1), m_windowsPerFrame(1), m_bandEdges(bandEdges),
+      m_pendingWindows(0), m_pendingPower(0.0), m_pendingEnergy(0.0), m_pendingWeighted(0.0),
+      m_pendingFlatness(0.0) {
+
+  // Pairwise merging needs an even budget
+  if (m_maxFrames < 2) {
+    m_maxFrames = 2;
+  }
+  if (m_hopSize > m_fftSize) {
+    m_hopSize = m_fftSize;
+  }
+  if (expectedWindows > m_maxFrames) {
+    m_windowsPerFrame = (int)((expectedWindows + m_maxFrames - 1) / m_maxFrames);
+  }
+  if (m_bandEdges.size() < 2) {
+    m_bandEdges = LogBandEdges(m_sampleRate, 1);
+  }
+
+  float binHz = (float)m_sampleRate / m_fftSize;
+  m_bandFirstBin.resize(m_numBands);
+  m_bandLastBin.resize(m_numBands);
+  for (int b = 0; b < m_numBands; b++) {
+    int first = (int)ceilf(m_bandEdges[b] / binHz);
+    int last = (int)ceilf(m_bandEdges[b + 1] / binHz);
+    if (last > m_numBins) {
+      last = m_numBins;
+    }
+    if (first >= last) {
+      // Band narrower than a bin: use the bin nearest its centre
+      float centre = sqrtf(m_bandEdges[b] * m_bandEdges[b + 1]);
+      first = (int)lroundf(centre / binHz);
+      if (first >= m_numBins) {
+        first = m_numBins - 1;
+      }
+      last = first + 1;
+    }
+    m_bandFirstBin[b] = first;
+    m_bandLastBin[b] = last;
+  }
+
+  m_pendingBands.assign(m_numBands, 0.0);
+  m_power.reserve(m_maxFrames);
+  m_spectralEnergy.reserve(m_maxFrames);
+  m_weightedFrequency.reserve(m_maxFrames);
+  m_flatness.reserve(m_maxFrames);
+  m_bandPower.reserve((size_t)m_maxFrames * m_numBands);
+}
+
+std::vector<float> MagdaFeatureFrameBuilder::LogBandEdges(int sampleRate, int numBands) {
+  // Log-spaced bands up to 20 kHz or Nyquist
+  float low = kLowestBandHz;
+  float high = sampleRate * 0.5f < kHighestBandHz ? sampleRate * 0.5f : kHighestBandHz;
+  std::vector<float> edges(numBands + 1);
+  for (int b = 0; b <= numBands; b++) {
+    edges[b] = low * powf(high / low, (float)b / numBands);
+  }
+  return edges;
+}
+
+std::vector<float> MagdaFeatureFrameBuilder::CriticalBandEdges(int sampleRate) {
+  // Bands above Nyquist are dropped; the last one is cut at Nyquist
+  float nyquist = sampleRate * 0.5f;
+  std::vector<float> edges;
+  for (int i = 0; i < kNumCriticalBandEdges; i++) {
+    if (kCriticalBandEdges[i] >= nyquist) {
+      edges.push_back(nyquist);
+      break;
+    }
+    edges.push_back(kCriticalBandEdges[i]);
+  }
+  return edges;
+}
+
+int MagdaFeatureFrameBuilder::GetNumFrames() const {
+  return (int)m_power.size() + (m_pendingWindows > 0 ? 1 : 0);
+}
+
+void MagdaFeatureFrameBuilder::AddWindow(const float *samples, const float *magnitudes) {
+  // Level over the hop-sized slice at the window centre, so consecutive
+  // windows tile the signal without overlap
+  const float *slice = samples + (m_fftSize - m_hopSize) / 2;
+  double sumSquares = 0.0;
+  for (int i = 0; i < m_hopSize; i++) {
+    sumSquares += (double)slice[i] * slice[i];
+  }
+  m_pendingPower += sumSquares / m_hopSize;
+
+  // Spectral descriptors on the normalized power spectrum (DC excluded)
+  const double scale = 2.0 / m_fftSize;
+  const double binHz = (double)m_sampleRate / m_fftSize;
+  double energy = 0.0;
+  double weighted = 0.0;
+  double logSum = 0.0;
+  for (int k = 1; k < m_numBins; k++) {
+    double amplitude = magnitudes[k] * scale;
+    double power = amplitude * amplitude;
+    energy += power;
+    weighted += power * k * binHz;
+    logSum += log(power + 1e-20);
+  }
+  int count = m_numBins - 1;
+  if (count > 0 && energy > 1e-20 * count) {
+    double geometric = exp(logSum / count);
+    double arithmetic = energy / count;
+    m_pendingFlatness += geometric / arithmetic;
+  }
+  m_pendingEnergy += energy;
+  m_pendingWeighted += weighted;
+
+  for (int b = 0; b < m_numBands; b++) {
+    double bandPower = 0.0;
+    for (int k = m_bandFirstBin[b]; k < m_bandLastBin[b]; k++) {
+      double amplitude = magnitudes[k] * scale;
+      bandPower += amplitude * amplitude;
+    }
+    m_pendingBands[b] += bandPower;
+  }
+
+  if (++m_pendingWindows >= m_windowsPerFrame) {
+    CommitFrame();
+  }
+}
+
+void MagdaFeatureFrameBuilder::CommitFrame() {
+  if ((int)m_power.size() >= m_maxFrames) {
+    // No room: halve the frame rate instead. The pending frame now holds
+    // half a merged frame and keeps filling up. Merging only here, not once
+    // the budget is reached, keeps a signal that fills it exactly at full
+    // resolution.
+    MergePairs();
+    return;
+  }
+
+  m_power.push_back(m_pendingPower);
+  m_spectralEnergy.push_back(m_pendingEnergy);
+  m_weightedFrequency.push_back(m_pendingWeighted);
+  m_flatness.push_back(m_pendingFlatness);
+  m_bandPower.insert(m_bandPower.end(), m_pendingBands.begin(), m_pendingBands.end());
+
+  m_pendingWindows = 0;
+  m_pendingPower = 0.0;
+  m_pendingEnergy = 0.0;
+  m_pendingWeighted = 0.0;
+  m_pendingFlatness = 0.0;
+  m_pendingBands.assign(m_numBands, 0.0);
+}
+
+void MagdaFeatureFrameBuilder::MergePairs() {
+  // Only called with the budget (an even number) of full frames
+  int half = (int)m_power.size() / 2;
+  for (int i = 0; i < half; i++) {
+    m_power[i] = m_power[2 * i] + m_power[2 * i + 1];
+    m_spectralEnergy[i] = m_spectralEnergy[2 * i] + m_spectralEnergy[2 * i + 1];
+    m_weightedFrequency[i] = m_weightedFrequency[2 * i] + m_weightedFrequency[2 * i + 1];
+    m_flatness[i] = m_flatness[2 * i] + m_flatness[2 * i + 1];
+    const double *a = m_bandPower.data() + (size_t)(2 * i) * m_numBands;
+    const double *b = a + m_numBands;
+    double *out = m_bandPower.data() + (size_t)i * m_numBands;
+    for (int band = 0; band < m_numBands; band++) {
+      out[band] = a[band] + b[band];
+    }
+  }
+  m_power.resize(half);
+  m_spectralEnergy.resize(half);
+  m_weightedFrequency.resize(half);
+  m_flatness.resize(half);
+  m_bandPower.resize((size_t)half * m_numBands);
+  m_windowsPerFrame *= 2;
+}
+
+void MagdaFeatureFrameBuilder::Finish(FeatureFrames &out) const {
+  int committed = (int)m_power.size();
+  int numFrames = GetNumFrames();
+
+  out.startSeconds = (double)((m_fftSize - m_hopSize) / 2) / m_sampleRate;
+  out.frameSeconds = (double)m_windowsPerFrame * m_hopSize / m_sampleRate;
+  out.bandEdges = m_bandEdges;
+  out.rms.resize(numFrames);
+  out.centroid.resize(numFrames);
+  out.flatness.resize(numFrames);
+  out.bandEnergies.resize((size_t)numFrames * m_numBands);
+
+  for (int f = 0; f < numFrames; f++) {
+    bool pending = f >= committed;
+    double windows = pending ? m_pendingWindows : m_windowsPerFrame;
+    double power = pending ? m_pendingPower : m_power[f];
+    double energy = pending ? m_pendingEnergy : m_spectralEnergy[f];
+    double weighted = pending ? m_pendingWeighted : m_weightedFrequency[f];
+    double flatness = pending ? m_pendingFlatness : m_flatness[f];
+
+    out.rms[f] = PowerToDb(power / windows);
+    out.centroid[f] = energy > 0.0 ? (float)(weighted / energy) : 0.0f;
+    out.flatness[f] = (float)(flatness / windows);
+
+    const double *bands =
+        pending ? m_pendingBands.data() : m_bandPower.data() + (size_t)f * m_numBands;
+    for (int b = 0; b < m_numBands; b++) {
+      out.bandEnergies[(size_t)b * numFrames + f] = PowerToDb(bands[b] / windows);
+    }
+  }
+}
+
+void MagdaFeatureFrameBuilder::Decimate(const FeatureFrames &in, int factor, FeatureFrames &out) {
+  int numFrames = in.GetNumFrames();
+  int numBands = in.GetNumBands();
+  if (factor < 1) {
+    factor = 1;
+  }
+  int outFrames = (numFrames + factor - 1) / factor;
+
+  FeatureFrames merged;
+  merged.startSeconds = in.startSeconds;
+  merged.frameSeconds = in.frameSeconds * factor;
+  merged.bandEdges = in.bandEdges;
+  merged.rms.resize(outFrames);
+  merged.centroid.resize(outFrames);
+  merged.flatness.resize(outFrames);
+  merged.bandEnergies.resize((size_t)outFrames * numBands);
+
+  for (int o = 0; o < outFrames; o++) {
+    int first = o * factor;
+    int last = first + factor < numFrames ? first + factor : numFrames;
+    int count = last - first;
+
+    double power = 0.0;
+    double centroid = 0.0;
+    double flatness = 0.0;
+    for (int f = first; f < last; f++) {
+      power += DbToPower(in.rms[f]);
+      centroid += in.centroid[f];
+      flatness += in.flatness[f];
+    }
+    merged.rms[o] = PowerToDb(power / count);
+    merged.centroid[o] = (float)(centroid / count);
+    merged.flatness[o] = (float)(flatness / count);
+
+    for (int b = 0; b < numBands; b++) {
+      const float *band = in.bandEnergies.data() + (size_t)b * numFrames;
+      double bandPower = 0.0;
+      for (int f = first; f < last; f++) {
+        bandPower += DbToPower(band[f]);
+      }
+      merged.bandEnergies[(size_t)b * outFrames + o] = PowerToDb(bandPower / count);
+    }
+  }
+  out = std::move(merged);
+}
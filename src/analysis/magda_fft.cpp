@@ -0,0 +1,208 @@
+#include "magda_fft.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+MagdaFFTPlan::MagdaFFTPlan(int size)
+    : m_size(size < 1 ? 1 : size), m_half(m_size / 2),
+      m_powerOfTwo(MagdaFFT::IsPowerOfTwo(m_size) && m_size >= 2), m_leadingRadix2(false) {
+
+  // Analysis window (same formula as MagdaDSPAnalyzer::HannWindow so results
+  // don't shift when switching from the per-sample helper to the cached table)
+  m_window.resize(m_size);
+  for (int n = 0; n < m_size; n++) {
+    m_window[n] = m_size > 1 ? 0.5f * (1.0f - cosf(2.0f * M_PI * n / (m_size - 1))) : 1.0f;
+  }
+
+  if (!m_powerOfTwo) {
+    m_dftTable.resize(m_size * 2);
+    for (int j = 0; j < m_size; j++) {
+      double angle = 2.0 * M_PI * j / m_size;
+      m_dftTable[j * 2] = (float)cos(angle);
+      m_dftTable[j * 2 + 1] = (float)sin(angle);
+    }
+    return;
+  }
+
+  // Bit reversal permutation for the half-size complex FFT
+  int bits = 0;
+  while ((1 << bits) < m_half) {
+    bits++;
+  }
+  m_bitReverse.resize(m_half);
+  for (int i = 0; i < m_half; i++) {
+    int rev = 0;
+    for (int b = 0; b < bits; b++) {
+      if (i & (1 << b)) {
+        rev |= 1 << (bits - 1 - b);
+      }
+    }
+    m_bitReverse[i] = rev;
+  }
+
+  // Odd number of radix-2 stages: do one radix-2 pass first, the rest as
+  // radix-4 passes (each radix-4 pass replaces two radix-2 passes)
+  m_leadingRadix2 = (bits & 1) != 0;
+
+  for (int quarter = m_leadingRadix2 ? 2 : 1; quarter * 4 <= m_half; quarter *= 4) {
+    for (int k = 0; k < quarter; k++) {
+      double angle = -2.0 * M_PI * k / (4.0 * quarter);
+      m_stageTwiddle.push_back((float)cos(angle));
+      m_stageTwiddle.push_back((float)sin(angle));
+      m_stageTwiddle.push_back((float)cos(2.0 * angle));
+      m_stageTwiddle.push_back((float)sin(2.0 * angle));
+      m_stageTwiddle.push_back((float)cos(3.0 * angle));
+      m_stageTwiddle.push_back((float)sin(3.0 * angle));
+    }
+  }
+
+  m_splitTwiddle.resize((m_half + 1) * 2);
+  for (int k = 0; k <= m_half; k++) {
+    double angle = -2.0 * M_PI * k / m_size;
+    m_splitTwiddle[k * 2] = (float)cos(angle);
+    m_splitTwiddle[k * 2 + 1] = (float)sin(angle);
+  }
+}
+
+void MagdaFFTPlan::ComplexFFT(float *data) const {
+  int quarter = 1;
+
+  if (m_leadingRadix2) {
+    for (int i = 0; i < m_half; i += 2) {
+      float *a = data + i * 2;
+      float *b = a + 2;
+      float ar = a[0], ai = a[1];
+      a[0] = ar + b[0];
+      a[1] = ai + b[1];
+      b[0] = ar - b[0];
+      b[1] = ai - b[1];
+    }
+    quarter = 2;
+  }
+
+  const float *tw = m_stageTwiddle.data();
+  for (; quarter * 4 <= m_half; quarter *= 4) {
+    int span = quarter * 4;
+    for (int block = 0; block < m_half; block += span) {
+      for (int k = 0; k < quarter; k++) {
+        const float *w = tw + k * 6;
+        float *x0 = data + (block + k) * 2;
+        float *x1 = x0 + quarter * 2;
+        float *x2 = x1 + quarter * 2;
+        float *x3 = x2 + quarter * 2;
+
+        // b' = w2*x1, c' = w1*x2, d' = w3*x3
+        float br = x1[0] * w[2] - x1[1] * w[3];
+        float bi = x1[0] * w[3] + x1[1] * w[2];
+        float cr = x2[0] * w[0] - x2[1] * w[1];
+        float ci = x2[0] * w[1] + x2[1] * w[0];
+        float dr = x3[0] * w[4] - x3[1] * w[5];
+        float di = x3[0] * w[5] + x3[1] * w[4];
+
+        float s0r = x0[0] + br, s0i = x0[1] + bi;
+        float s1r = x0[0] - br, s1i = x0[1] - bi;
+        float t0r = cr + dr, t0i = ci + di;
+        float t1r = cr - dr, t1i = ci - di;
+
+        x0[0] = s0r + t0r;
+        x0[1] = s0i + t0i;
+        x2[0] = s0r - t0r;
+        x2[1] = s0i - t0i;
+        // x1 = s1 - j*t1, x3 = s1 + j*t1
+        x1[0] = s1r + t1i;
+        x1[1] = s1i - t1r;
+        x3[0] = s1r - t1i;
+        x3[1] = s1i + t1r;
+      }
+    }
+    tw += quarter * 6;
+  }
+}
+
+void MagdaFFTPlan::DirectDFT(const float *input, float *realOut, float *imagOut) const {
+  const int N = m_size;
+  for (int k = 0; k < N / 2 + 1; k++) {
+    double sumReal = 0.0;
+    double sumImag = 0.0;
+    int idx = 0; // (k * n) mod N, advanced incrementally
+    for (int n = 0; n < N; n++) {
+      sumReal += input[n] * m_dftTable[idx * 2];
+      sumImag -= input[n] * m_dftTable[idx * 2 + 1];
+      idx += k;
+      if (idx >= N) {
+        idx -= N;
+      }
+    }
+    realOut[k] = (float)sumReal;
+    imagOut[k] = (float)sumImag;
+  }
+}
+
+void MagdaFFTPlan::Forward(const float *input, float *realOut, float *imagOut, float *work) const {
+  if (!m_powerOfTwo) {
+    DirectDFT(input, realOut, imagOut);
+    return;
+  }
+
+  // Pack even/odd samples as one complex sequence of half the length, already
+  // in bit-reversed order for the in-place passes
+  for (int n = 0; n < m_half; n++) {
+    int dst = m_bitReverse[n] * 2;
+    work[dst] = input[n * 2];
+    work[dst + 1] = input[n * 2 + 1];
+  }
+
+  ComplexFFT(work);
+
+  // Split Z[k] into the spectra of the even and odd samples and recombine:
+  //   X[k] = (Z[k] + conj(Z[M-k]))/2 - j/2 * W^k * (Z[k] - conj(Z[M-k]))
+  realOut[0] = work[0] + work[1];
+  imagOut[0] = 0.0f;
+  realOut[m_half] = work[0] - work[1];
+  imagOut[m_half] = 0.0f;
+
+  for (int k = 1; k < m_half; k++) {
+    float zr = work[k * 2];
+    float zi = work[k * 2 + 1];
+    float mr = work[(m_half - k) * 2];
+    float mi = -work[(m_half - k) * 2 + 1];
+
+    float er = 0.5f * (zr + mr);
+    float ei = 0.5f * (zi + mi);
+    // Fo = -j/2 * (Z[k] - conj(Z[M-k]))
+    float orr = 0.5f * (zi - mi);
+    float oi = -0.5f * (zr - mr);
+
+    float wr = m_splitTwiddle[k * 2];
+    float wi = m_splitTwiddle[k * 2 + 1];
+    realOut[k] = er + (orr * wr - oi * wi);
+    imagOut[k] = ei + (orr * wi + oi * wr);
+  }
+}
+
+// ============================================================================
+// Plan cache
+// ============================================================================
+
+static std::mutex s_planMutex;
+static std::map<int, std::shared_ptr<const MagdaFFTPlan>> s_plans;
+
+std::shared_ptr<const MagdaFFTPlan> MagdaFFT::GetPlan(int size) {
+  std::lock_guard<std::mutex> lock(s_planMutex);
+  auto it = s_plans.find(size);
+  if (it != s_plans.end()) {
+    return it->second;
+  }
+  auto plan = std::make_shared<const MagdaFFTPlan>(size);
+  s_plans[size] = plan;
+  return plan;
+}
+
+void MagdaFFT::ClearCache() {
+  std::lock_guard<std::mutex> lock(s_planMutex);
+  s_plans.clear();
+}
@@ -0,0 +1,76 @@
+#include "magda_live_history.h"
+#include <algorithm>
+
+MagdaLiveSegments::MagdaLiveSegments(long long spanFrames) { Reset(spanFrames); }
+
+void MagdaLiveSegments::Reset(long long spanFrames) {
+  m_spanFrames = spanFrames > 2 ? spanFrames : 2;
+  for (int s = 0; s < kSegments; s++) {
+    m_frames[s] = 0;
+    m_running[s] = s == 0;
+  }
+}
+
+long long MagdaLiveSegments::GetFramesUntilChange() const {
+  // The second segment starts half a span after the first
+  long long frames = m_running[1] ? m_spanFrames : m_spanFrames / 2 - m_frames[0];
+  for (int s = 0; s < kSegments; s++) {
+    if (m_running[s]) {
+      frames = std::min(frames, m_spanFrames - m_frames[s]);
+    }
+  }
+  return frames;
+}
+
+int MagdaLiveSegments::Advance(long long frames) {
+  for (int s = 0; s < kSegments; s++) {
+    if (m_running[s]) {
+      m_frames[s] += frames;
+    }
+  }
+  if (!m_running[1] && m_frames[0] >= m_spanFrames / 2) {
+    m_running[1] = true;
+    return 1;
+  }
+  // Staggered by half a span, so only one segment fills up at a time
+  for (int s = 0; s < kSegments; s++) {
+    if (m_running[s] && m_frames[s] >= m_spanFrames) {
+      m_frames[s] = 0;
+      return s;
+    }
+  }
+  return -1;
+}
+
+int MagdaLiveSegments::GetOldest() const {
+  return m_running[1] && m_frames[1] > m_frames[0] ? 1 : 0;
+}
+
+MagdaLiveResult::MagdaLiveResult() : m_hasResult(false), m_seconds(0.0), m_time(0.0) {}
+
+void MagdaLiveResult::Publish(DSPAnalysisResult result, double seconds, double now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_result = std::move(result);
+  m_hasResult = true;
+  m_seconds = seconds;
+  m_time = now;
+}
+
+void MagdaLiveResult::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_result = DSPAnalysisResult();
+  m_hasResult = false;
+  m_seconds = 0.0;
+  m_time = 0.0;
+}
+
+bool MagdaLiveResult::Get(double minSeconds, double maxAge, double now,
+                          DSPAnalysisResult &result, double &seconds) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_hasResult || m_seconds < minSeconds || now - m_time > maxAge) {
+    return false;
+  }
+  result = m_result;
+  seconds = m_seconds;
+  return true;
+}
@@ -0,0 +1,282 @@
+#include "magda_live_meter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+extern reaper_plugin_info_t *g_rec;
+
+// Ring between the audio and analysis threads, sized for the device rate:
+// far longer than the analysis thread ever lags behind
+static const double kRingSeconds = 2.0;
+// Frames the audio thread converts per ring write
+static const int kHookBlockFrames = 1024;
+// Frames the analysis thread takes from the ring at a time; blocks quieter
+// than kSilenceThreshold are treated as a stopped transport
+static const int kDrainFrames = 2048;
+static const float kSilenceThreshold = 1e-6f; // -120 dBFS
+// How often a result is published, and how often the ring is drained
+static const int kAnalysisIntervalMs = 1000;
+static const int kDrainIntervalMs = 20;
+// Publishing waits at least this many times as long as the last snapshot
+// took, so snapshots stay a small share of the analysis thread's time
+static const double kSnapshotIntervalFactor = 20.0;
+// Rate the ring is sized for when neither the device nor the project has one
+static const int kFallbackSampleRate = 48000;
+
+static double NowSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static DSPAnalysisConfig LiveConfig() {
+  DSPAnalysisConfig config;
+  config.fftSize = 4096;
+  config.analyzeFullItem = true;
+  // Blocks are small and arrive in real time; leave the worker pool to item
+  // analyses
+  config.analysisThreads = 1;
+  return config;
+}
+
+static bool IsSilent(const float *data, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (fabsf(data[i]) >= kSilenceThreshold) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rate of the running audio device, else the project rate
+static int GetOutputSampleRate() {
+  bool (*GetAudioDeviceInfo)(const char *, char *, int) =
+      (bool (*)(const char *, char *, int))g_rec->GetFunc("GetAudioDeviceInfo");
+  char buf[64] = {0};
+  if (GetAudioDeviceInfo && GetAudioDeviceInfo("SRATE", buf, sizeof(buf))) {
+    int rate = atoi(buf);
+    if (rate > 0) {
+      return rate;
+    }
+  }
+  double (*GetSetProjectInfo)(ReaProject *, const char *, double, bool) =
+      (double (*)(ReaProject *, const char *, double, bool))g_rec->GetFunc("GetSetProjectInfo");
+  int rate = GetSetProjectInfo ? (int)GetSetProjectInfo(nullptr, "PROJECT_SRATE", 0.0, false) : 0;
+  return rate > 0 ? rate : kFallbackSampleRate;
+}
+
+MagdaLiveMeter &MagdaLiveMeter::Get() {
+  static MagdaLiveMeter meter;
+  return meter;
+}
+
+MagdaLiveMeter::MagdaLiveMeter()
+    : m_sampleRate(0), m_droppedFrames(0), m_running(false), m_historySeconds(0.0),
+      m_stopping(false), m_streamRate(0), m_capturedFrames(0) {
+  m_hook.OnAudioBuffer = OnAudioBuffer;
+  m_hook.userdata1 = this;
+  m_hook.userdata2 = nullptr;
+  m_hook.input_nch = 0;
+  m_hook.output_nch = 0;
+  m_hook.GetBuffer = nullptr;
+}
+
+MagdaLiveMeter::~MagdaLiveMeter() {
+  // REAPER may already be gone here; the unload path calls Stop()
+  StopThread();
+}
+
+bool MagdaLiveMeter::Start(double historySeconds, WDL_FastString &error_msg) {
+  if (!g_rec) {
+    error_msg.Set("REAPER API not available");
+    return false;
+  }
+  int (*Audio_RegHardwareHook)(bool, audio_hook_register_t *) =
+      (int (*)(bool, audio_hook_register_t *))g_rec->GetFunc("Audio_RegHardwareHook");
+  if (!Audio_RegHardwareHook) {
+    error_msg.Set("Audio_RegHardwareHook not available");
+    return false;
+  }
+  if (!(historySeconds >= 1.0 && historySeconds <= kMaxHistorySeconds)) {
+    error_msg.SetFormatted(128, "Live history must be between 1 and %.0f seconds",
+                           kMaxHistorySeconds);
+    return false;
+  }
+
+  Stop();
+
+  // Everything the analysis and audio threads touch exists before they do.
+  // The streams are made by the analysis thread once the hook reports the
+  // rate; they only hold per-FFT state, however long the history is.
+  int rate = GetOutputSampleRate();
+  m_historySeconds = historySeconds;
+  m_ring.reset(new MagdaSampleRing((size_t)(kRingSeconds * rate) * 2));
+  m_hookBlock.assign((size_t)kHookBlockFrames * 2, 0.0f);
+  m_sampleRate.store(0);
+  m_droppedFrames.store(0);
+  for (std::unique_ptr<MagdaDSPStream> &stream : m_streams) {
+    stream.reset();
+  }
+  m_streamRate.store(0);
+  m_capturedFrames.store(0);
+  m_result.Reset();
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_stopping = false;
+  }
+  m_thread = std::thread([this]() { AnalysisLoop(); });
+
+  Audio_RegHardwareHook(true, &m_hook);
+  m_running.store(true);
+  return true;
+}
+
+void MagdaLiveMeter::Stop() {
+  if (!m_running.exchange(false)) {
+    return;
+  }
+  if (g_rec) {
+    int (*Audio_RegHardwareHook)(bool, audio_hook_register_t *) =
+        (int (*)(bool, audio_hook_register_t *))g_rec->GetFunc("Audio_RegHardwareHook");
+    if (Audio_RegHardwareHook) {
+      // REAPER removes the hook under its audio lock, so no callback is
+      // still running once this returns
+      Audio_RegHardwareHook(false, &m_hook);
+    }
+  }
+  StopThread();
+}
+
+void MagdaLiveMeter::StopThread() {
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+double MagdaLiveMeter::GetCapturedSeconds() const {
+  int rate = m_streamRate.load();
+  return rate > 0 ? (double)m_capturedFrames.load() / rate : 0.0;
+}
+
+bool MagdaLiveMeter::GetLatestResult(double minSeconds, double maxAgeSeconds,
+                                     DSPAnalysisResult &result, double &seconds) const {
+  return m_result.Get(minSeconds, maxAgeSeconds, NowSeconds(), result, seconds);
+}
+
+void MagdaLiveMeter::OnAudioBuffer(bool isPost, int len, double srate,
+                                   audio_hook_register_t *reg) {
+  // Output buffers only hold the mix once processing is done
+  if (!isPost || len <= 0 || !reg->GetBuffer || reg->output_nch <= 0) {
+    return;
+  }
+  MagdaLiveMeter *meter = (MagdaLiveMeter *)reg->userdata1;
+  ReaSample *left = reg->GetBuffer(true, 0);
+  ReaSample *right = reg->output_nch > 1 ? reg->GetBuffer(true, 1) : left;
+  if (!left) {
+    return;
+  }
+  if (!right) {
+    right = left;
+  }
+  meter->m_sampleRate.store((int)srate, std::memory_order_relaxed);
+
+  float *block = meter->m_hookBlock.data();
+  for (int offset = 0; offset < len; offset += kHookBlockFrames) {
+    int frames = len - offset < kHookBlockFrames ? len - offset : kHookBlockFrames;
+    for (int i = 0; i < frames; i++) {
+      block[i * 2] = (float)left[offset + i];
+      block[i * 2 + 1] = (float)right[offset + i];
+    }
+    if (!meter->m_ring->Write(block, (size_t)frames * 2)) {
+      meter->m_droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+    }
+  }
+}
+
+void MagdaLiveMeter::AnalysisLoop() {
+  using Clock = std::chrono::steady_clock;
+  std::vector<float> block((size_t)kDrainFrames * 2);
+  Clock::time_point lastPublish = Clock::now();
+  double intervalMs = kAnalysisIntervalMs;
+  bool newAudio = false;
+
+  std::unique_lock<std::mutex> lock(m_wakeMutex);
+  while (!m_wake.wait_for(lock, std::chrono::milliseconds(kDrainIntervalMs),
+                          [this]() { return m_stopping; })) {
+    lock.unlock();
+
+    // A new device rate invalidates what has been analyzed so far
+    int rate = m_sampleRate.load(std::memory_order_relaxed);
+    if (rate > 0 && rate != m_streamRate.load()) {
+      ResetStreams(rate);
+    }
+
+    size_t count = 0;
+    while ((count = m_ring->Read(block.data(), block.size())) > 0) {
+      if (m_streamRate.load() > 0 && !IsSilent(block.data(), count)) {
+        AnalyzeBlock(block.data(), (int)(count / 2));
+        newAudio = true;
+      }
+    }
+
+    // A snapshot only reads the running state, so it takes milliseconds, far
+    // less than the ring holds; the interval still follows its measured cost
+    double sincePublishMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - lastPublish).count();
+    if (newAudio && sincePublishMs >= intervalMs) {
+      double snapshotMs = PublishResult();
+      intervalMs = std::max((double)kAnalysisIntervalMs, snapshotMs * kSnapshotIntervalFactor);
+      lastPublish = Clock::now();
+      newAudio = false;
+    }
+
+    lock.lock();
+  }
+}
+
+void MagdaLiveMeter::ResetStreams(int rate) {
+  m_segments.Reset((long long)(m_historySeconds * rate));
+  m_streams[0].reset(new MagdaDSPStream(rate, 2, LiveConfig()));
+  m_streams[1].reset();
+  m_capturedFrames.store(0);
+  m_streamRate.store(rate);
+}
+
+void MagdaLiveMeter::AnalyzeBlock(const float *data, int frames) {
+  // Split the block where a segment starts (over), so each stream sees
+  // exactly its own span
+  while (frames > 0) {
+    int count = (int)std::min((long long)frames, m_segments.GetFramesUntilChange());
+    for (int s = 0; s < MagdaLiveSegments::kSegments; s++) {
+      if (m_segments.IsRunning(s)) {
+        m_streams[s]->Process(data, count);
+      }
+    }
+    int fresh = m_segments.Advance(count);
+    if (fresh >= 0) {
+      m_streams[fresh].reset(new MagdaDSPStream(m_streamRate.load(), 2, LiveConfig()));
+    }
+    data += (size_t)count * 2;
+    frames -= count;
+  }
+  m_capturedFrames.store(m_segments.GetFrames(m_segments.GetOldest()));
+}
+
+double MagdaLiveMeter::PublishResult() {
+  auto start = std::chrono::steady_clock::now();
+  int oldest = m_segments.GetOldest();
+  long long frames = m_segments.GetFrames(oldest);
+  if (frames > 0) {
+    DSPAnalysisResult result = m_streams[oldest]->Snapshot();
+    if (result.success) {
+      m_result.Publish(std::move(result), (double)frames / m_streamRate.load(), NowSeconds());
+    }
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
@@ -0,0 +1,294 @@
+#include "magda_loudness.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Histogram covers the absolute gate up to +10 LUFS (anything louder lands in
+// the top bin, its energy is still summed exactly)
+static const double kAbsoluteGate = -70.0;
+static const double kHistogramMax = 10.0;
+static const double kHistogramStep = 0.05;
+static const int kHistogramBins = (int)((kHistogramMax - kAbsoluteGate) / kHistogramStep);
+
+static const int kMomentarySubBlocks = 4;  // 400 ms
+static const int kShortTermSubBlocks = 30; // 3 s
+
+MagdaLoudnessMeter::LoudnessHistogram::LoudnessHistogram()
+    : counts(kHistogramBins, 0), energySums(kHistogramBins, 0.0) {}
+
+void MagdaLoudnessMeter::LoudnessHistogram::Add(double energy) {
+  double lufs = EnergyToLufs(energy);
+  if (lufs < kAbsoluteGate) {
+    return;
+  }
+  int bin = HistogramBin(lufs);
+  counts[bin]++;
+  energySums[bin] += energy;
+}
+
+double MagdaLoudnessMeter::LoudnessHistogram::MeanEnergyAbove(double gateLufs,
+                                                              long long *countOut) const {
+  int first = gateLufs <= kAbsoluteGate ? 0 : HistogramBin(gateLufs);
+  long long count = 0;
+  double sum = 0.0;
+  for (int bin = first; bin < kHistogramBins; bin++) {
+    count += counts[bin];
+    sum += energySums[bin];
+  }
+  if (countOut) {
+    *countOut = count;
+  }
+  return count > 0 ? sum / count : 0.0;
+}
+
+double MagdaLoudnessMeter::EnergyToLufs(double energy) {
+  if (energy <= 0.0) {
+    return -HUGE_VAL;
+  }
+  return -0.691 + 10.0 * log10(energy);
+}
+
+double MagdaLoudnessMeter::LufsToEnergy(double lufs) { return pow(10.0, (lufs + 0.691) / 10.0); }
+
+int MagdaLoudnessMeter::HistogramBin(double lufs) {
+  int bin = (int)floor((lufs - kAbsoluteGate) / kHistogramStep);
+  if (bin < 0) {
+    return 0;
+  }
+  return bin < kHistogramBins ? bin : kHistogramBins - 1;
+}
+
+double MagdaLoudnessMeter::HistogramBinCenter(int bin) {
+  return kAbsoluteGate + (bin + 0.5) * kHistogramStep;
+}
+
+MagdaLoudnessMeter::MagdaLoudnessMeter(int sampleRate, int channels)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 44100), m_channels(channels < 1 ? 1 : channels),
+      m_subBlockFill(0), m_subBlockSum(0.0), m_subBlockHead(0), m_subBlockCount(0),
+      m_momentaryMax(kNoLoudness), m_shortTermMax(kNoLoudness) {
+
+  // K-weighting stage 1: high shelf (+4 dB above ~1.5 kHz), BS.1770 Table 1
+  // re-derived for the actual sample rate
+  double f0 = 1681.974450955533;
+  double G = 3.999843853973347;
+  double Q = 0.7071752369554196;
+  double K = tan(M_PI * f0 / m_sampleRate);
+  double Vh = pow(10.0, G / 20.0);
+  double Vb = pow(Vh, 0.4996667741545416);
+  double a0 = 1.0 + K / Q + K * K;
+  m_shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+  m_shelf.b1 = 2.0 * (K * K - Vh) / a0;
+  m_shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+  m_shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+  m_shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+  // Stage 2: RLB high-pass (~38 Hz)
+  f0 = 38.13547087602444;
+  Q = 0.5003270373238773;
+  K = tan(M_PI * f0 / m_sampleRate);
+  a0 = 1.0 + K / Q + K * K;
+  m_highPass.b0 = 1.0;
+  m_highPass.b1 = -2.0;
+  m_highPass.b2 = 1.0;
+  m_highPass.a1 = 2.0 * (K * K - 1.0) / a0;
+  m_highPass.a2 = (1.0 - K / Q + K * K) / a0;
+
+  // Channel weights: 1.0 for front channels, 1.41 for surrounds, LFE ignored
+  // (assumes L R C LFE Ls Rs ordering for 6+ channels, L R C Ls Rs for 5)
+  m_channelWeights.assign(m_channels, 1.0);
+  if (m_channels == 5) {
+    m_channelWeights[3] = m_channelWeights[4] = 1.41;
+  } else if (m_channels >= 6) {
+    m_channelWeights[3] = 0.0;
+    m_channelWeights[4] = m_channelWeights[5] = 1.41;
+  }
+
+  m_filterState.assign((size_t)m_channels * 8, 0.0);
+
+  m_subBlockSize = (int)(m_sampleRate / 10.0 + 0.5);
+  if (m_subBlockSize < 1) {
+    m_subBlockSize = 1;
+  }
+  m_subBlocks.assign(kShortTermSubBlocks, 0.0);
+}
+
+void MagdaLoudnessMeter::Process(const float *interleaved, int numFrames) {
+  if (!interleaved || numFrames <= 0) {
+    return;
+  }
+
+  const Biquad s = m_shelf;
+  const Biquad h = m_highPass;
+
+  int i = 0;
+  while (i < numFrames) {
+    int count = numFrames - i;
+    if (count > m_subBlockSize - m_subBlockFill) {
+      count = m_subBlockSize - m_subBlockFill;
+    }
+
+    // Channel-major inner loop keeps each channel's filter state in registers
+    for (int ch = 0; ch < m_channels; ch++) {
+      double weight = m_channelWeights[ch];
+      if (weight == 0.0) {
+        continue;
+      }
+      double *st = &m_filterState[(size_t)ch * 8];
+      double sx1 = st[0], sx2 = st[1], sy1 = st[2], sy2 = st[3];
+      double hx1 = st[4], hx2 = st[5], hy1 = st[6], hy2 = st[7];
+      double sum = 0.0;
+
+      const float *x = interleaved + (size_t)i * m_channels + ch;
+      for (int n = 0; n < count; n++) {
+        double in = x[(size_t)n * m_channels];
+        double sy = s.b0 * in + s.b1 * sx1 + s.b2 * sx2 - s.a1 * sy1 - s.a2 * sy2;
+        sx2 = sx1;
+        sx1 = in;
+        sy2 = sy1;
+        sy1 = sy;
+
+        double hy = h.b0 * sy + h.b1 * hx1 + h.b2 * hx2 - h.a1 * hy1 - h.a2 * hy2;
+        hx2 = hx1;
+        hx1 = sy;
+        hy2 = hy1;
+        hy1 = hy;
+
+        sum += hy * hy;
+      }
+
+      st[0] = sx1;
+      st[1] = sx2;
+      st[2] = sy1;
+      st[3] = sy2;
+      st[4] = hx1;
+      st[5] = hx2;
+      st[6] = hy1;
+      st[7] = hy2;
+      m_subBlockSum += weight * sum;
+    }
+
+    m_subBlockFill += count;
+    i += count;
+    if (m_subBlockFill == m_subBlockSize) {
+      FinishSubBlock();
+    }
+  }
+}
+
+void MagdaLoudnessMeter::FinishSubBlock() {
+  m_subBlocks[m_subBlockHead] = m_subBlockSum / m_subBlockSize;
+  m_subBlockHead = (m_subBlockHead + 1) % kShortTermSubBlocks;
+  m_subBlockCount++;
+  m_subBlockSum = 0.0;
+  m_subBlockFill = 0;
+
+  // Gating blocks (400 ms, 75% overlap) feed integrated loudness
+  if (m_subBlockCount >= kMomentarySubBlocks) {
+    double energy = WindowEnergy(kMomentarySubBlocks);
+    m_momentaryHistogram.Add(energy);
+    double lufs = EnergyToLufs(energy);
+    if (lufs > m_momentaryMax) {
+      m_momentaryMax = lufs;
+    }
+  }
+
+  // Short-term blocks (3 s, 10 Hz rate) feed loudness range
+  if (m_subBlockCount >= kShortTermSubBlocks) {
+    double energy = WindowEnergy(kShortTermSubBlocks);
+    m_shortTermHistogram.Add(energy);
+    double lufs = EnergyToLufs(energy);
+    if (lufs > m_shortTermMax) {
+      m_shortTermMax = lufs;
+    }
+  }
+}
+
+double MagdaLoudnessMeter::WindowEnergy(int subBlocks) const {
+  double sum = 0.0;
+  for (int k = 1; k <= subBlocks; k++) {
+    sum += m_subBlocks[(m_subBlockHead - k + kShortTermSubBlocks) % kShortTermSubBlocks];
+  }
+  return sum / subBlocks;
+}
+
+double MagdaLoudnessMeter::GetMomentary() const {
+  if (m_subBlockCount < kMomentarySubBlocks) {
+    return kNoLoudness;
+  }
+  double lufs = EnergyToLufs(WindowEnergy(kMomentarySubBlocks));
+  return lufs > kNoLoudness ? lufs : kNoLoudness;
+}
+
+double MagdaLoudnessMeter::GetShortTerm() const {
+  if (m_subBlockCount < kShortTermSubBlocks) {
+    return kNoLoudness;
+  }
+  double lufs = EnergyToLufs(WindowEnergy(kShortTermSubBlocks));
+  return lufs > kNoLoudness ? lufs : kNoLoudness;
+}
+
+double MagdaLoudnessMeter::GetIntegrated() const {
+  // Absolute gate: every block in the histogram is already >= -70 LUFS
+  long long count = 0;
+  double absGated = m_momentaryHistogram.MeanEnergyAbove(kAbsoluteGate, &count);
+  if (count == 0) {
+    return kNoLoudness;
+  }
+
+  // Relative gate: 10 LU below the absolute-gated loudness
+  double relativeGate = EnergyToLufs(absGated) - 10.0;
+  double gated = m_momentaryHistogram.MeanEnergyAbove(relativeGate, &count);
+  if (count == 0) {
+    return kNoLoudness;
+  }
+  return EnergyToLufs(gated);
+}
+
+double MagdaLoudnessMeter::GetLoudnessRange() const {
+  long long count = 0;
+  double absGated = m_shortTermHistogram.MeanEnergyAbove(kAbsoluteGate, &count);
+  if (count == 0) {
+    return 0.0;
+  }
+
+  // EBU Tech 3342: relative gate 20 LU below the absolute-gated level, then
+  // the spread between the 10th and 95th percentile of what remains
+  double relativeGate = EnergyToLufs(absGated) - 20.0;
+  int first = HistogramBin(relativeGate);
+  long long total = 0;
+  for (int bin = first; bin < kHistogramBins; bin++) {
+    total += m_shortTermHistogram.counts[bin];
+  }
+  if (total == 0) {
+    return 0.0;
+  }
+
+  long long lowTarget = (long long)(total * 0.10);
+  long long highTarget = (long long)(total * 0.95);
+  if (highTarget >= total) {
+    highTarget = total - 1;
+  }
+
+  double low = 0.0, high = 0.0;
+  bool haveLow = false;
+  long long seen = 0;
+  for (int bin = first; bin < kHistogramBins; bin++) {
+    long long n = m_shortTermHistogram.counts[bin];
+    if (n == 0) {
+      continue;
+    }
+    if (!haveLow && seen + n > lowTarget) {
+      low = HistogramBinCenter(bin);
+      haveLow = true;
+    }
+    if (seen + n > highTarget) {
+      high = HistogramBinCenter(bin);
+      break;
+    }
+    seen += n;
+  }
+
+  return high > low ? high - low : 0.0;
+}
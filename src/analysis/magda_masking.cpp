@@ -0,0 +1,265 @@
+#include "magda_masking.h"
+#include "magda_compact_json.h"
+#include "magda_worker_pool.h"
+#include <algorithm>
+#include <cmath>
+
+static const float kFloorDb = -96.0f;
+// A band is active above this level and within kActiveRangeDb of the
+// track's loudest frame in that band
+static const float kActiveFloorDb = -60.0f;
+static const float kActiveRangeDb = 40.0f;
+// Levels this close compete; further apart the louder track simply covers
+// the quieter one
+static const float kMaskingRangeDb = 12.0f;
+// Cap on the common grid so very long projects stay cheap
+static const int kMaxGridFrames = 4096;
+
+static bool SameBandEdges(const std::vector<float> &a, const std::vector<float> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (fabsf(a[i] - b[i]) > 0.01f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Resample one track onto the grid: frames are power-averaged into the grid
+// cell holding their centre, and each band is marked active or not.
+// levels and active are band-major: [band * gridFrames + cell].
+static void ResampleTrack(const MaskingTrack &track, double gridStart, double gridStep,
+                          int gridFrames, int numBands, std::vector<float> &levels,
+                          std::vector<unsigned char> &active) {
+  levels.assign((size_t)numBands * gridFrames, kFloorDb);
+  active.assign((size_t)numBands * gridFrames, 0);
+
+  const FeatureFrames &frames = *track.frames;
+  int numFrames = frames.GetNumFrames();
+  if (numFrames == 0) {
+    return;
+  }
+
+  std::vector<int> cellOf(numFrames);
+  for (int f = 0; f < numFrames; f++) {
+    double centre = track.startTime + frames.startSeconds + (f + 0.5) * frames.frameSeconds;
+    cellOf[f] = (int)floor((centre - gridStart) / gridStep);
+  }
+
+  std::vector<double> power(gridFrames);
+  std::vector<int> count(gridFrames);
+  for (int b = 0; b < numBands; b++) {
+    const float *band = frames.bandEnergies.data() + (size_t)b * numFrames;
+    std::fill(power.begin(), power.end(), 0.0);
+    std::fill(count.begin(), count.end(), 0);
+    float loudest = kFloorDb;
+    for (int f = 0; f < numFrames; f++) {
+      int cell = cellOf[f];
+      if (cell < 0 || cell >= gridFrames) {
+        continue;
+      }
+      power[cell] += pow(10.0, band[f] / 10.0);
+      count[cell]++;
+      loudest = band[f] > loudest ? band[f] : loudest;
+    }
+
+    float *out = levels.data() + (size_t)b * gridFrames;
+    unsigned char *isActive = active.data() + (size_t)b * gridFrames;
+    float threshold = loudest - kActiveRangeDb;
+    if (threshold < kActiveFloorDb) {
+      threshold = kActiveFloorDb;
+    }
+    for (int g = 0; g < gridFrames; g++) {
+      if (count[g] == 0) {
+        continue;
+      }
+      double mean = power[g] / count[g];
+      out[g] = mean > 1e-12 ? (float)(10.0 * log10(mean)) : kFloorDb;
+      isActive[g] = out[g] >= threshold ? 1 : 0;
+    }
+  }
+}
+
+bool MagdaMaskingAnalyzer::Compute(const std::vector<MaskingTrack> &tracks, MaskingMatrix &out,
+                                   int maxThreads) {
+  out = MaskingMatrix();
+  int numTracks = (int)tracks.size();
+  if (numTracks < 2) {
+    return false;
+  }
+  for (const MaskingTrack &track : tracks) {
+    if (!track.frames || track.frames->GetNumBands() == 0 ||
+        !SameBandEdges(track.frames->bandEdges, tracks[0].frames->bandEdges)) {
+      return false;
+    }
+  }
+  int numBands = tracks[0].frames->GetNumBands();
+
+  // Common grid: the coarsest frame size, spanning every track
+  double gridStep = 0.0;
+  double gridStart = 0.0;
+  double gridEnd = 0.0;
+  bool first = true;
+  for (const MaskingTrack &track : tracks) {
+    const FeatureFrames &frames = *track.frames;
+    if (frames.GetNumFrames() == 0) {
+      continue;
+    }
+    double start = track.startTime + frames.startSeconds;
+    double end = start + frames.GetNumFrames() * frames.frameSeconds;
+    gridStep = frames.frameSeconds > gridStep ? frames.frameSeconds : gridStep;
+    gridStart = first || start < gridStart ? start : gridStart;
+    gridEnd = first || end > gridEnd ? end : gridEnd;
+    first = false;
+  }
+  if (first || gridStep <= 0.0) {
+    return false;
+  }
+  int gridFrames = (int)ceil((gridEnd - gridStart) / gridStep);
+  if (gridFrames > kMaxGridFrames) {
+    gridStep = (gridEnd - gridStart) / kMaxGridFrames;
+    gridFrames = kMaxGridFrames;
+  }
+  if (gridFrames < 1) {
+    gridFrames = 1;
+  }
+
+  std::vector<std::vector<float>> levels(numTracks);
+  std::vector<std::vector<unsigned char>> active(numTracks);
+  MagdaWorkerPool &pool = MagdaWorkerPool::Get();
+  pool.ParallelFor(numTracks, maxThreads, [&](int t) {
+    ResampleTrack(tracks[t], gridStart, gridStep, gridFrames, numBands, levels[t], active[t]);
+  });
+
+  out.bandEdges = tracks[0].frames->bandEdges;
+  out.frameSeconds = gridStep;
+  for (int a = 0; a < numTracks; a++) {
+    for (int b = a + 1; b < numTracks; b++) {
+      MaskingPair pair;
+      pair.trackA = a;
+      pair.trackB = b;
+      pair.bands.resize(numBands);
+      out.pairs.push_back(pair);
+    }
+  }
+
+  // Every pair only reads the resampled tracks and writes its own slot
+  pool.ParallelFor((int)out.pairs.size(), maxThreads, [&](int p) {
+    MaskingPair &pair = out.pairs[p];
+    for (int band = 0; band < numBands; band++) {
+      size_t offset = (size_t)band * gridFrames;
+      const float *levelA = levels[pair.trackA].data() + offset;
+      const float *levelB = levels[pair.trackB].data() + offset;
+      const unsigned char *activeA = active[pair.trackA].data() + offset;
+      const unsigned char *activeB = active[pair.trackB].data() + offset;
+
+      int eitherActive = 0;
+      int competing = 0;
+      double diffSum = 0.0;
+      for (int g = 0; g < gridFrames; g++) {
+        if (!activeA[g] && !activeB[g]) {
+          continue;
+        }
+        eitherActive++;
+        float diff = levelA[g] - levelB[g];
+        if (activeA[g] && activeB[g] && fabsf(diff) <= kMaskingRangeDb) {
+          competing++;
+          diffSum += diff;
+        }
+      }
+
+      MaskingBand &result = pair.bands[band];
+      result.overlap = eitherActive > 0 ? (float)competing / eitherActive : 0.0f;
+      result.competingSeconds = (float)(competing * gridStep);
+      result.levelDiff = competing > 0 ? (float)(diffSum / competing) : 0.0f;
+    }
+  });
+
+  return true;
+}
+
+void MagdaMaskingAnalyzer::FindConflicts(const MaskingMatrix &matrix, float minOverlap,
+                                         int maxConflicts, std::vector<MaskingConflict> &out) {
+  out.clear();
+
+  for (const MaskingPair &pair : matrix.pairs) {
+    int numBands = (int)pair.bands.size();
+    int band = 0;
+    while (band < numBands) {
+      const MaskingBand &start = pair.bands[band];
+      if (start.overlap < minOverlap || start.competingSeconds <= 0.0f) {
+        band++;
+        continue;
+      }
+
+      // Extend the run over adjacent competing bands
+      MaskingConflict conflict;
+      conflict.trackA = pair.trackA;
+      conflict.trackB = pair.trackB;
+      conflict.lowHz = matrix.bandEdges[band];
+      double overlapSum = 0.0;
+      double weightedDiff = 0.0;
+      double totalSeconds = 0.0;
+      int runBands = 0;
+      while (band < numBands && pair.bands[band].overlap >= minOverlap &&
+             pair.bands[band].competingSeconds > 0.0f) {
+        const MaskingBand &current = pair.bands[band];
+        overlapSum += current.overlap;
+        weightedDiff += (double)current.levelDiff * current.competingSeconds;
+        totalSeconds += current.competingSeconds;
+        if (current.competingSeconds > conflict.seconds) {
+          conflict.seconds = current.competingSeconds;
+        }
+        runBands++;
+        band++;
+      }
+      conflict.highHz = matrix.bandEdges[band];
+      conflict.overlap = (float)(overlapSum / runBands);
+      conflict.levelDiff = (float)(weightedDiff / totalSeconds);
+      out.push_back(conflict);
+    }
+  }
+
+  // Strongest first; ties keep pair and band order so output is stable
+  std::stable_sort(out.begin(), out.end(), [](const MaskingConflict &a, const MaskingConflict &b) {
+    return a.overlap * a.seconds > b.overlap * b.seconds;
+  });
+  if (maxConflicts >= 0 && (int)out.size() > maxConflicts) {
+    out.resize(maxConflicts);
+  }
+}
+
+void MagdaMaskingAnalyzer::AppendJSON(WDL_FastString &json,
+                                      const std::vector<MaskingConflict> &conflicts,
+                                      const std::vector<std::string> &trackNames) {
+  json.Append(",\"masking\":[");
+  for (size_t i = 0; i < conflicts.size(); i++) {
+    const MaskingConflict &conflict = conflicts[i];
+    json.Append(i > 0 ? ",{\"a\":" : "{\"a\":");
+    if (conflict.trackA < (int)trackNames.size()) {
+      MagdaCompactJSON::AppendString(json, trackNames[conflict.trackA].c_str());
+    } else {
+      MagdaCompactJSON::AppendNumber(json, conflict.trackA, 0);
+    }
+    json.Append(",\"b\":");
+    if (conflict.trackB < (int)trackNames.size()) {
+      MagdaCompactJSON::AppendString(json, trackNames[conflict.trackB].c_str());
+    } else {
+      MagdaCompactJSON::AppendNumber(json, conflict.trackB, 0);
+    }
+    json.Append(",\"hz\":[");
+    MagdaCompactJSON::AppendNumber(json, conflict.lowHz, 0);
+    json.Append(",");
+    MagdaCompactJSON::AppendNumber(json, conflict.highHz, 0);
+    json.Append("],\"overlap\":");
+    MagdaCompactJSON::AppendNumber(json, conflict.overlap, 2);
+    json.Append(",\"seconds\":");
+    MagdaCompactJSON::AppendNumber(json, conflict.seconds, 1);
+    json.Append(",\"diff\":");
+    MagdaCompactJSON::AppendNumber(json, conflict.levelDiff, 1);
+    json.Append("}");
+  }
+  json.Append("]");
+}
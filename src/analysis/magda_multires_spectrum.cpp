@@ -0,0 +1,204 @@
+#include "magda_multires_spectrum.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// FFT size on every decimated level (hop is half of it)
+static const int kLevelFFTSize = 1024;
+// Bins a third-octave band needs before a source is trusted with it
+static const float kMinBinsPerBand = 8.0f;
+// Width of a third-octave band relative to its centre: 2^(1/6) - 2^(-1/6)
+static const float kThirdOctaveWidth = 0.2316f;
+// Half-band decimation filter length (odd, so it has a centre tap)
+static const int kTaps = 31;
+static const int kMaxLevels = 12;
+
+// Lowest band centre a source with the given bin width resolves
+static float MinServedHz(double binWidth) {
+  return (float)(kMinBinsPerBand * binWidth / kThirdOctaveWidth);
+}
+
+MagdaMultiResSpectrum::MagdaMultiResSpectrum(int sampleRate, int refFftSize, float lowestHz,
+                                             int maxThreads)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 44100),
+      m_refFftSize(refFftSize > 0 ? refFftSize : 4096) {
+
+  m_refMinHz = MinServedHz((double)m_sampleRate / m_refFftSize);
+
+  // Blackman-windowed sinc with the cutoff at a quarter of the input rate;
+  // aliases only land above the frequencies a level serves
+  m_taps.resize(kTaps);
+  double sum = 0.0;
+  int centre = kTaps / 2;
+  for (int t = 0; t < kTaps; t++) {
+    int n = t - centre;
+    double sinc = n == 0 ? 0.5 : sin(M_PI * 0.5 * n) / (M_PI * n);
+    double phase = 2.0 * M_PI * t / (kTaps - 1);
+    double window = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+    m_taps[t] = (float)(sinc * window);
+    sum += m_taps[t];
+  }
+  for (float &tap : m_taps) {
+    tap = (float)(tap / sum);
+  }
+
+  // Lower edge of the lowest band that still has to be resolved
+  float lowestEdge = lowestHz * powf(2.0f, -1.0f / 6.0f);
+  if (m_refMinHz <= lowestEdge) {
+    return;
+  }
+
+  // Decimate until a level resolves lowestEdge; only levels finer than the
+  // reference spectrum get an STFT
+  m_chain.reserve(kMaxLevels);
+  for (int l = 1; l <= kMaxLevels; l++) {
+    Level level;
+    level.factor = 1 << l;
+    level.history.assign(kTaps - 1, 0.0f);
+    level.skipNext = false;
+    level.minHz = MinServedHz((double)m_sampleRate / ((double)level.factor * kLevelFFTSize));
+    if (level.minHz < m_refMinHz) {
+      level.stft = std::make_unique<MagdaSTFT>(kLevelFFTSize, kLevelFFTSize / 2, maxThreads);
+    }
+    bool last = level.minHz <= lowestEdge || l == kMaxLevels;
+    if (last) {
+      level.minHz = 0.0f;
+    }
+    m_chain.push_back(std::move(level));
+    if (last) {
+      break;
+    }
+  }
+  for (Level &level : m_chain) {
+    if (level.stft) {
+      m_levels.push_back(&level);
+    }
+  }
+}
+
+MagdaMultiResSpectrum::~MagdaMultiResSpectrum() {}
+
+void MagdaMultiResSpectrum::SetSilenceGate(float thresholdDb) {
+  for (Level *level : m_levels) {
+    level->stft->SetSilenceGate(thresholdDb);
+  }
+}
+
+void MagdaMultiResSpectrum::Decimate(const float *in, int numFrames, Level &level) {
+  // History first, so every output sees kTaps consecutive inputs
+  m_scratch.assign(level.history.begin(), level.history.end());
+  m_scratch.insert(m_scratch.end(), in, in + numFrames);
+
+  level.output.clear();
+  for (int i = 0; i < numFrames; i++) {
+    if (!level.skipNext) {
+      const float *x = m_scratch.data() + i;
+      float acc = 0.0f;
+      for (int t = 0; t < kTaps; t++) {
+        acc += m_taps[t] * x[t];
+      }
+      level.output.push_back(acc);
+    }
+    level.skipNext = !level.skipNext;
+  }
+
+  level.history.assign(m_scratch.end() - (kTaps - 1), m_scratch.end());
+}
+
+void MagdaMultiResSpectrum::Process(const float *mono, int numFrames) {
+  if (!mono || numFrames <= 0) {
+    return;
+  }
+
+  const float *in = mono;
+  int count = numFrames;
+  for (Level &level : m_chain) {
+    Decimate(in, count, level);
+    if (level.output.empty()) {
+      break;
+    }
+    if (level.stft) {
+      level.stft->Process(level.output.data(), (int)level.output.size());
+    }
+    in = level.output.data();
+    count = (int)level.output.size();
+  }
+}
+
+void MagdaMultiResSpectrum::Flush() {
+  for (Level *level : m_levels) {
+    level->stft->Flush();
+  }
+}
+
+void MagdaMultiResSpectrum::AccumulateLevel(const Level &level, float lowHz, float highHz,
+                                            double &weightedPower, double &width) const {
+  const MagdaSTFT &stft = *level.stft;
+  const std::vector<double> &sums = stft.GetMagnitudeSums();
+  long long active = stft.GetNumActiveWindows();
+  double binWidth = (double)m_sampleRate / ((double)level.factor * kLevelFFTSize);
+  // Same per-bin power density as the reference FFT: a level bin is
+  // factor * kLevelFFTSize / refFftSize times narrower
+  double scale = (double)level.factor * kLevelFFTSize / m_refFftSize;
+
+  int first = (int)ceil(lowHz / binWidth);
+  for (int k = first < 0 ? 0 : first; k < stft.GetNumBins() && k * binWidth < highHz; k++) {
+    double magnitude = active > 0 ? sums[k] / active / (kLevelFFTSize / 2.0) : 0.0;
+    weightedPower += magnitude * magnitude * scale * binWidth;
+    width += binWidth;
+  }
+}
+
+float MagdaMultiResSpectrum::GetBandLevel(float lowHz, float highHz,
+                                          const std::vector<float> &refFrequencies,
+                                          const std::vector<float> &refMagnitudes) const {
+  double weightedPower = 0.0;
+  double width = 0.0;
+
+  // Reference spectrum: everything above the first usable level
+  auto addReference = [&](float lo, float hi) {
+    double binWidth = (double)m_sampleRate / m_refFftSize;
+    for (size_t i = 0; i < refFrequencies.size() && i < refMagnitudes.size(); i++) {
+      if (refFrequencies[i] >= lo && refFrequencies[i] < hi) {
+        weightedPower += pow(10.0, refMagnitudes[i] / 10.0) * binWidth;
+        width += binWidth;
+      }
+    }
+  };
+
+  // Walk the sources finest first. A level without a complete window (input
+  // shorter than its window) leaves its range to the finer source above it.
+  const Level *current = nullptr;
+  float currentHigh = highHz;
+  float top = m_levels.empty() ? 0.0f : m_refMinHz;
+  for (const Level *level : m_levels) {
+    if (level->stft->GetNumWindows() > 0) {
+      float lo = top > lowHz ? top : lowHz;
+      if (lo < currentHigh) {
+        if (current) {
+          AccumulateLevel(*current, lo, currentHigh, weightedPower, width);
+        } else {
+          addReference(lo, currentHigh);
+        }
+      }
+      current = level;
+      currentHigh = top < highHz ? top : highHz;
+    }
+    top = level->minHz;
+  }
+  if (lowHz < currentHigh) {
+    if (current) {
+      AccumulateLevel(*current, lowHz, currentHigh, weightedPower, width);
+    } else {
+      addReference(lowHz, currentHigh);
+    }
+  }
+
+  if (width <= 0.0 || weightedPower <= 0.0) {
+    return -96.0f;
+  }
+  float db = 10.0f * (float)log10(weightedPower / width);
+  return db < -96.0f ? -96.0f : db;
+}
@@ -0,0 +1,218 @@
+#include "magda_onsets.h"
+#include <algorithm>
+#include <cmath>
+
+// Windows of history kept for thresholding and envelope refinement
+static const int kRingWindows = 16;
+// Adaptive threshold: mean over [w - kPreWindows, w + kPostWindows]
+static const int kPreWindows = 8;
+static const int kPostWindows = 2;
+// Threshold offset as a share of the largest flux seen so far, and an
+// absolute floor (mean per-bin log change) so noise never triggers
+static const double kRelativeDelta = 0.1;
+static const double kMinFlux = 0.001;
+// Log compression: log(1 + kCompression * |X|) on normalized magnitudes
+static const float kCompression = 100.0f;
+// Envelope values per hop for sub-hop timing
+static const int kSubBlocksPerHop = 8;
+
+// Heap order for the stored onsets: the weakest on top, so it is the one
+// replaced once the cap is reached
+static bool StrongerOnset(const Onset &a, const Onset &b) { return a.strength > b.strength; }
+
+MagdaOnsetDetector::MagdaOnsetDetector(int sampleRate, int fftSize, int hopSize, int maxOnsets)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 44100), m_fftSize(fftSize > 0 ? fftSize : 4096),
+      m_hopSize(hopSize > 0 ? hopSize : m_fftSize / 2), m_numBins(m_fftSize / 2 + 1),
+      m_maxOnsets(maxOnsets > 0 ? maxOnsets : 1), m_windows(0), m_maxFlux(0.0),
+      m_totalFlux(0.0), m_onsetFlux(0.0), m_totalOnsets(0), m_finished(false) {
+
+  if (m_hopSize > m_fftSize) {
+    m_hopSize = m_fftSize;
+  }
+  m_subBlockSize = m_hopSize / kSubBlocksPerHop > 0 ? m_hopSize / kSubBlocksPerHop : 1;
+  m_subBlocks = m_hopSize / m_subBlockSize;
+
+  m_prevLogMagnitudes.assign(m_numBins, 0.0f);
+  m_fluxRing.assign(kRingWindows, 0.0);
+  m_envelopeRing.assign((size_t)kRingWindows * m_subBlocks, 0.0f);
+}
+
+double MagdaOnsetDetector::FluxAt(long long window) const {
+  if (window < 0 || window >= m_windows) {
+    return 0.0;
+  }
+  return m_fluxRing[window % kRingWindows];
+}
+
+void MagdaOnsetDetector::AddWindow(const float *samples, const float *magnitudes) {
+  // Positive log-magnitude change against the previous window (the first
+  // window is compared against silence)
+  const float scale = 2.0f / m_fftSize;
+  double flux = 0.0;
+  for (int k = 0; k < m_numBins; k++) {
+    float logMag = log1pf(kCompression * magnitudes[k] * scale);
+    float rise = logMag - m_prevLogMagnitudes[k];
+    if (rise > 0.0f) {
+      flux += rise;
+    }
+    m_prevLogMagnitudes[k] = logMag;
+  }
+  flux /= m_numBins;
+
+  // RMS envelope of the hop-sized centre slice; consecutive windows tile the
+  // signal, so the ring holds a continuous envelope
+  const float *slice = samples + (m_fftSize - m_hopSize) / 2;
+  float *envelope = m_envelopeRing.data() + (size_t)(m_windows % kRingWindows) * m_subBlocks;
+  for (int s = 0; s < m_subBlocks; s++) {
+    const float *block = slice + s * m_subBlockSize;
+    double sumSquares = 0.0;
+    for (int i = 0; i < m_subBlockSize; i++) {
+      sumSquares += (double)block[i] * block[i];
+    }
+    envelope[s] = (float)sqrt(sumSquares / m_subBlockSize);
+  }
+
+  m_fluxRing[m_windows % kRingWindows] = flux;
+  m_totalFlux += flux;
+  m_windows++;
+
+  // The window kPostWindows back now has its full look-ahead
+  long long candidate = m_windows - 1 - kPostWindows;
+  if (candidate >= 0) {
+    Evaluate(candidate, m_windows - 1);
+  }
+}
+
+void MagdaOnsetDetector::Evaluate(long long window, long long lastWindow) {
+  double flux = FluxAt(window);
+  if (flux > m_maxFlux) {
+    m_maxFlux = flux;
+  }
+
+  // Local maximum (strict against the earlier neighbour so plateaus fire once)
+  if (flux <= FluxAt(window - 1) || flux < FluxAt(window + 1)) {
+    return;
+  }
+
+  long long first = window - kPreWindows > 0 ? window - kPreWindows : 0;
+  long long last = window + kPostWindows < lastWindow ? window + kPostWindows : lastWindow;
+  double sum = 0.0;
+  for (long long w = first; w <= last; w++) {
+    sum += FluxAt(w);
+  }
+  double threshold = sum / (double)(last - first + 1) + kRelativeDelta * m_maxFlux;
+  if (flux < threshold || flux < kMinFlux) {
+    return;
+  }
+
+  m_totalOnsets++;
+  m_onsetFlux += flux;
+
+  // Keep the maxOnsets strongest: a busy intro must not crowd out the big
+  // hits later in the item
+  bool full = (int)m_onsets.size() >= m_maxOnsets;
+  if (full && (float)flux <= m_onsets.front().strength) {
+    return;
+  }
+  Onset onset;
+  onset.strength = (float)flux;
+  RefineOnset(window, onset);
+  if (full) {
+    std::pop_heap(m_onsets.begin(), m_onsets.end(), StrongerOnset);
+    m_onsets.back() = onset;
+  } else {
+    m_onsets.push_back(onset);
+  }
+  std::push_heap(m_onsets.begin(), m_onsets.end(), StrongerOnset);
+}
+
+void MagdaOnsetDetector::RefineOnset(long long window, Onset &onset) const {
+  // The flux of window w reacts to changes around its centre, so search the
+  // envelope over the slices of windows w-2 .. w+1
+  long long firstWindow = window - 2 > 0 ? window - 2 : 0;
+  long long lastWindow = window + 1 < m_windows - 1 ? window + 1 : m_windows - 1;
+
+  std::vector<float> envelope;
+  for (long long w = firstWindow; w <= lastWindow; w++) {
+    const float *values = m_envelopeRing.data() + (size_t)(w % kRingWindows) * m_subBlocks;
+    envelope.insert(envelope.end(), values, values + m_subBlocks);
+  }
+
+  long long regionStart = (long long)(m_fftSize - m_hopSize) / 2 + firstWindow * m_hopSize;
+  int peak = (int)(std::max_element(envelope.begin(), envelope.end()) - envelope.begin());
+  int valley = (int)(std::min_element(envelope.begin(), envelope.begin() + peak + 1) -
+                     envelope.begin());
+
+  float low = envelope[valley];
+  float rise = envelope[peak] - low;
+  int start = valley;
+  int end = peak;
+  if (rise > 0.0f) {
+    while (start < peak && envelope[start] < low + 0.1f * rise) {
+      start++;
+    }
+    end = start;
+    while (end < peak && envelope[end] < low + 0.9f * rise) {
+      end++;
+    }
+  }
+
+  onset.time = (double)(regionStart + (long long)start * m_subBlockSize) / m_sampleRate;
+  onset.attack = (float)((double)(end - start) * m_subBlockSize / m_sampleRate);
+}
+
+void MagdaOnsetDetector::Finish() {
+  if (m_finished) {
+    return;
+  }
+  m_finished = true;
+
+  // Windows at the end never got their full look-ahead; treat the missing
+  // windows as silence
+  long long first = m_windows - kPostWindows > 0 ? m_windows - kPostWindows : 0;
+  for (long long w = first; w < m_windows; w++) {
+    Evaluate(w, m_windows - 1);
+  }
+
+  SortAndNormalize(m_onsets);
+}
+
+std::vector<Onset> MagdaOnsetDetector::GetOnsetsSoFar() const {
+  std::vector<Onset> onsets = m_onsets;
+  if (!m_finished) {
+    SortAndNormalize(onsets);
+  }
+  return onsets;
+}
+
+void MagdaOnsetDetector::SortAndNormalize(std::vector<Onset> &onsets) {
+  std::sort(onsets.begin(), onsets.end(),
+            [](const Onset &a, const Onset &b) { return a.time < b.time; });
+
+  float strongest = 0.0f;
+  for (const Onset &onset : onsets) {
+    strongest = onset.strength > strongest ? onset.strength : strongest;
+  }
+  if (strongest > 0.0f) {
+    for (Onset &onset : onsets) {
+      onset.strength /= strongest;
+    }
+  }
+}
+
+float MagdaOnsetDetector::GetMedianAttack() const {
+  if (m_onsets.empty()) {
+    return 0.0f;
+  }
+  std::vector<float> attacks;
+  attacks.reserve(m_onsets.size());
+  for (const Onset &onset : m_onsets) {
+    attacks.push_back(onset.attack);
+  }
+  std::nth_element(attacks.begin(), attacks.begin() + attacks.size() / 2, attacks.end());
+  return attacks[attacks.size() / 2];
+}
+
+float MagdaOnsetDetector::GetOnsetFluxShare() const {
+  return m_totalFlux > 0.0 ? (float)(m_onsetFlux / m_totalFlux) : 0.0f;
+}
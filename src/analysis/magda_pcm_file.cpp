@@ -0,0 +1,428 @@
+#include "magda_pcm_file.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint16_t ReadLE16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static uint32_t ReadLE32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t ReadBE16(const unsigned char *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+
+static uint32_t ReadBE32(const unsigned char *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// 80-bit IEEE extended (AIFF sample rate)
+static double ReadExtended(const unsigned char *p) {
+  int exponent = ((p[0] & 0x7F) << 8) | p[1];
+  uint64_t mantissa = 0;
+  for (int i = 0; i < 8; i++) {
+    mantissa = (mantissa << 8) | p[2 + i];
+  }
+  if (exponent == 0 && mantissa == 0) {
+    return 0.0;
+  }
+  double value = ldexp((double)mantissa, exponent - 16383 - 63);
+  return (p[0] & 0x80) ? -value : value;
+}
+
+MagdaPCMFile::MagdaPCMFile()
+    : m_data(nullptr), m_size(0),
+#ifdef _WIN32
+      m_file(nullptr), m_mapping(nullptr),
+#endif
+      m_samples(nullptr), m_sampleRate(0), m_channels(0), m_numFrames(0),
+      m_format(PCM_FORMAT_INT16), m_bytesPerSample(0), m_bigEndian(false) {
+}
+
+MagdaPCMFile::~MagdaPCMFile() { Close(); }
+
+bool MagdaPCMFile::Open(const char *path, WDL_FastString &error_msg) {
+  Close();
+  if (!path || !path[0]) {
+    error_msg.Set("No file name");
+    return false;
+  }
+
+#ifdef _WIN32
+  // REAPER paths are UTF-8
+  wchar_t widePath[2048];
+  if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, widePath, 2048)) {
+    error_msg.Set("Invalid file name");
+    return false;
+  }
+  HANDLE file = CreateFileW(widePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    error_msg.Set("Failed to open file");
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    error_msg.Set("Empty file");
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view) {
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    error_msg.Set("Failed to map file");
+    return false;
+  }
+  m_file = file;
+  m_mapping = mapping;
+  m_data = (const unsigned char *)view;
+  m_size = (size_t)size.QuadPart;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    error_msg.Set("Failed to open file");
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    error_msg.Set("Empty file");
+    return false;
+  }
+  void *view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file alive
+  close(fd);
+  if (view == MAP_FAILED) {
+    error_msg.Set("Failed to map file");
+    return false;
+  }
+  m_data = (const unsigned char *)view;
+  m_size = (size_t)st.st_size;
+#endif
+
+  bool ok = false;
+  if (m_size >= 12 && memcmp(m_data, "RIFF", 4) == 0 && memcmp(m_data + 8, "WAVE", 4) == 0) {
+    ok = ParseWAV(error_msg);
+  } else if (m_size >= 12 && memcmp(m_data, "FORM", 4) == 0 &&
+             (memcmp(m_data + 8, "AIFF", 4) == 0 || memcmp(m_data + 8, "AIFC", 4) == 0)) {
+    ok = ParseAIFF(error_msg);
+  } else {
+    error_msg.Set("Not a WAV or AIFF file");
+  }
+  if (!ok) {
+    Close();
+  }
+  return ok;
+}
+
+void MagdaPCMFile::Close() {
+#ifdef _WIN32
+  if (m_data) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping) {
+    CloseHandle((HANDLE)m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file) {
+    CloseHandle((HANDLE)m_file);
+    m_file = nullptr;
+  }
+#else
+  if (m_data) {
+    munmap((void *)m_data, m_size);
+  }
+#endif
+  m_data = nullptr;
+  m_size = 0;
+  m_samples = nullptr;
+  m_sampleRate = 0;
+  m_channels = 0;
+  m_numFrames = 0;
+}
+
+bool MagdaPCMFile::ParseWAV(WDL_FastString &error_msg) {
+  const unsigned char *fmt = nullptr;
+  uint32_t fmtSize = 0;
+  const unsigned char *data = nullptr;
+  size_t dataSize = 0;
+
+  size_t pos = 12;
+  while (pos + 8 <= m_size) {
+    const unsigned char *chunk = m_data + pos;
+    size_t chunkSize = ReadLE32(chunk + 4);
+    size_t available = m_size - pos - 8;
+    if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available) {
+      fmt = chunk + 8;
+      fmtSize = (uint32_t)chunkSize;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      // A file still being written (or over 4 GB) claims more than is there
+      data = chunk + 8;
+      dataSize = chunkSize < available ? chunkSize : available;
+      break;
+    }
+    pos += 8 + chunkSize + (chunkSize & 1);
+  }
+  if (!fmt || !data) {
+    error_msg.Set("WAV file has no fmt or data chunk");
+    return false;
+  }
+
+  int formatTag = ReadLE16(fmt);
+  m_channels = ReadLE16(fmt + 2);
+  m_sampleRate = (int)ReadLE32(fmt + 4);
+  int bits = ReadLE16(fmt + 14);
+  if (formatTag == 0xFFFE && fmtSize >= 40) {
+    // WAVE_FORMAT_EXTENSIBLE: the subformat GUID starts with the format tag
+    formatTag = ReadLE16(fmt + 24);
+  }
+
+  if (formatTag == 1 && bits == 16) {
+    m_format = PCM_FORMAT_INT16;
+  } else if (formatTag == 1 && bits == 24) {
+    m_format = PCM_FORMAT_INT24;
+  } else if (formatTag == 1 && bits == 32) {
+    m_format = PCM_FORMAT_INT32;
+  } else if (formatTag == 3 && bits == 32) {
+    m_format = PCM_FORMAT_FLOAT32;
+  } else if (formatTag == 3 && bits == 64) {
+    m_format = PCM_FORMAT_FLOAT64;
+  } else {
+    error_msg.Set("Unsupported WAV sample format");
+    return false;
+  }
+  if (m_channels <= 0 || m_sampleRate <= 0) {
+    error_msg.Set("Invalid WAV format");
+    return false;
+  }
+
+  m_bytesPerSample = bits / 8;
+  m_bigEndian = false;
+  m_samples = data;
+  m_numFrames = (long long)(dataSize / ((size_t)m_bytesPerSample * m_channels));
+  return true;
+}
+
+bool MagdaPCMFile::ParseAIFF(WDL_FastString &error_msg) {
+  bool isAIFC = memcmp(m_data + 8, "AIFC", 4) == 0;
+  const unsigned char *comm = nullptr;
+  uint32_t commSize = 0;
+  const unsigned char *ssnd = nullptr;
+  size_t ssndSize = 0;
+
+  size_t pos = 12;
+  while (pos + 8 <= m_size) {
+    const unsigned char *chunk = m_data + pos;
+    size_t chunkSize = ReadBE32(chunk + 4);
+    size_t available = m_size - pos - 8;
+    if (memcmp(chunk, "COMM", 4) == 0 && chunkSize >= 18 && chunkSize <= available) {
+      comm = chunk + 8;
+      commSize = (uint32_t)chunkSize;
+    } else if (memcmp(chunk, "SSND", 4) == 0 && available >= 8) {
+      ssnd = chunk + 8;
+      ssndSize = chunkSize < available ? chunkSize : available;
+    }
+    if (comm && ssnd) {
+      break;
+    }
+    pos += 8 + chunkSize + (chunkSize & 1);
+  }
+  if (!comm || !ssnd || ssndSize < 8) {
+    error_msg.Set("AIFF file has no COMM or SSND chunk");
+    return false;
+  }
+
+  m_channels = ReadBE16(comm);
+  long long declaredFrames = ReadBE32(comm + 2);
+  int bits = ReadBE16(comm + 6);
+  m_sampleRate = (int)lround(ReadExtended(comm + 8));
+
+  m_bigEndian = true;
+  bool isFloat = false;
+  if (isAIFC && commSize >= 22) {
+    const unsigned char *compression = comm + 18;
+    if (memcmp(compression, "sowt", 4) == 0) {
+      m_bigEndian = false;
+    } else if (memcmp(compression, "fl32", 4) == 0 || memcmp(compression, "FL32", 4) == 0) {
+      isFloat = true;
+      bits = 32;
+    } else if (memcmp(compression, "fl64", 4) == 0 || memcmp(compression, "FL64", 4) == 0) {
+      isFloat = true;
+      bits = 64;
+    } else if (memcmp(compression, "NONE", 4) != 0) {
+      error_msg.Set("Compressed AIFC is not supported");
+      return false;
+    }
+  }
+
+  if (!isFloat && bits == 16) {
+    m_format = PCM_FORMAT_INT16;
+  } else if (!isFloat && bits == 24) {
+    m_format = PCM_FORMAT_INT24;
+  } else if (!isFloat && bits == 32) {
+    m_format = PCM_FORMAT_INT32;
+  } else if (isFloat && bits == 32) {
+    m_format = PCM_FORMAT_FLOAT32;
+  } else if (isFloat && bits == 64) {
+    m_format = PCM_FORMAT_FLOAT64;
+  } else {
+    error_msg.Set("Unsupported AIFF sample format");
+    return false;
+  }
+  if (m_channels <= 0 || m_sampleRate <= 0) {
+    error_msg.Set("Invalid AIFF format");
+    return false;
+  }
+
+  // SSND starts with an offset to the first frame and a block size
+  uint32_t offset = ReadBE32(ssnd);
+  if (8 + (size_t)offset > ssndSize) {
+    error_msg.Set("Invalid AIFF sound data");
+    return false;
+  }
+  m_bytesPerSample = bits / 8;
+  m_samples = ssnd + 8 + offset;
+  size_t frameBytes = (size_t)m_bytesPerSample * m_channels;
+  long long available = (long long)((ssndSize - 8 - offset) / frameBytes);
+  m_numFrames = declaredFrames < available ? declaredFrames : available;
+  return true;
+}
+
+void MagdaPCMFile::ReadFrames(long long first, int frames, float *out, bool loop) const {
+  while (frames > 0) {
+    long long index = first;
+    if (loop && m_numFrames > 0) {
+      index = ((first % m_numFrames) + m_numFrames) % m_numFrames;
+    }
+
+    int count;
+    if (index < 0) {
+      // Before the file: silence up to its start
+      count = (int)(-index < frames ? -index : frames);
+      memset(out, 0, (size_t)count * m_channels * sizeof(float));
+    } else if (index >= m_numFrames) {
+      count = frames;
+      memset(out, 0, (size_t)count * m_channels * sizeof(float));
+    } else {
+      long long remaining = m_numFrames - index;
+      count = (int)(remaining < frames ? remaining : frames);
+      Decode(index, count, out);
+    }
+
+    first += count;
+    frames -= count;
+    out += (size_t)count * m_channels;
+  }
+}
+
+void MagdaPCMFile::Decode(long long first, int frames, float *out) const {
+  size_t count = (size_t)frames * m_channels;
+  const unsigned char *p = m_samples + (size_t)first * m_channels * m_bytesPerSample;
+
+  switch (m_format) {
+  case PCM_FORMAT_INT16:
+    for (size_t i = 0; i < count; i++, p += 2) {
+      int16_t value = (int16_t)(m_bigEndian ? ReadBE16(p) : ReadLE16(p));
+      out[i] = value * (1.0f / 32768.0f);
+    }
+    break;
+  case PCM_FORMAT_INT24:
+    for (size_t i = 0; i < count; i++, p += 3) {
+      uint32_t raw = m_bigEndian ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                                       ((uint32_t)p[2] << 8)
+                                 : ((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) |
+                                       ((uint32_t)p[0] << 8);
+      out[i] = (float)((int32_t)raw >> 8) * (1.0f / 8388608.0f);
+    }
+    break;
+  case PCM_FORMAT_INT32:
+    for (size_t i = 0; i < count; i++, p += 4) {
+      int32_t value = (int32_t)(m_bigEndian ? ReadBE32(p) : ReadLE32(p));
+      out[i] = (float)((double)value * (1.0 / 2147483648.0));
+    }
+    break;
+  case PCM_FORMAT_FLOAT32:
+    for (size_t i = 0; i < count; i++, p += 4) {
+      uint32_t raw = m_bigEndian ? ReadBE32(p) : ReadLE32(p);
+      float value;
+      memcpy(&value, &raw, sizeof(value));
+      out[i] = value;
+    }
+    break;
+  case PCM_FORMAT_FLOAT64:
+    for (size_t i = 0; i < count; i++, p += 8) {
+      uint64_t raw = m_bigEndian ? ((uint64_t)ReadBE32(p) << 32) | ReadBE32(p + 4)
+                                 : ((uint64_t)ReadLE32(p + 4) << 32) | ReadLE32(p);
+      double value;
+      memcpy(&value, &raw, sizeof(value));
+      out[i] = (float)value;
+    }
+    break;
+  }
+}
+
+MagdaPCMFileSource::MagdaPCMFileSource(std::unique_ptr<MagdaPCMFile> file, double startOffset,
+                                       double length, double playrate, float gain, bool loop)
+    : m_file(std::move(file)), m_playrate(playrate > 0.0 ? playrate : 1.0), m_gain(gain),
+      m_loop(loop), m_position(0), m_hadAudio(false) {
+  m_startFrame = startOffset * m_file->GetSampleRate();
+  m_totalFrames = (long long)(length * m_file->GetSampleRate());
+  if (m_totalFrames < 0) {
+    m_totalFrames = 0;
+  }
+}
+
+int MagdaPCMFileSource::ReadBlock(float *out, int maxFrames) {
+  if (m_position >= m_totalFrames) {
+    return 0;
+  }
+  int frames = (int)(maxFrames < m_totalFrames - m_position ? maxFrames
+                                                             : m_totalFrames - m_position);
+  int channels = m_file->GetChannels();
+
+  double sourceStart = m_startFrame + (double)m_position * m_playrate;
+  long long firstFrame = (long long)floor(sourceStart);
+  if (m_playrate == 1.0 && sourceStart == (double)firstFrame) {
+    // Frame-aligned at the original rate: decode straight into out
+    m_file->ReadFrames(firstFrame, frames, out, m_loop);
+  } else {
+    // Source frames this block touches, plus one for the last interpolation
+    double sourceEnd = sourceStart + (double)(frames - 1) * m_playrate;
+    int sourceFrames = (int)((long long)floor(sourceEnd) - firstFrame) + 2;
+    m_scratch.resize((size_t)sourceFrames * channels);
+    m_file->ReadFrames(firstFrame, sourceFrames, m_scratch.data(), m_loop);
+
+    for (int i = 0; i < frames; i++) {
+      double position = sourceStart + (double)i * m_playrate - (double)firstFrame;
+      int index = (int)position;
+      float frac = (float)(position - index);
+      const float *a = m_scratch.data() + (size_t)index * channels;
+      const float *b = a + channels;
+      for (int ch = 0; ch < channels; ch++) {
+        out[i * channels + ch] = a[ch] + (b[ch] - a[ch]) * frac;
+      }
+    }
+  }
+
+  if (m_gain != 1.0f) {
+    size_t count = (size_t)frames * channels;
+    for (size_t i = 0; i < count; i++) {
+      out[i] *= m_gain;
+    }
+  }
+
+  m_hadAudio = m_hadAudio || m_file->GetNumFrames() > 0;
+  m_position += frames;
+  return frames;
+}
@@ -0,0 +1,79 @@
+#include "magda_stereo_image.h"
+#include <algorithm>
+#include <cmath>
+
+// Per-band stereo image uses the FrequencyBands ranges; the low-end check
+// looks at everything below kLowEndHz
+static const float kStereoBandEdges[] = {20.0f, 60.0f, 250.0f, 500.0f, 2000.0f,
+                                         4000.0f, 6000.0f, 20000.0f};
+static const float kLowEndHz = 120.0f;
+// Low end below this L/R correlation loses level when folded to mono; bands
+// quieter than kLowEndFloorDb don't count
+static const float kLowEndMinCorrelation = 0.5f;
+static const float kLowEndFloorDb = -70.0f;
+// A channel with less than this share of a band's L+R power is silent there
+static const double kSilentChannelRatio = 1e-7;
+
+static float PowerToDb(double power) {
+  return power > 0.0 ? std::max(-96.0f, 10.0f * (float)log10(power)) : -96.0f;
+}
+
+StereoBand MagdaStereoImage::Band(const MagdaSTFT &stft, int sampleRate, float lowHz,
+                                  float highHz) {
+  StereoBand band = {lowHz, highHz, -96.0f, -96.0f, 1.0f, 0.0f};
+  const std::vector<double> &midSums = stft.GetMidPowerSums();
+  const std::vector<double> &sideSums = stft.GetSidePowerSums();
+  const std::vector<double> &crossSums = stft.GetCrossSums();
+
+  double binWidth = (double)sampleRate / stft.GetFFTSize();
+  double mid = 0.0, side = 0.0, cross = 0.0;
+  int bins = 0;
+  for (int k = (int)ceil(lowHz / binWidth); k < stft.GetNumBins() && k * binWidth < highHz; k++) {
+    mid += midSums[k];
+    side += sideSums[k];
+    cross += crossSums[k];
+    bins++;
+  }
+  long long windows = stft.GetNumActiveWindows();
+  if (bins == 0 || windows == 0) {
+    return band;
+  }
+
+  // Same scale as the spectrum: magnitudes normalized by fftSize / 2
+  double norm = (double)bins * windows * (stft.GetFFTSize() / 2.0) * (stft.GetFFTSize() / 2.0);
+  band.midLevel = PowerToDb(mid / norm);
+  band.sideLevel = PowerToDb(side / norm);
+
+  // L = M + S, R = M - S, so |L|^2, |R|^2 and Re(L R*) follow from the sums.
+  // A channel that is silent in the band (hard pan) is uncorrelated; its sum
+  // is only rounding error, so don't divide by it.
+  double sumL2 = mid + side + 2.0 * cross;
+  double sumR2 = mid + side - 2.0 * cross;
+  double total = sumL2 + sumR2;
+  if (total > 0) {
+    if (std::min(sumL2, sumR2) > kSilentChannelRatio * total) {
+      double correlation = (mid - side) / sqrt(sumL2 * sumR2);
+      band.correlation = (float)std::max(-1.0, std::min(1.0, correlation));
+    } else {
+      band.correlation = 0.0f;
+    }
+  }
+  if (mid > 0) {
+    band.width = (float)std::min(1.0, sqrt(side / mid));
+  } else if (side > 0) {
+    band.width = 1.0f;
+  }
+  return band;
+}
+
+void MagdaStereoImage::Analyze(const MagdaSTFT &stft, int sampleRate,
+                               std::vector<StereoBand> &bands, StereoAnalysis &stereo) {
+  int numBands = (int)(sizeof(kStereoBandEdges) / sizeof(kStereoBandEdges[0])) - 1;
+  for (int b = 0; b < numBands; b++) {
+    bands.push_back(Band(stft, sampleRate, kStereoBandEdges[b], kStereoBandEdges[b + 1]));
+  }
+  StereoBand lowEnd = Band(stft, sampleRate, kStereoBandEdges[0], kLowEndHz);
+  bool audible = std::max(lowEnd.midLevel, lowEnd.sideLevel) > kLowEndFloorDb;
+  stereo.lowEndCorrelation = lowEnd.correlation;
+  stereo.lowEndMonoCompatible = !audible || lowEnd.correlation >= kLowEndMinCorrelation;
+}
@@ -0,0 +1,217 @@
+#include "magda_stft.h"
+#include "magda_fft.h"
+#include "magda_worker_pool.h"
+#include <cmath>
+#include <cstring>
+
+// Windows per batch and per pool task. Fixed sizes keep the work split (and
+// so the summation order) independent of how many threads run it.
+static const int kBatchWindows = 64;
+static const int kWindowsPerTask = 8;
+
+MagdaSTFT::MagdaSTFT(int fftSize, int hopSize, int maxThreads)
+    : m_fftSize(fftSize > 0 ? fftSize : 4096),
+      m_hopSize(hopSize > 0 ? hopSize : m_fftSize / 2), m_maxThreads(maxThreads),
+      m_numWindows(0), m_sideEnabled(false), m_gateEnergy(0.0), m_numActiveWindows(0) {
+
+  if (m_hopSize > m_fftSize) {
+    m_hopSize = m_fftSize;
+  }
+
+  m_plan = MagdaFFT::GetPlan(m_fftSize);
+  int numBins = m_plan->GetNumBins();
+  m_magnitudeSums.assign(numBins, 0.0);
+  m_batchMagnitudes.resize((size_t)kBatchWindows * numBins);
+  m_batchActive.assign(kBatchWindows, 1);
+
+  m_scratch.resize(kBatchWindows / kWindowsPerTask);
+  for (auto &scratch : m_scratch) {
+    scratch.windowed.resize(m_fftSize);
+    scratch.realOut.resize(numBins);
+    scratch.imagOut.resize(numBins);
+    scratch.work.resize(m_plan->GetWorkSize());
+  }
+}
+
+MagdaSTFT::~MagdaSTFT() {}
+
+int MagdaSTFT::GetNumBins() const { return m_plan->GetNumBins(); }
+
+void MagdaSTFT::SetSilenceGate(float thresholdDb) {
+  // Compare sums of squares instead of taking a root per window
+  double rms = pow(10.0, thresholdDb / 20.0);
+  m_gateEnergy = rms * rms * m_fftSize;
+}
+
+void MagdaSTFT::EnableSideChannel() {
+  if (m_sideEnabled) {
+    return;
+  }
+  m_sideEnabled = true;
+  int numBins = m_plan->GetNumBins();
+  m_batchStereo.resize((size_t)kBatchWindows * numBins * 3);
+  m_midPowerSums.assign(numBins, 0.0);
+  m_sidePowerSums.assign(numBins, 0.0);
+  m_crossSums.assign(numBins, 0.0);
+  for (auto &scratch : m_scratch) {
+    scratch.sideReal.resize(numBins);
+    scratch.sideImag.resize(numBins);
+  }
+}
+
+void MagdaSTFT::Process(const float *mono, int numFrames, const float *side) {
+  if (!mono || numFrames <= 0) {
+    return;
+  }
+
+  m_pending.insert(m_pending.end(), mono, mono + numFrames);
+  if (m_sideEnabled) {
+    if (side) {
+      m_pendingSide.insert(m_pendingSide.end(), side, side + numFrames);
+    } else {
+      m_pendingSide.resize(m_pendingSide.size() + numFrames, 0.0f);
+    }
+  }
+
+  // Samples needed for a full batch of overlapping windows
+  size_t batchSpan = (size_t)m_fftSize + (size_t)(kBatchWindows - 1) * m_hopSize;
+  while (m_pending.size() >= batchSpan) {
+    RunBatch(kBatchWindows);
+  }
+}
+
+void MagdaSTFT::Flush() {
+  if (m_pending.size() < (size_t)m_fftSize) {
+    return;
+  }
+  int windows = (int)((m_pending.size() - m_fftSize) / m_hopSize) + 1;
+  while (windows > 0) {
+    int batch = windows < kBatchWindows ? windows : kBatchWindows;
+    RunBatch(batch);
+    windows -= batch;
+  }
+}
+
+void MagdaSTFT::AnalyzeWindow(const float *frame, float *magnitudes, Scratch &scratch) const {
+  const float *window = m_plan->GetWindow();
+  for (int i = 0; i < m_fftSize; i++) {
+    scratch.windowed[i] = frame[i] * window[i];
+  }
+
+  m_plan->Forward(scratch.windowed.data(), scratch.realOut.data(), scratch.imagOut.data(),
+                  scratch.work.data());
+
+  int numBins = m_plan->GetNumBins();
+  for (int i = 0; i < numBins; i++) {
+    magnitudes[i] =
+        sqrtf(scratch.realOut[i] * scratch.realOut[i] + scratch.imagOut[i] * scratch.imagOut[i]);
+  }
+}
+
+void MagdaSTFT::GateBatch(int numWindows) {
+  if (m_gateEnergy <= 0.0) {
+    return;
+  }
+
+  // One pass over the batch span; each window's energy is then a difference
+  // of two prefix sums, however much the windows overlap
+  size_t span = (size_t)(numWindows - 1) * m_hopSize + m_fftSize;
+  m_energyPrefix.resize(span + 1);
+  m_energyPrefix[0] = 0.0;
+  // With a side channel the gate sees M^2 + S^2 = (L^2 + R^2) / 2, so
+  // out-of-phase material isn't mistaken for silence
+  for (size_t i = 0; i < span; i++) {
+    double x = m_pending[i];
+    double energy = x * x;
+    if (m_sideEnabled) {
+      double s = m_pendingSide[i];
+      energy += s * s;
+    }
+    m_energyPrefix[i + 1] = m_energyPrefix[i] + energy;
+  }
+
+  for (int w = 0; w < numWindows; w++) {
+    size_t start = (size_t)w * m_hopSize;
+    double energy = m_energyPrefix[start + m_fftSize] - m_energyPrefix[start];
+    m_batchActive[w] = energy >= m_gateEnergy ? 1 : 0;
+  }
+}
+
+void MagdaSTFT::AnalyzeSideWindow(const float *frame, float *stereoRow, Scratch &scratch) const {
+  // scratch.realOut/imagOut still hold the mid spectrum
+  const float *window = m_plan->GetWindow();
+  for (int i = 0; i < m_fftSize; i++) {
+    scratch.windowed[i] = frame[i] * window[i];
+  }
+
+  m_plan->Forward(scratch.windowed.data(), scratch.sideReal.data(), scratch.sideImag.data(),
+                  scratch.work.data());
+
+  int numBins = m_plan->GetNumBins();
+  for (int i = 0; i < numBins; i++) {
+    float mr = scratch.realOut[i], mi = scratch.imagOut[i];
+    float sr = scratch.sideReal[i], si = scratch.sideImag[i];
+    stereoRow[i * 3] = mr * mr + mi * mi;
+    stereoRow[i * 3 + 1] = sr * sr + si * si;
+    stereoRow[i * 3 + 2] = mr * sr + mi * si;
+  }
+}
+
+void MagdaSTFT::RunBatch(int numWindows) {
+  const int numBins = m_plan->GetNumBins();
+  const int numTasks = (numWindows + kWindowsPerTask - 1) / kWindowsPerTask;
+
+  GateBatch(numWindows);
+
+  MagdaWorkerPool::Get().ParallelFor(numTasks, m_maxThreads, [&](int task) {
+    Scratch &scratch = m_scratch[task];
+    int first = task * kWindowsPerTask;
+    int last = first + kWindowsPerTask < numWindows ? first + kWindowsPerTask : numWindows;
+    for (int w = first; w < last; w++) {
+      float *row = m_batchMagnitudes.data() + (size_t)w * numBins;
+      float *stereoRow = m_sideEnabled ? m_batchStereo.data() + (size_t)w * numBins * 3 : nullptr;
+      if (m_batchActive[w]) {
+        AnalyzeWindow(m_pending.data() + (size_t)w * m_hopSize, row, scratch);
+        if (stereoRow) {
+          AnalyzeSideWindow(m_pendingSide.data() + (size_t)w * m_hopSize, stereoRow, scratch);
+        }
+      } else {
+        memset(row, 0, sizeof(float) * numBins);
+      }
+    }
+  });
+
+  // Reduce in window order so the sums don't depend on scheduling. Gated
+  // windows still reach the callback so per-window stages keep their timing.
+  for (int w = 0; w < numWindows; w++) {
+    const float *row = m_batchMagnitudes.data() + (size_t)w * numBins;
+    if (m_batchActive[w]) {
+      for (int i = 0; i < numBins; i++) {
+        m_magnitudeSums[i] += row[i];
+      }
+      if (m_sideEnabled) {
+        const float *stereoRow = m_batchStereo.data() + (size_t)w * numBins * 3;
+        for (int i = 0; i < numBins; i++) {
+          m_midPowerSums[i] += stereoRow[i * 3];
+          m_sidePowerSums[i] += stereoRow[i * 3 + 1];
+          m_crossSums[i] += stereoRow[i * 3 + 2];
+        }
+      }
+      m_numActiveWindows++;
+    }
+    if (m_windowCallback) {
+      m_windowCallback(m_pending.data() + (size_t)w * m_hopSize, row);
+    }
+  }
+  m_numWindows += numWindows;
+
+  // Drop the samples no later window needs
+  size_t consumed = (size_t)numWindows * m_hopSize;
+  if (consumed > m_pending.size()) {
+    consumed = m_pending.size();
+  }
+  m_pending.erase(m_pending.begin(), m_pending.begin() + consumed);
+  if (m_sideEnabled) {
+    m_pendingSide.erase(m_pendingSide.begin(), m_pendingSide.begin() + consumed);
+  }
+}
@@ -0,0 +1,256 @@
+#include "magda_true_peak.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAGDA_TRUE_PEAK_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MAGDA_TRUE_PEAK_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const int kTapsPerPhase = 12;
+
+// BS.1770-4 Annex 2, 48-tap interpolation filter for 4x, split into phases
+static const float kAnnex2Phases[4][kTapsPerPhase] = {
+    {0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f, -0.0594482421875f,
+     0.1373291015625f, 0.9721679687500f, -0.1022949218750f, 0.0476074218750f, -0.0266113281250f,
+     0.0148925781250f, -0.0083007812500f},
+    {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f, -0.1665039062500f,
+     0.4650878906250f, 0.7797851562500f, -0.2003173828125f, 0.1015625000000f, -0.0582275390625f,
+     0.0330810546875f, -0.0189208984375f},
+    {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f, -0.2003173828125f,
+     0.7797851562500f, 0.4650878906250f, -0.1665039062500f, 0.0891113281250f, -0.0517578125000f,
+     0.0292968750000f, -0.0291748046875f},
+    {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f, -0.1022949218750f,
+     0.9721679687500f, 0.1373291015625f, -0.0594482421875f, 0.0332031250000f, -0.0196533203125f,
+     0.0109863281250f, 0.0017089843750f}};
+
+MagdaTruePeakDetector::MagdaTruePeakDetector(int sampleRate, int channels, int oversampling,
+                                             float overThresholdDb, int maxOvers)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 44100), m_channels(channels < 1 ? 1 : channels),
+      m_factor(oversampling < 1 ? 1 : (oversampling > 32 ? 32 : oversampling)),
+      m_taps(kTapsPerPhase), m_framesProcessed(0), m_maxOvers(maxOvers > 0 ? maxOvers : 0) {
+
+  m_groups = (m_factor + 3) / 4;
+  // Prototype is symmetric around (taps * factor - 1) / 2 upsampled samples
+  m_delay = (double)(m_taps * m_factor - 1) / (2.0 * m_factor);
+  m_threshold = powf(10.0f, overThresholdDb / 20.0f);
+  m_holdFrames = m_sampleRate / 100; // 10 ms
+
+  BuildFilter();
+
+  m_history.assign((size_t)m_channels * (m_taps - 1), 0.0f);
+  m_peaks.assign(m_channels, 0.0f);
+  m_samplePeaks.assign(m_channels, 0.0f);
+  m_runs.resize(m_channels);
+}
+
+void MagdaTruePeakDetector::BuildFilter() {
+  const int stride = m_groups * 4;
+  m_coefs.assign((size_t)m_taps * stride, 0.0f);
+
+  if (m_factor == 4) {
+    for (int p = 0; p < 4; p++) {
+      for (int k = 0; k < m_taps; k++) {
+        m_coefs[k * stride + p] = kAnnex2Phases[p][k];
+      }
+    }
+    return;
+  }
+
+  // Hann-windowed sinc, one phase per output position p / factor; each phase
+  // is normalized to unity gain at DC
+  const double halfSpan = m_taps / 2.0;
+  for (int p = 0; p < m_factor; p++) {
+    double sum = 0.0;
+    for (int k = 0; k < m_taps; k++) {
+      double t = m_delay - k - (double)p / m_factor;
+      double sinc = fabs(t) < 1e-9 ? 1.0 : sin(M_PI * t) / (M_PI * t);
+      double window = fabs(t) < halfSpan ? 0.5 * (1.0 + cos(M_PI * t / halfSpan)) : 0.0;
+      m_coefs[k * stride + p] = (float)(sinc * window);
+      sum += sinc * window;
+    }
+    if (sum != 0.0) {
+      for (int k = 0; k < m_taps; k++) {
+        m_coefs[k * stride + p] = (float)(m_coefs[k * stride + p] / sum);
+      }
+    }
+  }
+}
+
+void MagdaTruePeakDetector::Process(const float *interleaved, int numFrames) {
+  if (!interleaved || numFrames <= 0) {
+    return;
+  }
+
+  const int historyLen = m_taps - 1;
+  m_scratch.resize((size_t)historyLen + numFrames);
+
+  for (int ch = 0; ch < m_channels; ch++) {
+    // History + deinterleaved block, so every tap reads contiguous memory
+    float *history = &m_history[(size_t)ch * historyLen];
+    std::copy(history, history + historyLen, m_scratch.begin());
+    float samplePeak = m_samplePeaks[ch];
+    for (int i = 0; i < numFrames; i++) {
+      float s = interleaved[(size_t)i * m_channels + ch];
+      m_scratch[historyLen + i] = s;
+      samplePeak = std::max(samplePeak, fabsf(s));
+    }
+    m_samplePeaks[ch] = samplePeak;
+
+    ProcessChannel(ch, m_scratch.data(), numFrames);
+
+    std::copy(m_scratch.begin() + numFrames, m_scratch.begin() + numFrames + historyLen, history);
+  }
+
+  m_framesProcessed += numFrames;
+}
+
+void MagdaTruePeakDetector::ProcessChannel(int ch, const float *samples, int numFrames) {
+  const int stride = m_groups * 4;
+  const float *coefs = m_coefs.data();
+  const float *x = samples + (m_taps - 1); // x[n - k] = x[n] - k taps back
+
+#if defined(MAGDA_TRUE_PEAK_SSE2)
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 threshold = _mm_set1_ps(m_threshold);
+  __m128 peak = _mm_set1_ps(m_peaks[ch]);
+
+  for (int n = 0; n < numFrames; n++) {
+    for (int g = 0; g < m_groups; g++) {
+      __m128 acc = _mm_setzero_ps();
+      for (int k = 0; k < m_taps; k++) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(coefs + k * stride + g * 4),
+                                         _mm_set1_ps(x[n - k])));
+      }
+      acc = _mm_and_ps(acc, absMask);
+      peak = _mm_max_ps(peak, acc);
+      if (_mm_movemask_ps(_mm_cmpgt_ps(acc, threshold))) {
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        for (int lane = 0; lane < 4 && g * 4 + lane < m_factor; lane++) {
+          if (lanes[lane] > m_threshold) {
+            OnOver(ch, m_framesProcessed + n, g * 4 + lane, lanes[lane]);
+          }
+        }
+      }
+    }
+  }
+
+  float lanes[4];
+  _mm_storeu_ps(lanes, peak);
+  m_peaks[ch] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(MAGDA_TRUE_PEAK_NEON)
+  const float32x4_t threshold = vdupq_n_f32(m_threshold);
+  float32x4_t peak = vdupq_n_f32(m_peaks[ch]);
+
+  for (int n = 0; n < numFrames; n++) {
+    for (int g = 0; g < m_groups; g++) {
+      float32x4_t acc = vdupq_n_f32(0.0f);
+      for (int k = 0; k < m_taps; k++) {
+        acc = vmlaq_n_f32(acc, vld1q_f32(coefs + k * stride + g * 4), x[n - k]);
+      }
+      acc = vabsq_f32(acc);
+      peak = vmaxq_f32(peak, acc);
+      uint32x4_t over = vcgtq_f32(acc, threshold);
+      if (vgetq_lane_u32(over, 0) | vgetq_lane_u32(over, 1) | vgetq_lane_u32(over, 2) |
+          vgetq_lane_u32(over, 3)) {
+        float lanes[4];
+        vst1q_f32(lanes, acc);
+        for (int lane = 0; lane < 4 && g * 4 + lane < m_factor; lane++) {
+          if (lanes[lane] > m_threshold) {
+            OnOver(ch, m_framesProcessed + n, g * 4 + lane, lanes[lane]);
+          }
+        }
+      }
+    }
+  }
+
+  float lanes[4];
+  vst1q_f32(lanes, peak);
+  m_peaks[ch] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#else
+  float peak = m_peaks[ch];
+  for (int n = 0; n < numFrames; n++) {
+    for (int p = 0; p < m_factor; p++) {
+      float acc = 0.0f;
+      for (int k = 0; k < m_taps; k++) {
+        acc += coefs[k * stride + p] * x[n - k];
+      }
+      acc = fabsf(acc);
+      peak = std::max(peak, acc);
+      if (acc > m_threshold) {
+        OnOver(ch, m_framesProcessed + n, p, acc);
+      }
+    }
+  }
+  m_peaks[ch] = peak;
+#endif
+}
+
+void MagdaTruePeakDetector::OnOver(int ch, long long frame, int phase, float value) {
+  if (m_maxOvers == 0) {
+    return;
+  }
+
+  OverRun &run = m_runs[ch];
+  if (run.active && frame - run.lastFrame > m_holdFrames) {
+    InsertOver(m_overs, CloseRun(ch, run), m_maxOvers);
+    run.active = false;
+  }
+
+  if (!run.active || value > run.level) {
+    double position = (double)frame - m_delay + (double)phase / m_factor;
+    run.time = position > 0.0 ? position / m_sampleRate : 0.0;
+    run.level = value;
+  }
+  run.active = true;
+  run.lastFrame = frame;
+}
+
+TruePeakOver MagdaTruePeakDetector::CloseRun(int ch, const OverRun &run) const {
+  TruePeakOver over;
+  over.time = run.time;
+  over.level = 20.0f * log10f(run.level);
+  over.channel = ch;
+  return over;
+}
+
+void MagdaTruePeakDetector::InsertOver(std::vector<TruePeakOver> &overs,
+                                       const TruePeakOver &over, int maxOvers) {
+  // Kept sorted loudest first and capped at maxOvers
+  auto it = std::find_if(overs.begin(), overs.end(),
+                         [&](const TruePeakOver &o) { return over.level > o.level; });
+  if (it == overs.end() && (int)overs.size() >= maxOvers) {
+    return;
+  }
+  overs.insert(it, over);
+  if ((int)overs.size() > maxOvers) {
+    overs.pop_back();
+  }
+}
+
+float MagdaTruePeakDetector::GetTruePeak() const {
+  float peak = 0.0f;
+  for (int ch = 0; ch < m_channels; ch++) {
+    // The interpolation filter can undershoot right at the sample points
+    peak = std::max(peak, std::max(m_peaks[ch], m_samplePeaks[ch]));
+  }
+  return peak;
+}
+
+std::vector<TruePeakOver> MagdaTruePeakDetector::GetOvers() const {
+  std::vector<TruePeakOver> overs = m_overs;
+  for (int ch = 0; ch < m_channels; ch++) {
+    if (m_runs[ch].active) {
+      InsertOver(overs, CloseRun(ch, m_runs[ch]), m_maxOvers);
+    }
+  }
+  return overs;
+}
@@ -4,16 +4,20 @@
 #include "../dsl/magda_drummer_grammar.h"
 #include "../dsl/magda_dsl_grammar.h"
 #include "../dsl/magda_jsfx_grammar.h"
+#include "magda_dsl_stream.h"
 #include "reaper_plugin.h"
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
-#include <mutex>
-#include <thread>
 
 extern reaper_plugin_info_t *g_rec;
 
 #ifndef _WIN32
+#include "magda_http_pool.h"
+#include "magda_http_reactor.h"
+#include <condition_variable>
 #include <curl/curl.h>
+#include <mutex>
 #endif
 
 // ============================================================================
@@ -58,10 +62,16 @@ static void EscapeJSON(const char *input, WDL_FastString &output) {
   }
 }
 
+// Time elapsed since start, for OrchestrationStats
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
 // ============================================================================
 // MagdaAgentManager Implementation
 // ============================================================================
-MagdaAgentManager::MagdaAgentManager() : m_timeout_seconds(60) {}
+MagdaAgentManager::MagdaAgentManager() : m_timeout_seconds(60), m_speculative(true) {}
 MagdaAgentManager::~MagdaAgentManager() {}
 
 void MagdaAgentManager::SetAPIKey(const char *api_key) {
@@ -76,26 +86,23 @@ bool MagdaAgentManager::HasAPIKey() const {
 // ============================================================================
 // Agent Detection (gpt-4.1-mini)
 // ============================================================================
-bool MagdaAgentManager::DetectAgents(const char *question, AgentDetection &result,
-                                     WDL_FastString &error) {
-  if (!HasAPIKey()) {
-    error.Set("API key not set");
-    return false;
-  }
-
-  // Default: always DAW
-  result.needsDAW = true;
-  result.needsArranger = false;
-  result.needsDrummer = false;
-  result.needsJSFX = false;
+bool MagdaAgentManager::IsJSFXQuestion(const char *question) {
+  return strstr(question, "jsfx") || strstr(question, "JSFX") || strstr(question, "effect") ||
+         strstr(question, "plugin");
+}
 
-  // Quick keyword detection first
-  if (strstr(question, "jsfx") || strstr(question, "JSFX") || strstr(question, "effect") ||
-      strstr(question, "plugin")) {
-    result.needsJSFX = true;
-    return true;
+void MagdaAgentManager::GuessAgents(const char *question, AgentDetection &result) {
+  if (strstr(question, "chord") || strstr(question, "arpeggio") || strstr(question, "melody") ||
+      strstr(question, "note") || strstr(question, "bass")) {
+    result.needsArranger = true;
+  }
+  if (strstr(question, "drum") || strstr(question, "beat") || strstr(question, "kick") ||
+      strstr(question, "snare") || strstr(question, "groove") || strstr(question, "rhythm")) {
+    result.needsDrummer = true;
   }
+}
 
+void MagdaAgentManager::BuildDetectionRequest(const char *question, WDL_FastString &json) {
   // Build classification prompt
   const char *classifyPrompt =
       R"(You are a router for a music production AI. Classify which agents are needed.
@@ -117,7 +124,7 @@ EXAMPLES:
 
 Return ONLY JSON: {"needsArranger": bool, "needsDrummer": bool})";
 
-  WDL_FastString json, escaped;
+  WDL_FastString escaped;
   json.Set("{");
   json.Append("\"model\":\"gpt-4.1-mini\",");
   json.Append("\"input\":[{\"role\":\"user\",\"content\":\"");
@@ -131,25 +138,11 @@ Return ONLY JSON: {"needsArranger": bool, "needsDrummer": bool})";
   json.Append("\"reasoning\":{\"effort\":\"minimal\"},");
   json.Append("\"text\":{\"format\":{\"type\":\"json_object\"}}");
   json.Append("}");
+}
 
-  WDL_FastString response;
-  if (!SendHTTPSRequest("https://api.openai.com/v1/responses", json.Get(), json.GetLength(),
-                        response, error)) {
-    // Fallback: keyword detection
-    if (strstr(question, "chord") || strstr(question, "arpeggio") || strstr(question, "melody") ||
-        strstr(question, "note") || strstr(question, "bass")) {
-      result.needsArranger = true;
-    }
-    if (strstr(question, "drum") || strstr(question, "beat") || strstr(question, "kick") ||
-        strstr(question, "snare") || strstr(question, "groove") || strstr(question, "rhythm")) {
-      result.needsDrummer = true;
-    }
-    return true; // Use fallback
-  }
-
-  // Parse response to extract classification
+void MagdaAgentManager::ParseDetection(const char *response, int len, AgentDetection &result) {
   wdl_json_parser parser;
-  wdl_json_element *root = parser.parse(response.Get(), response.GetLength());
+  wdl_json_element *root = parser.parse(response, len);
   if (!parser.m_err && root) {
     // Navigate to output[0].content[0].text
     wdl_json_element *output = root->get_item_by_name("output");
@@ -182,8 +175,9 @@ Return ONLY JSON: {"needsArranger": bool, "needsDrummer": bool})";
       }
     }
   }
+}
 
-  // Log detection result
+void MagdaAgentManager::LogDetection(const AgentDetection &result) {
   if (g_rec) {
     void (*ShowConsoleMsg)(const char *) = (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
     if (ShowConsoleMsg) {
@@ -193,7 +187,41 @@ Return ONLY JSON: {"needsArranger": bool, "needsDrummer": bool})";
       ShowConsoleMsg(msg);
     }
   }
+}
+
+bool MagdaAgentManager::DetectAgents(const char *question, AgentDetection &result,
+                                     WDL_FastString &error) {
+  if (!HasAPIKey()) {
+    error.Set("API key not set");
+    return false;
+  }
+
+  // Default: always DAW
+  result.needsDAW = true;
+  result.needsArranger = false;
+  result.needsDrummer = false;
+  result.needsJSFX = false;
+
+  // Quick keyword detection first
+  if (IsJSFXQuestion(question)) {
+    result.needsJSFX = true;
+    return true;
+  }
+
+  WDL_FastString json;
+  BuildDetectionRequest(question, json);
+
+  WDL_FastString response;
+  if (!SendHTTPSRequest("https://api.openai.com/v1/responses", json.Get(), json.GetLength(),
+                        response, error)) {
+    // Fallback: keyword detection
+    GuessAgents(question, result);
+    return true; // Use fallback
+  }
 
+  // Parse response to extract classification
+  ParseDetection(response.Get(), response.GetLength(), result);
+  LogDetection(result);
   return true;
 }
 
@@ -202,10 +230,14 @@ Return ONLY JSON: {"needsArranger": bool, "needsDrummer": bool})";
 // ============================================================================
 char *MagdaAgentManager::BuildAgentRequest(const char *model, const char *question,
                                            const char *system_prompt, const char *tool_name,
-                                           const char *tool_description, const char *grammar) {
+                                           const char *tool_description, const char *grammar,
+                                           bool stream) {
   WDL_FastString json, escaped;
 
   json.Set("{");
+  if (stream) {
+    json.Append("\"stream\":true,");
+  }
   json.Append("\"model\":\"");
   json.Append(model);
   json.Append("\",");
@@ -329,49 +361,342 @@ static size_t CurlWriteCallback(void *contents, size_t size, size_t nmemb, void
 
 bool MagdaAgentManager::SendHTTPSRequest(const char *url, const char *post_data, int post_data_len,
                                          WDL_FastString &response, WDL_FastString &error) {
-  CURL *curl = curl_easy_init();
-  if (!curl) {
-    error.Set("Failed to init curl");
-    return false;
-  }
-
-  CurlWriteData writeData;
-  writeData.response = &response;
+  HTTPSCall call = {post_data, post_data_len, &response, &error, false};
+  SendHTTPSRequests(url, &call, 1);
+  return call.success;
+}
 
+// Set up curl to POST post_data to url, appending the reply to
+// writeData->response. Returns the header list to free after the transfer.
+static struct curl_slist *ConfigurePOST(CURL *curl, const char *url, const char *auth,
+                                        const char *post_data, int post_data_len,
+                                        long timeout_seconds, CurlWriteData *writeData) {
   curl_easy_setopt(curl, CURLOPT_URL, url);
   curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
   curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, post_data_len);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlWriteCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writeData);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, writeData);
   curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
   curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-  curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)m_timeout_seconds);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_seconds);
 
   struct curl_slist *headers = nullptr;
   headers = curl_slist_append(headers, "Content-Type: application/json");
-  char auth[512];
-  snprintf(auth, sizeof(auth), "Authorization: Bearer %s", m_api_key.Get());
   headers = curl_slist_append(headers, auth);
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  return headers;
+}
+
+// True for an HTTP 200 reply; otherwise describes the failure in error
+static bool CheckPOSTResult(CURL *curl, CURLcode result, const WDL_FastString &response,
+                            WDL_FastString &error) {
+  if (result != CURLE_OK) {
+    error.Set(curl_easy_strerror(result));
+    return false;
+  }
+  long code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+  if (code != 200) {
+    error.SetFormatted(512, "HTTP %ld: %.200s", code, response.Get());
+    return false;
+  }
+  return true;
+}
+
+void MagdaAgentManager::SendHTTPSRequests(const char *url, HTTPSCall *calls, int count) {
+  std::vector<CURL *> handles(count, nullptr);
+  std::vector<struct curl_slist *> headerLists(count, nullptr);
+  std::vector<CurlWriteData> writeData(count);
+
+  char auth[512];
+  snprintf(auth, sizeof(auth), "Authorization: Bearer %s", m_api_key.Get());
+
+  for (int i = 0; i < count; i++) {
+    calls[i].success = false;
+    CURL *curl = MagdaHTTPPool::Get().Acquire();
+    if (!curl) {
+      calls[i].error->Set("Failed to init curl");
+      continue;
+    }
+    writeData[i].response = calls[i].response;
+    headerLists[i] = ConfigurePOST(curl, url, auth, calls[i].post_data, calls[i].post_data_len,
+                                   (long)m_timeout_seconds, &writeData[i]);
+    handles[i] = curl;
+  }
+
+  // All transfers share the network thread; none needs a thread of its own
+  std::vector<CURLcode> results(count, CURLE_FAILED_INIT);
+  MagdaHTTPReactor::Get().PerformAll(handles.data(), count, results.data());
+
+  for (int i = 0; i < count; i++) {
+    if (!handles[i]) {
+      continue;
+    }
+    calls[i].success = CheckPOSTResult(handles[i], results[i], *calls[i].response, *calls[i].error);
+    curl_slist_free_all(headerLists[i]);
+    MagdaHTTPPool::Get().Release(handles[i]);
+  }
+}
+// A streamed agent reply (server-sent events). The grammar tool's input
+// arrives in pieces, which are split into statements as each completes.
+struct AgentStreamData {
+  WDL_FastString *response; // Raw body, for error messages
+  std::string line;
+  WDL_FastString dsl;
+  WDL_FastString error;
+  MagdaDSL::StatementStream statements;
+  MagdaAgentManager::StatementCallback onStatement;
+  bool completed = false;
+};
+
+static void DeliverStatements(AgentStreamData *data, std::vector<std::string> &statements) {
+  for (const std::string &statement : statements) {
+    data->onStatement(statement.c_str());
+  }
+  statements.clear();
+}
+
+static void HandleAgentStreamEvent(AgentStreamData *data, const char *json) {
+  wdl_json_parser parser;
+  wdl_json_element *root = parser.parse(json, (int)strlen(json));
+  if (parser.m_err || !root) {
+    return;
+  }
+  wdl_json_element *type = root->get_item_by_name("type");
+  if (!type || !type->m_value_string || !type->m_value) {
+    return;
+  }
+
+  std::vector<std::string> statements;
+  if (strcmp(type->m_value, "response.custom_tool_call_input.delta") == 0) {
+    wdl_json_element *delta = root->get_item_by_name("delta");
+    if (delta && delta->m_value_string && delta->m_value) {
+      data->dsl.Append(delta->m_value);
+      data->statements.Feed(delta->m_value, statements);
+      DeliverStatements(data, statements);
+    }
+  } else if (strcmp(type->m_value, "response.completed") == 0) {
+    data->completed = true;
+    data->statements.Finish(statements);
+    DeliverStatements(data, statements);
+  } else if (strcmp(type->m_value, "response.failed") == 0) {
+    wdl_json_element *response = root->get_item_by_name("response");
+    wdl_json_element *error = response ? response->get_item_by_name("error") : nullptr;
+    wdl_json_element *message = error ? error->get_item_by_name("message") : nullptr;
+    if (message && message->m_value) {
+      data->error.Set(message->m_value);
+    }
+  } else if (strcmp(type->m_value, "error") == 0) {
+    wdl_json_element *message = root->get_item_by_name("message");
+    if (message && message->m_value) {
+      data->error.Set(message->m_value);
+    }
+  }
+}
+
+// Runs on the reactor thread
+static size_t AgentStreamCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+  size_t realsize = size * nmemb;
+  AgentStreamData *data = (AgentStreamData *)userp;
+  const char *ptr = (const char *)contents;
+  data->response->Append(ptr, (int)realsize);
+  for (size_t i = 0; i < realsize; i++) {
+    if (ptr[i] == '\n') {
+      if (data->line.compare(0, 6, "data: ") == 0) {
+        HandleAgentStreamEvent(data, data->line.c_str() + 6);
+      }
+      data->line.clear();
+    } else if (ptr[i] != '\r') {
+      data->line += ptr[i];
+    }
+  }
+  return realsize;
+}
+
+// A detection or agent POST in flight during OrchestrateSpeculative()
+struct SpeculativeCall {
+  char *request = nullptr; // Agent request JSON (malloc'd)
+  const char *toolName = nullptr;
+  CURL *curl = nullptr;
+  struct curl_slist *headers = nullptr;
+  CurlWriteData writeData = {nullptr};
+  WDL_FastString response;
+  WDL_FastString error;
+  AgentStreamData *stream = nullptr; // Set for a streamed agent
+  bool launched = false;
+  int id = 0; // Reactor transfer, 0 if it never started
+  double startMs = 0.0;
+  // Set on the reactor thread, under the waiter's mutex
+  bool finished = false;
+  CURLcode result = CURLE_FAILED_INIT;
+  double endMs = 0.0;
+};
 
-  CURLcode res = curl_easy_perform(curl);
-  bool success = false;
+void MagdaAgentManager::OrchestrateSpeculative(const char *question, const char *state_json,
+                                               std::vector<AgentResult> &results,
+                                               OrchestrationStats &stats,
+                                               const StatementCallback &onStatement) {
+  enum { kDetect, kDAW, kArranger, kDrummer, kNumCalls };
+  const AgentType agentTypes[kNumCalls] = {AgentType::DAW, AgentType::DAW, AgentType::Arranger,
+                                           AgentType::Drummer};
+  const char *url = "https://api.openai.com/v1/responses";
+  auto start = std::chrono::steady_clock::now();
 
-  if (res == CURLE_OK) {
-    long code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
-    if (code == 200) {
-      success = true;
+  SpeculativeCall calls[kNumCalls];
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  char auth[512];
+  snprintf(auth, sizeof(auth), "Authorization: Bearer %s", m_api_key.Get());
+
+  // Start calls[i]; one that can't start counts as finished straight away
+  auto launch = [&](int i, const char *body, int len) {
+    SpeculativeCall &call = calls[i];
+    call.launched = true;
+    call.startMs = MillisecondsSince(start);
+    call.curl = body ? MagdaHTTPPool::Get().Acquire() : nullptr;
+    if (call.curl) {
+      call.writeData.response = &call.response;
+      call.headers = ConfigurePOST(call.curl, url, auth, body, len, (long)m_timeout_seconds,
+                                   &call.writeData);
+      if (call.stream) {
+        call.stream->response = &call.response;
+        curl_easy_setopt(call.curl, CURLOPT_WRITEFUNCTION, AgentStreamCallback);
+        curl_easy_setopt(call.curl, CURLOPT_WRITEDATA, call.stream);
+      }
+      call.id = MagdaHTTPReactor::Get().Launch(call.curl, [&, i](CURLcode result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        calls[i].result = result;
+        calls[i].endMs = MillisecondsSince(start);
+        calls[i].finished = true;
+        changed.notify_all();
+      });
+    } else if (body) {
+      call.error.Set("Failed to init curl");
+    }
+    if (!call.id) {
+      std::lock_guard<std::mutex> lock(mutex);
+      call.result = CURLE_ABORTED_BY_CALLBACK;
+      call.endMs = call.startMs;
+      call.finished = true;
+    }
+  };
+  auto launchAgent = [&](int i) {
+    calls[i].request = BuildRequestFor(agentTypes[i], question, state_json, &calls[i].toolName,
+                                       calls[i].stream != nullptr);
+    if (!calls[i].request) {
+      calls[i].error.Set("Failed to build request");
+    }
+    launch(i, calls[i].request, calls[i].request ? (int)strlen(calls[i].request) : 0);
+  };
+
+  // Detection and DAW go out together, and Arranger/Drummer too when the
+  // question's keywords suggest them
+  AgentDetection guess;
+  GuessAgents(question, guess);
+  WDL_FastString detectJSON;
+  BuildDetectionRequest(question, detectJSON);
+  launch(kDetect, detectJSON.Get(), detectJSON.GetLength());
+  // The DAW program streams so its statements can run as they complete
+  AgentStreamData dawStream;
+  if (onStatement) {
+    dawStream.onStatement = onStatement;
+    calls[kDAW].stream = &dawStream;
+  }
+  launchAgent(kDAW);
+  if (guess.needsArranger) {
+    launchAgent(kArranger);
+    stats.speculated++;
+  }
+  if (guess.needsDrummer) {
+    launchAgent(kDrummer);
+    stats.speculated++;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return calls[kDetect].finished; });
+  }
+
+  // Same fallback as DetectAgents() when detection fails
+  AgentDetection detection = guess;
+  SpeculativeCall &detect = calls[kDetect];
+  if (detect.curl && CheckPOSTResult(detect.curl, detect.result, detect.response, detect.error)) {
+    detection.needsArranger = false;
+    detection.needsDrummer = false;
+    ParseDetection(detect.response.Get(), detect.response.GetLength(), detection);
+    LogDetection(detection);
+  }
+  stats.detectMs = detect.endMs - detect.startMs;
+
+  // Start what detection adds, cancel what it rules out
+  const bool needed[kNumCalls] = {false, true, detection.needsArranger, detection.needsDrummer};
+  for (int i = kArranger; i <= kDrummer; i++) {
+    if (needed[i] && !calls[i].launched) {
+      launchAgent(i);
+      stats.late++;
+    } else if (!needed[i] && calls[i].launched) {
+      MagdaHTTPReactor::Get().Cancel(calls[i].id);
+      stats.cancelled++;
+    }
+  }
+
+  // Cancelled transfers finish too; every handle is idle after this
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() {
+      for (const SpeculativeCall &call : calls) {
+        if (call.launched && !call.finished) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  double slowestMs = 0.0;
+  for (int i = kDAW; i < kNumCalls; i++) {
+    SpeculativeCall &call = calls[i];
+    if (!needed[i]) {
+      continue;
+    }
+    AgentResult result;
+    result.agentType = agentTypes[i];
+    WDL_FastString dsl;
+    bool received = call.curl && CheckPOSTResult(call.curl, call.result, call.response, call.error);
+    if (call.stream) {
+      // Statements already went out; keep the program for the log
+      result.streamed = true;
+      if (received && !call.stream->completed) {
+        call.error.Set(call.stream->error.GetLength() > 0 ? call.stream->error.Get()
+                                                          : "Stream ended early");
+        received = false;
+      }
+      dsl.Set(call.stream->dsl.Get());
+      result.success = received && dsl.GetLength() > 0;
     } else {
-      error.SetFormatted(512, "HTTP %ld: %.200s", code, response.Get());
+      result.success = received && ExtractDSL(call.response.Get(), call.response.GetLength(),
+                                              call.toolName, dsl, call.error);
     }
-  } else {
-    error.Set(curl_easy_strerror(res));
+    result.dslCode = dsl.Get();
+    result.error = call.error.Get();
+    results.push_back(result);
+    if (call.endMs - call.startMs > slowestMs) {
+      slowestMs = call.endMs - call.startMs;
+    }
+  }
+
+  for (SpeculativeCall &call : calls) {
+    if (call.curl) {
+      curl_slist_free_all(call.headers);
+      MagdaHTTPPool::Get().Release(call.curl);
+    }
+    free(call.request);
   }
 
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
-  return success;
+  stats.speculative = true;
+  stats.totalMs = MillisecondsSince(start);
+  stats.serialMs = stats.detectMs + slowestMs;
 }
 #else
 // Windows implementation would go here
@@ -380,23 +705,87 @@ bool MagdaAgentManager::SendHTTPSRequest(const char *url, const char *post_data,
   error.Set("Windows not implemented yet");
   return false;
 }
+
+void MagdaAgentManager::SendHTTPSRequests(const char *url, HTTPSCall *calls, int count) {
+  (void)url;
+  for (int i = 0; i < count; i++) {
+    calls[i].success = false;
+    calls[i].error->Set("Windows not implemented yet");
+  }
+}
+
+void MagdaAgentManager::OrchestrateSpeculative(const char *question, const char *state_json,
+                                               std::vector<AgentResult> &results,
+                                               OrchestrationStats &stats,
+                                               const StatementCallback &onStatement) {
+  // No network thread to overlap on yet; detect first. The DAW program
+  // only arrives whole here, so its statements go to onStatement once it is
+  // in rather than while it is generated.
+  auto start = std::chrono::steady_clock::now();
+  AgentDetection detection;
+  WDL_FastString error;
+  DetectAgents(question, detection, error);
+  stats.detectMs = MillisecondsSince(start);
+  RunAgents(detection, question, state_json, results);
+  stats.totalMs = MillisecondsSince(start);
+  stats.serialMs = stats.totalMs;
+
+  if (!onStatement) {
+    return;
+  }
+  for (AgentResult &result : results) {
+    if (result.agentType != AgentType::DAW || !result.success) {
+      continue;
+    }
+    std::vector<std::string> statements;
+    MagdaDSL::StatementStream stream;
+    stream.Feed(result.dslCode.c_str(), statements);
+    stream.Finish(statements);
+    for (const std::string &statement : statements) {
+      onStatement(statement.c_str());
+    }
+    result.streamed = true;
+  }
+}
 #endif
 
 // ============================================================================
 // Agent Generators
 // ============================================================================
-bool MagdaAgentManager::GenerateDAW(const char *question, const char *state_json,
-                                    WDL_FastString &out_dsl, WDL_FastString &error) {
-  // Build system prompt with state
-  WDL_FastString prompt;
-  prompt.Set(MAGDA_DSL_TOOL_DESCRIPTION);
-  if (state_json && *state_json) {
-    prompt.Append("\n\nCurrent REAPER state:\n");
-    prompt.Append(state_json);
+char *MagdaAgentManager::BuildRequestFor(AgentType type, const char *question,
+                                         const char *state_json, const char **tool_name,
+                                         bool stream) {
+  switch (type) {
+  case AgentType::DAW: {
+    // Build system prompt with state
+    WDL_FastString prompt;
+    prompt.Set(MAGDA_DSL_TOOL_DESCRIPTION);
+    if (state_json && *state_json) {
+      prompt.Append("\n\nCurrent REAPER state:\n");
+      prompt.Append(state_json);
+    }
+    *tool_name = "magda_dsl";
+    return BuildAgentRequest("gpt-5.1", question, prompt.Get(), *tool_name,
+                             MAGDA_DSL_TOOL_DESCRIPTION, MAGDA_DSL_GRAMMAR, stream);
   }
+  case AgentType::Arranger:
+    *tool_name = "arranger_dsl";
+    return BuildAgentRequest("gpt-5.1", question, ARRANGER_TOOL_DESCRIPTION, *tool_name,
+                             ARRANGER_TOOL_DESCRIPTION, ARRANGER_DSL_GRAMMAR, stream);
+  case AgentType::Drummer:
+    *tool_name = "drummer_dsl";
+    return BuildAgentRequest("gpt-5.1", question, DRUMMER_TOOL_DESCRIPTION, *tool_name,
+                             DRUMMER_TOOL_DESCRIPTION, DRUMMER_DSL_GRAMMAR, stream);
+  default:
+    return nullptr;
+  }
+}
 
-  char *request = BuildAgentRequest("gpt-5.1", question, prompt.Get(), "magda_dsl",
-                                    MAGDA_DSL_TOOL_DESCRIPTION, MAGDA_DSL_GRAMMAR);
+bool MagdaAgentManager::GenerateWithAgent(AgentType type, const char *question,
+                                          const char *state_json, WDL_FastString &out_dsl,
+                                          WDL_FastString &error) {
+  const char *tool_name = nullptr;
+  char *request = BuildRequestFor(type, question, state_json, &tool_name);
   if (!request) {
     error.Set("Failed to build request");
     return false;
@@ -409,45 +798,22 @@ bool MagdaAgentManager::GenerateDAW(const char *question, const char *state_json
 
   if (!success)
     return false;
-  return ExtractDSL(response.Get(), response.GetLength(), "magda_dsl", out_dsl, error);
+  return ExtractDSL(response.Get(), response.GetLength(), tool_name, out_dsl, error);
+}
+
+bool MagdaAgentManager::GenerateDAW(const char *question, const char *state_json,
+                                    WDL_FastString &out_dsl, WDL_FastString &error) {
+  return GenerateWithAgent(AgentType::DAW, question, state_json, out_dsl, error);
 }
 
 bool MagdaAgentManager::GenerateArranger(const char *question, WDL_FastString &out_dsl,
                                          WDL_FastString &error) {
-  char *request = BuildAgentRequest("gpt-5.1", question, ARRANGER_TOOL_DESCRIPTION, "arranger_dsl",
-                                    ARRANGER_TOOL_DESCRIPTION, ARRANGER_DSL_GRAMMAR);
-  if (!request) {
-    error.Set("Failed to build request");
-    return false;
-  }
-
-  WDL_FastString response;
-  bool success = SendHTTPSRequest("https://api.openai.com/v1/responses", request,
-                                  (int)strlen(request), response, error);
-  free(request);
-
-  if (!success)
-    return false;
-  return ExtractDSL(response.Get(), response.GetLength(), "arranger_dsl", out_dsl, error);
+  return GenerateWithAgent(AgentType::Arranger, question, nullptr, out_dsl, error);
 }
 
 bool MagdaAgentManager::GenerateDrummer(const char *question, WDL_FastString &out_dsl,
                                         WDL_FastString &error) {
-  char *request = BuildAgentRequest("gpt-5.1", question, DRUMMER_TOOL_DESCRIPTION, "drummer_dsl",
-                                    DRUMMER_TOOL_DESCRIPTION, DRUMMER_DSL_GRAMMAR);
-  if (!request) {
-    error.Set("Failed to build request");
-    return false;
-  }
-
-  WDL_FastString response;
-  bool success = SendHTTPSRequest("https://api.openai.com/v1/responses", request,
-                                  (int)strlen(request), response, error);
-  free(request);
-
-  if (!success)
-    return false;
-  return ExtractDSL(response.Get(), response.GetLength(), "drummer_dsl", out_dsl, error);
+  return GenerateWithAgent(AgentType::Drummer, question, nullptr, out_dsl, error);
 }
 
 bool MagdaAgentManager::GenerateJSFX(const char *question, const char *existing_code,
@@ -477,64 +843,115 @@ bool MagdaAgentManager::GenerateJSFX(const char *question, const char *existing_
 }
 
 // ============================================================================
-// Orchestrate - Run agents in parallel
+// Orchestrate - Run agents concurrently
 // ============================================================================
-bool MagdaAgentManager::Orchestrate(const char *question, const char *state_json,
-                                    std::vector<AgentResult> &results, WDL_FastString &error) {
-  // Step 1: Detect which agents are needed
-  AgentDetection detection;
-  if (!DetectAgents(question, detection, error)) {
-    return false;
+void MagdaAgentManager::FormatStats(const OrchestrationStats &stats, char *buf, int bufSize) {
+  if (!buf || bufSize <= 0) {
+    return;
+  }
+  if (!stats.speculative) {
+    snprintf(buf, bufSize, "%.1f s, detect %.1f s", stats.totalMs / 1000.0,
+             stats.detectMs / 1000.0);
+    return;
   }
+  double savedMs = stats.serialMs > stats.totalMs ? stats.serialMs - stats.totalMs : 0.0;
+  int len = snprintf(buf, bufSize, "%.1f s, detect %.1f s overlapped, saved %.1f s",
+                     stats.totalMs / 1000.0, stats.detectMs / 1000.0, savedMs / 1000.0);
+  if (stats.cancelled > 0 && len > 0 && len < bufSize) {
+    snprintf(buf + len, bufSize - len, ", %d cancelled", stats.cancelled);
+  }
+}
 
-  // Step 2: Run agents (DAW always runs)
-  std::mutex resultsMutex;
-  std::vector<std::thread> threads;
+void MagdaAgentManager::RunAgents(const AgentDetection &detection, const char *question,
+                                  const char *state_json, std::vector<AgentResult> &results) {
+  // DAW always runs. The requests go out together on the network thread, so
+  // this takes as long as the slowest agent.
+  std::vector<AgentType> agents;
+  agents.push_back(AgentType::DAW);
+  if (detection.needsArranger) {
+    agents.push_back(AgentType::Arranger);
+  }
+  if (detection.needsDrummer) {
+    agents.push_back(AgentType::Drummer);
+  }
 
-  // DAW Agent
-  threads.emplace_back([&]() {
+  int count = (int)agents.size();
+  std::vector<char *> requests(count, nullptr);
+  std::vector<const char *> toolNames(count, nullptr);
+  std::vector<WDL_FastString> responses(count);
+  std::vector<WDL_FastString> errors(count);
+  std::vector<HTTPSCall> calls;
+  std::vector<int> callAgent; // Index into agents for each call
+  for (int i = 0; i < count; i++) {
+    requests[i] = BuildRequestFor(agents[i], question, state_json, &toolNames[i]);
+    if (!requests[i]) {
+      errors[i].Set("Failed to build request");
+      continue;
+    }
+    calls.push_back({requests[i], (int)strlen(requests[i]), &responses[i], &errors[i], false});
+    callAgent.push_back(i);
+  }
+
+  SendHTTPSRequests("https://api.openai.com/v1/responses", calls.data(), (int)calls.size());
+
+  std::vector<bool> sent(count, false);
+  for (size_t c = 0; c < calls.size(); c++) {
+    sent[callAgent[c]] = calls[c].success;
+  }
+
+  for (int i = 0; i < count; i++) {
     AgentResult result;
-    result.agentType = AgentType::DAW;
-    WDL_FastString dsl, err;
-    result.success = GenerateDAW(question, state_json, dsl, err);
+    result.agentType = agents[i];
+    WDL_FastString dsl;
+    result.success = sent[i] && ExtractDSL(responses[i].Get(), responses[i].GetLength(),
+                                           toolNames[i], dsl, errors[i]);
     result.dslCode = dsl.Get();
-    result.error = err.Get();
-    std::lock_guard<std::mutex> lock(resultsMutex);
+    result.error = errors[i].Get();
     results.push_back(result);
-  });
+    free(requests[i]);
+  }
+}
 
-  // Arranger Agent
-  if (detection.needsArranger) {
-    threads.emplace_back([&]() {
-      AgentResult result;
-      result.agentType = AgentType::Arranger;
-      WDL_FastString dsl, err;
-      result.success = GenerateArranger(question, dsl, err);
-      result.dslCode = dsl.Get();
-      result.error = err.Get();
-      std::lock_guard<std::mutex> lock(resultsMutex);
-      results.push_back(result);
-    });
+bool MagdaAgentManager::Orchestrate(const char *question, const char *state_json,
+                                    std::vector<AgentResult> &results, WDL_FastString &error,
+                                    OrchestrationStats *stats, StatementCallback onStatement) {
+  OrchestrationStats localStats;
+  OrchestrationStats &timing = stats ? *stats : localStats;
+  timing = OrchestrationStats();
+  auto start = std::chrono::steady_clock::now();
+
+  if (!HasAPIKey()) {
+    error.Set("API key not set");
+    return false;
   }
 
-  // Drummer Agent
-  if (detection.needsDrummer) {
-    threads.emplace_back([&]() {
-      AgentResult result;
-      result.agentType = AgentType::Drummer;
-      WDL_FastString dsl, err;
-      result.success = GenerateDrummer(question, dsl, err);
-      result.dslCode = dsl.Get();
-      result.error = err.Get();
-      std::lock_guard<std::mutex> lock(resultsMutex);
-      results.push_back(result);
-    });
+  if (m_speculative && !IsJSFXQuestion(question)) {
+    // Generators start alongside detection
+    OrchestrateSpeculative(question, state_json, results, timing, onStatement);
+  } else {
+    // Step 1: Detect which agents are needed
+    AgentDetection detection;
+    if (!DetectAgents(question, detection, error)) {
+      return false;
+    }
+    timing.detectMs = MillisecondsSince(start);
+
+    // Step 2: Run agents
+    RunAgents(detection, question, state_json, results);
+    timing.totalMs = MillisecondsSince(start);
+    timing.serialMs = timing.totalMs;
   }
 
-  // Wait for all threads
-  for (auto &t : threads) {
-    if (t.joinable())
-      t.join();
+  if (g_rec) {
+    void (*ShowConsoleMsg)(const char *) = (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+    if (ShowConsoleMsg) {
+      char summary[128];
+      FormatStats(timing, summary, sizeof(summary));
+      char msg[256];
+      snprintf(msg, sizeof(msg), "MAGDA Orchestrate: %s (speculated %d, late %d)\n", summary,
+               timing.speculated, timing.late);
+      ShowConsoleMsg(msg);
+    }
   }
 
   // Check if any succeeded
@@ -4,6 +4,7 @@
 #include "../WDL/WDL/wdlstring.h"
 #include <functional>
 #include <string>
+#include <vector>
 
 // ============================================================================
 // Agent Types
@@ -30,11 +31,25 @@ struct AgentDetection {
 // ============================================================================
 struct AgentResult {
   bool success = false;
+  bool streamed = false; // dslCode already went statement by statement to the callback
   std::string dslCode;
   std::string error;
   AgentType agentType;
 };
 
+// ============================================================================
+// Orchestration Timing (milliseconds)
+// ============================================================================
+struct OrchestrationStats {
+  bool speculative = false; // Agents started while detection ran
+  double detectMs = 0.0;    // Detection round trip (0 when routed locally)
+  double totalMs = 0.0;     // Whole Orchestrate() call
+  double serialMs = 0.0;    // Detection plus the slowest agent, as if run in turn
+  int speculated = 0;       // Arranger/Drummer started on the keyword guess
+  int cancelled = 0;        // ...and cancelled because detection said no
+  int late = 0;             // Needed by detection but missed by the guess
+};
+
 // ============================================================================
 // MagdaAgentManager - Routes requests to appropriate agents
 // ============================================================================
@@ -61,9 +76,26 @@ public:
   bool GenerateJSFX(const char *question, const char *existing_code, WDL_FastString &out_code,
                     WDL_FastString &error);
 
-  // Orchestrate: detect agents, run in parallel, merge results
+  // Receives each complete top-level statement of the DAW program while it
+  // is still being generated. Runs on the network thread; must not block.
+  // Without the network thread (Windows) the statements come on the calling
+  // thread once the whole program is in.
+  using StatementCallback = std::function<void(const char *statement)>;
+
+  // Orchestrate: detect agents, run in parallel, merge results. Timing goes
+  // to stats if given. With onStatement, a speculative run streams the DAW
+  // agent and marks its result streamed.
   bool Orchestrate(const char *question, const char *state_json, std::vector<AgentResult> &results,
-                   WDL_FastString &error);
+                   WDL_FastString &error, OrchestrationStats *stats = nullptr,
+                   StatementCallback onStatement = nullptr);
+
+  // Speculative orchestration (default on): the DAW agent starts alongside
+  // detection instead of after it, as do Arranger/Drummer when keywords in
+  // the question suggest them. Those are cancelled if detection says no.
+  void SetSpeculative(bool speculative) { m_speculative = speculative; }
+
+  // "2.1 s, detect 0.6 s overlapped, saved 0.5 s" for the chat status
+  static void FormatStats(const OrchestrationStats &stats, char *buf, int bufSize);
 
 private:
   // Internal helper to call OpenAI with CFG grammar
@@ -71,20 +103,60 @@ private:
                    const char *tool_name, const char *tool_description, const char *grammar,
                    WDL_FastString &out_dsl, WDL_FastString &error);
 
+  // Detection helpers: questions answered by the JSFX agent, the keyword
+  // guess (fallback and speculation), the gpt-4.1-mini request and its reply
+  static bool IsJSFXQuestion(const char *question);
+  static void GuessAgents(const char *question, AgentDetection &result);
+  static void BuildDetectionRequest(const char *question, WDL_FastString &json);
+  static void ParseDetection(const char *response, int len, AgentDetection &result);
+  static void LogDetection(const AgentDetection &result);
+
+  // Run the agents detection asked for (DAW always) side by side
+  void RunAgents(const AgentDetection &detection, const char *question, const char *state_json,
+                 std::vector<AgentResult> &results);
+
+  // Orchestrate() with detection and agents in flight at once
+  void OrchestrateSpeculative(const char *question, const char *state_json,
+                              std::vector<AgentResult> &results, OrchestrationStats &stats,
+                              const StatementCallback &onStatement);
+
   // Build request JSON for specific agent
   char *BuildAgentRequest(const char *model, const char *question, const char *system_prompt,
-                          const char *tool_name, const char *tool_description, const char *grammar);
+                          const char *tool_name, const char *tool_description, const char *grammar,
+                          bool stream = false);
+
+  // Request JSON for a DSL agent (DAW, Arranger or Drummer); sets tool_name.
+  // stream asks for server-sent events. Caller frees the result.
+  char *BuildRequestFor(AgentType type, const char *question, const char *state_json,
+                        const char **tool_name, bool stream = false);
+
+  // Build, send and extract for one DSL agent
+  bool GenerateWithAgent(AgentType type, const char *question, const char *state_json,
+                         WDL_FastString &out_dsl, WDL_FastString &error);
+
+  // One POST of a batch; response and error are filled in
+  struct HTTPSCall {
+    const char *post_data;
+    int post_data_len;
+    WDL_FastString *response;
+    WDL_FastString *error;
+    bool success;
+  };
 
   // HTTP request
   bool SendHTTPSRequest(const char *url, const char *post_data, int post_data_len,
                         WDL_FastString &response, WDL_FastString &error);
 
+  // Send every call to url at once and wait for all of them
+  void SendHTTPSRequests(const char *url, HTTPSCall *calls, int count);
+
   // Extract DSL from response
   bool ExtractDSL(const char *response_json, int len, const char *tool_name,
                   WDL_FastString &out_dsl, WDL_FastString &error);
 
   WDL_FastString m_api_key;
   int m_timeout_seconds;
+  bool m_speculative;
 };
 
 // ============================================================================
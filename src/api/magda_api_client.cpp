@@ -9,9 +9,13 @@
 #include "magda_auth.h"
 #include "magda_env.h"
 #include "magda_imgui_login.h"
+#include "magda_main_thread_queue.h"
 #include "magda_state.h"
+#include "magda_worker_pool.h"
 #include "reaper_plugin.h"
 #include <cstring>
+#include <memory>
+#include <string>
 
 extern reaper_plugin_info_t *g_rec;
 
@@ -21,6 +25,8 @@ extern reaper_plugin_info_t *g_rec;
 #pragma comment(lib, "winhttp.lib")
 #define SLEEP_MS(ms) Sleep(ms)
 #else
+#include "magda_http_pool.h"
+#include "magda_http_reactor.h"
 #include <curl/curl.h>
 #include <unistd.h>
 #define SLEEP_MS(ms) usleep((ms) * 1000)
@@ -246,6 +252,81 @@ char *MagdaHTTPClient::ExtractActionsJSON(const char *json_str, int json_len) {
   return nullptr;
 }
 
+// Report an async request that could not run; done still runs on the main thread
+static void FailAsync(const MagdaHTTPClient::AsyncCallback &done, const char *error) {
+  std::string message = error ? error : "";
+  MagdaMainThreadQueue::Get().Post([done, message]() {
+    WDL_FastString result, error_msg;
+    error_msg.Set(message.c_str());
+    done(false, result, error_msg);
+  });
+}
+
+static void AppendJSONEscaped(WDL_FastString &out, const char *text) {
+  for (const char *p = text; *p; p++) {
+    if (*p == '"' || *p == '\\') {
+      out.Append("\\");
+    }
+    out.AppendFormatted(1, "%c", *p);
+  }
+}
+
+// {"email":"...","password":"..."}
+static void BuildLoginJSON(const char *email, const char *password, WDL_FastString &out) {
+  out.Set("{\"email\":\"");
+  AppendJSONEscaped(out, email);
+  out.Append("\",\"password\":\"");
+  AppendJSONEscaped(out, password);
+  out.Append("\"}");
+}
+
+// Take the JWT token out of a login response (and store the refresh token)
+static bool ParseLoginResponse(const WDL_FastString &response, WDL_FastString &jwt_token_out,
+                               WDL_FastString &error_msg) {
+  const char *response_str = response.Get();
+  if (!response_str || !response_str[0]) {
+    error_msg.Set("Empty response from server");
+    return false;
+  }
+
+  // Extract JWT token from response
+  // Response format: {"access_token": "...", "refresh_token": "..."}
+  wdl_json_parser parser;
+  wdl_json_element *root = parser.parse(response_str, (int)strlen(response_str));
+  if (parser.m_err || !root) {
+    error_msg.Set("Failed to parse response JSON");
+    return false;
+  }
+
+  // Try "access_token" first, then "token" for backwards compatibility
+  wdl_json_element *token_elem = root->get_item_by_name("access_token");
+  if (!token_elem || !token_elem->m_value_string) {
+    token_elem = root->get_item_by_name("token");
+  }
+
+  if (!token_elem || !token_elem->m_value_string) {
+    error_msg.Set("No token found in response");
+    return false;
+  }
+
+  const char *token = token_elem->m_value;
+  if (!token || !token[0]) {
+    error_msg.Set("Token is empty");
+    return false;
+  }
+
+  jwt_token_out.Set(token);
+
+  // Also extract and store refresh_token if present
+  wdl_json_element *refresh_elem = root->get_item_by_name("refresh_token");
+  if (refresh_elem && refresh_elem->m_value_string && refresh_elem->m_value[0]) {
+    // Store refresh token via MagdaAuth
+    MagdaAuth::StoreRefreshToken(refresh_elem->m_value);
+  }
+
+  return true;
+}
+
 // Platform-specific HTTPS POST request helpers
 // These must be defined before SendQuestion which uses them
 #ifdef _WIN32
@@ -453,7 +534,7 @@ static size_t CurlWriteCallback(void *contents, size_t size, size_t nmemb, void
 static bool SendHTTPSRequest_Curl(const char *url, const char *post_data, int post_data_len,
                                   WDL_FastString &response, WDL_FastString &error_msg,
                                   const char *auth_token = nullptr, int timeout_seconds = 30) {
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -508,7 +589,7 @@ static bool SendHTTPSRequest_Curl(const char *url, const char *post_data, int po
     }
   }
 
-  CURLcode res = curl_easy_perform(curl);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
 
   // Log curl result for debugging
   if (g_rec) {
@@ -517,10 +598,11 @@ static bool SendHTTPSRequest_Curl(const char *url, const char *post_data, int po
     if (ShowConsoleMsg) {
       char log_msg[512];
       if (res == CURLE_OK) {
-        snprintf(log_msg, sizeof(log_msg), "MAGDA: curl_easy_perform succeeded\n");
+        char timing[256];
+        MagdaHTTPPool::FormatTiming(MagdaHTTPPool::GetTiming(curl), timing, sizeof(timing));
+        snprintf(log_msg, sizeof(log_msg), "MAGDA: Request succeeded (%s)\n", timing);
       } else {
-        snprintf(log_msg, sizeof(log_msg), "MAGDA: curl_easy_perform failed: %s\n",
-                 curl_easy_strerror(res));
+        snprintf(log_msg, sizeof(log_msg), "MAGDA: Request failed: %s\n", curl_easy_strerror(res));
       }
       ShowConsoleMsg(log_msg);
     }
@@ -554,20 +636,86 @@ static bool SendHTTPSRequest_Curl(const char *url, const char *post_data, int po
       }
       error_msg.Set(error_buf);
       curl_slist_free_all(headers);
-      curl_easy_cleanup(curl);
+      MagdaHTTPPool::Get().Release(curl);
       return false;
     }
   } else {
     error_msg.Set(curl_easy_strerror(res));
     curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    MagdaHTTPPool::Get().Release(curl);
     return false;
   }
 
   curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  MagdaHTTPPool::Get().Release(curl);
   return true;
 }
+
+// Owned by an async transfer until its completion has run
+struct CurlAsyncRequest {
+  WDL_FastString post_data; // CURLOPT_POSTFIELDS is not copied by curl
+  WDL_FastString response;
+  CurlWriteData writeData;
+  struct curl_slist *headers = nullptr;
+  ~CurlAsyncRequest() { curl_slist_free_all(headers); }
+};
+
+// SendHTTPSRequest_Curl on the network thread. done runs on the main thread
+// with the response; success means HTTP 200, as for the blocking version.
+static void StartHTTPSRequest_Curl(const char *url, const char *post_data, int post_data_len,
+                                   const char *auth_token, int timeout_seconds,
+                                   MagdaHTTPClient::AsyncCallback done) {
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
+  if (!curl) {
+    FailAsync(done, "Failed to initialize curl");
+    return;
+  }
+
+  auto request = std::make_shared<CurlAsyncRequest>();
+  request->post_data.Set(post_data, post_data_len);
+  request->writeData.response = &request->response;
+
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->post_data.Get());
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, post_data_len);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlWriteCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->writeData);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeout_seconds);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+
+  request->headers = curl_slist_append(request->headers, "Content-Type: application/json");
+  if (auth_token && strlen(auth_token) > 0) {
+    char auth_header[512];
+    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", auth_token);
+    request->headers = curl_slist_append(request->headers, auth_header);
+  }
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+
+  int id = MagdaHTTPReactor::Get().Start(curl, [request, done](CURL *curl, CURLcode res) {
+    WDL_FastString error_msg;
+    bool success = false;
+    if (res == CURLE_OK) {
+      long response_code = 0;
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+      if (response_code == 200) {
+        success = true;
+      } else if (request->response.GetLength() > 0) {
+        error_msg.SetFormatted(512, "HTTP error %ld: %.200s", response_code,
+                               request->response.Get());
+      } else {
+        error_msg.SetFormatted(64, "HTTP error %ld", response_code);
+      }
+    } else {
+      error_msg.Set(curl_easy_strerror(res));
+    }
+    done(success, request->response, error_msg);
+  });
+  if (!id) {
+    FailAsync(done, "Network is shut down");
+  }
+}
 #endif
 
 bool MagdaHTTPClient::SendPOSTRequest(const char *endpoint, const char *json_data,
@@ -904,24 +1052,7 @@ bool MagdaHTTPClient::SendLoginRequest(const char *email, const char *password,
 
   // Build login request JSON
   WDL_FastString request_json;
-  request_json.Append("{\"email\":\"");
-  // Escape email
-  for (const char *p = email; *p; p++) {
-    if (*p == '"' || *p == '\\') {
-      request_json.Append("\\");
-    }
-    request_json.AppendFormatted(1, "%c", *p);
-  }
-  request_json.Append("\",\"password\":\"");
-  // Escape password
-  for (const char *p = password; *p; p++) {
-    if (*p == '"' || *p == '\\') {
-      request_json.Append("\\");
-    }
-    request_json.AppendFormatted(1, "%c", *p);
-  }
-  request_json.Append("\"}");
-
+  BuildLoginJSON(email, password, request_json);
   int request_json_len = (int)request_json.GetLength();
 
   // Build URL
@@ -943,49 +1074,52 @@ bool MagdaHTTPClient::SendLoginRequest(const char *email, const char *password,
   }
 #endif
 
-  // Parse response JSON
-  const char *response_str = response.Get();
-  if (!response_str || !response_str[0]) {
-    error_msg.Set("Empty response from server");
-    return false;
-  }
-
-  // Extract JWT token from response
-  // Response format: {"access_token": "...", "refresh_token": "..."}
-  wdl_json_parser parser;
-  wdl_json_element *root = parser.parse(response_str, (int)strlen(response_str));
-  if (parser.m_err || !root) {
-    error_msg.Set("Failed to parse response JSON");
-    return false;
-  }
-
-  // Try "access_token" first, then "token" for backwards compatibility
-  wdl_json_element *token_elem = root->get_item_by_name("access_token");
-  if (!token_elem || !token_elem->m_value_string) {
-    token_elem = root->get_item_by_name("token");
-  }
-
-  if (!token_elem || !token_elem->m_value_string) {
-    error_msg.Set("No token found in response");
-    return false;
-  }
+  return ParseLoginResponse(response, jwt_token_out, error_msg);
+}
 
-  const char *token = token_elem->m_value;
-  if (!token || !token[0]) {
-    error_msg.Set("Token is empty");
-    return false;
+void MagdaHTTPClient::SendLoginRequestAsync(const char *email, const char *password,
+                                            AsyncCallback done) {
+  if (!email || !email[0] || !password || !password[0]) {
+    FailAsync(done, "Email and password are required.");
+    return;
   }
 
-  jwt_token_out.Set(token);
-
-  // Also extract and store refresh_token if present
-  wdl_json_element *refresh_elem = root->get_item_by_name("refresh_token");
-  if (refresh_elem && refresh_elem->m_value_string && refresh_elem->m_value[0]) {
-    // Store refresh token via MagdaAuth
-    MagdaAuth::StoreRefreshToken(refresh_elem->m_value);
-  }
+  WDL_FastString request_json;
+  BuildLoginJSON(email, password, request_json);
+  WDL_FastString url;
+  url.Set(m_backend_url.Get());
+  url.Append("/api/auth/login");
 
-  return true;
+#ifdef _WIN32
+  // No event-driven WinHTTP path; run the blocking request on a worker
+  std::string url_copy = url.Get();
+  std::string body = request_json.Get();
+  MagdaWorkerPool::Get().Submit([url_copy, body, done]() {
+    WDL_FastString response, token, error_msg;
+    bool success = SendHTTPSRequest_WinHTTP(url_copy.c_str(), body.c_str(), (int)body.size(),
+                                            response, error_msg, nullptr) &&
+                   ParseLoginResponse(response, token, error_msg);
+    std::string token_copy = token.Get();
+    std::string error_copy = error_msg.Get();
+    MagdaMainThreadQueue::Get().Post([done, success, token_copy, error_copy]() {
+      WDL_FastString result, error;
+      result.Set(token_copy.c_str());
+      error.Set(error_copy.c_str());
+      done(success, result, error);
+    });
+  });
+#else
+  StartHTTPSRequest_Curl(
+      url.Get(), request_json.Get(), request_json.GetLength(), nullptr, 30,
+      [done](bool success, const WDL_FastString &response, const WDL_FastString &error_msg) {
+        WDL_FastString token, error;
+        error.Set(error_msg.Get());
+        if (success) {
+          success = ParseLoginResponse(response, token, error);
+        }
+        done(success, token, error);
+      });
+#endif
 }
 
 bool MagdaHTTPClient::SendRefreshRequest(const char *refresh_token, WDL_FastString &jwt_token_out,
@@ -998,13 +1132,7 @@ bool MagdaHTTPClient::SendRefreshRequest(const char *refresh_token, WDL_FastStri
   // Build refresh request JSON
   WDL_FastString request_json;
   request_json.Append("{\"refresh_token\":\"");
-  // Escape refresh token
-  for (const char *p = refresh_token; *p; p++) {
-    if (*p == '"' || *p == '\\') {
-      request_json.Append("\\");
-    }
-    request_json.AppendFormatted(1, "%c", *p);
-  }
+  AppendJSONEscaped(request_json, refresh_token);
   request_json.Append("\"}");
 
   int request_json_len = (int)request_json.GetLength();
@@ -1553,7 +1681,7 @@ static bool SendSSEPostRequest(const char *url, const char *post_data, int post_
 
 #else
   // macOS/Linux: libcurl streaming implementation
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -1614,7 +1742,20 @@ static bool SendSSEPostRequest(const char *url, const char *post_data, int post_
   }
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-  CURLcode res = curl_easy_perform(curl);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
+
+  // Connection setup vs. streaming time, to see what the pooled connection saves
+  if (res == CURLE_OK && g_rec) {
+    void (*ShowConsoleMsg)(const char *msg) =
+        (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+    if (ShowConsoleMsg) {
+      char timing[256];
+      char log_msg[320];
+      MagdaHTTPPool::FormatTiming(MagdaHTTPPool::GetTiming(curl), timing, sizeof(timing));
+      snprintf(log_msg, sizeof(log_msg), "MAGDA: Stream finished (%s)\n", timing);
+      ShowConsoleMsg(log_msg);
+    }
+  }
 
   long response_code = 0;
   if (res == CURLE_OK) {
@@ -1676,18 +1817,18 @@ static bool SendSSEPostRequest(const char *url, const char *post_data, int post_
       }
 
       curl_slist_free_all(headers);
-      curl_easy_cleanup(curl);
+      MagdaHTTPPool::Get().Release(curl);
       return false;
     }
   } else {
     error_msg.Set(curl_easy_strerror(res));
     curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    MagdaHTTPPool::Get().Release(curl);
     return false;
   }
 
   curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  MagdaHTTPPool::Get().Release(curl);
   return stream_data.success;
 #endif
 }
@@ -1752,18 +1893,11 @@ bool MagdaHTTPClient::SendPOSTStream(const char *endpoint, const char *json_data
                             user_data, error_msg, timeout_seconds > 0 ? timeout_seconds : 60);
 }
 
-bool MagdaHTTPClient::CheckHealth(WDL_FastString &error_msg, int timeout_seconds) {
 #ifndef _WIN32
-  // Use curl for macOS/Linux
-  CURL *curl = curl_easy_init();
-  if (!curl) {
-    error_msg.Set("Failed to initialize curl");
-    return false;
-  }
-
-  // Build health check URL
+// GET <backend>/health with the body discarded
+static void ConfigureHealthCheck(CURL *curl, const char *backend_url, int timeout_seconds) {
   WDL_FastString url;
-  url.Set(m_backend_url.Get());
+  url.Set(backend_url);
   url.Append("/health");
 
   curl_easy_setopt(curl, CURLOPT_URL, url.Get());
@@ -1777,30 +1911,65 @@ bool MagdaHTTPClient::CheckHealth(WDL_FastString &error_msg, int timeout_seconds
       curl, CURLOPT_WRITEFUNCTION, +[](char *, size_t size, size_t nmemb, void *) -> size_t {
         return size * nmemb; // Discard body
       });
+}
 
-  CURLcode res = curl_easy_perform(curl);
-
-  if (res == CURLE_OK) {
-    long response_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-    curl_easy_cleanup(curl);
-
-    if (response_code >= 200 && response_code < 300) {
-      return true;
-    } else {
-      char err[64];
-      snprintf(err, sizeof(err), "HTTP %ld", response_code);
-      error_msg.Set(err);
-      return false;
-    }
-  } else {
+// Any 2xx answer means the API is up
+static bool HealthCheckResult(CURL *curl, CURLcode res, WDL_FastString &error_msg) {
+  if (res != CURLE_OK) {
     error_msg.Set(curl_easy_strerror(res));
-    curl_easy_cleanup(curl);
     return false;
   }
+  long response_code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+  if (response_code >= 200 && response_code < 300) {
+    return true;
+  }
+  char err[64];
+  snprintf(err, sizeof(err), "HTTP %ld", response_code);
+  error_msg.Set(err);
+  return false;
+}
+#endif
+
+bool MagdaHTTPClient::CheckHealth(WDL_FastString &error_msg, int timeout_seconds) {
+#ifndef _WIN32
+  // Use curl for macOS/Linux
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
+  if (!curl) {
+    error_msg.Set("Failed to initialize curl");
+    return false;
+  }
+
+  ConfigureHealthCheck(curl, m_backend_url.Get(), timeout_seconds);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
+  bool success = HealthCheckResult(curl, res, error_msg);
+  MagdaHTTPPool::Get().Release(curl);
+  return success;
 #else
   // Windows implementation placeholder
   error_msg.Set("Health check not implemented on Windows");
   return false;
 #endif
 }
+
+void MagdaHTTPClient::CheckHealthAsync(AsyncCallback done, int timeout_seconds) {
+#ifndef _WIN32
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
+  if (!curl) {
+    FailAsync(done, "Failed to initialize curl");
+    return;
+  }
+
+  ConfigureHealthCheck(curl, m_backend_url.Get(), timeout_seconds);
+  int id = MagdaHTTPReactor::Get().Start(curl, [done](CURL *curl, CURLcode res) {
+    WDL_FastString result, error_msg;
+    bool success = HealthCheckResult(curl, res, error_msg);
+    done(success, result, error_msg);
+  });
+  if (!id) {
+    FailAsync(done, "Network is shut down");
+  }
+#else
+  FailAsync(done, "Health check not implemented on Windows");
+#endif
+}
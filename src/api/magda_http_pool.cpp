@@ -0,0 +1,152 @@
+#include "magda_http_pool.h"
+
+#ifndef _WIN32
+#include <cstdio>
+
+// Idle handles kept beyond this are closed; requests rarely overlap more
+static const size_t kMaxIdleHandles = 8;
+
+MagdaHTTPPool &MagdaHTTPPool::Get() {
+  static MagdaHTTPPool pool;
+  return pool;
+}
+
+MagdaHTTPPool::MagdaHTTPPool() : m_numOut(0), m_shutdown(false), m_share(nullptr) {
+  // Reference counted by libcurl, so other callers may init as well
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+
+  m_share = curl_share_init();
+  if (m_share) {
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, Lock);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, Unlock);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // Safe to share now that every transfer runs on the reactor thread;
+    // libcurl doesn't support it across concurrently performing threads
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+  }
+}
+
+MagdaHTTPPool::~MagdaHTTPPool() { Shutdown(); }
+
+void MagdaHTTPPool::Lock(CURL *, curl_lock_data data, curl_lock_access, void *userptr) {
+  MagdaHTTPPool *pool = (MagdaHTTPPool *)userptr;
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST) {
+    pool->m_shareLocks[data].lock();
+  }
+}
+
+void MagdaHTTPPool::Unlock(CURL *, curl_lock_data data, void *userptr) {
+  MagdaHTTPPool *pool = (MagdaHTTPPool *)userptr;
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST) {
+    pool->m_shareLocks[data].unlock();
+  }
+}
+
+CURL *MagdaHTTPPool::Acquire() {
+  CURL *curl = nullptr;
+  CURLSH *share = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_idle.empty()) {
+      curl = m_idle.back();
+      m_idle.pop_back();
+    }
+    share = m_shutdown ? nullptr : m_share;
+    if (!curl) {
+      curl = curl_easy_init();
+    }
+    if (curl) {
+      m_numOut++;
+    }
+  }
+  if (!curl) {
+    return nullptr;
+  }
+
+  if (share) {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+  }
+  // Pooled handles are used from many threads; timeouts must not rely on
+  // signals, and idle connections are kept alive for the next request
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  return curl;
+}
+
+void MagdaHTTPPool::Release(CURL *curl) {
+  if (!curl) {
+    return;
+  }
+
+  // Drop the caller's options (callbacks, buffers, headers); the
+  // connection and caches survive a reset
+  curl_easy_reset(curl);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_numOut--;
+  if (!m_shutdown && m_idle.size() < kMaxIdleHandles) {
+    m_idle.push_back(curl);
+    return;
+  }
+  curl_easy_cleanup(curl);
+  if (m_shutdown) {
+    CloseShareIfUnused();
+  }
+}
+
+MagdaHTTPTiming MagdaHTTPPool::GetTiming(CURL *curl) {
+  MagdaHTTPTiming timing;
+  if (!curl) {
+    return timing;
+  }
+
+  // Each value is microseconds from the start of the transfer
+  curl_off_t lookup = 0, connect = 0, tls = 0, pretransfer = 0, firstByte = 0, total = 0;
+  curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &lookup);
+  curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+  curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &tls);
+  curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &firstByte);
+  curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+  long newConnections = 0;
+  curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections);
+
+  timing.dnsMs = lookup / 1000.0;
+  timing.connectMs = connect > lookup ? (connect - lookup) / 1000.0 : 0.0;
+  // APPCONNECT stays 0 without a new TLS handshake
+  timing.tlsMs = tls > connect ? (tls - connect) / 1000.0 : 0.0;
+  timing.firstByteMs = firstByte > pretransfer ? (firstByte - pretransfer) / 1000.0 : 0.0;
+  timing.totalMs = total / 1000.0;
+  timing.reusedConnection = newConnections == 0;
+  return timing;
+}
+
+void MagdaHTTPPool::FormatTiming(const MagdaHTTPTiming &timing, char *buf, int bufSize) {
+  if (!buf || bufSize <= 0) {
+    return;
+  }
+  snprintf(buf, bufSize,
+           "dns %.1f ms, connect %.1f ms, tls %.1f ms, first byte %.1f ms, total %.1f ms%s",
+           timing.dnsMs, timing.connectMs, timing.tlsMs, timing.firstByteMs, timing.totalMs,
+           timing.reusedConnection ? ", reused connection" : "");
+}
+
+void MagdaHTTPPool::Shutdown() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_shutdown = true;
+  for (CURL *curl : m_idle) {
+    curl_easy_cleanup(curl);
+  }
+  m_idle.clear();
+  CloseShareIfUnused();
+}
+
+void MagdaHTTPPool::CloseShareIfUnused() {
+  if (m_share && m_numOut == 0) {
+    curl_share_cleanup(m_share);
+    m_share = nullptr;
+  }
+}
+#endif
@@ -0,0 +1,226 @@
+#include "magda_http_reactor.h"
+
+#ifndef _WIN32
+#include "magda_http_pool.h"
+#include "magda_main_thread_queue.h"
+#include <condition_variable>
+
+// Connections open at once across all transfers; more transfers wait in
+// curl's queue until one frees up
+static const long kMaxConnections = 8;
+// Longest the thread sleeps without traffic (it is woken for new work)
+static const int kPollTimeoutMs = 1000;
+
+MagdaHTTPReactor &MagdaHTTPReactor::Get() {
+  static MagdaHTTPReactor reactor;
+  return reactor;
+}
+
+MagdaHTTPReactor::MagdaHTTPReactor() : m_multi(nullptr), m_nextId(1), m_stop(false) {
+  // The pool must outlive the reactor, which releases handles into it
+  MagdaHTTPPool::Get();
+
+  m_multi = curl_multi_init();
+  if (m_multi) {
+    curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, kMaxConnections);
+  }
+}
+
+MagdaHTTPReactor::~MagdaHTTPReactor() {
+  Shutdown();
+  if (m_multi) {
+    curl_multi_cleanup(m_multi);
+  }
+}
+
+int MagdaHTTPReactor::Submit(Transfer transfer) {
+  int id = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop || !m_multi) {
+      return 0;
+    }
+    if (!m_thread.joinable()) {
+      m_thread = std::thread([this]() { ThreadLoop(); });
+    }
+    id = m_nextId++;
+    transfer.id = id;
+    m_incoming.push_back(std::move(transfer));
+  }
+  curl_multi_wakeup(m_multi);
+  return id;
+}
+
+int MagdaHTTPReactor::Start(CURL *curl, Completion onDone) {
+  if (!curl) {
+    return 0;
+  }
+  Transfer transfer;
+  transfer.curl = curl;
+  transfer.onDone = std::move(onDone);
+  int id = Submit(std::move(transfer));
+  if (!id) {
+    MagdaHTTPPool::Get().Release(curl);
+  }
+  return id;
+}
+
+int MagdaHTTPReactor::Launch(CURL *curl, std::function<void(CURLcode)> onFinish) {
+  if (!curl) {
+    return 0;
+  }
+  Transfer transfer;
+  transfer.curl = curl;
+  transfer.wake = std::move(onFinish);
+  return Submit(std::move(transfer));
+}
+
+void MagdaHTTPReactor::Cancel(int id) {
+  if (id <= 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) {
+      return;
+    }
+    m_cancelled.push_back(id);
+  }
+  curl_multi_wakeup(m_multi);
+}
+
+CURLcode MagdaHTTPReactor::Perform(CURL *curl) {
+  CURLcode result = CURLE_FAILED_INIT;
+  PerformAll(&curl, 1, &result);
+  return result;
+}
+
+void MagdaHTTPReactor::PerformAll(CURL *const *handles, int count, CURLcode *results) {
+  std::mutex mutex;
+  std::condition_variable done;
+  int remaining = 0;
+
+  for (int i = 0; i < count; i++) {
+    results[i] = CURLE_FAILED_INIT;
+    if (!handles[i]) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      remaining++;
+    }
+    auto onFinish = [&mutex, &done, &remaining, results, i](CURLcode result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      results[i] = result;
+      remaining--;
+      done.notify_all();
+    };
+    if (!Launch(handles[i], onFinish)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      results[i] = CURLE_ABORTED_BY_CALLBACK;
+      remaining--;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&remaining]() { return remaining == 0; });
+}
+
+void MagdaHTTPReactor::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  if (m_thread.joinable()) {
+    curl_multi_wakeup(m_multi);
+    m_thread.join();
+  }
+}
+
+void MagdaHTTPReactor::Finish(Transfer &transfer, CURLcode result, bool deliver) {
+  if (transfer.wake) {
+    transfer.wake(result);
+    return;
+  }
+
+  CURL *curl = transfer.curl;
+  if (!deliver) {
+    MagdaHTTPPool::Get().Release(curl);
+    return;
+  }
+  Completion onDone = std::move(transfer.onDone);
+  MagdaMainThreadQueue::Get().Post([curl, onDone, result]() {
+    if (onDone) {
+      onDone(curl, result);
+    }
+    MagdaHTTPPool::Get().Release(curl);
+  });
+}
+
+void MagdaHTTPReactor::ThreadLoop() {
+  for (;;) {
+    std::deque<Transfer> incoming;
+    std::vector<int> cancelled;
+    bool stop = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      incoming.swap(m_incoming);
+      cancelled.swap(m_cancelled);
+      stop = m_stop;
+    }
+
+    for (Transfer &transfer : incoming) {
+      CURL *curl = transfer.curl;
+      if (stop || curl_multi_add_handle(m_multi, curl) != CURLM_OK) {
+        Finish(transfer, CURLE_ABORTED_BY_CALLBACK, !stop);
+        continue;
+      }
+      m_active[curl] = std::move(transfer);
+    }
+
+    for (int id : cancelled) {
+      for (auto it = m_active.begin(); it != m_active.end(); ++it) {
+        if (it->second.id == id) {
+          curl_multi_remove_handle(m_multi, it->first);
+          Transfer transfer = std::move(it->second);
+          m_active.erase(it);
+          Finish(transfer, CURLE_ABORTED_BY_CALLBACK, true);
+          break;
+        }
+      }
+    }
+
+    if (stop) {
+      for (auto &entry : m_active) {
+        curl_multi_remove_handle(m_multi, entry.first);
+        Finish(entry.second, CURLE_ABORTED_BY_CALLBACK, false);
+      }
+      m_active.clear();
+      return;
+    }
+
+    int running = 0;
+    curl_multi_perform(m_multi, &running);
+
+    CURLMsg *msg = nullptr;
+    int queued = 0;
+    while ((msg = curl_multi_info_read(m_multi, &queued))) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+      // msg dies with the removal; copy what is needed first
+      CURL *curl = msg->easy_handle;
+      CURLcode result = msg->data.result;
+      curl_multi_remove_handle(m_multi, curl);
+      auto it = m_active.find(curl);
+      if (it != m_active.end()) {
+        Transfer transfer = std::move(it->second);
+        m_active.erase(it);
+        Finish(transfer, result, true);
+      }
+    }
+
+    curl_multi_poll(m_multi, nullptr, 0, kPollTimeoutMs, nullptr);
+  }
+}
+#endif
@@ -2,9 +2,13 @@
 #include "../WDL/WDL/jsonparse.h"
 #include "../dsl/magda_dsl_grammar.h"
 #include "../dsl/magda_jsfx_grammar.h"
+#include "magda_main_thread_queue.h"
+#include "magda_worker_pool.h"
 #include "reaper_plugin.h"
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <string>
 
 extern reaper_plugin_info_t *g_rec;
 
@@ -13,6 +17,8 @@ extern reaper_plugin_info_t *g_rec;
 #include <winhttp.h>
 #pragma comment(lib, "winhttp.lib")
 #else
+#include "magda_http_pool.h"
+#include "magda_http_reactor.h"
 #include <curl/curl.h>
 #endif
 
@@ -80,12 +86,16 @@ static void EscapeJSONString(const char *input, WDL_FastString &output) {
 }
 
 char *MagdaOpenAI::BuildRequestJSON(const char *question, const char *system_prompt,
-                                    const char *state_json) {
+                                    const char *state_json, bool stream) {
   WDL_FastString json;
   WDL_FastString escaped;
 
   json.Set("{");
 
+  if (stream) {
+    json.Append("\"stream\":true,");
+  }
+
   // Model
   json.Append("\"model\":\"");
   json.Append(m_model.Get());
@@ -453,7 +463,8 @@ static size_t CurlStreamWriteCallback(void *contents, size_t size, size_t nmemb,
                     }
                     data->received_content = true;
                   }
-                } else if (strcmp(event_type, "response.function_call_arguments.delta") == 0) {
+                } else if (strcmp(event_type, "response.function_call_arguments.delta") == 0 ||
+                           strcmp(event_type, "response.custom_tool_call_input.delta") == 0) {
                   // CFG grammar tool call streaming (for JSFX/DSL output)
                   wdl_json_element *delta_elem = root->get_item_by_name("delta");
                   if (delta_elem && delta_elem->m_value_string && delta_elem->m_value) {
@@ -463,7 +474,8 @@ static size_t CurlStreamWriteCallback(void *contents, size_t size, size_t nmemb,
                     data->received_content = true;
                   }
                 } else if (strcmp(event_type, "response.output_text.done") == 0 ||
-                           strcmp(event_type, "response.function_call_arguments.done") == 0) {
+                           strcmp(event_type, "response.function_call_arguments.done") == 0 ||
+                           strcmp(event_type, "response.custom_tool_call_input.done") == 0) {
                   // Text/arguments output complete - mark content received
                   data->received_content = true;
                 } else if (strcmp(event_type, "response.done") == 0 ||
@@ -508,7 +520,7 @@ static size_t CurlStreamWriteCallback(void *contents, size_t size, size_t nmemb,
 
 bool MagdaOpenAI::SendHTTPSRequest(const char *url, const char *post_data, int post_data_len,
                                    WDL_FastString &response, WDL_FastString &error_msg) {
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -537,7 +549,7 @@ bool MagdaOpenAI::SendHTTPSRequest(const char *url, const char *post_data, int p
 
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-  CURLcode res = curl_easy_perform(curl);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
 
   bool success = false;
   if (res == CURLE_OK) {
@@ -549,9 +561,11 @@ bool MagdaOpenAI::SendHTTPSRequest(const char *url, const char *post_data, int p
       void (*ShowConsoleMsg)(const char *msg) =
           (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
       if (ShowConsoleMsg) {
+        char timing[256];
         char log_msg[2048];
-        snprintf(log_msg, sizeof(log_msg), "MAGDA OpenAI: HTTP %ld, Response: %.1500s\n",
-                 response_code, response.Get());
+        MagdaHTTPPool::FormatTiming(MagdaHTTPPool::GetTiming(curl), timing, sizeof(timing));
+        snprintf(log_msg, sizeof(log_msg), "MAGDA OpenAI: HTTP %ld (%s), Response: %.1500s\n",
+                 response_code, timing, response.Get());
         ShowConsoleMsg(log_msg);
       }
     }
@@ -566,7 +580,7 @@ bool MagdaOpenAI::SendHTTPSRequest(const char *url, const char *post_data, int p
   }
 
   curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  MagdaHTTPPool::Get().Release(curl);
   return success;
 }
 #endif
@@ -654,9 +668,8 @@ bool MagdaOpenAI::GenerateDSLWithState(const char *question, const char *system_
 bool MagdaOpenAI::GenerateDSLStream(const char *question, const char *system_prompt,
                                     const char *state_json, StreamCallback callback,
                                     WDL_FastString &error_msg) {
-  // For now, use non-streaming implementation and call callback once at end
-  // TODO: Implement true streaming with SSE parsing
-
+#ifdef _WIN32
+  // Windows: no SSE path yet; deliver the whole program at once
   WDL_FastString dsl;
   bool success = GenerateDSLWithState(question, system_prompt, state_json, dsl, error_msg);
 
@@ -665,12 +678,99 @@ bool MagdaOpenAI::GenerateDSLStream(const char *question, const char *system_pro
   }
 
   return success;
+#else
+  if (!HasAPIKey()) {
+    error_msg.Set("OpenAI API key not configured");
+    return false;
+  }
+
+  if (!question || !*question) {
+    error_msg.Set("Empty question");
+    return false;
+  }
+
+  char *request_json = BuildRequestJSON(question, system_prompt, state_json, true);
+  if (!request_json) {
+    error_msg.Set("Failed to build request JSON");
+    return false;
+  }
+
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
+  if (!curl) {
+    free(request_json);
+    error_msg.Set("Failed to initialize curl");
+    return false;
+  }
+
+  // Grammar tool input arrives as custom_tool_call_input.delta events, each
+  // passed straight to the callback (on the network thread)
+  CurlStreamWriteData streamData;
+  streamData.callback = callback;
+  streamData.line_pos = 0;
+  streamData.success = false;
+  streamData.received_content = false;
+
+  curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/responses");
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_json);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)strlen(request_json));
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlStreamWriteCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &streamData);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)m_timeout_seconds);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+
+  struct curl_slist *headers = nullptr;
+  headers = curl_slist_append(headers, "Content-Type: application/json");
+  headers = curl_slist_append(headers, "Accept: text/event-stream");
+
+  char auth_header[512];
+  snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", m_api_key.Get());
+  headers = curl_slist_append(headers, auth_header);
+
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
+
+  bool success = false;
+  if (res == CURLE_OK) {
+    long response_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+    if (response_code == 200 && (streamData.success || streamData.received_content)) {
+      success = true;
+      if (!streamData.success && callback) {
+        callback("", true);
+      }
+    } else if (response_code != 200) {
+      error_msg.SetFormatted(512, "HTTP %ld: %s", response_code,
+                             streamData.error_msg.GetLength() > 0 ? streamData.error_msg.Get()
+                                                                  : "API error");
+    } else {
+      error_msg.Set(streamData.error_msg.GetLength() > 0 ? streamData.error_msg.Get()
+                                                         : "No DSL received from API");
+    }
+  } else {
+    error_msg.Set(curl_easy_strerror(res));
+  }
+
+  curl_slist_free_all(headers);
+  MagdaHTTPPool::Get().Release(curl);
+  free(request_json);
+  return success;
+#endif
 }
 
 // ============================================================================
 // API Key Validation
 // ============================================================================
 
+// Hand an async result to the main thread
+static void PostResult(const MagdaOpenAI::ResultCallback &done, bool success, const char *error) {
+  std::string message = error ? error : "";
+  MagdaMainThreadQueue::Get().Post([done, success, message]() { done(success, message.c_str()); });
+}
+
 #ifdef _WIN32
 bool MagdaOpenAI::ValidateAPIKey(WDL_FastString &error_msg) {
   if (!HasAPIKey()) {
@@ -751,7 +851,54 @@ bool MagdaOpenAI::ValidateAPIKey(WDL_FastString &error_msg) {
   return success;
 }
 
+void MagdaOpenAI::ValidateAPIKeyAsync(ResultCallback done) {
+  // No event-driven WinHTTP path; run the blocking request on a worker
+  MagdaWorkerPool::Get().Submit([this, done]() {
+    WDL_FastString error_msg;
+    bool success = ValidateAPIKey(error_msg);
+    PostResult(done, success, error_msg.Get());
+  });
+}
+
 #else
+// GET /v1/models, which only answers 200 to a valid key
+static struct curl_slist *ConfigureValidateRequest(CURL *curl, const char *api_key,
+                                                   CurlWriteData *writeData) {
+  curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/models");
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlWriteCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, writeData);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+
+  // Set Authorization header
+  struct curl_slist *headers = nullptr;
+  char auth_header[512];
+  snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", api_key);
+  headers = curl_slist_append(headers, auth_header);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  return headers;
+}
+
+static bool ValidateResult(CURL *curl, CURLcode res, WDL_FastString &error_msg) {
+  if (res != CURLE_OK) {
+    error_msg.Set(curl_easy_strerror(res));
+    return false;
+  }
+  long response_code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+  if (response_code == 200) {
+    return true;
+  } else if (response_code == 401) {
+    error_msg.Set("Invalid API key");
+  } else {
+    error_msg.SetFormatted(256, "HTTP error %ld", response_code);
+  }
+  return false;
+}
+
 // macOS/Linux curl implementation
 bool MagdaOpenAI::ValidateAPIKey(WDL_FastString &error_msg) {
   if (!HasAPIKey()) {
@@ -759,7 +906,7 @@ bool MagdaOpenAI::ValidateAPIKey(WDL_FastString &error_msg) {
     return false;
   }
 
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -768,44 +915,47 @@ bool MagdaOpenAI::ValidateAPIKey(WDL_FastString &error_msg) {
   WDL_FastString response;
   CurlWriteData writeData;
   writeData.response = &response;
+  struct curl_slist *headers = ConfigureValidateRequest(curl, m_api_key.Get(), &writeData);
 
-  curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/models");
-  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlWriteCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writeData);
-  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
+  bool success = ValidateResult(curl, res, error_msg);
 
-  // Set Authorization header
-  struct curl_slist *headers = nullptr;
-  char auth_header[512];
-  snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", m_api_key.Get());
-  headers = curl_slist_append(headers, auth_header);
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-  CURLcode res = curl_easy_perform(curl);
+  curl_slist_free_all(headers);
+  MagdaHTTPPool::Get().Release(curl);
+  return success;
+}
 
-  bool success = false;
-  if (res == CURLE_OK) {
-    long response_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+void MagdaOpenAI::ValidateAPIKeyAsync(ResultCallback done) {
+  if (!HasAPIKey()) {
+    PostResult(done, false, "API key not set");
+    return;
+  }
 
-    if (response_code == 200) {
-      success = true;
-    } else if (response_code == 401) {
-      error_msg.Set("Invalid API key");
-    } else {
-      error_msg.SetFormatted(256, "HTTP error %ld", response_code);
-    }
-  } else {
-    error_msg.Set(curl_easy_strerror(res));
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
+  if (!curl) {
+    PostResult(done, false, "Failed to initialize curl");
+    return;
   }
 
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
-  return success;
+  // Owned by the transfer until its completion has run
+  struct Request {
+    WDL_FastString response;
+    CurlWriteData writeData;
+    struct curl_slist *headers = nullptr;
+    ~Request() { curl_slist_free_all(headers); }
+  };
+  auto request = std::make_shared<Request>();
+  request->writeData.response = &request->response;
+  request->headers = ConfigureValidateRequest(curl, m_api_key.Get(), &request->writeData);
+
+  int id = MagdaHTTPReactor::Get().Start(curl, [request, done](CURL *curl, CURLcode res) {
+    WDL_FastString error_msg;
+    bool success = ValidateResult(curl, res, error_msg);
+    done(success, error_msg.Get());
+  });
+  if (!id) {
+    PostResult(done, false, "Network is shut down");
+  }
 }
 #endif
 
@@ -898,7 +1048,7 @@ bool MagdaOpenAI::GenerateMixFeedback(const char *analysis_json, const char *tra
 
 #ifndef _WIN32
   // macOS/Linux: Use curl with streaming
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -935,7 +1085,7 @@ bool MagdaOpenAI::GenerateMixFeedback(const char *analysis_json, const char *tra
     ShowConsoleMsg("MAGDA OpenAI: Starting SSE stream...\n");
   }
 
-  CURLcode res = curl_easy_perform(curl);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
 
   bool success = false;
   if (res == CURLE_OK) {
@@ -978,7 +1128,7 @@ bool MagdaOpenAI::GenerateMixFeedback(const char *analysis_json, const char *tra
   }
 
   curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  MagdaHTTPPool::Get().Release(curl);
   return success;
 
 #else
@@ -1129,7 +1279,7 @@ bool MagdaOpenAI::GenerateJSFXStream(const char *question, const char *existing_
 
 #ifndef _WIN32
   // macOS/Linux: Use curl with streaming
-  CURL *curl = curl_easy_init();
+  CURL *curl = MagdaHTTPPool::Get().Acquire();
   if (!curl) {
     error_msg.Set("Failed to initialize curl");
     return false;
@@ -1166,7 +1316,7 @@ bool MagdaOpenAI::GenerateJSFXStream(const char *question, const char *existing_
     ShowConsoleMsg("MAGDA OpenAI: Starting JSFX SSE stream...\n");
   }
 
-  CURLcode res = curl_easy_perform(curl);
+  CURLcode res = MagdaHTTPReactor::Get().Perform(curl);
 
   bool success = false;
   if (res == CURLE_OK) {
@@ -1206,7 +1356,7 @@ bool MagdaOpenAI::GenerateJSFXStream(const char *question, const char *existing_
   }
 
   curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  MagdaHTTPPool::Get().Release(curl);
   return success;
 
 #else
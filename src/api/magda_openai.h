@@ -39,7 +39,9 @@ public:
   // Return false from callback to cancel stream
   using StreamCallback = std::function<bool(const char *partial_dsl, bool is_done)>;
 
-  // Generate DSL with streaming (for UI updates)
+  // Generate DSL with streaming: the callback gets each piece of the program
+  // as it is generated (on the network thread; it must not block), then
+  // is_done. MagdaDSL::StatementStream turns the pieces into statements.
   bool GenerateDSLStream(const char *question, const char *system_prompt, const char *state_json,
                          StreamCallback callback, WDL_FastString &error_msg);
 
@@ -60,13 +62,21 @@ public:
   // Validate API key by making a simple API call (GET /v1/models)
   bool ValidateAPIKey(WDL_FastString &error_msg);
 
+  // Completion of an async call; runs on the main thread
+  using ResultCallback = std::function<void(bool success, const char *error_msg)>;
+
+  // ValidateAPIKey without blocking the caller (network thread on
+  // macOS/Linux, a worker on Windows)
+  void ValidateAPIKeyAsync(ResultCallback done);
+
   // Get/set timeout (seconds)
   void SetTimeout(int seconds) { m_timeout_seconds = seconds; }
   int GetTimeout() const { return m_timeout_seconds; }
 
 private:
   // Build request JSON with CFG grammar tool
-  char *BuildRequestJSON(const char *question, const char *system_prompt, const char *state_json);
+  char *BuildRequestJSON(const char *question, const char *system_prompt, const char *state_json,
+                         bool stream = false);
 
   // Extract DSL from response JSON
   bool ExtractDSLFromResponse(const char *response_json, int response_len, WDL_FastString &out_dsl,
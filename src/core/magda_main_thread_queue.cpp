@@ -0,0 +1,95 @@
+#include "magda_main_thread_queue.h"
+#include <chrono>
+#include <vector>
+
+MagdaMainThreadQueue &MagdaMainThreadQueue::Get() {
+  static MagdaMainThreadQueue queue;
+  return queue;
+}
+
+MagdaMainThreadQueue::MagdaMainThreadQueue() : m_incoming(nullptr), m_numPending(0), m_tick(0) {}
+
+MagdaMainThreadQueue::~MagdaMainThreadQueue() { Clear(); }
+
+void MagdaMainThreadQueue::PostPolling(std::function<bool()> step, MainThreadPriority priority) {
+  Task *task = new Task;
+  task->step = std::move(step);
+  task->priority = priority >= 0 && priority < MAIN_THREAD_NUM_PRIORITIES ? priority
+                                                                          : MAIN_THREAD_NORMAL;
+  m_numPending.fetch_add(1, std::memory_order_relaxed);
+
+  Task *head = m_incoming.load(std::memory_order_relaxed);
+  do {
+    task->next = head;
+  } while (!m_incoming.compare_exchange_weak(head, task, std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
+
+void MagdaMainThreadQueue::TakeIncoming() {
+  Task *stack = m_incoming.exchange(nullptr, std::memory_order_acquire);
+
+  // The stack is newest first; reverse it to keep posting order
+  Task *oldest = nullptr;
+  while (stack) {
+    Task *next = stack->next;
+    stack->next = oldest;
+    oldest = stack;
+    stack = next;
+  }
+  for (Task *task = oldest; task; task = task->next) {
+    m_ready[task->priority].push_back(task);
+  }
+}
+
+int MagdaMainThreadQueue::RunPending(double budgetMs) {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  m_mainThread.store(std::this_thread::get_id());
+  m_tick++;
+
+  TakeIncoming();
+
+  // Tasks that asked to run again, per priority in their original order
+  std::vector<Task *> again[MAIN_THREAD_NUM_PRIORITIES];
+  int ran = 0;
+  bool outOfTime = false;
+  for (int p = 0; p < MAIN_THREAD_NUM_PRIORITIES && !outOfTime; p++) {
+    std::deque<Task *> &ready = m_ready[p];
+    while (!ready.empty()) {
+      if (ran > 0) {
+        double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsed >= budgetMs) {
+          outOfTime = true;
+          break;
+        }
+      }
+
+      Task *task = ready.front();
+      ready.pop_front();
+      ran++;
+      if (task->step()) {
+        delete task;
+        m_numPending.fetch_sub(1, std::memory_order_relaxed);
+      } else {
+        again[p].push_back(task);
+      }
+    }
+  }
+
+  // Unfinished tasks keep their place ahead of anything they haven't reached
+  for (int p = 0; p < MAIN_THREAD_NUM_PRIORITIES; p++) {
+    m_ready[p].insert(m_ready[p].begin(), again[p].begin(), again[p].end());
+  }
+  return ran;
+}
+
+void MagdaMainThreadQueue::Clear() {
+  TakeIncoming();
+  for (std::deque<Task *> &ready : m_ready) {
+    for (Task *task : ready) {
+      delete task;
+      m_numPending.fetch_sub(1, std::memory_order_relaxed);
+    }
+    ready.clear();
+  }
+}
@@ -0,0 +1,49 @@
+#include "magda_sample_ring.h"
+#include <cstring>
+
+MagdaSampleRing::MagdaSampleRing(size_t capacity) : m_writePos(0), m_readPos(0) {
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  m_buffer.assign(size, 0.0f);
+  m_mask = size - 1;
+}
+
+size_t MagdaSampleRing::GetReadAvailable() const {
+  return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire);
+}
+
+bool MagdaSampleRing::Write(const float *data, size_t count) {
+  size_t write = m_writePos.load(std::memory_order_relaxed);
+  size_t read = m_readPos.load(std::memory_order_acquire);
+  if (count > m_buffer.size() - (write - read)) {
+    return false;
+  }
+
+  // Copy in up to two pieces around the end of the buffer
+  size_t start = write & m_mask;
+  size_t first = count < m_buffer.size() - start ? count : m_buffer.size() - start;
+  memcpy(m_buffer.data() + start, data, first * sizeof(float));
+  memcpy(m_buffer.data(), data + first, (count - first) * sizeof(float));
+
+  m_writePos.store(write + count, std::memory_order_release);
+  return true;
+}
+
+size_t MagdaSampleRing::Read(float *out, size_t maxCount) {
+  size_t read = m_readPos.load(std::memory_order_relaxed);
+  size_t write = m_writePos.load(std::memory_order_acquire);
+  size_t count = write - read < maxCount ? write - read : maxCount;
+  if (count == 0) {
+    return 0;
+  }
+
+  size_t start = read & m_mask;
+  size_t first = count < m_buffer.size() - start ? count : m_buffer.size() - start;
+  memcpy(out, m_buffer.data() + start, first * sizeof(float));
+  memcpy(out + first, m_buffer.data(), (count - first) * sizeof(float));
+
+  m_readPos.store(read + count, std::memory_order_release);
+  return count;
+}
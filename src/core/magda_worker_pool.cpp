@@ -0,0 +1,140 @@
+#include "magda_worker_pool.h"
+
+MagdaWorkerPool &MagdaWorkerPool::Get() {
+  // At least one worker, so Submit() never runs on the (main) caller even on
+  // a single core or when the core count is unknown
+  int numWorkers = (int)std::thread::hardware_concurrency() - 1;
+  static MagdaWorkerPool pool(numWorkers > 0 ? numWorkers : 1);
+  return pool;
+}
+
+MagdaWorkerPool::MagdaWorkerPool(int numWorkers) : m_stopping(false) {
+  for (int i = 0; i < numWorkers; i++) {
+    m_workers.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+MagdaWorkerPool::~MagdaWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto &worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void MagdaWorkerPool::RunIndices(Job &job, std::unique_lock<std::mutex> &lock) {
+  while (job.next < job.count) {
+    int index = job.next++;
+    lock.unlock();
+    (*job.fn)(index);
+    lock.lock();
+    if (++job.completed == job.count) {
+      job.done.notify_all();
+    }
+  }
+}
+
+void MagdaWorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_wake.wait(lock, [this]() {
+      if (m_stopping) {
+        return true;
+      }
+      for (const auto &job : m_jobs) {
+        if (job->next < job->count && job->helpers < job->maxHelpers) {
+          return true;
+        }
+      }
+      return false;
+    });
+    if (m_stopping) {
+      return;
+    }
+
+    // Oldest job that still has work and room for another helper
+    std::shared_ptr<Job> job;
+    for (const auto &candidate : m_jobs) {
+      if (candidate->next < candidate->count && candidate->helpers < candidate->maxHelpers) {
+        job = candidate;
+        break;
+      }
+    }
+    if (!job) {
+      continue;
+    }
+
+    job->helpers++;
+    RunIndices(*job, lock);
+    job->helpers--;
+    if (job->detached && job->completed == job->count) {
+      RemoveJob(job);
+    }
+  }
+}
+
+void MagdaWorkerPool::RemoveJob(const std::shared_ptr<Job> &job) {
+  for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+    if (*it == job) {
+      m_jobs.erase(it);
+      break;
+    }
+  }
+}
+
+void MagdaWorkerPool::ParallelFor(int count, int maxThreads,
+                                  const std::function<void(int)> &fn) {
+  if (count <= 0) {
+    return;
+  }
+
+  int helpers = GetNumWorkers();
+  if (maxThreads > 0 && maxThreads - 1 < helpers) {
+    helpers = maxThreads - 1;
+  }
+  if (helpers <= 0 || count == 1) {
+    for (int i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->count = count;
+  job->maxHelpers = helpers;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_jobs.push_back(job);
+  m_wake.notify_all();
+
+  // The caller works too, then waits for indices still running elsewhere
+  RunIndices(*job, lock);
+  job->done.wait(lock, [&]() { return job->completed == job->count; });
+  RemoveJob(job);
+}
+
+void MagdaWorkerPool::Submit(std::function<void()> task) {
+  if (GetNumWorkers() == 0) {
+    // Callers are often the main thread; running a network request or an
+    // analysis here would block the UI
+    std::thread(std::move(task)).detach();
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->ownedFn = [task = std::move(task)](int) { task(); };
+  job->fn = &job->ownedFn;
+  job->count = 1;
+  job->maxHelpers = 1;
+  job->detached = true;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_jobs.push_back(job);
+  m_wake.notify_one();
+}
@@ -5,6 +5,8 @@
 #include "magda_drum_mapping_window.h"
 #include "magda_dsl_interpreter.h"
 #include "magda_dsp_analyzer.h"
+#include "magda_http_pool.h"
+#include "magda_http_reactor.h"
 #include "magda_imgui_api_keys.h"
 #include "magda_imgui_chat.h"
 #include "magda_imgui_login.h"
@@ -12,6 +14,8 @@
 #include "magda_imgui_plugin_window.h"
 #include "magda_imgui_settings.h"
 #include "magda_jsfx_editor.h"
+#include "magda_live_meter.h"
+#include "magda_main_thread_queue.h"
 #include "magda_param_mapping.h"
 #include "magda_param_mapping_window.h"
 #include "magda_plugin_scanner.h"
@@ -52,14 +56,16 @@ MagdaParamMappingWindow *g_paramMappingWindow = nullptr;
 // Global drum mapping window instance (defined in
 // magda_drum_mapping_window.cpp)
 
-// Separate timer callback for processing Reaper command queue
-// This runs at lower frequency and is separate from UI rendering
-static void commandQueueTimerCallback() {
-  // Process Reaper command queue (render, delete operations)
-  MagdaBounceWorkflow::ProcessCommandQueue();
+// Time each timer tick may spend on queued main-thread work; the rest of a
+// long queue waits for later ticks so the arrange view stays responsive
+static const double kMainThreadBudgetMs = 8.0;
 
-  // Process cleanup queue (legacy track deletion)
-  MagdaBounceWorkflow::ProcessCleanupQueue();
+// Separate timer callback for processing the main-thread queue
+// This is separate from UI rendering
+static void commandQueueTimerCallback() {
+  // Reaper operations posted by workflows and background threads (render,
+  // delete, streamed actions)
+  MagdaMainThreadQueue::Get().RunPending(kMainThreadBudgetMs);
 }
 
 // Timer callback for ImGui rendering
@@ -221,16 +227,17 @@ static void performDSPAnalysis(int trackIndex, const char *trackName, float anal
       snprintf(summary, sizeof(summary),
                "Track: '%s' (index %d)\n"
                "Analyzed: %.2f sec, %d Hz, %d channels\n"
-               "Loudness: RMS=%.1f dB, Peak=%.1f dB, LUFS≈%.1f\n"
+               "Loudness: RMS=%.1f dB, Peak=%.1f dB, LUFS=%.1f, LRA=%.1f LU\n"
                "Dynamics: Range=%.1f dB, Crest=%.1f dB\n"
                "Stereo: Width=%.2f, Correlation=%.2f\n"
                "Freq Bands: Sub=%.1f, Bass=%.1f, Mid=%.1f, High=%.1f dB\n"
                "Resonances detected: %zu\n",
                trackName, trackIndex, result.lengthSeconds, result.sampleRate, result.channels,
                result.loudness.rms, result.loudness.peak, result.loudness.lufs,
-               result.dynamics.dynamicRange, result.dynamics.crestFactor, result.stereo.width,
-               result.stereo.correlation, result.bands.sub, result.bands.bass, result.bands.mid,
-               result.bands.brilliance, result.resonances.size());
+               result.loudness.loudnessRange, result.dynamics.dynamicRange,
+               result.dynamics.crestFactor, result.stereo.width, result.stereo.correlation,
+               result.bands.sub, result.bands.bass, result.bands.mid, result.bands.brilliance,
+               result.resonances.size());
       ShowConsoleMsg(summary);
 
       if (!result.resonances.empty()) {
@@ -869,7 +876,16 @@ extern "C" {
 REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(REAPER_PLUGIN_HINSTANCE hInstance,
                                                       reaper_plugin_info_t *rec) {
   if (!rec) {
-    // Extension is being unloaded
+    // Extension is being unloaded; queued work would outlive REAPER's API.
+    // Stop the network thread first so no completion is queued after Clear().
+#ifndef _WIN32
+    MagdaHTTPReactor::Get().Shutdown();
+#endif
+    MagdaMainThreadQueue::Get().Clear();
+    MagdaLiveMeter::Get().Stop();
+#ifndef _WIN32
+    MagdaHTTPPool::Get().Shutdown();
+#endif
     if (g_imguiPluginWindow) {
       delete g_imguiPluginWindow;
       g_imguiPluginWindow = nullptr;
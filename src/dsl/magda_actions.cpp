@@ -1402,6 +1402,11 @@ bool MagdaActions::ExecuteAction(const wdl_json_element *action, WDL_FastString
       config.analysisLength = (float)atof(max_length_str);
       config.analyzeFullItem = false;
     }
+    const char *feature_frames_str = action->get_string_by_name("feature_frames", true);
+    if (feature_frames_str && atoi(feature_frames_str) > 0) {
+      config.analyzeFeatureFrames = true;
+      config.featureFrameBudget = atoi(feature_frames_str);
+    }
 
     // Perform analysis
     DSPAnalysisResult analysisResult = MagdaDSPAnalyzer::AnalyzeTrack(track_index, config);
@@ -1409,7 +1414,10 @@ bool MagdaActions::ExecuteAction(const wdl_json_element *action, WDL_FastString
     if (analysisResult.success) {
       result.Append("{\"action\":\"analyze_track\",\"success\":true,\"analysis\":");
       WDL_FastString analysisJson;
-      MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson);
+      DSPJSONOptions jsonOptions;
+      jsonOptions.spectrumBands = 32;
+      jsonOptions.maxBytes = 32768; // Room for feature frames when requested
+      MagdaDSPAnalyzer::ToJSON(analysisResult, analysisJson, jsonOptions);
       result.Append(analysisJson.Get());
 
       // Also include FX info
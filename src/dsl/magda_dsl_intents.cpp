@@ -0,0 +1,520 @@
+#include "magda_dsl_intents.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace MagdaDSL {
+
+// ============================================================================
+// Template Table
+// ============================================================================
+// Pattern words are matched case-insensitively; [word] is optional. Slots:
+//   {track} - "track 3", "the selected track", or a track name ("the bass")
+//   {db}    - a gain in dB ("-6", "-6db", "-6 db")
+//   {pan}   - left, right, center, -1..1 or a percentage ("30% left")
+//   {name}  - the rest of the command, as typed (must be the last slot)
+// The action is DSL with the same slots filled in.
+
+struct IntentTemplate {
+  const char *intent;
+  const char *pattern;
+  const char *action;
+};
+
+static const IntentTemplate kTemplates[] = {
+    {"mute", "mute {track}", "{track}.set_track(mute=true)"},
+    {"mute", "unmute {track}", "{track}.set_track(mute=false)"},
+    {"solo", "solo {track}", "{track}.set_track(solo=true)"},
+    {"solo", "unsolo {track}", "{track}.set_track(solo=false)"},
+    {"select", "select {track}", "{track}.set_track(selected=true)"},
+    {"delete", "delete {track}", "{track}.delete()"},
+    {"delete", "remove {track}", "{track}.delete()"},
+    {"volume", "set {track} volume to {db}", "{track}.set_track(volume_db={db})"},
+    {"volume", "set [the] volume of {track} to {db}", "{track}.set_track(volume_db={db})"},
+    {"pan", "pan {track} [to] {pan}", "{track}.set_track(pan={pan})"},
+    {"pan", "set {track} pan to {pan}", "{track}.set_track(pan={pan})"},
+    {"pan", "set [the] pan of {track} to {pan}", "{track}.set_track(pan={pan})"},
+    {"rename", "rename {track} to {name}", "{track}.set_track(name=\"{name}\")"},
+    {"create", "create [a] [new] track", "track()"},
+    {"create", "add [a] [new] track", "track()"},
+    {"create", "create [a] [new] track called {name}", "track(name=\"{name}\")"},
+    {"create", "create [a] [new] track named {name}", "track(name=\"{name}\")"},
+    {"create", "add [a] [new] track called {name}", "track(name=\"{name}\")"},
+    {"create", "add [a] [new] track named {name}", "track(name=\"{name}\")"},
+};
+
+static const size_t kMaxTrackWords = 8; // Longest track reference tried
+static const size_t kMaxNameLength = 64;
+
+// ============================================================================
+// Tokens
+// ============================================================================
+
+struct Word {
+  std::string text;  // As typed, trailing punctuation removed
+  std::string lower; // Lowercase for matching
+};
+
+// ASCII only: names and commands are matched byte for byte otherwise
+static bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static char Lower(char c) {
+  return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool IsTrailingPunct(char c) {
+  return c == ',' || c == '.' || c == '!' || c == '?' || c == ';' || c == ':';
+}
+
+static std::string ToLower(const std::string &s) {
+  std::string out = s;
+  for (char &c : out) {
+    c = Lower(c);
+  }
+  return out;
+}
+
+static void SplitWords(const char *text, std::vector<Word> &words) {
+  const char *p = text;
+  while (*p) {
+    while (*p && IsSpace(*p)) {
+      p++;
+    }
+    const char *start = p;
+    while (*p && !IsSpace(*p)) {
+      p++;
+    }
+    std::string text(start, p - start);
+    while (!text.empty() && IsTrailingPunct(text.back())) {
+      text.pop_back();
+    }
+    if (!text.empty()) {
+      words.push_back({text, ToLower(text)});
+    }
+  }
+}
+
+// A track name as SplitWords sees it: lowercase words, single spaces
+static std::string SpokenName(const std::string &name) {
+  std::string out;
+  out.reserve(name.size());
+  size_t i = 0;
+  while (i < name.size()) {
+    while (i < name.size() && IsSpace(name[i])) {
+      i++;
+    }
+    size_t start = i;
+    while (i < name.size() && !IsSpace(name[i])) {
+      i++;
+    }
+    size_t end = i;
+    while (end > start && IsTrailingPunct(name[end - 1])) {
+      end--;
+    }
+    if (end > start && !out.empty()) {
+      out += ' ';
+    }
+    for (size_t c = start; c < end; c++) {
+      out += Lower(name[c]);
+    }
+  }
+  return out;
+}
+
+// Drop politeness that doesn't change the command
+static void StripFiller(std::vector<Word> &words) {
+  size_t first = 0;
+  if (first < words.size() && words[first].lower == "please") {
+    first++;
+  }
+  if (first + 1 < words.size() &&
+      (words[first].lower == "can" || words[first].lower == "could") &&
+      words[first + 1].lower == "you") {
+    first += 2;
+  }
+  if (first < words.size() && words[first].lower == "please") {
+    first++;
+  }
+  words.erase(words.begin(), words.begin() + first);
+  if (!words.empty() && words.back().lower == "please") {
+    words.pop_back();
+  }
+}
+
+// Whole-string number; accepts a trailing suffix (e.g. "db" or "%")
+static bool ParseNumber(const std::string &s, const char *suffix, double &value) {
+  std::string digits = s;
+  size_t suffixLen = suffix ? strlen(suffix) : 0;
+  if (suffixLen && digits.size() > suffixLen &&
+      digits.compare(digits.size() - suffixLen, suffixLen, suffix) == 0) {
+    digits.erase(digits.size() - suffixLen);
+  }
+  if (digits.empty() || !(isdigit((unsigned char)digits[0]) || strchr("+-.", digits[0]))) {
+    return false;
+  }
+  char *end = nullptr;
+  value = strtod(digits.c_str(), &end);
+  return end && *end == '\0';
+}
+
+static std::string FormatNumber(double value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%g", value == 0.0 ? 0.0 : value); // No "-0"
+  return buf;
+}
+
+// ============================================================================
+// Slots
+// ============================================================================
+
+struct Slots {
+  std::string track;
+  std::string db;
+  std::string pan;
+  std::string name;
+};
+
+// Every track a span of words could mean, as DSL references
+// (names: SpokenName of each track)
+static void ResolveTrack(const std::vector<Word> &words, size_t begin, size_t end,
+                         const std::vector<std::string> &names, std::vector<std::string> &refs) {
+  if (begin < end && end - begin > 1 && words[begin].lower == "the") {
+    begin++;
+  }
+  size_t count = end - begin;
+  if (count == 0) {
+    return;
+  }
+
+  if (count == 2 && words[begin].lower == "selected" && words[begin + 1].lower == "track") {
+    refs.push_back("track(selected=true)");
+    return;
+  }
+
+  // "track 3", "track #3", "track number 3"
+  if (words[begin].lower == "track" && (count == 2 || count == 3)) {
+    if (count == 2 || words[begin + 1].lower == "number") {
+      std::string number = words[end - 1].lower;
+      if (count == 2 && !number.empty() && number[0] == '#') {
+        number.erase(0, 1);
+      }
+      char *numEnd = nullptr;
+      long id = number.empty() || !isdigit((unsigned char)number[0])
+                    ? 0
+                    : strtol(number.c_str(), &numEnd, 10);
+      if (id > 0 && numEnd && *numEnd == '\0' && id <= (long)names.size()) {
+        refs.push_back("track(id=" + std::to_string(id) + ")");
+      }
+    }
+  }
+
+  // A name, possibly with "track" before or after it ("the bass track")
+  std::string spoken[3];
+  for (size_t i = begin; i < end; i++) {
+    if (i > begin) {
+      spoken[0] += ' ';
+    }
+    spoken[0] += words[i].lower;
+  }
+  if (count > 1 && words[end - 1].lower == "track") {
+    spoken[1] = spoken[0].substr(0, spoken[0].size() - 6);
+  }
+  if (count > 1 && words[begin].lower == "track") {
+    spoken[2] = spoken[0].substr(6);
+  }
+
+  for (size_t t = 0; t < names.size(); t++) {
+    if (names[t].empty()) {
+      continue;
+    }
+    for (const std::string &s : spoken) {
+      if (s == names[t]) {
+        refs.push_back("track(id=" + std::to_string(t + 1) + ")");
+        break;
+      }
+    }
+  }
+}
+
+static bool ParseDB(const std::vector<Word> &words, size_t begin, size_t end, std::string &db) {
+  double value = 0.0;
+  size_t count = end - begin;
+  if (count == 1) {
+    if (!ParseNumber(words[begin].lower, "db", value)) {
+      return false;
+    }
+  } else if (count == 2) {
+    if (words[begin + 1].lower != "db" || !ParseNumber(words[begin].lower, nullptr, value)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (!(value >= -150.0 && value <= 12.0)) { // Also rejects "nan"
+    return false;
+  }
+  db = FormatNumber(value);
+  return true;
+}
+
+static bool ParseSide(const std::string &word, double &side) {
+  if (word == "left") {
+    side = -1.0;
+  } else if (word == "right") {
+    side = 1.0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool ParsePan(const std::vector<Word> &words, size_t begin, size_t end, std::string &pan) {
+  if (end - begin > 1 && words[begin].lower == "the") {
+    begin++; // "to the left"
+  }
+  size_t count = end - begin;
+  const std::string &first = words[begin].lower;
+  double value = 0.0;
+  double side = 0.0;
+  if (count == 1) {
+    if (first == "center" || first == "centre" || first == "middle") {
+      value = 0.0;
+    } else if (ParseSide(first, side)) {
+      value = side;
+    } else if (!ParseNumber(first, nullptr, value)) {
+      return false;
+    }
+  } else if (count == 2) {
+    // "hard left", "30% right", "30 left"
+    if (!ParseSide(words[begin + 1].lower, side)) {
+      return false;
+    }
+    if (first == "hard" || first == "full" || first == "fully") {
+      value = side;
+    } else if (ParseNumber(first, "%", value) && value >= 0.0) {
+      value = side * value / 100.0;
+    } else {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (!(value >= -1.0 && value <= 1.0)) {
+    return false;
+  }
+  pan = FormatNumber(value);
+  return true;
+}
+
+static bool ParseName(const std::vector<Word> &words, size_t begin, size_t end,
+                      std::string &name) {
+  name.clear();
+  for (size_t i = begin; i < end; i++) {
+    if (i > begin) {
+      name += ' ';
+    }
+    name += words[i].text;
+  }
+  // Quotes around the name are not part of it
+  if (name.size() >= 2 && (name[0] == '"' || name[0] == '\'') && name.back() == name[0]) {
+    name = name.substr(1, name.size() - 2);
+  }
+  // DSL strings have no escapes
+  return !name.empty() && name.size() <= kMaxNameLength && name.find('"') == std::string::npos;
+}
+
+// ============================================================================
+// Matching
+// ============================================================================
+
+struct Element {
+  enum Kind { WORD, OPTIONAL, TRACK, DB, PAN, NAME } kind;
+  std::string word;
+};
+
+static std::vector<Element> ParsePattern(const char *pattern) {
+  std::vector<Element> elements;
+  std::vector<Word> words;
+  SplitWords(pattern, words);
+  for (const Word &w : words) {
+    Element e{Element::WORD, w.lower};
+    if (w.lower == "{track}") {
+      e.kind = Element::TRACK;
+    } else if (w.lower == "{db}") {
+      e.kind = Element::DB;
+    } else if (w.lower == "{pan}") {
+      e.kind = Element::PAN;
+    } else if (w.lower == "{name}") {
+      e.kind = Element::NAME;
+    } else if (w.lower.size() > 2 && w.lower[0] == '[') {
+      e.kind = Element::OPTIONAL;
+      e.word = w.lower.substr(1, w.lower.size() - 2);
+    }
+    elements.push_back(e);
+  }
+  return elements;
+}
+
+static std::string Render(const char *action, const Slots &slots) {
+  std::string out;
+  for (const char *p = action; *p; p++) {
+    if (*p == '{') {
+      const char *close = strchr(p, '}');
+      std::string slot(p + 1, close - p - 1);
+      if (slot == "track") {
+        out += slots.track;
+      } else if (slot == "db") {
+        out += slots.db;
+      } else if (slot == "pan") {
+        out += slots.pan;
+      } else if (slot == "name") {
+        out += slots.name;
+      }
+      p = close;
+    } else {
+      out += *p;
+    }
+  }
+  return out;
+}
+
+// A new track named after an existing one would refer to it instead
+static bool NameExists(const std::string &name, const std::vector<std::string> &names) {
+  std::string spoken = SpokenName(name);
+  for (const std::string &existing : names) {
+    if (existing == spoken) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct MatchState {
+  const std::vector<Word> &words;
+  const std::vector<std::string> &names;
+  const std::vector<Element> &elements;
+  const IntentTemplate &tmpl;
+  std::vector<std::string> &results;
+};
+
+// Try every way the words from w on can fill the elements from e on
+static void MatchFrom(MatchState &m, size_t e, size_t w, Slots &slots) {
+  const std::vector<Word> &words = m.words;
+  if (e == m.elements.size()) {
+    bool createsExisting = strcmp(m.tmpl.intent, "create") == 0 && !slots.name.empty() &&
+                           NameExists(slots.name, m.names);
+    if (w == words.size() && !createsExisting) {
+      m.results.push_back(Render(m.tmpl.action, slots));
+    }
+    return;
+  }
+
+  const Element &element = m.elements[e];
+  switch (element.kind) {
+  case Element::WORD:
+    if (w < words.size() && words[w].lower == element.word) {
+      MatchFrom(m, e + 1, w + 1, slots);
+    }
+    return;
+  case Element::OPTIONAL:
+    if (w < words.size() && words[w].lower == element.word) {
+      MatchFrom(m, e + 1, w + 1, slots);
+    }
+    MatchFrom(m, e + 1, w, slots);
+    return;
+  case Element::TRACK:
+    for (size_t end = w + 1; end <= words.size() && end - w <= kMaxTrackWords; end++) {
+      // Only look up spans the rest of the pattern could follow
+      const Element *next = e + 1 < m.elements.size() ? &m.elements[e + 1] : nullptr;
+      if (next ? next->kind == Element::WORD &&
+                     (end == words.size() || words[end].lower != next->word)
+               : end != words.size()) {
+        continue;
+      }
+      std::vector<std::string> refs;
+      ResolveTrack(words, w, end, m.names, refs);
+      for (const std::string &ref : refs) {
+        slots.track = ref;
+        MatchFrom(m, e + 1, end, slots);
+      }
+    }
+    return;
+  case Element::DB:
+  case Element::PAN:
+    for (size_t end = w + 1; end <= words.size() && end - w <= 3; end++) {
+      bool ok = element.kind == Element::DB ? ParseDB(words, w, end, slots.db)
+                                            : ParsePan(words, w, end, slots.pan);
+      if (ok) {
+        MatchFrom(m, e + 1, end, slots);
+      }
+    }
+    return;
+  case Element::NAME:
+    if (w < words.size() && ParseName(words, w, words.size(), slots.name)) {
+      MatchFrom(m, e + 1, words.size(), slots);
+    }
+    return;
+  }
+}
+
+bool IntentMatcher::Match(const char *command, const std::vector<std::string> &trackNames,
+                          IntentMatch &out) {
+  if (!command) {
+    return false;
+  }
+
+  // Patterns are parsed once; the table never changes
+  static const std::vector<std::vector<Element>> patterns = []() {
+    std::vector<std::vector<Element>> parsed;
+    for (const IntentTemplate &tmpl : kTemplates) {
+      parsed.push_back(ParsePattern(tmpl.pattern));
+    }
+    return parsed;
+  }();
+
+  std::vector<Word> words;
+  SplitWords(command, words);
+  StripFiller(words);
+  if (words.empty()) {
+    return false;
+  }
+
+  std::vector<std::string> names; // Filled once a pattern's verb matches
+  std::string dsl;
+  const char *intent = nullptr;
+  for (size_t i = 0; i < patterns.size(); i++) {
+    // Every pattern starts with a literal verb
+    if (patterns[i].empty() || patterns[i][0].word != words[0].lower) {
+      continue;
+    }
+    if (names.size() != trackNames.size()) {
+      names.reserve(trackNames.size());
+      for (const std::string &name : trackNames) {
+        names.push_back(SpokenName(name));
+      }
+    }
+    std::vector<std::string> results;
+    MatchState state{words, names, patterns[i], kTemplates[i], results};
+    Slots slots;
+    MatchFrom(state, 0, 0, slots);
+    for (const std::string &result : results) {
+      if (!dsl.empty() && result != dsl) {
+        return false; // Two readings disagree: let the LLM decide
+      }
+      dsl = result;
+      intent = kTemplates[i].intent;
+    }
+  }
+
+  if (dsl.empty()) {
+    return false;
+  }
+  out.dsl = dsl;
+  out.intent = intent;
+  return true;
+}
+
+} // namespace MagdaDSL
@@ -0,0 +1,144 @@
+#include "magda_dsl_stream.h"
+#include <cstring>
+
+namespace MagdaDSL {
+
+static bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+StatementStream::StatementStream() {
+  Reset();
+}
+
+void StatementStream::Reset() {
+  m_buffer.clear();
+  m_scan = 0;
+  m_depth = 0;
+  m_inString = false;
+  m_inComment = false;
+  m_closed = false;
+  m_closeEnd = 0;
+}
+
+void StatementStream::Feed(const char *text, std::vector<std::string> &out) {
+  if (text) {
+    Feed(text, (int)strlen(text), out);
+  }
+}
+
+void StatementStream::Feed(const char *text, int len, std::vector<std::string> &out) {
+  if (text && len > 0) {
+    m_buffer.append(text, len);
+  }
+
+  while (m_scan < m_buffer.size()) {
+    char c = m_buffer[m_scan];
+    if (m_inComment) {
+      m_inComment = c != '\n';
+      m_scan++;
+      continue;
+    }
+    if (m_inString) {
+      m_inString = c != '"';
+      m_scan++;
+      continue;
+    }
+    if (c == '/') {
+      // "//" may be split across pieces; wait for the next one
+      if (m_scan + 1 >= m_buffer.size()) {
+        break;
+      }
+      if (m_buffer[m_scan + 1] == '/') {
+        m_inComment = true;
+        m_scan += 2;
+        continue;
+      }
+    }
+    if (IsSpace(c)) {
+      m_scan++;
+      continue;
+    }
+
+    if (m_closed) {
+      if (c != '.') {
+        // c starts the next statement; look at it again afterwards
+        Emit(m_closeEnd, out);
+        continue;
+      }
+      m_closed = false; // The chain goes on
+    }
+
+    if (c == '"') {
+      m_inString = true;
+    } else if (c == '(' || c == '[') {
+      m_depth++;
+    } else if (c == ')' || c == ']') {
+      if (m_depth > 0) {
+        m_depth--;
+      }
+      if (m_depth == 0 && c == ')') {
+        m_closed = true;
+        m_closeEnd = m_scan + 1;
+      }
+    }
+    m_scan++;
+  }
+}
+
+void StatementStream::Finish(std::vector<std::string> &out) {
+  Emit(m_buffer.size(), out);
+  Reset();
+}
+
+void StatementStream::Emit(size_t end, std::vector<std::string> &out) {
+  std::string statement;
+  bool inString = false;
+  bool inComment = false;
+  bool joinLine = false; // Drop whitespace after a line break
+  for (size_t i = 0; i < end; i++) {
+    char c = m_buffer[i];
+    if (inComment) {
+      if (c != '\n') {
+        continue;
+      }
+      inComment = false;
+    }
+    if (inString) {
+      inString = c != '"';
+      statement += c;
+      continue;
+    }
+    if (c == '/' && i + 1 < end && m_buffer[i + 1] == '/') {
+      inComment = true;
+      continue;
+    }
+    if (c == '\n' || c == '\r') {
+      while (!statement.empty() && IsSpace(statement.back())) {
+        statement.pop_back();
+      }
+      joinLine = true;
+      continue;
+    }
+    if (joinLine && IsSpace(c)) {
+      continue;
+    }
+    joinLine = false;
+    inString = c == '"';
+    statement += c;
+  }
+
+  size_t first = statement.find_first_not_of(" \t");
+  if (first != std::string::npos) {
+    size_t last = statement.find_last_not_of(" \t");
+    out.push_back(statement.substr(first, last - first + 1));
+  }
+
+  m_buffer.erase(0, end);
+  m_scan -= end < m_scan ? end : m_scan;
+  m_depth = 0;
+  m_closed = false;
+  m_closeEnd = 0;
+}
+
+} // namespace MagdaDSL
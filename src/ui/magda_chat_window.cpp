@@ -549,19 +549,19 @@ void MagdaChatWindow::CheckAPIHealth() {
   // Update status to checking
   UpdateStatus("Checking API...", false);
 
-  // Try to ping the API health endpoint
+  // Ping the API health endpoint; the status updates when the answer arrives
   static MagdaHTTPClient httpClient;
-  WDL_FastString error_msg;
-
-  bool success = httpClient.CheckHealth(error_msg, 5);
-
-  if (success) {
-    UpdateStatus("API: Connected", true);
-  } else {
-    char status[256];
-    snprintf(status, sizeof(status), "API: Offline - %s", error_msg.Get());
-    UpdateStatus(status, false);
-  }
+  httpClient.CheckHealthAsync(
+      [this](bool success, const WDL_FastString &, const WDL_FastString &error_msg) {
+        if (success) {
+          UpdateStatus("API: Connected", true);
+        } else {
+          char status[256];
+          snprintf(status, sizeof(status), "API: Offline - %s", error_msg.Get());
+          UpdateStatus(status, false);
+        }
+      },
+      5);
 }
 
 void MagdaChatWindow::UpdateStatus(const char *status, bool isOK) {
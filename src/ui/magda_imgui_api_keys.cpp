@@ -3,7 +3,6 @@
 #include "magda_openai.h"
 #include <cstdlib>
 #include <cstring>
-#include <thread>
 
 // g_rec is needed for REAPER API access
 extern reaper_plugin_info_t *g_rec;
@@ -227,38 +226,29 @@ void MagdaImGuiApiKeys::ValidateOpenAIKey() {
   m_openaiKeyStatus = ApiKeyStatus::Checking;
   m_statusMessage = "Validating...";
 
-  // Create a copy of the key for the thread
-  char keyCopy[256];
-  strncpy(keyCopy, m_openaiApiKey, sizeof(keyCopy) - 1);
-  keyCopy[sizeof(keyCopy) - 1] = '\0';
-
-  // Validate in background thread
-  std::thread([this, keyCopy]() {
-    MagdaOpenAI *openai = GetMagdaOpenAI();
-    if (!openai) {
-      OnValidationComplete(false, "OpenAI client not available");
-      return;
-    }
-
-    // Set the key for validation
-    openai->SetAPIKey(keyCopy);
+  MagdaOpenAI *openai = GetMagdaOpenAI();
+  if (!openai) {
+    OnValidationComplete(false, "OpenAI client not available");
+    return;
+  }
 
-    // Also set on agent manager
-    MagdaAgentManager *agentMgr = GetMagdaAgentManager();
-    if (agentMgr) {
-      agentMgr->SetAPIKey(keyCopy);
-    }
+  // Set the key for validation
+  openai->SetAPIKey(m_openaiApiKey);
 
-    // Validate by calling GET /v1/models
-    WDL_FastString error;
-    bool success = openai->ValidateAPIKey(error);
+  // Also set on agent manager
+  MagdaAgentManager *agentMgr = GetMagdaAgentManager();
+  if (agentMgr) {
+    agentMgr->SetAPIKey(m_openaiApiKey);
+  }
 
+  // Validate by calling GET /v1/models; the result comes back on the main thread
+  openai->ValidateAPIKeyAsync([this](bool success, const char *error) {
     if (success) {
       OnValidationComplete(true, "API key is valid!");
     } else {
-      OnValidationComplete(false, error.GetLength() > 0 ? error.Get() : "Invalid API key");
+      OnValidationComplete(false, error && error[0] ? error : "Invalid API key");
     }
-  }).detach();
+  });
 }
 
 void MagdaImGuiApiKeys::OnValidationComplete(bool success, const char *message) {
@@ -12,13 +12,18 @@
 #include "magda_actions.h"
 #include "magda_api_client.h"
 #include "magda_bounce_workflow.h"
+#include "magda_dsl_intents.h"
+#include "magda_dsl_stream.h"
 #include "magda_imgui_api_keys.h"
 #include "magda_imgui_login.h"
 #include "magda_imgui_settings.h"
+#include "magda_live_meter.h"
+#include "magda_main_thread_queue.h"
 #include "magda_param_mapping.h"
 #include "magda_plugin_scanner.h"
 #include "magda_state.h"
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 #include <set>
@@ -399,12 +404,15 @@ void MagdaImGuiChat::ShowWithInput(const char *text) {
 }
 
 void MagdaImGuiChat::CheckAPIHealth() {
-  WDL_FastString error_msg;
-  if (s_httpClient.CheckHealth(error_msg, 3)) {
-    SetAPIStatus("Connected", 0x88FF88FF); // Green
-  } else {
-    SetAPIStatus("Disconnected", 0xFF6666FF); // Red
-  }
+  s_httpClient.CheckHealthAsync(
+      [this](bool success, const WDL_FastString &, const WDL_FastString &) {
+        if (success) {
+          SetAPIStatus("Connected", 0x88FF88FF); // Green
+        } else {
+          SetAPIStatus("Disconnected", 0xFF6666FF); // Red
+        }
+      },
+      3);
 }
 
 void MagdaImGuiChat::Render() {
@@ -745,7 +753,13 @@ void MagdaImGuiChat::Render() {
           }
         }
         char loadingMsg[128];
-        snprintf(loadingMsg, sizeof(loadingMsg), "%s %s", spinnerFrames[frameIndex], phaseMsg);
+        float progress = MagdaBounceWorkflow::GetPhaseProgress();
+        if (phase != MIX_PHASE_IDLE && progress >= 0.0f) {
+          snprintf(loadingMsg, sizeof(loadingMsg), "%s %s %d%%", spinnerFrames[frameIndex],
+                   phaseMsg, (int)(progress * 100.0f));
+        } else {
+          snprintf(loadingMsg, sizeof(loadingMsg), "%s %s", spinnerFrames[frameIndex], phaseMsg);
+        }
         m_ImGui_TextColored(m_ctx, g_theme.statusYellow, loadingMsg);
         m_scrollToBottom = true;
       }
@@ -991,7 +1005,13 @@ void MagdaImGuiChat::RenderResponseColumn() {
           break;
         }
         char loadingMsg[128];
-        snprintf(loadingMsg, sizeof(loadingMsg), "%s %s", spinnerFrames[frameIndex], phaseMsg);
+        float progress = MagdaBounceWorkflow::GetPhaseProgress();
+        if (phase != MIX_PHASE_IDLE && progress >= 0.0f) {
+          snprintf(loadingMsg, sizeof(loadingMsg), "%s %s %d%%", spinnerFrames[frameIndex],
+                   phaseMsg, (int)(progress * 100.0f));
+        } else {
+          snprintf(loadingMsg, sizeof(loadingMsg), "%s %s", spinnerFrames[frameIndex], phaseMsg);
+        }
         m_ImGui_TextColored(m_ctx, g_theme.statusYellow, loadingMsg);
       }
       m_scrollToBottom = true; // Keep scrolling to show new content
@@ -1464,6 +1484,7 @@ void MagdaImGuiChat::UpdateAutocompleteSuggestions() {
         {"bus", "Analyze bus/group track"},
         {"group", "Analyze group/submix track"},
         {"compare", "Compare multiple tracks"},
+        {"live", "Live master metering (on [seconds] / off)"},
     };
 
     for (const auto &pair : mixTypes) {
@@ -1690,7 +1711,7 @@ void MagdaImGuiChat::CopyToClipboard() {
 
 // Check if message is a #mix command and handle it
 // Returns true if handled (should not be sent to regular API)
-// Supports: #master, #drums, #bass, #synth, #compare, etc.
+// Supports: #master, #drums, #bass, #synth, #compare, #live, etc.
 bool MagdaImGuiChat::HandleMixCommand(const std::string &msg) {
   // Check for # prefix (new style) or legacy @mix:/@master: prefixes
   size_t hashPos = msg.find('#');
@@ -1797,6 +1818,41 @@ bool MagdaImGuiChat::HandleMixCommand(const std::string &msg) {
     return true;
   }
 
+  // Handle #live command: live master metering feeds #master without a render
+  if (lowerCmd == "live") {
+    MagdaLiveMeter &meter = MagdaLiveMeter::Get();
+    std::string arg = userQuery;
+    std::transform(arg.begin(), arg.end(), arg.begin(), ::tolower);
+    char reply[256];
+    if (arg == "on" || arg.compare(0, 3, "on ") == 0) {
+      double seconds = atof(arg.c_str() + 2);
+      WDL_FastString error_msg;
+      if (!meter.Start(seconds > 0.0 ? seconds : 30.0, error_msg)) {
+        std::string errorStr = "Live metering failed: ";
+        errorStr += error_msg.Get();
+        AddAssistantMessage(errorStr);
+        return true;
+      }
+      snprintf(reply, sizeof(reply),
+               "Live metering on: analyzing the latest %.0f s of playback. #master will use it "
+               "instead of rendering while playback runs.",
+               meter.GetHistorySeconds());
+    } else if (arg == "off") {
+      meter.Stop();
+      snprintf(reply, sizeof(reply), "Live metering off.");
+    } else if (meter.IsRunning()) {
+      snprintf(reply, sizeof(reply),
+               "Live metering on: %.1f of %.0f s captured, %lld frames dropped.",
+               meter.GetCapturedSeconds(), meter.GetHistorySeconds(), meter.GetDroppedFrames());
+    } else {
+      snprintf(reply, sizeof(reply),
+               "Live metering is off. Use #live on [seconds] (1-%.0f) to start it.",
+               MagdaLiveMeter::kMaxHistorySeconds);
+    }
+    AddAssistantMessage(reply);
+    return true;
+  }
+
   // Handle #compare command
   if (lowerCmd == "compare") {
     if (userQuery.empty()) {
@@ -1917,7 +1973,8 @@ void MagdaImGuiChat::StartDirectOpenAIRequest(const std::string &question) {
     m_directOpenAI = true; // Mark as direct OpenAI (DSL result)
     m_asyncResponseJson.clear();
     m_asyncErrorMsg.clear();
-    m_streamingActions.clear();
+    m_asyncTiming.clear();
+    m_streamGeneration++;
   }
 
   // Wait for any previous thread to finish
@@ -1940,15 +1997,33 @@ void MagdaImGuiChat::StartDirectOpenAIRequest(const std::string &question) {
         return;
       }
 
-      // Use simple DAW-only mode via OpenAI client
-      WDL_FastString dslCode, errorMsg;
-      bool success = openai->GenerateDSLWithState(question.c_str(), MAGDA_DSL_TOOL_DESCRIPTION,
-                                                  stateStr.c_str(), dslCode, errorMsg);
+      // Use simple DAW-only mode via OpenAI client. Each statement runs as
+      // soon as it has streamed in.
+      MagdaDSL::StatementStream statements;
+      int streamedCount = 0;
+      auto onPiece = [this, &statements, &streamedCount](const char *partial_dsl, bool is_done) {
+        std::vector<std::string> complete;
+        statements.Feed(partial_dsl, complete);
+        if (is_done) {
+          statements.Finish(complete);
+        }
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        for (const std::string &statement : complete) {
+          QueueStreamedDSL(statement);
+          streamedCount++;
+        }
+        return !m_cancelRequested;
+      };
+      WDL_FastString errorMsg;
+      bool success = openai->GenerateDSLStream(question.c_str(), MAGDA_DSL_TOOL_DESCRIPTION,
+                                               stateStr.c_str(), onPiece, errorMsg);
 
       std::lock_guard<std::mutex> lock(m_asyncMutex);
-      m_asyncSuccess = success && dslCode.GetLength() > 0;
-      m_asyncResponseJson = dslCode.Get();
+      m_asyncSuccess = success && streamedCount > 0;
       m_asyncErrorMsg = errorMsg.Get();
+      if (!m_asyncSuccess && m_asyncErrorMsg.empty()) {
+        m_asyncErrorMsg = "No DSL generated";
+      }
       m_asyncResultReady = true;
       m_asyncPending = false;
       return;
@@ -1957,12 +2032,26 @@ void MagdaImGuiChat::StartDirectOpenAIRequest(const std::string &question) {
     // Use agent orchestration (detects and runs appropriate agents)
     std::vector<AgentResult> results;
     WDL_FastString errorMsg;
-    bool success = agentMgr->Orchestrate(question.c_str(), stateStr.c_str(), results, errorMsg);
+    OrchestrationStats stats;
+    // The DAW program streams; its statements run as they complete
+    auto onStatement = [this](const char *statement) {
+      std::lock_guard<std::mutex> lock(m_asyncMutex);
+      QueueStreamedDSL(statement);
+    };
+    bool success = agentMgr->Orchestrate(question.c_str(), stateStr.c_str(), results, errorMsg,
+                                         &stats, onStatement);
+    char timing[128];
+    MagdaAgentManager::FormatStats(stats, timing, sizeof(timing));
 
     if (success && !results.empty()) {
-      // Combine all DSL results
+      // Combine all DSL results (streamed ones have already run)
       std::string combinedDSL;
+      bool anyStreamed = false;
       for (const auto &result : results) {
+        if (result.streamed) {
+          anyStreamed = anyStreamed || result.success;
+          continue;
+        }
         if (result.success && !result.dslCode.empty()) {
           if (!combinedDSL.empty())
             combinedDSL += "\n";
@@ -1971,9 +2060,10 @@ void MagdaImGuiChat::StartDirectOpenAIRequest(const std::string &question) {
       }
 
       std::lock_guard<std::mutex> lock(m_asyncMutex);
-      m_asyncSuccess = !combinedDSL.empty();
+      m_asyncSuccess = !combinedDSL.empty() || anyStreamed;
       m_asyncResponseJson = combinedDSL;
       m_asyncErrorMsg = m_asyncSuccess ? "" : "No DSL generated";
+      m_asyncTiming = timing;
       m_asyncResultReady = true;
       m_asyncPending = false;
     } else {
@@ -1986,6 +2076,63 @@ void MagdaImGuiChat::StartDirectOpenAIRequest(const std::string &question) {
   });
 }
 
+bool MagdaImGuiChat::StartLocalCommand(const std::string &question) {
+  if (!g_rec) {
+    return false;
+  }
+  int (*GetNumTracks)() = (int (*)())g_rec->GetFunc("GetNumTracks");
+  const char *(*GetTrackInfo)(INT_PTR, int *) =
+      (const char *(*)(INT_PTR, int *))g_rec->GetFunc("GetTrackInfo");
+  if (!GetNumTracks || !GetTrackInfo) {
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> trackNames;
+  int numTracks = GetNumTracks();
+  for (int i = 0; i < numTracks; i++) {
+    int flags = 0;
+    const char *name = GetTrackInfo(i, &flags);
+    trackNames.push_back(name ? name : "");
+  }
+
+  MagdaDSL::IntentMatch match;
+  if (!MagdaDSL::IntentMatcher::Match(question.c_str(), trackNames, match)) {
+    return false;
+  }
+  long long us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  void (*ShowConsoleMsg)(const char *msg) =
+      (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+  if (ShowConsoleMsg) {
+    char log_msg[512];
+    snprintf(log_msg, sizeof(log_msg), "MAGDA: Local %s command in %lld us, skipping the LLM\n",
+             match.intent, us);
+    ShowConsoleMsg(log_msg);
+  }
+
+  // Hand the DSL to ProcessAsyncResult as if the LLM had produced it
+  if (m_asyncThread.joinable()) {
+    m_asyncThread.join();
+  }
+  char timing[64];
+  snprintf(timing, sizeof(timing), "local, %lld us", us);
+  std::lock_guard<std::mutex> lock(m_asyncMutex);
+  m_pendingQuestion = question;
+  m_asyncPending = false;
+  m_asyncSuccess = true;
+  m_cancelRequested = false;
+  m_directOpenAI = true;
+  m_asyncResponseJson = match.dsl;
+  m_asyncErrorMsg.clear();
+  m_asyncTiming = timing;
+  m_streamGeneration++;
+  m_asyncResultReady = true;
+  return true;
+}
+
 void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
   // Don't start a new request if one is already pending
   {
@@ -2004,6 +2151,11 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
   // "Processing...")
   MagdaBounceWorkflow::SetCurrentPhase(MIX_PHASE_IDLE);
 
+  // Simple track commands ("mute track 3") don't need the LLM
+  if (StartLocalCommand(question)) {
+    return;
+  }
+
   // Check if OpenAI API key is configured - use direct OpenAI if available
   MagdaOpenAI *openai = GetMagdaOpenAI();
   if (openai && openai->HasAPIKey()) {
@@ -2083,7 +2235,7 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
     m_cancelRequested = false; // Reset cancel flag for new request
     m_asyncResponseJson.clear();
     m_asyncErrorMsg.clear();
-    m_streamingActions.clear(); // Clear any pending actions
+    m_streamGeneration++; // Skip any actions still queued from the last request
   }
 
   // Wait for any previous thread to finish
@@ -2152,7 +2304,7 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
 
               {
                 std::lock_guard<std::mutex> lock(ctx->chat->m_asyncMutex);
-                ctx->chat->m_streamingActions.push_back(actionEventJson);
+                ctx->chat->QueueStreamedAction(actionEventJson);
               }
               ctx->allActions.push_back(actionEventJson);
               ctx->actionCount++;
@@ -2240,7 +2392,7 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
 
           {
             std::lock_guard<std::mutex> lock(ctx->chat->m_asyncMutex);
-            ctx->chat->m_streamingActions.push_back(actionJson);
+            ctx->chat->QueueStreamedAction(actionJson);
 
             // Format and add to streaming buffer for display
             std::string formatted = FormatAction(root, ctx->actionCount);
@@ -2261,7 +2413,7 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
         // Parse failed - might still be valid JSON, try queuing it
         {
           std::lock_guard<std::mutex> lock(ctx->chat->m_asyncMutex);
-          ctx->chat->m_streamingActions.push_back(std::string(event_json));
+          ctx->chat->QueueStreamedAction(std::string(event_json));
 
           // Still add to buffer for visibility
           char progress_msg[256];
@@ -2295,6 +2447,305 @@ void MagdaImGuiChat::StartAsyncRequest(const std::string &question) {
   });
 }
 
+// Human-readable summary of what a DSL command did ("" if nothing to report)
+static std::string GetDSLActionSummary(const std::string &line) {
+  // Check for chained commands first - the action is what comes after the dot
+  // e.g., track(id=1).add_automation(...) -> "Added automation"
+
+  // Check for automation first (highest priority since it's the main action)
+  if (line.find(".add_automation") != std::string::npos ||
+      line.find(".addAutomation") != std::string::npos) {
+    size_t paramStart = line.find("param=\"");
+    if (paramStart != std::string::npos) {
+      paramStart += 7;
+      size_t paramEnd = line.find("\"", paramStart);
+      if (paramEnd != std::string::npos) {
+        std::string param = line.substr(paramStart, paramEnd - paramStart);
+        // Clean up @plugin:param format for display
+        size_t colonPos = param.find(':');
+        if (colonPos != std::string::npos && param[0] == '@') {
+          param = param.substr(colonPos + 1); // Just show param name
+        }
+        return "Added automation on '" + param + "'";
+      }
+    }
+    return "Added automation";
+  }
+
+  // Check for add_fx
+  if (line.find(".add_fx") != std::string::npos) {
+    size_t fxStart = line.find("fxname=\"");
+    if (fxStart != std::string::npos) {
+      fxStart += 8;
+      size_t fxEnd = line.find("\"", fxStart);
+      if (fxEnd != std::string::npos) {
+        return "Added FX '" + line.substr(fxStart, fxEnd - fxStart) + "'";
+      }
+    }
+    return "Added FX";
+  }
+
+  // Check for new_clip
+  if (line.find(".new_clip") != std::string::npos) {
+    return "Created clip";
+  }
+
+  // Check for set_track
+  if (line.find(".set_track") != std::string::npos) {
+    return "Updated track";
+  }
+
+  // Check for delete
+  if (line.find(".delete()") != std::string::npos) {
+    return "Deleted track";
+  }
+
+  // Now check for standalone commands (not chained)
+  if (line.find("track(") == 0) {
+    // Determine if this is a track reference or creation
+    bool hasId = (line.find("id=") != std::string::npos);
+    bool hasSelected = (line.find("selected=") != std::string::npos);
+    bool hasInstrument = (line.find("instrument=") != std::string::npos);
+    bool hasNameOnly =
+        (line.find("name=") != std::string::npos) && !hasInstrument && !hasId && !hasSelected;
+
+    // If it's just a reference with no action, skip it
+    bool isReference = hasId || hasSelected || hasNameOnly;
+    if (isReference && line.find(").") == std::string::npos) {
+      // Check if line ends with just ) - pure reference
+      size_t closeParenPos = line.find(')');
+      if (closeParenPos != std::string::npos && closeParenPos == line.length() - 1) {
+        return ""; // Just a track reference, no action
+      }
+    }
+
+    // Track with instrument = creation
+    if (hasInstrument) {
+      size_t instStart = line.find("instrument=\"");
+      if (instStart != std::string::npos) {
+        instStart += 12;
+        size_t instEnd = line.find("\"", instStart);
+        if (instEnd != std::string::npos) {
+          std::string inst = line.substr(instStart, instEnd - instStart);
+          // Clean up @plugin format
+          if (inst[0] == '@')
+            inst = inst.substr(1);
+          return "Created track with " + inst;
+        }
+      }
+    }
+
+    // Track with name only (no instrument) = might be reference to existing
+    if (hasNameOnly) {
+      size_t nameStart = line.find("name=\"");
+      if (nameStart != std::string::npos) {
+        nameStart += 6;
+        size_t nameEnd = line.find("\"", nameStart);
+        if (nameEnd != std::string::npos) {
+          // This might be a reference OR a creation - the interpreter decides
+          // Don't report here, let the actual execution determine the message
+          return "";
+        }
+      }
+    }
+
+    // Empty track() = creation
+    if (!hasId && !hasSelected && !hasNameOnly && !hasInstrument) {
+      return "Created track";
+    }
+  }
+
+  // Musical content commands
+  if (line.find("note(") == 0) {
+    size_t pitchStart = line.find("pitch=\"");
+    if (pitchStart != std::string::npos) {
+      pitchStart += 7;
+      size_t pitchEnd = line.find("\"", pitchStart);
+      if (pitchEnd != std::string::npos) {
+        return "Added note " + line.substr(pitchStart, pitchEnd - pitchStart);
+      }
+    }
+    return "Added note";
+  }
+
+  if (line.find("chord(") == 0) {
+    size_t symStart = line.find("symbol=");
+    if (symStart != std::string::npos) {
+      symStart += 7;
+      size_t symEnd = line.find_first_of(",)", symStart);
+      if (symEnd != std::string::npos) {
+        return "Added " + line.substr(symStart, symEnd - symStart) + " chord";
+      }
+    }
+    return "Added chord";
+  }
+
+  if (line.find("arpeggio(") == 0) {
+    size_t symStart = line.find("symbol=");
+    if (symStart != std::string::npos) {
+      symStart += 7;
+      size_t symEnd = line.find_first_of(",)", symStart);
+      if (symEnd != std::string::npos) {
+        return "Added " + line.substr(symStart, symEnd - symStart) + " arpeggio";
+      }
+    }
+    return "Added arpeggio";
+  }
+
+  if (line.find("pattern(") == 0) {
+    size_t drumStart = line.find("drum=");
+    if (drumStart != std::string::npos) {
+      drumStart += 5;
+      size_t drumEnd = line.find_first_of(",)", drumStart);
+      if (drumEnd != std::string::npos) {
+        return "Added " + line.substr(drumStart, drumEnd - drumStart) + " pattern";
+      }
+    }
+    return "Added drum pattern";
+  }
+
+  if (line.find("progression(") == 0) {
+    return "Added chord progression";
+  }
+
+  if (line.find("fx(") == 0) {
+    return "Added FX";
+  }
+
+  if (line.find("clip(") == 0) {
+    return "Created clip";
+  }
+
+  return "";
+}
+
+// Run one DSL command with the interpreter for its kind; error is set on failure
+static bool ExecuteDSLLine(const std::string &line, std::string &error) {
+  bool lineSuccess = false;
+  if (line.find("arpeggio(") == 0 || line.find("chord(") == 0 || line.find("note(") == 0 ||
+      line.find("progression(") == 0) {
+    MagdaArranger::Interpreter arrangerInterp;
+    lineSuccess = arrangerInterp.Execute(line.c_str());
+    if (!lineSuccess)
+      error = arrangerInterp.GetError();
+  } else if (line.find("pattern(") == 0) {
+    MagdaDrummer::Interpreter drummerInterp;
+    lineSuccess = drummerInterp.Execute(line.c_str());
+    if (!lineSuccess)
+      error = drummerInterp.GetError();
+  } else {
+    MagdaDSL::Interpreter dawInterp;
+    lineSuccess = dawInterp.Execute(line.c_str());
+    if (!lineSuccess)
+      error = dawInterp.GetError();
+  }
+  return lineSuccess;
+}
+
+void MagdaImGuiChat::QueueStreamedAction(const std::string &actionJson) {
+  int generation = m_streamGeneration;
+  auto execute = [this, actionJson, generation]() {
+    ExecuteStreamedAction(actionJson, generation);
+  };
+  m_lastStreamedAction = MagdaMainThreadQueue::Get().Post(execute, MAIN_THREAD_HIGH).share();
+}
+
+void MagdaImGuiChat::ExecuteStreamedAction(const std::string &actionJson, int generation) {
+  {
+    std::lock_guard<std::mutex> lock(m_asyncMutex);
+    if (m_cancelRequested || generation != m_streamGeneration) {
+      return;
+    }
+  }
+
+  // The actionJson is already the unwrapped action object:
+  // {"action":"create_track","index":0,"instrument":"@plugin:serum_2","name":"bass"}
+  // Just wrap it in an array for ExecuteActions
+  std::string singleActionJson = "[" + actionJson + "]";
+
+  // Debug: log what we're executing
+  if (g_rec) {
+    void (*ShowConsoleMsg)(const char *msg) =
+        (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+    if (ShowConsoleMsg) {
+      char log_msg[1024];
+      snprintf(log_msg, sizeof(log_msg), "MAGDA: Executing action: %.500s\n",
+               singleActionJson.c_str());
+      ShowConsoleMsg(log_msg);
+    }
+  }
+
+  WDL_FastString execution_result, execution_error;
+  if (!MagdaActions::ExecuteActions(singleActionJson.c_str(), execution_result, execution_error)) {
+    // Log error
+    if (g_rec) {
+      void (*ShowConsoleMsg)(const char *msg) =
+          (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+      if (ShowConsoleMsg) {
+        char log_msg[512];
+        snprintf(log_msg, sizeof(log_msg), "MAGDA: Action execution failed: %s\n",
+                 execution_error.Get());
+        ShowConsoleMsg(log_msg);
+      }
+    }
+  } else {
+    // Log success
+    if (g_rec) {
+      void (*ShowConsoleMsg)(const char *msg) =
+          (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+      if (ShowConsoleMsg) {
+        ShowConsoleMsg("MAGDA: Action executed successfully\n");
+      }
+    }
+  }
+}
+
+void MagdaImGuiChat::QueueStreamedDSL(const std::string &statement) {
+  int generation = m_streamGeneration;
+  auto execute = [this, statement, generation]() { ExecuteStreamedDSL(statement, generation); };
+  m_lastStreamedAction = MagdaMainThreadQueue::Get().Post(execute, MAIN_THREAD_HIGH).share();
+}
+
+void MagdaImGuiChat::ExecuteStreamedDSL(const std::string &statement, int generation) {
+  {
+    std::lock_guard<std::mutex> lock(m_asyncMutex);
+    if (m_cancelRequested || generation != m_streamGeneration) {
+      return;
+    }
+  }
+
+  // First statement of this request: start a fresh DSL session
+  if (m_streamedDSL.generation != generation) {
+    m_streamedDSL = StreamedDSL();
+    m_streamedDSL.generation = generation;
+    MagdaDSLContext::Get().Clear();
+  }
+  if (!m_streamedDSL.executed.insert(statement).second) {
+    return; // Duplicate command
+  }
+
+  if (g_rec) {
+    void (*ShowConsoleMsg)(const char *msg) =
+        (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
+    if (ShowConsoleMsg) {
+      char log_msg[1024];
+      snprintf(log_msg, sizeof(log_msg), "MAGDA: Executing streamed DSL: %.500s\n",
+               statement.c_str());
+      ShowConsoleMsg(log_msg);
+    }
+  }
+
+  if (ExecuteDSLLine(statement, m_streamedDSL.lastError)) {
+    m_streamedDSL.successCount++;
+    std::string summary = GetDSLActionSummary(statement);
+    if (!summary.empty()) {
+      m_streamedDSL.summaries.push_back(summary);
+    }
+  } else {
+    m_streamedDSL.failed = true;
+  }
+}
+
 void MagdaImGuiChat::ProcessAsyncResult() {
   // First check for mix analysis streaming state (TRUE STREAMING)
   {
@@ -2367,59 +2818,13 @@ void MagdaImGuiChat::ProcessAsyncResult() {
     }
   }
 
-  // Process streaming actions as they arrive (even if stream not complete)
-  // This allows actions to execute in real-time as they stream in
-  std::vector<std::string> actionsToExecute;
+  // Streamed actions run on the main-thread queue as they arrive; let the
+  // last one finish before handling the final result
   {
     std::lock_guard<std::mutex> lock(m_asyncMutex);
-    if (!m_streamingActions.empty()) {
-      actionsToExecute = m_streamingActions;
-      m_streamingActions.clear(); // Clear after copying
-    }
-  }
-
-  // Execute actions from stream on MAIN thread
-  for (const auto &actionEventJson : actionsToExecute) {
-    // The actionEventJson is already the unwrapped action object:
-    // {"action":"create_track","index":0,"instrument":"@plugin:serum_2","name":"bass"}
-    // Just wrap it in an array for ExecuteActions
-    std::string singleActionJson = "[" + actionEventJson + "]";
-
-    // Debug: log what we're executing
-    if (g_rec) {
-      void (*ShowConsoleMsg)(const char *msg) =
-          (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
-      if (ShowConsoleMsg) {
-        char log_msg[1024];
-        snprintf(log_msg, sizeof(log_msg), "MAGDA: Executing action: %.500s\n",
-                 singleActionJson.c_str());
-        ShowConsoleMsg(log_msg);
-      }
-    }
-
-    WDL_FastString execution_result, execution_error;
-    if (!MagdaActions::ExecuteActions(singleActionJson.c_str(), execution_result,
-                                      execution_error)) {
-      // Log error
-      if (g_rec) {
-        void (*ShowConsoleMsg)(const char *msg) =
-            (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
-        if (ShowConsoleMsg) {
-          char log_msg[512];
-          snprintf(log_msg, sizeof(log_msg), "MAGDA: Action execution failed: %s\n",
-                   execution_error.Get());
-          ShowConsoleMsg(log_msg);
-        }
-      }
-    } else {
-      // Log success
-      if (g_rec) {
-        void (*ShowConsoleMsg)(const char *msg) =
-            (void (*)(const char *))g_rec->GetFunc("ShowConsoleMsg");
-        if (ShowConsoleMsg) {
-          ShowConsoleMsg("MAGDA: Action executed successfully\n");
-        }
-      }
+    if (m_lastStreamedAction.valid() &&
+        m_lastStreamedAction.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return;
     }
   }
 
@@ -2456,16 +2861,22 @@ void MagdaImGuiChat::ProcessAsyncResult() {
 
   // Check if this is a direct OpenAI (DSL) result
   bool isDSL = false;
+  std::string timing;
+  int generation = 0;
   {
     std::lock_guard<std::mutex> lock(m_asyncMutex);
     isDSL = m_directOpenAI;
     m_directOpenAI = false; // Reset for next request
+    timing = m_asyncTiming;
+    generation = m_streamGeneration;
   }
+  // Statements that already ran while the DSL streamed
+  bool streamedDSL = isDSL && m_streamedDSL.generation == generation;
 
   // Process final result on the MAIN thread
   if (success) {
     // For direct OpenAI: execute DSL code
-    if (isDSL && !responseJson.empty()) {
+    if (isDSL && (!responseJson.empty() || streamedDSL)) {
       // Log the DSL code we received
       if (g_rec) {
         void (*ShowConsoleMsg)(const char *msg) =
@@ -2484,8 +2895,16 @@ void MagdaImGuiChat::ProcessAsyncResult() {
       int successCount = 0;
       std::vector<std::string> actionSummaries; // Track what actions were performed
 
-      // Clear DSL context before processing
-      MagdaDSLContext::Get().Clear();
+      if (streamedDSL) {
+        // Keep the context the streamed statements set up (created tracks)
+        dslSuccess = !m_streamedDSL.failed;
+        lastError = m_streamedDSL.lastError;
+        successCount = m_streamedDSL.successCount;
+        actionSummaries = m_streamedDSL.summaries;
+      } else {
+        // Clear DSL context before processing
+        MagdaDSLContext::Get().Clear();
+      }
 
       // Split DSL by newlines and SORT: DAW commands first, then content
       // commands This ensures track/clip creation happens before MIDI notes are
@@ -2537,6 +2956,9 @@ void MagdaImGuiChat::ProcessAsyncResult() {
       // Second pass: categorize commands and deduplicate using sets
       pos = 0;
       std::set<std::string> seenDawCmds, seenContentCmds;
+      if (streamedDSL) {
+        seenDawCmds = m_streamedDSL.executed;
+      }
       while (pos < preprocessedDsl.size()) {
         size_t endPos = preprocessedDsl.find('\n', pos);
         if (endPos == std::string::npos)
@@ -2584,201 +3006,13 @@ void MagdaImGuiChat::ProcessAsyncResult() {
         }
       }
 
-      // Helper to extract a human-readable summary from a DSL command
-      auto getActionSummary = [](const std::string &line) -> std::string {
-        // Check for chained commands first - the action is what comes after the dot
-        // e.g., track(id=1).add_automation(...) -> "Added automation"
-
-        // Check for automation first (highest priority since it's the main action)
-        if (line.find(".add_automation") != std::string::npos ||
-            line.find(".addAutomation") != std::string::npos) {
-          size_t paramStart = line.find("param=\"");
-          if (paramStart != std::string::npos) {
-            paramStart += 7;
-            size_t paramEnd = line.find("\"", paramStart);
-            if (paramEnd != std::string::npos) {
-              std::string param = line.substr(paramStart, paramEnd - paramStart);
-              // Clean up @plugin:param format for display
-              size_t colonPos = param.find(':');
-              if (colonPos != std::string::npos && param[0] == '@') {
-                param = param.substr(colonPos + 1); // Just show param name
-              }
-              return "Added automation on '" + param + "'";
-            }
-          }
-          return "Added automation";
-        }
-
-        // Check for add_fx
-        if (line.find(".add_fx") != std::string::npos) {
-          size_t fxStart = line.find("fxname=\"");
-          if (fxStart != std::string::npos) {
-            fxStart += 8;
-            size_t fxEnd = line.find("\"", fxStart);
-            if (fxEnd != std::string::npos) {
-              return "Added FX '" + line.substr(fxStart, fxEnd - fxStart) + "'";
-            }
-          }
-          return "Added FX";
-        }
-
-        // Check for new_clip
-        if (line.find(".new_clip") != std::string::npos) {
-          return "Created clip";
-        }
-
-        // Check for set_track
-        if (line.find(".set_track") != std::string::npos) {
-          return "Updated track";
-        }
-
-        // Check for delete
-        if (line.find(".delete()") != std::string::npos) {
-          return "Deleted track";
-        }
-
-        // Now check for standalone commands (not chained)
-        if (line.find("track(") == 0) {
-          // Determine if this is a track reference or creation
-          bool hasId = (line.find("id=") != std::string::npos);
-          bool hasSelected = (line.find("selected=") != std::string::npos);
-          bool hasInstrument = (line.find("instrument=") != std::string::npos);
-          bool hasNameOnly =
-              (line.find("name=") != std::string::npos) && !hasInstrument && !hasId && !hasSelected;
-
-          // If it's just a reference with no action, skip it
-          bool isReference = hasId || hasSelected || hasNameOnly;
-          if (isReference && line.find(").") == std::string::npos) {
-            // Check if line ends with just ) - pure reference
-            size_t closeParenPos = line.find(')');
-            if (closeParenPos != std::string::npos && closeParenPos == line.length() - 1) {
-              return ""; // Just a track reference, no action
-            }
-          }
-
-          // Track with instrument = creation
-          if (hasInstrument) {
-            size_t instStart = line.find("instrument=\"");
-            if (instStart != std::string::npos) {
-              instStart += 12;
-              size_t instEnd = line.find("\"", instStart);
-              if (instEnd != std::string::npos) {
-                std::string inst = line.substr(instStart, instEnd - instStart);
-                // Clean up @plugin format
-                if (inst[0] == '@')
-                  inst = inst.substr(1);
-                return "Created track with " + inst;
-              }
-            }
-          }
-
-          // Track with name only (no instrument) = might be reference to existing
-          if (hasNameOnly) {
-            size_t nameStart = line.find("name=\"");
-            if (nameStart != std::string::npos) {
-              nameStart += 6;
-              size_t nameEnd = line.find("\"", nameStart);
-              if (nameEnd != std::string::npos) {
-                // This might be a reference OR a creation - the interpreter decides
-                // Don't report here, let the actual execution determine the message
-                return "";
-              }
-            }
-          }
-
-          // Empty track() = creation
-          if (!hasId && !hasSelected && !hasNameOnly && !hasInstrument) {
-            return "Created track";
-          }
-        }
-
-        // Musical content commands
-        if (line.find("note(") == 0) {
-          size_t pitchStart = line.find("pitch=\"");
-          if (pitchStart != std::string::npos) {
-            pitchStart += 7;
-            size_t pitchEnd = line.find("\"", pitchStart);
-            if (pitchEnd != std::string::npos) {
-              return "Added note " + line.substr(pitchStart, pitchEnd - pitchStart);
-            }
-          }
-          return "Added note";
-        }
-
-        if (line.find("chord(") == 0) {
-          size_t symStart = line.find("symbol=");
-          if (symStart != std::string::npos) {
-            symStart += 7;
-            size_t symEnd = line.find_first_of(",)", symStart);
-            if (symEnd != std::string::npos) {
-              return "Added " + line.substr(symStart, symEnd - symStart) + " chord";
-            }
-          }
-          return "Added chord";
-        }
-
-        if (line.find("arpeggio(") == 0) {
-          size_t symStart = line.find("symbol=");
-          if (symStart != std::string::npos) {
-            symStart += 7;
-            size_t symEnd = line.find_first_of(",)", symStart);
-            if (symEnd != std::string::npos) {
-              return "Added " + line.substr(symStart, symEnd - symStart) + " arpeggio";
-            }
-          }
-          return "Added arpeggio";
-        }
-
-        if (line.find("pattern(") == 0) {
-          size_t drumStart = line.find("drum=");
-          if (drumStart != std::string::npos) {
-            drumStart += 5;
-            size_t drumEnd = line.find_first_of(",)", drumStart);
-            if (drumEnd != std::string::npos) {
-              return "Added " + line.substr(drumStart, drumEnd - drumStart) + " pattern";
-            }
-          }
-          return "Added drum pattern";
-        }
-
-        if (line.find("progression(") == 0) {
-          return "Added chord progression";
-        }
-
-        if (line.find("fx(") == 0) {
-          return "Added FX";
-        }
-
-        if (line.find("clip(") == 0) {
-          return "Created clip";
-        }
-
-        return "";
-      };
 
       // Helper lambda to execute a line
       auto executeLine = [&](const std::string &line) -> bool {
-        bool lineSuccess = false;
-        if (line.find("arpeggio(") == 0 || line.find("chord(") == 0 || line.find("note(") == 0 ||
-            line.find("progression(") == 0) {
-          MagdaArranger::Interpreter arrangerInterp;
-          lineSuccess = arrangerInterp.Execute(line.c_str());
-          if (!lineSuccess)
-            lastError = arrangerInterp.GetError();
-        } else if (line.find("pattern(") == 0) {
-          MagdaDrummer::Interpreter drummerInterp;
-          lineSuccess = drummerInterp.Execute(line.c_str());
-          if (!lineSuccess)
-            lastError = drummerInterp.GetError();
-        } else {
-          MagdaDSL::Interpreter dawInterp;
-          lineSuccess = dawInterp.Execute(line.c_str());
-          if (!lineSuccess)
-            lastError = dawInterp.GetError();
-        }
+        bool lineSuccess = ExecuteDSLLine(line, lastError);
         // Add action summary if successful
         if (lineSuccess) {
-          std::string summary = getActionSummary(line);
+          std::string summary = GetDSLActionSummary(line);
           if (!summary.empty()) {
             actionSummaries.push_back(summary);
           }
@@ -2817,6 +3051,8 @@ void MagdaImGuiChat::ProcessAsyncResult() {
         }
       }
 
+      // Agent timing, e.g. "Done (2.1 s, detect 0.6 s overlapped, saved 0.5 s)"
+      std::string doneStatus = timing.empty() ? "Done" : "Done (" + timing + ")";
       if (successCount > 0 && !dslSuccess) {
         // Partial success - show what worked and the error
         std::string msg;
@@ -2835,11 +3071,11 @@ void MagdaImGuiChat::ProcessAsyncResult() {
             msg += "\n";
         }
         AddAssistantMessage(msg);
-        SetAPIStatus("Done", 0x88FF88FF); // Green
+        SetAPIStatus(doneStatus, 0x88FF88FF); // Green
       } else if (dslSuccess) {
         // Success but no trackable actions (fallback)
         AddAssistantMessage("Done.");
-        SetAPIStatus("Done", 0x88FF88FF); // Green
+        SetAPIStatus(doneStatus, 0x88FF88FF); // Green
       } else {
         std::string errorStr = "Error: " + lastError;
         AddAssistantMessage(errorStr);
@@ -77,12 +77,7 @@ MagdaImGuiLogin::MagdaImGuiLogin() {
   strncpy(m_apiUrlBuffer, DEFAULT_API_URL, sizeof(m_apiUrlBuffer) - 1);
 }
 
-MagdaImGuiLogin::~MagdaImGuiLogin() {
-  // Wait for any pending async operation
-  if (m_asyncThread.joinable()) {
-    m_asyncThread.join();
-  }
-}
+MagdaImGuiLogin::~MagdaImGuiLogin() {}
 
 bool MagdaImGuiLogin::Initialize(reaper_plugin_info_t *rec) {
   if (!rec)
@@ -262,40 +257,37 @@ void MagdaImGuiLogin::StartHealthCheck() {
   m_statusMessage = "Checking API...";
   m_statusIsError = false;
 
-  // Start health check in background thread
+  // Start health check without blocking the UI
   m_asyncPending = true;
   std::string apiUrl = m_apiUrlBuffer;
 
-  m_asyncThread = std::thread([this, apiUrl]() {
-    // Create a local HTTP client for this thread
-    MagdaHTTPClient httpClient;
-    httpClient.SetBackendURL(apiUrl.c_str());
-
-    WDL_FastString errorMsg;
-    bool success = httpClient.CheckHealth(errorMsg, 5);
-
-    std::lock_guard<std::mutex> lock(m_asyncMutex);
-
-    if (success) {
-      // For now, assume local (localhost) = no auth, remote = auth required
-      if (apiUrl.find("localhost") != std::string::npos ||
-          apiUrl.find("127.0.0.1") != std::string::npos) {
-        m_asyncAuthMode = AuthMode::None;
-      } else {
-        m_asyncAuthMode = AuthMode::Gateway;
-      }
-      m_asyncSuccess = true;
-    } else {
-      m_asyncAuthMode = AuthMode::Error;
-      m_asyncErrorMsg = errorMsg.GetLength() > 0 ? errorMsg.Get() : "Failed to connect to API";
-      m_asyncSuccess = false;
-    }
-
-    m_asyncResultReady = true;
-    m_asyncPending = false;
-  });
-
-  m_asyncThread.detach();
+  // The client only builds the request; the check runs on the network
+  // thread and reports back on the main thread
+  MagdaHTTPClient httpClient;
+  httpClient.SetBackendURL(apiUrl.c_str());
+  httpClient.CheckHealthAsync(
+      [this, apiUrl](bool success, const WDL_FastString &, const WDL_FastString &errorMsg) {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+
+        if (success) {
+          // For now, assume local (localhost) = no auth, remote = auth required
+          if (apiUrl.find("localhost") != std::string::npos ||
+              apiUrl.find("127.0.0.1") != std::string::npos) {
+            m_asyncAuthMode = AuthMode::None;
+          } else {
+            m_asyncAuthMode = AuthMode::Gateway;
+          }
+          m_asyncSuccess = true;
+        } else {
+          m_asyncAuthMode = AuthMode::Error;
+          m_asyncErrorMsg = errorMsg.GetLength() > 0 ? errorMsg.Get() : "Failed to connect to API";
+          m_asyncSuccess = false;
+        }
+
+        m_asyncResultReady = true;
+        m_asyncPending = false;
+      },
+      5);
 }
 
 void MagdaImGuiLogin::StartLoginRequest() {
@@ -314,35 +306,30 @@ void MagdaImGuiLogin::StartLoginRequest() {
   // Save email for next time
   SaveSettings();
 
-  // Start login in background thread
+  // Start login without blocking the UI
   m_asyncPending = true;
   std::string email = m_emailBuffer;
   std::string password = m_passwordBuffer;
   std::string apiUrl = m_apiUrlBuffer;
 
-  m_asyncThread = std::thread([this, email, password, apiUrl]() {
-    // Create a local HTTP client for this thread
-    MagdaHTTPClient httpClient;
-    httpClient.SetBackendURL(apiUrl.c_str());
-
-    WDL_FastString tokenOut, errorMsg;
-    bool success = httpClient.SendLoginRequest(email.c_str(), password.c_str(), tokenOut, errorMsg);
-
-    std::lock_guard<std::mutex> lock(m_asyncMutex);
-
-    if (success && tokenOut.GetLength() > 0) {
-      m_asyncToken = tokenOut.Get();
-      m_asyncSuccess = true;
-    } else {
-      m_asyncSuccess = false;
-      m_asyncErrorMsg = errorMsg.GetLength() > 0 ? errorMsg.Get() : "Login failed";
-    }
-
-    m_asyncResultReady = true;
-    m_asyncPending = false;
-  });
-
-  m_asyncThread.detach();
+  MagdaHTTPClient httpClient;
+  httpClient.SetBackendURL(apiUrl.c_str());
+  httpClient.SendLoginRequestAsync(
+      email.c_str(), password.c_str(),
+      [this](bool success, const WDL_FastString &tokenOut, const WDL_FastString &errorMsg) {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+
+        if (success && tokenOut.GetLength() > 0) {
+          m_asyncToken = tokenOut.Get();
+          m_asyncSuccess = true;
+        } else {
+          m_asyncSuccess = false;
+          m_asyncErrorMsg = errorMsg.GetLength() > 0 ? errorMsg.Get() : "Login failed";
+        }
+
+        m_asyncResultReady = true;
+        m_asyncPending = false;
+      });
 }
 
 void MagdaImGuiLogin::ProcessAsyncResult() {
@@ -0,0 +1,168 @@
+/**
+ * Unit tests for the on-disk analysis cache
+ *
+ * Covers the binary round trip, key checks, LRU eviction and index reload.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "magda_analysis_cache.h"
+
+static DSPAnalysisResult MakeResult(float seed) {
+    DSPAnalysisResult result;
+    result.success = true;
+    result.sampleRate = 48000;
+    result.channels = 2;
+    result.lengthSeconds = 12.5;
+    result.activeSeconds = 9.75;
+    for (int i = 0; i < 64; i++) {
+        result.fftFrequencies.push_back(i * 375.0f);
+        result.fftMagnitudes.push_back(-seed - i * 0.5f);
+    }
+    result.eqProfileFreqs = {100.0f, 1000.0f, 10000.0f};
+    result.eqProfileMags = {-12.0f, -6.0f, -18.0f};
+    result.bands.bass = -10.0f - seed;
+    result.peaks.push_back({440.0f, -3.0f, 12.0f});
+    result.resonances.push_back({220.0f, 8.0f, 20.0f, "high", "ringing"});
+    result.spectralFeatures = {1500.0f, 8000.0f, -4.5f, 0.2f, 12.0f, 30.0f, 60.0f, 10.0f};
+    result.loudness = {-14.0f, -13.0f, -11.0f, -9.0f, 5.5f, -1.0f, 0.3f};
+    result.truePeakOvers.push_back({1.25, 0.3f, 1});
+    result.dynamics = {10.0f, 13.0f, 2.0f};
+    result.stereo = {0.4f, 0.8f, -0.1f, 0.95f, true};
+    result.stereoBands.push_back({20.0f, 60.0f, -20.0f, -40.0f, 0.9f, 0.1f});
+    result.transients = {0.012f, 0.35f, 2.5f};
+    result.onsets.push_back({0.5, 1.0f, 0.004f});
+    result.featureFrames.frameSeconds = 0.5;
+    result.featureFrames.bandEdges = {20.0f, 200.0f, 2000.0f};
+    result.featureFrames.rms = {-20.0f, -18.0f};
+    result.featureFrames.bandEnergies = {-30.0f, -28.0f, -40.0f, -38.0f};
+    return result;
+}
+
+static std::string MakeTempDir() {
+    char path[] = "/tmp/magda_cache_test_XXXXXX";
+    char *dir = mkdtemp(path);
+    return dir ? std::string(dir) + "/cache" : std::string();
+}
+
+TEST(AnalysisCacheTest, SerializeRoundTrip) {
+    DSPAnalysisResult original = MakeResult(1.0f);
+    std::vector<char> data;
+    MagdaAnalysisCache::Serialize("key", original, data);
+
+    DSPAnalysisResult loaded;
+    ASSERT_TRUE(MagdaAnalysisCache::Deserialize(data, "key", loaded));
+    EXPECT_TRUE(loaded.success);
+    EXPECT_EQ(loaded.sampleRate, 48000);
+    EXPECT_EQ(loaded.channels, 2);
+    EXPECT_DOUBLE_EQ(loaded.lengthSeconds, 12.5);
+    EXPECT_DOUBLE_EQ(loaded.activeSeconds, 9.75);
+    EXPECT_EQ(loaded.fftMagnitudes, original.fftMagnitudes);
+    EXPECT_EQ(loaded.eqProfileMags, original.eqProfileMags);
+    EXPECT_FLOAT_EQ(loaded.bands.bass, original.bands.bass);
+    ASSERT_EQ(loaded.peaks.size(), 1u);
+    EXPECT_FLOAT_EQ(loaded.peaks[0].frequency, 440.0f);
+    ASSERT_EQ(loaded.resonances.size(), 1u);
+    EXPECT_STREQ(loaded.resonances[0].severity, "high");
+    EXPECT_STREQ(loaded.resonances[0].type, "ringing");
+    EXPECT_FLOAT_EQ(loaded.loudness.loudnessRange, 5.5f);
+    ASSERT_EQ(loaded.truePeakOvers.size(), 1u);
+    EXPECT_DOUBLE_EQ(loaded.truePeakOvers[0].time, 1.25);
+    EXPECT_EQ(loaded.truePeakOvers[0].channel, 1);
+    EXPECT_FLOAT_EQ(loaded.stereo.correlation, 0.8f);
+    EXPECT_TRUE(loaded.stereo.lowEndMonoCompatible);
+    ASSERT_EQ(loaded.stereoBands.size(), 1u);
+    EXPECT_FLOAT_EQ(loaded.stereoBands[0].sideLevel, -40.0f);
+    EXPECT_FLOAT_EQ(loaded.transients.attackTime, 0.012f);
+    ASSERT_EQ(loaded.onsets.size(), 1u);
+    EXPECT_DOUBLE_EQ(loaded.onsets[0].time, 0.5);
+    EXPECT_EQ(loaded.featureFrames.GetNumFrames(), 2);
+    EXPECT_EQ(loaded.featureFrames.bandEnergies, original.featureFrames.bandEnergies);
+}
+
+TEST(AnalysisCacheTest, RejectsMismatchedOrTruncatedData) {
+    std::vector<char> data;
+    MagdaAnalysisCache::Serialize("key-a", MakeResult(1.0f), data);
+
+    DSPAnalysisResult loaded;
+    EXPECT_FALSE(MagdaAnalysisCache::Deserialize(data, "key-b", loaded));
+
+    data.resize(data.size() / 2);
+    EXPECT_FALSE(MagdaAnalysisCache::Deserialize(data, "key-a", loaded));
+}
+
+TEST(AnalysisCacheTest, ConfigChangesKey) {
+    DSPAnalysisConfig config;
+    std::string a = "file";
+    MagdaAnalysisCache::AppendConfigKey(config, a);
+
+    config.fftSize = 8192;
+    std::string b = "file";
+    MagdaAnalysisCache::AppendConfigKey(config, b);
+    EXPECT_NE(a, b);
+}
+
+TEST(AnalysisCacheTest, StoreAndLookup) {
+    std::string dir = MakeTempDir();
+    ASSERT_FALSE(dir.empty());
+    MagdaAnalysisCache cache(dir, 1 << 20);
+
+    DSPAnalysisResult loaded;
+    EXPECT_FALSE(cache.Lookup("song.wav", loaded));
+
+    cache.Store("song.wav", MakeResult(2.0f));
+    EXPECT_EQ(cache.GetNumEntries(), 1);
+    ASSERT_TRUE(cache.Lookup("song.wav", loaded));
+    EXPECT_FLOAT_EQ(loaded.bands.bass, -12.0f);
+    EXPECT_FALSE(cache.Lookup("other.wav", loaded));
+
+    // Failed results are never stored
+    DSPAnalysisResult failed;
+    cache.Store("failed.wav", failed);
+    EXPECT_EQ(cache.GetNumEntries(), 1);
+
+    cache.Clear();
+    EXPECT_EQ(cache.GetNumEntries(), 0);
+    EXPECT_EQ(cache.GetTotalBytes(), 0);
+    EXPECT_FALSE(cache.Lookup("song.wav", loaded));
+}
+
+TEST(AnalysisCacheTest, EvictsLeastRecentlyUsed) {
+    std::vector<char> data;
+    MagdaAnalysisCache::Serialize("a", MakeResult(1.0f), data);
+    long long entryBytes = (long long)data.size();
+
+    // Room for two entries, not three
+    MagdaAnalysisCache cache(MakeTempDir(), entryBytes * 2 + entryBytes / 2);
+    cache.Store("a", MakeResult(1.0f));
+    cache.Store("b", MakeResult(2.0f));
+
+    DSPAnalysisResult loaded;
+    ASSERT_TRUE(cache.Lookup("a", loaded)); // "b" is now the oldest
+    cache.Store("c", MakeResult(3.0f));
+
+    EXPECT_EQ(cache.GetNumEntries(), 2);
+    EXPECT_LE(cache.GetTotalBytes(), entryBytes * 2 + entryBytes / 2);
+    EXPECT_TRUE(cache.Lookup("a", loaded));
+    EXPECT_FALSE(cache.Lookup("b", loaded));
+    EXPECT_TRUE(cache.Lookup("c", loaded));
+}
+
+TEST(AnalysisCacheTest, PersistsAcrossInstances) {
+    std::string dir = MakeTempDir();
+    {
+        MagdaAnalysisCache cache(dir, 1 << 20);
+        cache.Store("song.wav", MakeResult(4.0f));
+    }
+
+    MagdaAnalysisCache reopened(dir, 1 << 20);
+    EXPECT_EQ(reopened.GetNumEntries(), 1);
+    DSPAnalysisResult loaded;
+    ASSERT_TRUE(reopened.Lookup("song.wav", loaded));
+    EXPECT_FLOAT_EQ(loaded.bands.bass, -14.0f);
+    reopened.Clear();
+}
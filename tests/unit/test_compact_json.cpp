@@ -0,0 +1,105 @@
+/**
+ * Unit tests for compact analysis JSON output
+ *
+ * Checks fixed-precision number formatting against printf and the log-band
+ * spectrum reduction.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "magda_compact_json.h"
+
+static std::string Format(double value, int decimals) {
+    char buf[MagdaCompactJSON::kMaxNumberChars];
+    int length = MagdaCompactJSON::FormatFixed(value, decimals, buf);
+    return std::string(buf, length);
+}
+
+TEST(CompactJSONTest, FormatsFixedPrecision) {
+    EXPECT_EQ(Format(0.0, 2), "0");
+    EXPECT_EQ(Format(1.5, 2), "1.5");
+    EXPECT_EQ(Format(-12.345, 1), "-12.3");
+    EXPECT_EQ(Format(-12.36, 1), "-12.4");
+    EXPECT_EQ(Format(0.05, 2), "0.05");
+    EXPECT_EQ(Format(-0.004, 2), "0");
+    EXPECT_EQ(Format(100.0, 3), "100");
+    EXPECT_EQ(Format(19999.6, 0), "20000");
+    EXPECT_EQ(Format(0.00123, 4), "0.0012");
+}
+
+TEST(CompactJSONTest, NonFiniteValuesStayValidJSON) {
+    EXPECT_EQ(Format(NAN, 2), "0");
+    EXPECT_EQ(Format(INFINITY, 2), "0");
+    EXPECT_EQ(Format(-INFINITY, 1), "0");
+}
+
+TEST(CompactJSONTest, MatchesPrintfRounding) {
+    // Values away from exact .5 ties must round like printf
+    srand(7);
+    for (int i = 0; i < 10000; i++) {
+        double value = (rand() / (double)RAND_MAX - 0.5) * 2000.0;
+        for (int decimals = 0; decimals <= 3; decimals++) {
+            char expected[64];
+            snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+            double parsed = atof(Format(value, decimals).c_str());
+            EXPECT_NEAR(parsed, atof(expected), 1e-9) << value << " at " << decimals;
+        }
+    }
+}
+
+TEST(CompactJSONTest, AppendsArrays) {
+    WDL_FastString json;
+    const float values[] = {1.0f, -2.25f, 3.5f};
+    MagdaCompactJSON::AppendArray(json, "a", values, 3, 1, true);
+    MagdaCompactJSON::AppendArray(json, "b", values, 0, 1, false);
+    EXPECT_STREQ(json.Get(), "\"a\":[1,-2.3,3.5],\"b\":[]");
+}
+
+TEST(CompactJSONTest, AppendsLongArrays) {
+    std::vector<float> values(5000, -96.5f);
+    WDL_FastString json;
+    MagdaCompactJSON::AppendArray(json, "v", values.data(), (int)values.size(), 1, true);
+
+    std::string expected = "\"v\":[";
+    for (size_t i = 0; i < values.size(); i++) {
+        expected += i > 0 ? ",-96.5" : "-96.5";
+    }
+    expected += "]";
+    EXPECT_EQ(std::string(json.Get()), expected);
+}
+
+TEST(CompactJSONTest, LogBinsFlatSpectrum) {
+    std::vector<float> frequencies, magnitudes;
+    for (int i = 0; i < 2049; i++) {
+        frequencies.push_back(i * 44100.0f / 4096.0f);
+        magnitudes.push_back(-30.0f);
+    }
+
+    std::vector<float> centres, levels;
+    MagdaCompactJSON::LogBinSpectrum(frequencies, magnitudes, 32, 20.0f, 20000.0f, centres,
+                                     levels);
+    ASSERT_EQ(centres.size(), 32u);
+    ASSERT_EQ(levels.size(), 32u);
+    for (size_t b = 0; b < centres.size(); b++) {
+        EXPECT_NEAR(levels[b], -30.0f, 1e-3f);
+        if (b > 0) {
+            EXPECT_NEAR(centres[b] / centres[b - 1], powf(1000.0f, 1.0f / 32), 1e-3f);
+        }
+    }
+}
+
+TEST(CompactJSONTest, LogBinsAverageEnergy) {
+    // Two bins in one band at -10 and -20 dB: energy mean is -12.6 dB
+    std::vector<float> frequencies = {900.0f, 1100.0f};
+    std::vector<float> magnitudes = {-10.0f, -20.0f};
+
+    std::vector<float> centres, levels;
+    MagdaCompactJSON::LogBinSpectrum(frequencies, magnitudes, 1, 500.0f, 2000.0f, centres, levels);
+    ASSERT_EQ(levels.size(), 1u);
+    EXPECT_NEAR(levels[0], 10.0f * log10f((0.1f + 0.01f) / 2.0f), 1e-3f);
+}
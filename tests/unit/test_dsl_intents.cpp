@@ -0,0 +1,116 @@
+/**
+ * Unit tests for the local intent matcher
+ *
+ * Checks that simple track commands become the expected DSL, that anything
+ * ambiguous or unknown is left to the LLM, and that matching stays in the
+ * microsecond range.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "magda_dsl_intents.h"
+
+using MagdaDSL::IntentMatch;
+using MagdaDSL::IntentMatcher;
+
+static const std::vector<std::string> kTracks = {"Drums", "Bass", "Lead Synth", "Pad", "Vocals"};
+
+// DSL for a command, or "" when it goes to the LLM
+static std::string MatchDSL(const char* command,
+                            const std::vector<std::string>& tracks = kTracks) {
+    IntentMatch match;
+    if (!IntentMatcher::Match(command, tracks, match)) {
+        return "";
+    }
+    return match.dsl;
+}
+
+TEST(DSLIntentsTest, TrackStateCommands) {
+    EXPECT_EQ(MatchDSL("mute track 3"), "track(id=3).set_track(mute=true)");
+    EXPECT_EQ(MatchDSL("Unmute the bass"), "track(id=2).set_track(mute=false)");
+    EXPECT_EQ(MatchDSL("solo lead synth"), "track(id=3).set_track(solo=true)");
+    EXPECT_EQ(MatchDSL("unsolo track #5"), "track(id=5).set_track(solo=false)");
+    EXPECT_EQ(MatchDSL("select the pad track"), "track(id=4).set_track(selected=true)");
+    EXPECT_EQ(MatchDSL("delete the selected track"), "track(selected=true).delete()");
+    EXPECT_EQ(MatchDSL("please remove track number 1."), "track(id=1).delete()");
+}
+
+TEST(DSLIntentsTest, VolumeAndPan) {
+    EXPECT_EQ(MatchDSL("set Bass volume to -6"), "track(id=2).set_track(volume_db=-6)");
+    EXPECT_EQ(MatchDSL("set the volume of track 1 to -3.5 dB"),
+              "track(id=1).set_track(volume_db=-3.5)");
+    EXPECT_EQ(MatchDSL("set vocals volume to 0db"), "track(id=5).set_track(volume_db=0)");
+    EXPECT_EQ(MatchDSL("pan drums to the left"), "track(id=1).set_track(pan=-1)");
+    EXPECT_EQ(MatchDSL("pan pad 30% right"), "track(id=4).set_track(pan=0.3)");
+    EXPECT_EQ(MatchDSL("set the pan of lead synth to center"), "track(id=3).set_track(pan=0)");
+    EXPECT_EQ(MatchDSL("set bass pan to -0.25"), "track(id=2).set_track(pan=-0.25)");
+}
+
+TEST(DSLIntentsTest, CreateAndRename) {
+    IntentMatch match;
+    ASSERT_TRUE(IntentMatcher::Match("Could you add a new track?", kTracks, match));
+    EXPECT_EQ(match.dsl, "track()");
+    EXPECT_STREQ(match.intent, "create");
+
+    EXPECT_EQ(MatchDSL("create a track called Piano Room"), "track(name=\"Piano Room\")");
+    EXPECT_EQ(MatchDSL("rename track 4 to 'Strings'"), "track(id=4).set_track(name=\"Strings\")");
+    EXPECT_EQ(MatchDSL("rename the bass to Sub Bass"), "track(id=2).set_track(name=\"Sub Bass\")");
+}
+
+TEST(DSLIntentsTest, LeavesUnclearCommandsToTheLLM) {
+    EXPECT_EQ(MatchDSL("mute track 9"), "");                  // No such track
+    EXPECT_EQ(MatchDSL("mute the guitar"), "");               // Unknown name
+    EXPECT_EQ(MatchDSL("mute tracks 1 and 2"), "");           // Not a template
+    EXPECT_EQ(MatchDSL("mute the bass and add reverb"), "");  // More than one command
+    EXPECT_EQ(MatchDSL("set Bass volume to loud"), "");       // Not a gain
+    EXPECT_EQ(MatchDSL("set bass volume to 40"), "");         // Out of range
+    EXPECT_EQ(MatchDSL("pan pad to 2"), "");                  // Out of range
+    EXPECT_EQ(MatchDSL("create a track called Bass"), "");    // Would refer to track 2
+    EXPECT_EQ(MatchDSL("rename pad to Say \"hi\""), "");      // Quote in the name
+    EXPECT_EQ(MatchDSL("make a dark pad"), "");
+    EXPECT_EQ(MatchDSL(""), "");
+    EXPECT_EQ(MatchDSL(nullptr), "");
+}
+
+TEST(DSLIntentsTest, AmbiguousTrackNamesAreNotGuessed) {
+    std::vector<std::string> tracks = {"Drum", "Drum Track", "Keys", "keys"};
+    EXPECT_EQ(MatchDSL("mute drum track", tracks), ""); // "Drum" or "Drum Track"
+    EXPECT_EQ(MatchDSL("mute keys", tracks), "");       // Two tracks share the name
+    EXPECT_EQ(MatchDSL("mute drum", tracks), "track(id=1).set_track(mute=true)");
+
+    // A track named like another track's number
+    tracks = {"Track 2", "Bass"};
+    EXPECT_EQ(MatchDSL("solo track 2", tracks), "");
+}
+
+TEST(DSLIntentsTest, MatchesInMicroseconds) {
+    std::vector<std::string> tracks;
+    for (int i = 1; i <= 64; i++) {
+        tracks.push_back("Track Name " + std::to_string(i));
+    }
+    tracks.push_back("Lead Vocal Double");
+
+    const char* commands[] = {"mute track 12", "set lead vocal double volume to -4.5 db",
+                              "pan track name 40 hard left", "make the chorus bigger"};
+    const int iterations = 2000;
+    IntentMatch match;
+    int matched = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const char* command : commands) {
+            matched += IntentMatcher::Match(command, tracks, match) ? 1 : 0;
+        }
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                    .count();
+    double perCall = us / (iterations * 4);
+    printf("Intent match: %.2f us per command (%d tracks)\n", perCall, (int)tracks.size());
+
+    EXPECT_EQ(matched, iterations * 3);
+    // Far below an LLM round trip even on slow or instrumented CI builds
+    EXPECT_LT(perCall, 500.0);
+}
@@ -0,0 +1,95 @@
+/**
+ * Unit tests for the streaming DSL statement splitter
+ *
+ * Feeds DSL programs in small pieces, as an LLM stream delivers them, and
+ * checks that each top-level statement comes out as soon as it is complete.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "magda_dsl_stream.h"
+
+using MagdaDSL::StatementStream;
+
+// Feed text one character at a time and collect every statement
+static std::vector<std::string> SplitByCharacter(const std::string& text) {
+    StatementStream stream;
+    std::vector<std::string> out;
+    for (char c : text) {
+        stream.Feed(&c, 1, out);
+    }
+    stream.Finish(out);
+    return out;
+}
+
+TEST(DSLStreamTest, SplitsTopLevelStatements) {
+    std::vector<std::string> out = SplitByCharacter(
+        "track(name=\"Bass\").new_clip(bar=1, length_bars=4)\n"
+        "track(instrument=\"@serum\")\n"
+        "filter(tracks, track.name == \"Old\").delete()\n");
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_EQ(out[0], "track(name=\"Bass\").new_clip(bar=1, length_bars=4)");
+    EXPECT_EQ(out[1], "track(instrument=\"@serum\")");
+    EXPECT_EQ(out[2], "filter(tracks, track.name == \"Old\").delete()");
+}
+
+TEST(DSLStreamTest, EmitsStatementOnceTheNextOneStarts) {
+    StatementStream stream;
+    std::vector<std::string> out;
+
+    stream.Feed("track(id=1).set_track(mute=true)", out);
+    EXPECT_TRUE(out.empty()); // A chained call could still follow
+
+    stream.Feed("\ntr", out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0], "track(id=1).set_track(mute=true)");
+
+    stream.Feed("ack(id=2", out);
+    EXPECT_EQ(out.size(), 1u);
+    stream.Finish(out);
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[1], "track(id=2");
+}
+
+TEST(DSLStreamTest, JoinsChainsSplitAcrossLines) {
+    std::vector<std::string> out = SplitByCharacter(
+        "track(id=1)\n"
+        "  .set_track(volume_db=-3)\n"
+        "  .add_fx(fxname=\"ReaEQ\")\n"
+        "note(pitch=\"E1\", duration=4)");
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[0], "track(id=1).set_track(volume_db=-3).add_fx(fxname=\"ReaEQ\")");
+    EXPECT_EQ(out[1], "note(pitch=\"E1\", duration=4)");
+}
+
+TEST(DSLStreamTest, IgnoresDelimitersInStringsAndComments) {
+    std::vector<std::string> out = SplitByCharacter(
+        "// two tracks (bass and keys)\n"
+        "track(name=\"Bass (DI) // clean\") // first one)\n"
+        "progression(chords=[C, Am, F, G], length=16)\n");
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[0], "track(name=\"Bass (DI) // clean\")");
+    EXPECT_EQ(out[1], "progression(chords=[C, Am, F, G], length=16)");
+}
+
+TEST(DSLStreamTest, EmptyAndBlankStreamsProduceNothing) {
+    StatementStream stream;
+    std::vector<std::string> out;
+    stream.Feed("", out);
+    stream.Feed("  \n// just a comment\n", out);
+    stream.Finish(out);
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(DSLStreamTest, ResetDropsPartialStatement) {
+    StatementStream stream;
+    std::vector<std::string> out;
+    stream.Feed("track(name=\"Half", out);
+    stream.Reset();
+    stream.Feed("track()", out);
+    stream.Finish(out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0], "track()");
+}
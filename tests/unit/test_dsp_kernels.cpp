@@ -0,0 +1,93 @@
+/**
+ * Unit tests for the fused time-domain DSP kernel
+ *
+ * Checks that the SIMD path picked at runtime matches the scalar reference,
+ * including the mono downmix and side outputs.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_dsp_kernels.h"
+
+static std::vector<float> TestBlock(int frames, int channels) {
+    std::vector<float> x((size_t)frames * channels);
+    unsigned int seed = 4321;
+    for (size_t i = 0; i < x.size(); i++) {
+        seed = seed * 1103515245u + 12345u;
+        x[i] = ((seed >> 8) & 0xffff) / 32767.5f - 1.0f;
+    }
+    return x;
+}
+
+static void ExpectMatchesScalar(int frames, int channels) {
+    std::vector<float> x = TestBlock(frames, channels);
+
+    TimeDomainStats simd, ref;
+    std::vector<float> mono(frames), monoAbs(frames), refMono(frames), refMonoAbs(frames);
+    std::vector<float> side(frames, 1.0f), refSide(frames);
+    MagdaDSPKernels::AccumulateTimeDomain(x.data(), frames, channels, simd, mono.data(),
+                                          monoAbs.data(), side.data());
+    MagdaDSPKernels::AccumulateTimeDomainScalar(x.data(), frames, channels, ref, refMono.data(),
+                                                refMonoAbs.data(), refSide.data());
+
+    EXPECT_EQ(simd.sampleCount, ref.sampleCount);
+    EXPECT_FLOAT_EQ(simd.peak, ref.peak);
+    EXPECT_NEAR(simd.sumSquares, ref.sumSquares, 1e-4 * ref.sumSquares);
+    EXPECT_NEAR(simd.sumL2, ref.sumL2, 1e-4 * ref.sumL2 + 1e-9);
+    EXPECT_NEAR(simd.sumR2, ref.sumR2, 1e-4 * ref.sumR2 + 1e-9);
+    EXPECT_NEAR(simd.sumLR, ref.sumLR, 1e-4 * fabs(ref.sumL2) + 1e-9);
+    for (int i = 0; i < frames; i++) {
+        ASSERT_NEAR(mono[i], refMono[i], 1e-6f) << "frame " << i;
+        ASSERT_NEAR(monoAbs[i], refMonoAbs[i], 1e-6f) << "frame " << i;
+        ASSERT_NEAR(side[i], refSide[i], 1e-6f) << "frame " << i;
+        const float *frame = x.data() + (size_t)i * channels;
+        float expectedSide = channels >= 2 ? (frame[0] - frame[1]) * 0.5f : 0.0f;
+        ASSERT_NEAR(side[i], expectedSide, 1e-6f) << "frame " << i;
+    }
+}
+
+TEST(MagdaDSPKernelsTest, ReportsAnInstructionSet) {
+    EXPECT_NE(MagdaDSPKernels::GetActiveISA(), nullptr);
+}
+
+TEST(MagdaDSPKernelsTest, MatchesScalarForMonoAndStereo) {
+    // Odd lengths exercise the scalar tails after the vector loops
+    for (int frames : {1, 3, 7, 8, 255, 1000, 16384 + 5}) {
+        ExpectMatchesScalar(frames, 1);
+        ExpectMatchesScalar(frames, 2);
+    }
+}
+
+TEST(MagdaDSPKernelsTest, HandlesOtherChannelCounts) {
+    ExpectMatchesScalar(1001, 6);
+}
+
+TEST(MagdaDSPKernelsTest, AccumulatesAcrossBlocks) {
+    const int frames = 4096;
+    std::vector<float> x = TestBlock(frames, 2);
+
+    TimeDomainStats whole, split;
+    MagdaDSPKernels::AccumulateTimeDomain(x.data(), frames, 2, whole, nullptr, nullptr);
+    MagdaDSPKernels::AccumulateTimeDomain(x.data(), 1001, 2, split, nullptr, nullptr);
+    MagdaDSPKernels::AccumulateTimeDomain(x.data() + 1001 * 2, frames - 1001, 2, split, nullptr,
+                                          nullptr);
+
+    EXPECT_EQ(whole.sampleCount, split.sampleCount);
+    EXPECT_FLOAT_EQ(whole.peak, split.peak);
+    EXPECT_NEAR(whole.sumSquares, split.sumSquares, 1e-4 * whole.sumSquares);
+}
+
+TEST(MagdaDSPKernelsTest, StereoSumsDescribeChannelRelationship) {
+    // Identical channels: L.R equals L.L
+    const int frames = 512;
+    std::vector<float> x((size_t)frames * 2);
+    for (int i = 0; i < frames; i++) {
+        x[i * 2] = x[i * 2 + 1] = sinf(0.05f * i);
+    }
+    TimeDomainStats stats;
+    MagdaDSPKernels::AccumulateTimeDomain(x.data(), frames, 2, stats, nullptr, nullptr);
+    EXPECT_NEAR(stats.sumLR, stats.sumL2, 1e-4 * stats.sumL2);
+    EXPECT_NEAR(stats.sumL2, stats.sumR2, 1e-6 * stats.sumL2);
+}
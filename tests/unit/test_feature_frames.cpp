@@ -0,0 +1,229 @@
+/**
+ * Unit tests for time-resolved feature frames
+ *
+ * Feeds STFT windows of known signals through the frame builder and checks
+ * levels, band placement, decimation and the frame budget.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_feature_frames.h"
+#include "magda_stft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const int kSampleRate = 48000;
+static const int kFFTSize = 2048;
+static const int kHopSize = 1024;
+
+static void Analyze(const std::vector<float> &signal, MagdaFeatureFrameBuilder &builder) {
+    MagdaSTFT stft(kFFTSize, kHopSize, 1);
+    stft.SetWindowCallback([&builder](const float *samples, const float *magnitudes) {
+        builder.AddWindow(samples, magnitudes);
+    });
+    stft.Process(signal.data(), (int)signal.size());
+    stft.Flush();
+}
+
+static std::vector<float> Sine(float frequency, float amplitude, int frames) {
+    std::vector<float> signal(frames);
+    for (int i = 0; i < frames; i++) {
+        signal[i] = amplitude * (float)sin(2.0 * M_PI * frequency * i / kSampleRate);
+    }
+    return signal;
+}
+
+TEST(FeatureFramesTest, SineLevelAndBand) {
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize, 24, 256);
+    Analyze(Sine(1000.0f, 0.5f, kSampleRate), builder);
+
+    FeatureFrames frames;
+    builder.Finish(frames);
+    ASSERT_GT(frames.GetNumFrames(), 0);
+    ASSERT_EQ(frames.GetNumBands(), 24);
+    EXPECT_EQ(frames.bandEnergies.size(), (size_t)frames.GetNumFrames() * 24);
+
+    // 0.5 amplitude sine: RMS = 0.5 / sqrt(2) = -9.03 dB
+    for (int f = 0; f < frames.GetNumFrames(); f++) {
+        EXPECT_NEAR(frames.rms[f], -9.03f, 0.1f);
+        EXPECT_NEAR(frames.centroid[f], 1000.0f, 50.0f);
+        EXPECT_LT(frames.flatness[f], 0.05f);
+    }
+
+    int numFrames = frames.GetNumFrames();
+    int loudestBand = 0;
+    for (int b = 1; b < frames.GetNumBands(); b++) {
+        if (frames.bandEnergies[(size_t)b * numFrames] >
+            frames.bandEnergies[(size_t)loudestBand * numFrames]) {
+            loudestBand = b;
+        }
+    }
+    EXPECT_LE(frames.bandEdges[loudestBand], 1000.0f);
+    EXPECT_GT(frames.bandEdges[loudestBand + 1], 1000.0f);
+}
+
+TEST(FeatureFramesTest, NoiseIsFlat) {
+    std::vector<float> noise(kSampleRate);
+    unsigned int state = 12345;
+    for (float &sample : noise) {
+        state = state * 1664525u + 1013904223u;
+        sample = ((state >> 8) / 8388608.0f - 1.0f) * 0.5f;
+    }
+
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize, 24, 256);
+    Analyze(noise, builder);
+
+    FeatureFrames frames;
+    builder.Finish(frames);
+    ASSERT_GT(frames.GetNumFrames(), 0);
+    for (int f = 0; f < frames.GetNumFrames(); f++) {
+        EXPECT_GT(frames.flatness[f], 0.4f);
+        EXPECT_GT(frames.centroid[f], 8000.0f);
+    }
+}
+
+TEST(FeatureFramesTest, TracksLevelChangesOverTime) {
+    // One second loud, one second quiet
+    std::vector<float> signal = Sine(440.0f, 0.5f, kSampleRate);
+    std::vector<float> quiet = Sine(440.0f, 0.05f, kSampleRate);
+    signal.insert(signal.end(), quiet.begin(), quiet.end());
+
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize, 16, 8);
+    Analyze(signal, builder);
+
+    FeatureFrames frames;
+    builder.Finish(frames);
+    int numFrames = frames.GetNumFrames();
+    ASSERT_GE(numFrames, 4);
+    EXPECT_NEAR(frames.rms[0], -9.03f, 0.1f);
+    EXPECT_NEAR(frames.rms[numFrames - 1], -29.03f, 0.1f);
+}
+
+TEST(FeatureFramesTest, DecimatesToBudget) {
+    const int budget = 16;
+    std::vector<float> signal = Sine(220.0f, 0.25f, kSampleRate * 20);
+
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize, 8, budget);
+    Analyze(signal, builder);
+
+    FeatureFrames frames;
+    builder.Finish(frames);
+    EXPECT_LE(frames.GetNumFrames(), budget);
+    EXPECT_GE(frames.GetNumFrames(), budget / 2);
+    EXPECT_GT(builder.GetWindowsPerFrame(), 1);
+
+    // Frames still cover the whole signal
+    double covered = frames.startSeconds + frames.frameSeconds * (frames.GetNumFrames() - 1);
+    EXPECT_GT(covered, 15.0);
+    EXPECT_LT(covered, 20.0);
+    for (float rms : frames.rms) {
+        EXPECT_NEAR(rms, -15.05f, 0.1f);
+    }
+}
+
+TEST(FeatureFramesTest, ExpectedLengthUsesWholeBudget) {
+    const int budget = 64;
+    const int numSamples = kSampleRate * 20;
+    long long expectedWindows = (numSamples - kFFTSize) / kHopSize + 1;
+
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize, 8, budget, expectedWindows);
+    Analyze(Sine(220.0f, 0.25f, numSamples), builder);
+
+    EXPECT_LE(builder.GetNumFrames(), budget);
+    EXPECT_GT(builder.GetNumFrames(), budget * 3 / 4);
+}
+
+TEST(FeatureFramesTest, ExactMultipleOfBudgetKeepsFullResolution) {
+    const int budget = 16;
+    std::vector<float> samples(kFFTSize, 0.1f);
+    std::vector<float> magnitudes(kFFTSize / 2 + 1, 1.0f);
+
+    // One window per frame, exactly filling the budget
+    MagdaFeatureFrameBuilder single(kSampleRate, kFFTSize, kHopSize, 8, budget, budget);
+    for (int i = 0; i < budget; i++) {
+        single.AddWindow(samples.data(), magnitudes.data());
+    }
+    FeatureFrames frames;
+    single.Finish(frames);
+    EXPECT_EQ(frames.GetNumFrames(), budget);
+    EXPECT_EQ(single.GetWindowsPerFrame(), 1);
+    EXPECT_DOUBLE_EQ(frames.frameSeconds, (double)kHopSize / kSampleRate);
+
+    // Three windows per frame, exactly filling the budget
+    MagdaFeatureFrameBuilder triple(kSampleRate, kFFTSize, kHopSize, 8, budget, budget * 3);
+    for (int i = 0; i < budget * 3; i++) {
+        triple.AddWindow(samples.data(), magnitudes.data());
+    }
+    triple.Finish(frames);
+    EXPECT_EQ(frames.GetNumFrames(), budget);
+    EXPECT_EQ(triple.GetWindowsPerFrame(), 3);
+
+    // One window more than expected merges, and that window stays pending
+    single.AddWindow(samples.data(), magnitudes.data());
+    EXPECT_EQ(single.GetWindowsPerFrame(), 2);
+    EXPECT_EQ(single.GetNumFrames(), budget / 2 + 1);
+    single.Finish(frames);
+    for (float rms : frames.rms) {
+        EXPECT_NEAR(rms, -20.0f, 0.01f);
+    }
+}
+
+TEST(FeatureFramesTest, DecimateMergesFrames) {
+    FeatureFrames frames;
+    frames.frameSeconds = 0.1;
+    frames.bandEdges = {20.0f, 2000.0f, 20000.0f};
+    frames.rms = {-10.0f, -10.0f, -20.0f};
+    frames.centroid = {1000.0f, 3000.0f, 500.0f};
+    frames.flatness = {0.2f, 0.4f, 0.9f};
+    frames.bandEnergies = {-10.0f, -20.0f, -30.0f, -40.0f, -40.0f, -50.0f};
+
+    FeatureFrames merged;
+    MagdaFeatureFrameBuilder::Decimate(frames, 2, merged);
+    ASSERT_EQ(merged.GetNumFrames(), 2);
+    ASSERT_EQ(merged.GetNumBands(), 2);
+    EXPECT_DOUBLE_EQ(merged.frameSeconds, 0.2);
+    EXPECT_NEAR(merged.rms[0], -10.0f, 1e-4f);
+    EXPECT_NEAR(merged.rms[1], -20.0f, 1e-4f);
+    EXPECT_NEAR(merged.centroid[0], 2000.0f, 1e-3f);
+    EXPECT_NEAR(merged.flatness[0], 0.3f, 1e-6f);
+    // Power mean of -10 and -20 dB
+    EXPECT_NEAR(merged.bandEnergies[0], 10.0f * log10f(0.055f), 1e-3f);
+    EXPECT_NEAR(merged.bandEnergies[1], -30.0f, 1e-4f);
+    EXPECT_NEAR(merged.bandEnergies[2], -40.0f, 1e-4f);
+    EXPECT_NEAR(merged.bandEnergies[3], -50.0f, 1e-4f);
+}
+
+TEST(FeatureFramesTest, CriticalBandLayout) {
+    std::vector<float> edges = MagdaFeatureFrameBuilder::CriticalBandEdges(48000);
+    ASSERT_EQ(edges.size(), 26u);
+    EXPECT_FLOAT_EQ(edges.front(), 20.0f);
+    EXPECT_FLOAT_EQ(edges[1], 100.0f);
+    EXPECT_FLOAT_EQ(edges.back(), 20000.0f);
+
+    // Cut at Nyquist for low sample rates
+    edges = MagdaFeatureFrameBuilder::CriticalBandEdges(16000);
+    EXPECT_FLOAT_EQ(edges.back(), 8000.0f);
+    EXPECT_LT(edges[edges.size() - 2], 8000.0f);
+
+    MagdaFeatureFrameBuilder builder(kSampleRate, kFFTSize, kHopSize,
+                                     MagdaFeatureFrameBuilder::CriticalBandEdges(kSampleRate), 64);
+    Analyze(Sine(250.0f, 0.5f, kSampleRate / 2), builder);
+    FeatureFrames frames;
+    builder.Finish(frames);
+    ASSERT_EQ(frames.GetNumBands(), 25);
+
+    // 250 Hz sits in the 200-300 Hz critical band
+    int numFrames = frames.GetNumFrames();
+    int loudestBand = 0;
+    for (int b = 1; b < frames.GetNumBands(); b++) {
+        if (frames.bandEnergies[(size_t)b * numFrames] >
+            frames.bandEnergies[(size_t)loudestBand * numFrames]) {
+            loudestBand = b;
+        }
+    }
+    EXPECT_EQ(loudestBand, 2);
+}
@@ -0,0 +1,115 @@
+/**
+ * Unit tests for the MAGDA real-input FFT engine
+ *
+ * Compares MagdaFFTPlan against a double precision reference DFT.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void ReferenceDFT(const std::vector<float>& input, std::vector<double>& re,
+                         std::vector<double>& im) {
+    int N = (int)input.size();
+    re.assign(N / 2 + 1, 0.0);
+    im.assign(N / 2 + 1, 0.0);
+    for (int k = 0; k < N / 2 + 1; k++) {
+        for (int n = 0; n < N; n++) {
+            double angle = 2.0 * M_PI * (double)k * n / N;
+            re[k] += input[n] * cos(angle);
+            im[k] -= input[n] * sin(angle);
+        }
+    }
+}
+
+static std::vector<float> TestSignal(int N) {
+    std::vector<float> x(N);
+    unsigned int seed = 12345;
+    for (int n = 0; n < N; n++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 8) & 0xffff) / 65535.0f - 0.5f;
+        x[n] = 0.6f * sinf(2.0f * (float)M_PI * 7.0f * n / N) + 0.2f * noise;
+    }
+    return x;
+}
+
+static void ExpectMatchesReference(int N, double tolerance) {
+    auto plan = MagdaFFT::GetPlan(N);
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->GetSize(), N);
+    ASSERT_EQ(plan->GetNumBins(), N / 2 + 1);
+
+    std::vector<float> x = TestSignal(N);
+    std::vector<float> re(plan->GetNumBins()), im(plan->GetNumBins());
+    std::vector<float> work(plan->GetWorkSize());
+    plan->Forward(x.data(), re.data(), im.data(), work.data());
+
+    std::vector<double> refRe, refIm;
+    ReferenceDFT(x, refRe, refIm);
+
+    double maxErr = 0.0;
+    for (int k = 0; k < N / 2 + 1; k++) {
+        maxErr = std::max(maxErr, fabs(re[k] - refRe[k]));
+        maxErr = std::max(maxErr, fabs(im[k] - refIm[k]));
+    }
+    EXPECT_LT(maxErr, tolerance) << "N=" << N;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+TEST(MagdaFFTTest, MatchesReferenceForPowerOfTwoSizes) {
+    // Covers both the leading radix-2 path (odd log2(N/2)) and pure radix-4
+    for (int N : {2, 4, 8, 16, 32, 64, 256, 1024, 4096}) {
+        ExpectMatchesReference(N, 1e-4 * N);
+    }
+}
+
+TEST(MagdaFFTTest, MatchesReferenceForOtherSizes) {
+    for (int N : {3, 12, 100, 1000}) {
+        ExpectMatchesReference(N, 1e-4 * N);
+    }
+}
+
+TEST(MagdaFFTTest, PureToneLandsInOneBin) {
+    const int N = 4096;
+    auto plan = MagdaFFT::GetPlan(N);
+    std::vector<float> x(N);
+    for (int n = 0; n < N; n++) {
+        x[n] = cosf(2.0f * (float)M_PI * 100.0f * n / N);
+    }
+    std::vector<float> re(N / 2 + 1), im(N / 2 + 1), work(plan->GetWorkSize());
+    plan->Forward(x.data(), re.data(), im.data(), work.data());
+
+    EXPECT_NEAR(re[100], N / 2.0f, 0.01f * N);
+    EXPECT_NEAR(sqrtf(re[99] * re[99] + im[99] * im[99]), 0.0f, 0.01f);
+    EXPECT_NEAR(sqrtf(re[101] * re[101] + im[101] * im[101]), 0.0f, 0.01f);
+}
+
+TEST(MagdaFFTTest, PlansAreCachedPerSize) {
+    auto a = MagdaFFT::GetPlan(2048);
+    auto b = MagdaFFT::GetPlan(2048);
+    auto c = MagdaFFT::GetPlan(1024);
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_NE(a.get(), c.get());
+}
+
+TEST(MagdaFFTTest, WindowIsHann) {
+    const int N = 512;
+    auto plan = MagdaFFT::GetPlan(N);
+    const float* w = plan->GetWindow();
+    EXPECT_NEAR(w[0], 0.0f, 1e-6f);
+    EXPECT_NEAR(w[N - 1], 0.0f, 1e-6f);
+    EXPECT_NEAR(w[(N - 1) / 2], 1.0f, 1e-4f);
+}
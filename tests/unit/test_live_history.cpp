@@ -0,0 +1,93 @@
+/**
+ * Unit tests for the live meter's playback history and latest result
+ *
+ * Covers when the staggered analysis segments start and start over, that
+ * the oldest one always spans half to all of the history, and result age
+ * and length checks.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "magda_live_history.h"
+
+TEST(LiveSegmentsTest, SecondSegmentStartsHalfASpanIn) {
+    MagdaLiveSegments segments(100);
+    EXPECT_TRUE(segments.IsRunning(0));
+    EXPECT_FALSE(segments.IsRunning(1));
+    EXPECT_EQ(segments.GetFramesUntilChange(), 50);
+
+    EXPECT_EQ(segments.Advance(30), -1);
+    EXPECT_EQ(segments.GetFramesUntilChange(), 20);
+    EXPECT_EQ(segments.Advance(20), 1);
+    EXPECT_TRUE(segments.IsRunning(1));
+    EXPECT_EQ(segments.GetFrames(1), 0);
+    EXPECT_EQ(segments.GetOldest(), 0);
+    EXPECT_EQ(segments.GetFramesUntilChange(), 50);
+}
+
+TEST(LiveSegmentsTest, FullSegmentStartsOverAndTheOtherBecomesOldest) {
+    MagdaLiveSegments segments(100);
+    segments.Advance(50);
+    EXPECT_EQ(segments.Advance(50), 0);
+    EXPECT_EQ(segments.GetFrames(0), 0);
+    EXPECT_EQ(segments.GetOldest(), 1);
+    EXPECT_EQ(segments.GetFrames(1), 50);
+
+    EXPECT_EQ(segments.Advance(50), 1);
+    EXPECT_EQ(segments.GetOldest(), 0);
+    EXPECT_EQ(segments.GetFrames(0), 50);
+}
+
+TEST(LiveSegmentsTest, OldestAlwaysCoversHalfToAllOfTheSpan) {
+    // Uneven block sizes, split where a segment starts over
+    MagdaLiveSegments segments(1000);
+    const long long blocks[] = {7, 300, 1, 999, 64, 2048, 13};
+    long long total = 0;
+    for (int round = 0; round < 20; round++) {
+        for (long long block : blocks) {
+            while (block > 0) {
+                long long count = std::min(block, segments.GetFramesUntilChange());
+                ASSERT_GT(count, 0);
+                segments.Advance(count);
+                block -= count;
+                total += count;
+                long long oldest = segments.GetFrames(segments.GetOldest());
+                if (total < 500) {
+                    EXPECT_EQ(oldest, total);
+                } else {
+                    EXPECT_GE(oldest, 500);
+                    EXPECT_LE(oldest, 1000);
+                }
+            }
+        }
+    }
+
+    segments.Reset(10);
+    EXPECT_FALSE(segments.IsRunning(1));
+    EXPECT_EQ(segments.GetFrames(0), 0);
+    EXPECT_EQ(segments.GetSpanFrames(), 10);
+}
+
+TEST(LiveResultTest, RequiresEnoughRecentPlayback) {
+    MagdaLiveResult live;
+    DSPAnalysisResult result;
+    double seconds = 0.0;
+    EXPECT_FALSE(live.Get(0.0, 1e9, 0.0, result, seconds));
+
+    DSPAnalysisResult published;
+    published.success = true;
+    published.sampleRate = 48000;
+    live.Publish(published, 6.0, 100.0);
+
+    EXPECT_TRUE(live.Get(5.0, 3.0, 102.0, result, seconds));
+    EXPECT_EQ(result.sampleRate, 48000);
+    EXPECT_DOUBLE_EQ(seconds, 6.0);
+
+    // Too short, then too old
+    EXPECT_FALSE(live.Get(10.0, 3.0, 102.0, result, seconds));
+    EXPECT_FALSE(live.Get(5.0, 3.0, 103.5, result, seconds));
+
+    live.Reset();
+    EXPECT_FALSE(live.Get(0.0, 1e9, 100.0, result, seconds));
+}
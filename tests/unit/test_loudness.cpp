@@ -0,0 +1,99 @@
+/**
+ * Unit tests for the BS.1770 / EBU R128 loudness meter
+ *
+ * Uses the EBU Tech 3341 / 3342 style reference signals (1 kHz stereo sine).
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_loudness.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Append `seconds` of a 1 kHz stereo sine whose amplitude is `dbfs` (peak)
+static void AppendSine(std::vector<float>& out, int sampleRate, double seconds, double dbfs) {
+    double amplitude = pow(10.0, dbfs / 20.0);
+    size_t start = out.size() / 2;
+    size_t frames = (size_t)(seconds * sampleRate);
+    for (size_t i = 0; i < frames; i++) {
+        float s = (float)(amplitude * sin(2.0 * M_PI * 1000.0 * (double)(start + i) / sampleRate));
+        out.push_back(s);
+        out.push_back(s);
+    }
+}
+
+static void AppendSilence(std::vector<float>& out, int sampleRate, double seconds) {
+    out.resize(out.size() + (size_t)(seconds * sampleRate) * 2, 0.0f);
+}
+
+static void Feed(MagdaLoudnessMeter& meter, const std::vector<float>& x, int blockFrames) {
+    int frames = (int)(x.size() / 2);
+    for (int pos = 0; pos < frames; pos += blockFrames) {
+        int n = std::min(blockFrames, frames - pos);
+        meter.Process(x.data() + (size_t)pos * 2, n);
+    }
+}
+
+TEST(MagdaLoudnessTest, SineAtMinus23ReadsMinus23Lufs) {
+    for (int sampleRate : {44100, 48000}) {
+        std::vector<float> x;
+        AppendSine(x, sampleRate, 20.0, -23.0);
+        MagdaLoudnessMeter meter(sampleRate, 2);
+        Feed(meter, x, 4096);
+
+        EXPECT_NEAR(meter.GetIntegrated(), -23.0, 0.1) << sampleRate;
+        EXPECT_NEAR(meter.GetMomentaryMax(), -23.0, 0.1);
+        EXPECT_NEAR(meter.GetShortTermMax(), -23.0, 0.1);
+        EXPECT_NEAR(meter.GetLoudnessRange(), 0.0, 0.2);
+    }
+}
+
+TEST(MagdaLoudnessTest, GatingIgnoresSilence) {
+    std::vector<float> x;
+    AppendSilence(x, 48000, 10.0);
+    AppendSine(x, 48000, 10.0, -23.0);
+    AppendSilence(x, 48000, 10.0);
+    MagdaLoudnessMeter meter(48000, 2);
+    Feed(meter, x, 1000);
+
+    // Gating blocks straddling the tone edges still pass the relative gate,
+    // so expect a slightly lower reading than the steady tone alone
+    EXPECT_NEAR(meter.GetIntegrated(), -23.0, 0.2);
+}
+
+TEST(MagdaLoudnessTest, LoudnessRangeOfTwoLevels) {
+    // EBU Tech 3342 case 1: -20 dBFS then -30 dBFS, 20 s each -> LRA 10 LU
+    std::vector<float> x;
+    AppendSine(x, 48000, 20.0, -20.0);
+    AppendSine(x, 48000, 20.0, -30.0);
+    MagdaLoudnessMeter meter(48000, 2);
+    Feed(meter, x, 16384);
+
+    EXPECT_NEAR(meter.GetLoudnessRange(), 10.0, 1.0);
+}
+
+TEST(MagdaLoudnessTest, BlockSizeDoesNotChangeResult) {
+    std::vector<float> x;
+    AppendSine(x, 44100, 5.0, -18.0);
+    AppendSine(x, 44100, 5.0, -28.0);
+    MagdaLoudnessMeter a(44100, 2), b(44100, 2);
+    Feed(a, x, 37);
+    Feed(b, x, 65536);
+
+    EXPECT_DOUBLE_EQ(a.GetIntegrated(), b.GetIntegrated());
+    EXPECT_DOUBLE_EQ(a.GetLoudnessRange(), b.GetLoudnessRange());
+}
+
+TEST(MagdaLoudnessTest, SilenceHasNoLoudness) {
+    std::vector<float> x;
+    AppendSilence(x, 48000, 5.0);
+    MagdaLoudnessMeter meter(48000, 2);
+    Feed(meter, x, 4096);
+
+    EXPECT_EQ(meter.GetIntegrated(), MagdaLoudnessMeter::kNoLoudness);
+    EXPECT_EQ(meter.GetLoudnessRange(), 0.0);
+}
@@ -0,0 +1,134 @@
+/**
+ * Unit tests for the main-thread task queue
+ *
+ * Covers ordering, priorities, polling tasks, the per-tick time budget and
+ * futures waited on from other threads.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "magda_main_thread_queue.h"
+
+TEST(MainThreadQueueTest, RunsInPostingOrderByPriority) {
+    MagdaMainThreadQueue queue;
+    std::string order;
+    queue.Post([&]() { order += "a"; }, MAIN_THREAD_LOW);
+    queue.Post([&]() { order += "b"; });
+    queue.Post([&]() { order += "c"; }, MAIN_THREAD_HIGH);
+    queue.Post([&]() { order += "d"; });
+    queue.Post([&]() { order += "e"; }, MAIN_THREAD_HIGH);
+
+    EXPECT_EQ(queue.GetNumPending(), 5);
+    EXPECT_EQ(queue.RunPending(1000.0), 5);
+    EXPECT_EQ(order, "cebda");
+    EXPECT_EQ(queue.GetNumPending(), 0);
+}
+
+TEST(MainThreadQueueTest, TasksPostedDuringATickWaitForTheNext) {
+    MagdaMainThreadQueue queue;
+    int runs = 0;
+    queue.Post([&]() {
+        runs++;
+        queue.Post([&]() { runs++; }, MAIN_THREAD_HIGH);
+    });
+
+    EXPECT_EQ(queue.RunPending(1000.0), 1);
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(queue.RunPending(1000.0), 1);
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(MainThreadQueueTest, PollingTasksKeepTheirPlace) {
+    MagdaMainThreadQueue queue;
+    std::string order;
+    int polls = 0;
+    queue.PostPolling([&]() {
+        order += "p";
+        return ++polls == 3;
+    });
+    queue.Post([&]() { order += "x"; });
+
+    EXPECT_EQ(queue.RunPending(1000.0), 2);
+    queue.Post([&]() { order += "y"; });
+    queue.RunPending(1000.0);
+    queue.RunPending(1000.0);
+    queue.RunPending(1000.0);
+
+    EXPECT_EQ(order, "pxpyp");
+    EXPECT_EQ(queue.GetNumPending(), 0);
+}
+
+TEST(MainThreadQueueTest, BudgetSpreadsWorkOverTicks) {
+    MagdaMainThreadQueue queue;
+    int runs = 0;
+    for (int i = 0; i < 6; i++) {
+        queue.Post([&]() {
+            runs++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+    }
+
+    // A zero budget still runs one task per tick
+    EXPECT_EQ(queue.RunPending(0.0), 1);
+    int ticks = 1;
+    while (queue.GetNumPending() > 0 && ticks < 100) {
+        int ran = queue.RunPending(8.0);
+        EXPECT_GE(ran, 1);
+        EXPECT_LE(ran, 2);
+        ticks++;
+    }
+    EXPECT_EQ(runs, 6);
+    EXPECT_GE(ticks, 4);
+}
+
+TEST(MainThreadQueueTest, FuturesResolveForWaitingThreads) {
+    MagdaMainThreadQueue queue;
+    std::atomic<bool> done(false);
+    int result = 0;
+    std::thread background([&]() {
+        std::future<int> future = queue.Post([]() { return 42; });
+        result = future.get();
+        done = true;
+    });
+
+    // Act as the timer until the background thread has its answer
+    for (int i = 0; i < 1000 && !done; i++) {
+        queue.RunPending(5.0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    background.join();
+    EXPECT_EQ(result, 42);
+    EXPECT_TRUE(queue.IsMainThread());
+}
+
+TEST(MainThreadQueueTest, ManyProducersLoseNothing) {
+    MagdaMainThreadQueue queue;
+    std::atomic<int> sum(0);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < 500; i++) {
+                queue.Post([&sum]() { sum++; }, (MainThreadPriority)(i % 3));
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_EQ(queue.RunPending(10000.0), 2000);
+    EXPECT_EQ(sum.load(), 2000);
+}
+
+TEST(MainThreadQueueTest, ClearBreaksFutures) {
+    MagdaMainThreadQueue queue;
+    std::future<void> future = queue.Post([]() {});
+    queue.Clear();
+    EXPECT_EQ(queue.GetNumPending(), 0);
+    EXPECT_THROW(future.get(), std::future_error);
+}
@@ -0,0 +1,144 @@
+/**
+ * Unit tests for the cross-track masking matrix
+ *
+ * Builds synthetic per-band frames and checks overlap, time alignment,
+ * conflict merging and the JSON output.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "magda_masking.h"
+
+static const std::vector<float> kEdges = {20.0f, 100.0f, 200.0f, 300.0f, 400.0f};
+
+// numFrames frames of 0.1 s, every band at -96 dB except those in levels
+static FeatureFrames MakeFrames(int numFrames, const std::vector<std::pair<int, float>> &levels) {
+    FeatureFrames frames;
+    frames.frameSeconds = 0.1;
+    frames.bandEdges = kEdges;
+    int numBands = (int)kEdges.size() - 1;
+    frames.rms.assign(numFrames, -20.0f);
+    frames.centroid.assign(numFrames, 1000.0f);
+    frames.flatness.assign(numFrames, 0.5f);
+    frames.bandEnergies.assign((size_t)numBands * numFrames, -96.0f);
+    for (const auto &level : levels) {
+        for (int f = 0; f < numFrames; f++) {
+            frames.bandEnergies[(size_t)level.first * numFrames + f] = level.second;
+        }
+    }
+    return frames;
+}
+
+static MaskingTrack Track(const FeatureFrames &frames, double startTime = 0.0) {
+    MaskingTrack track;
+    track.frames = &frames;
+    track.startTime = startTime;
+    return track;
+}
+
+TEST(MaskingTest, SharedBandsCompeteOthersDoNot) {
+    FeatureFrames bass = MakeFrames(100, {{0, -20.0f}, {1, -24.0f}});
+    FeatureFrames kick = MakeFrames(100, {{0, -23.0f}, {3, -30.0f}});
+
+    MaskingMatrix matrix;
+    ASSERT_TRUE(MagdaMaskingAnalyzer::Compute({Track(bass), Track(kick)}, matrix, 2));
+    ASSERT_EQ(matrix.pairs.size(), 1u);
+    const MaskingPair &pair = matrix.pairs[0];
+    ASSERT_EQ(pair.bands.size(), 4u);
+
+    EXPECT_NEAR(pair.bands[0].overlap, 1.0f, 1e-6);
+    EXPECT_NEAR(pair.bands[0].competingSeconds, 10.0f, 0.01f);
+    EXPECT_NEAR(pair.bands[0].levelDiff, 3.0f, 0.01f);
+    EXPECT_EQ(pair.bands[1].overlap, 0.0f);
+    EXPECT_EQ(pair.bands[2].overlap, 0.0f);
+    EXPECT_EQ(pair.bands[3].overlap, 0.0f);
+}
+
+TEST(MaskingTest, LargeLevelGapIsNotCompetition) {
+    FeatureFrames loud = MakeFrames(50, {{2, -10.0f}});
+    FeatureFrames quiet = MakeFrames(50, {{2, -40.0f}});
+
+    MaskingMatrix matrix;
+    ASSERT_TRUE(MagdaMaskingAnalyzer::Compute({Track(loud), Track(quiet)}, matrix, 1));
+    EXPECT_EQ(matrix.pairs[0].bands[2].overlap, 0.0f);
+    EXPECT_EQ(matrix.pairs[0].bands[2].competingSeconds, 0.0f);
+}
+
+TEST(MaskingTest, TracksOnlyCompeteWhileTheyOverlapInTime) {
+    FeatureFrames first = MakeFrames(100, {{0, -20.0f}});
+    FeatureFrames second = MakeFrames(100, {{0, -20.0f}});
+
+    // Second track starts halfway through the first
+    MaskingMatrix matrix;
+    ASSERT_TRUE(MagdaMaskingAnalyzer::Compute({Track(first), Track(second, 5.0)}, matrix, 0));
+    EXPECT_NEAR(matrix.pairs[0].bands[0].competingSeconds, 5.0f, 0.11f);
+    EXPECT_NEAR(matrix.pairs[0].bands[0].overlap, 1.0f / 3.0f, 0.01f);
+
+    // No overlap at all when one starts after the other ends
+    ASSERT_TRUE(MagdaMaskingAnalyzer::Compute({Track(first), Track(second, 20.0)}, matrix, 0));
+    EXPECT_EQ(matrix.pairs[0].bands[0].competingSeconds, 0.0f);
+}
+
+TEST(MaskingTest, EveryPairIsComputedInOrder) {
+    FeatureFrames a = MakeFrames(20, {{0, -20.0f}});
+    FeatureFrames b = MakeFrames(20, {{0, -20.0f}});
+    FeatureFrames c = MakeFrames(20, {{1, -20.0f}});
+    FeatureFrames d = MakeFrames(20, {{1, -22.0f}});
+
+    MaskingMatrix matrix;
+    ASSERT_TRUE(
+        MagdaMaskingAnalyzer::Compute({Track(a), Track(b), Track(c), Track(d)}, matrix, 0));
+    ASSERT_EQ(matrix.pairs.size(), 6u);
+    int expected[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+    for (int p = 0; p < 6; p++) {
+        EXPECT_EQ(matrix.pairs[p].trackA, expected[p][0]);
+        EXPECT_EQ(matrix.pairs[p].trackB, expected[p][1]);
+    }
+    EXPECT_NEAR(matrix.pairs[0].bands[0].overlap, 1.0f, 1e-6);
+    EXPECT_NEAR(matrix.pairs[5].bands[1].overlap, 1.0f, 1e-6);
+    EXPECT_EQ(matrix.pairs[1].bands[0].overlap, 0.0f);
+}
+
+TEST(MaskingTest, RejectsMismatchedBandsAndSingleTracks) {
+    FeatureFrames a = MakeFrames(10, {{0, -20.0f}});
+    FeatureFrames b = MakeFrames(10, {{0, -20.0f}});
+    b.bandEdges = {20.0f, 150.0f, 200.0f, 300.0f, 400.0f};
+
+    MaskingMatrix matrix;
+    EXPECT_FALSE(MagdaMaskingAnalyzer::Compute({Track(a), Track(b)}, matrix));
+    EXPECT_FALSE(MagdaMaskingAnalyzer::Compute({Track(a)}, matrix));
+}
+
+TEST(MaskingTest, ConflictsMergeAdjacentBandsAndSerialize) {
+    FeatureFrames bass = MakeFrames(100, {{0, -20.0f}, {1, -20.0f}, {3, -30.0f}});
+    FeatureFrames kick = MakeFrames(100, {{0, -18.0f}, {1, -22.0f}});
+    FeatureFrames keys = MakeFrames(40, {{3, -31.0f}});
+
+    MaskingMatrix matrix;
+    ASSERT_TRUE(
+        MagdaMaskingAnalyzer::Compute({Track(bass), Track(kick), Track(keys)}, matrix, 0));
+
+    std::vector<MaskingConflict> conflicts;
+    MagdaMaskingAnalyzer::FindConflicts(matrix, 0.3f, 10, conflicts);
+    ASSERT_EQ(conflicts.size(), 2u);
+
+    // Bass vs kick over the two lowest bands, strongest first
+    EXPECT_EQ(conflicts[0].trackA, 0);
+    EXPECT_EQ(conflicts[0].trackB, 1);
+    EXPECT_FLOAT_EQ(conflicts[0].lowHz, 20.0f);
+    EXPECT_FLOAT_EQ(conflicts[0].highHz, 200.0f);
+    EXPECT_NEAR(conflicts[0].levelDiff, 0.0f, 0.01f);
+    EXPECT_EQ(conflicts[1].trackA, 0);
+    EXPECT_EQ(conflicts[1].trackB, 2);
+    EXPECT_FLOAT_EQ(conflicts[1].lowHz, 300.0f);
+
+    MagdaMaskingAnalyzer::FindConflicts(matrix, 0.3f, 1, conflicts);
+    ASSERT_EQ(conflicts.size(), 1u);
+
+    WDL_FastString json;
+    MagdaMaskingAnalyzer::AppendJSON(json, conflicts, {"Bass", "Kick \"909\"", "Keys"});
+    EXPECT_STREQ(json.Get(), ",\"masking\":[{\"a\":\"Bass\",\"b\":\"Kick \\\"909\\\"\","
+                             "\"hz\":[20,200],\"overlap\":1,\"seconds\":10,\"diff\":0}]");
+}
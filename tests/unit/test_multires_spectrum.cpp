@@ -0,0 +1,127 @@
+/**
+ * Unit tests for the multi-resolution (octave-decimated) spectrum
+ *
+ * Checks that low third-octave bands are resolved, that levels line up with
+ * the reference spectrum, and the fallback for input shorter than a window.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "magda_multires_spectrum.h"
+
+static const int kSampleRate = 48000;
+static const int kRefFFTSize = 4096;
+
+static std::vector<float> Noise(int frames) {
+    std::vector<float> x(frames);
+    unsigned int seed = 12345;
+    for (int n = 0; n < frames; n++) {
+        seed = seed * 1103515245u + 12345u;
+        x[n] = ((seed >> 8) & 0xffff) / 65535.0f - 0.5f;
+    }
+    return x;
+}
+
+static std::vector<float> Sine(int frames, float freq, float amplitude) {
+    std::vector<float> x(frames);
+    for (int n = 0; n < frames; n++) {
+        x[n] = amplitude * sinf(2.0f * (float)M_PI * freq * n / kSampleRate);
+    }
+    return x;
+}
+
+// Reference spectrum the way the DSP stream builds it (Hz, dB)
+static void ReferenceSpectrum(const std::vector<float>& x, std::vector<float>& freqs,
+                              std::vector<float>& mags) {
+    MagdaSTFT stft(kRefFFTSize, kRefFFTSize / 2, 0);
+    stft.Process(x.data(), (int)x.size());
+    stft.Flush();
+    freqs.resize(stft.GetNumBins());
+    mags.resize(stft.GetNumBins());
+    for (int k = 0; k < stft.GetNumBins(); k++) {
+        freqs[k] = (float)k * kSampleRate / kRefFFTSize;
+        double mag = stft.GetMagnitudeSums()[k] / stft.GetNumWindows() / (kRefFFTSize / 2.0);
+        mags[k] = mag > 0 ? 20.0f * log10f((float)mag) : -96.0f;
+    }
+}
+
+static void Feed(MagdaMultiResSpectrum& spectrum, const std::vector<float>& x) {
+    for (size_t pos = 0; pos < x.size(); pos += 16384) {
+        int n = (int)std::min((size_t)16384, x.size() - pos);
+        spectrum.Process(x.data() + pos, n);
+    }
+    spectrum.Flush();
+}
+
+static float ThirdOctave(const MagdaMultiResSpectrum& spectrum, float centre,
+                         const std::vector<float>& freqs, const std::vector<float>& mags) {
+    float ratio = powf(2.0f, 1.0f / 6.0f);
+    return spectrum.GetBandLevel(centre / ratio, centre * ratio, freqs, mags);
+}
+
+TEST(MultiResSpectrumTest, NoiseLevelsMatchReferenceSpectrum) {
+    std::vector<float> x = Noise(kSampleRate * 12);
+    std::vector<float> freqs, mags;
+    ReferenceSpectrum(x, freqs, mags);
+
+    MagdaMultiResSpectrum spectrum(kSampleRate, kRefFFTSize);
+    Feed(spectrum, x);
+    ASSERT_GT(spectrum.GetNumLevels(), 0);
+
+    // White noise: the decimated low bands read like the reference high ones
+    float reference = ThirdOctave(spectrum, 2000.0f, freqs, mags);
+    for (float centre : {31.5f, 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f}) {
+        EXPECT_NEAR(ThirdOctave(spectrum, centre, freqs, mags), reference, 1.5f)
+            << "band " << centre;
+    }
+}
+
+TEST(MultiResSpectrumTest, ResolvesLowSine) {
+    // 40 Hz sits in one third-octave band; a 4096-point spectrum smears it
+    // over its 11.7 Hz bins into the neighbours
+    std::vector<float> x = Sine(kSampleRate * 10, 40.0f, 0.5f);
+    std::vector<float> freqs, mags;
+    ReferenceSpectrum(x, freqs, mags);
+
+    MagdaMultiResSpectrum spectrum(kSampleRate, kRefFFTSize);
+    Feed(spectrum, x);
+    float band = ThirdOctave(spectrum, 40.0f, freqs, mags);
+    EXPECT_GT(band, ThirdOctave(spectrum, 25.0f, freqs, mags) + 30.0f);
+    EXPECT_GT(band, ThirdOctave(spectrum, 63.0f, freqs, mags) + 30.0f);
+    EXPECT_GT(band, ThirdOctave(spectrum, 100.0f, freqs, mags) + 40.0f);
+}
+
+TEST(MultiResSpectrumTest, HighSineDoesNotAliasIntoLowBands) {
+    std::vector<float> x = Sine(kSampleRate * 8, 5000.0f, 0.5f);
+    std::vector<float> freqs, mags;
+    ReferenceSpectrum(x, freqs, mags);
+
+    MagdaMultiResSpectrum spectrum(kSampleRate, kRefFFTSize);
+    Feed(spectrum, x);
+    float tone = ThirdOctave(spectrum, 5000.0f, freqs, mags);
+    for (float centre : {20.0f, 50.0f, 100.0f, 200.0f}) {
+        EXPECT_LT(ThirdOctave(spectrum, centre, freqs, mags), tone - 60.0f) << "band " << centre;
+    }
+}
+
+TEST(MultiResSpectrumTest, ShortInputFallsBackToFinerLevels) {
+    // One second is shorter than the deepest level's window
+    std::vector<float> x = Noise(kSampleRate);
+    std::vector<float> freqs, mags;
+    ReferenceSpectrum(x, freqs, mags);
+
+    MagdaMultiResSpectrum spectrum(kSampleRate, kRefFFTSize);
+    Feed(spectrum, x);
+    float low = ThirdOctave(spectrum, 20.0f, freqs, mags);
+    EXPECT_GT(low, -96.0f);
+    EXPECT_NEAR(low, ThirdOctave(spectrum, 1000.0f, freqs, mags), 6.0f);
+}
+
+TEST(MultiResSpectrumTest, LargeReferenceNeedsNoLevels) {
+    // A reference FFT this long already resolves 20 Hz on its own
+    MagdaMultiResSpectrum spectrum(kSampleRate, 1 << 20);
+    EXPECT_EQ(spectrum.GetNumLevels(), 0);
+}
@@ -0,0 +1,170 @@
+/**
+ * Unit tests for the spectral-flux onset detector
+ *
+ * Feeds STFT windows of synthetic hits with known start times and attack
+ * ramps through the detector.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "magda_onsets.h"
+#include "magda_stft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const int kSampleRate = 44100;
+static const int kFFTSize = 4096;
+static const int kHopSize = 2048;
+
+static void Analyze(const std::vector<float> &signal, MagdaOnsetDetector &detector) {
+    MagdaSTFT stft(kFFTSize, kHopSize, 1);
+    stft.SetWindowCallback([&detector](const float *samples, const float *magnitudes) {
+        detector.AddWindow(samples, magnitudes);
+    });
+    stft.Process(signal.data(), (int)signal.size());
+    stft.Flush();
+    detector.Finish();
+}
+
+// Noisy tone hits with a linear attack ramp and exponential decay
+static void AddHit(std::vector<float> &signal, double time, float attackSeconds,
+                   float gain = 0.5f) {
+    unsigned int state = 1234u + (unsigned int)(time * 1000);
+    int start = (int)(time * kSampleRate);
+    int attack = (int)(attackSeconds * kSampleRate);
+    for (int i = 0; i < kSampleRate / 5 && start + i < (int)signal.size(); i++) {
+        state = state * 1664525u + 1013904223u;
+        float noise = (state >> 8) / 8388608.0f - 1.0f;
+        float env = i < attack ? (float)i / attack : expf(-(float)(i - attack) / 4000.0f);
+        float tone = sinf(2.0f * (float)M_PI * 200.0f * i / kSampleRate);
+        signal[start + i] += gain * env * (0.5f * noise + tone);
+    }
+}
+
+TEST(OnsetDetectorTest, FindsHitsAtTheirStartTimes) {
+    const double times[] = {0.5, 1.0, 1.25, 2.0, 2.6, 3.1};
+    std::vector<float> signal(kSampleRate * 4, 0.0f);
+    for (double t : times) {
+        AddHit(signal, t, 0.002f);
+    }
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize);
+    Analyze(signal, detector);
+
+    const std::vector<Onset> &onsets = detector.GetOnsets();
+    ASSERT_EQ(onsets.size(), 6u);
+    float strongest = 0.0f;
+    for (size_t i = 0; i < onsets.size(); i++) {
+        EXPECT_NEAR(onsets[i].time, times[i], 0.01);
+        EXPECT_GT(onsets[i].strength, 0.0f);
+        EXPECT_LE(onsets[i].strength, 1.0f);
+        strongest = std::max(strongest, onsets[i].strength);
+    }
+    EXPECT_FLOAT_EQ(strongest, 1.0f);
+    EXPECT_GT(detector.GetOnsetFluxShare(), 0.5f);
+}
+
+TEST(OnsetDetectorTest, MeasuresAttackTime) {
+    std::vector<float> signal(kSampleRate * 3, 0.0f);
+    AddHit(signal, 0.5, 0.05f);
+    AddHit(signal, 1.5, 0.05f);
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize);
+    Analyze(signal, detector);
+
+    // 10% to 90% of a 50 ms linear ramp is 40 ms
+    ASSERT_EQ(detector.GetOnsets().size(), 2u);
+    EXPECT_NEAR(detector.GetMedianAttack(), 0.04f, 0.008f);
+}
+
+TEST(OnsetDetectorTest, SteadyToneHasOneOnset) {
+    std::vector<float> signal(kSampleRate * 3, 0.0f);
+    int start = kSampleRate / 2;
+    for (int i = start; i < (int)signal.size(); i++) {
+        signal[i] = 0.5f * sinf(2.0f * (float)M_PI * 1000.0f * i / kSampleRate);
+    }
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize);
+    Analyze(signal, detector);
+
+    ASSERT_EQ(detector.GetOnsets().size(), 1u);
+    EXPECT_NEAR(detector.GetOnsets()[0].time, 0.5, 0.01);
+}
+
+TEST(OnsetDetectorTest, SilenceHasNoOnsets) {
+    std::vector<float> signal(kSampleRate * 2, 0.0f);
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize);
+    Analyze(signal, detector);
+
+    EXPECT_TRUE(detector.GetOnsets().empty());
+    EXPECT_EQ(detector.GetTotalOnsets(), 0);
+    EXPECT_FLOAT_EQ(detector.GetMedianAttack(), 0.0f);
+}
+
+TEST(OnsetDetectorTest, CapsStoredOnsets) {
+    std::vector<float> signal(kSampleRate * 4, 0.0f);
+    for (int i = 0; i < 7; i++) {
+        AddHit(signal, 0.25 + i * 0.5, 0.002f);
+    }
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize, 3);
+    Analyze(signal, detector);
+
+    EXPECT_EQ(detector.GetOnsets().size(), 3u);
+    EXPECT_EQ(detector.GetTotalOnsets(), 7);
+}
+
+TEST(OnsetDetectorTest, CapKeepsTheStrongestOnsets) {
+    // A busy quiet intro, then two loud hits
+    std::vector<float> signal(kSampleRate * 4, 0.0f);
+    for (int i = 0; i < 5; i++) {
+        AddHit(signal, 0.25 + i * 0.5, 0.002f, 0.05f);
+    }
+    AddHit(signal, 2.75, 0.002f);
+    AddHit(signal, 3.25, 0.002f);
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize, 2);
+    Analyze(signal, detector);
+
+    const std::vector<Onset> &onsets = detector.GetOnsets();
+    ASSERT_EQ(onsets.size(), 2u);
+    EXPECT_NEAR(onsets[0].time, 2.75, 0.01);
+    EXPECT_NEAR(onsets[1].time, 3.25, 0.01);
+    EXPECT_EQ(detector.GetTotalOnsets(), 7);
+}
+
+TEST(OnsetDetectorTest, OnsetsSoFarDontEndDetection) {
+    std::vector<float> signal(kSampleRate * 4, 0.0f);
+    AddHit(signal, 0.5, 0.002f, 0.1f);
+    AddHit(signal, 1.0, 0.002f);
+    AddHit(signal, 3.0, 0.002f);
+
+    MagdaOnsetDetector detector(kSampleRate, kFFTSize, kHopSize);
+    MagdaSTFT stft(kFFTSize, kHopSize, 1);
+    stft.SetWindowCallback([&detector](const float *samples, const float *magnitudes) {
+        detector.AddWindow(samples, magnitudes);
+    });
+    int half = kSampleRate * 2;
+    stft.Process(signal.data(), half);
+    stft.Flush();
+
+    // Time order, the loud hit is the reference strength
+    std::vector<Onset> soFar = detector.GetOnsetsSoFar();
+    ASSERT_EQ(soFar.size(), 2u);
+    EXPECT_NEAR(soFar[0].time, 0.5, 0.01);
+    EXPECT_LT(soFar[0].strength, 1.0f);
+    EXPECT_FLOAT_EQ(soFar[1].strength, 1.0f);
+
+    stft.Process(signal.data() + half, (int)signal.size() - half);
+    stft.Flush();
+    detector.Finish();
+    ASSERT_EQ(detector.GetOnsets().size(), 3u);
+    EXPECT_NEAR(detector.GetOnsets()[2].time, 3.0, 0.01);
+    EXPECT_EQ(detector.GetOnsetsSoFar().size(), 3u);
+}
@@ -0,0 +1,278 @@
+/**
+ * Unit tests for memory-mapped WAV/AIFF decoding
+ *
+ * Covers header parsing and sample decoding for the supported encodings,
+ * rejection of unsupported files, and the item window (offset, loop,
+ * playrate, gain) applied by MagdaPCMFileSource.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "magda_pcm_file.h"
+
+static void PutLE(std::vector<unsigned char> &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+static void PutBE(std::vector<unsigned char> &out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        out.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+static void PutTag(std::vector<unsigned char> &out, const char *tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+// WAV with the given format tag (1 = PCM, 3 = float), optionally as
+// WAVE_FORMAT_EXTENSIBLE, and an odd-sized chunk before the data
+static std::vector<unsigned char> MakeWAV(int formatTag, int bits, int channels, int rate,
+                                          const std::vector<unsigned char> &samples,
+                                          bool extensible = false) {
+    std::vector<unsigned char> fmt;
+    PutLE(fmt, extensible ? 0xFFFE : formatTag, 2);
+    PutLE(fmt, channels, 2);
+    PutLE(fmt, rate, 4);
+    PutLE(fmt, rate * channels * bits / 8, 4);
+    PutLE(fmt, channels * bits / 8, 2);
+    PutLE(fmt, bits, 2);
+    if (extensible) {
+        PutLE(fmt, 22, 2);
+        PutLE(fmt, bits, 2);
+        PutLE(fmt, 3, 4);
+        PutLE(fmt, formatTag, 2);
+        fmt.resize(fmt.size() + 14, 0);
+    }
+
+    std::vector<unsigned char> body;
+    PutTag(body, "WAVE");
+    PutTag(body, "fmt ");
+    PutLE(body, fmt.size(), 4);
+    body.insert(body.end(), fmt.begin(), fmt.end());
+    PutTag(body, "LIST");
+    PutLE(body, 3, 4);
+    body.insert(body.end(), {'a', 'b', 'c', 0});
+    PutTag(body, "data");
+    PutLE(body, samples.size(), 4);
+    body.insert(body.end(), samples.begin(), samples.end());
+
+    std::vector<unsigned char> file;
+    PutTag(file, "RIFF");
+    PutLE(file, body.size(), 4);
+    file.insert(file.end(), body.begin(), body.end());
+    return file;
+}
+
+// AIFF (or AIFC with a compression tag) at 44100 Hz
+static std::vector<unsigned char> MakeAIFF(int bits, int channels, long long frames,
+                                           const std::vector<unsigned char> &samples,
+                                           const char *compression = nullptr) {
+    std::vector<unsigned char> comm;
+    PutBE(comm, channels, 2);
+    PutBE(comm, frames, 4);
+    PutBE(comm, bits, 2);
+    // 44100 as 80-bit extended
+    const unsigned char rate[10] = {0x40, 0x0E, 0xAC, 0x44, 0, 0, 0, 0, 0, 0};
+    comm.insert(comm.end(), rate, rate + 10);
+    if (compression) {
+        PutTag(comm, compression);
+        comm.insert(comm.end(), {0, 0});
+    }
+
+    std::vector<unsigned char> body;
+    PutTag(body, compression ? "AIFC" : "AIFF");
+    PutTag(body, "COMM");
+    PutBE(body, comm.size(), 4);
+    body.insert(body.end(), comm.begin(), comm.end());
+    PutTag(body, "SSND");
+    PutBE(body, samples.size() + 8, 4);
+    PutBE(body, 0, 4);
+    PutBE(body, 0, 4);
+    body.insert(body.end(), samples.begin(), samples.end());
+
+    std::vector<unsigned char> file;
+    PutTag(file, "FORM");
+    PutBE(file, body.size(), 4);
+    file.insert(file.end(), body.begin(), body.end());
+    return file;
+}
+
+static std::string WriteTemp(const std::vector<unsigned char> &data) {
+    char path[] = "/tmp/magda_pcm_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return std::string();
+    }
+    EXPECT_EQ(write(fd, data.data(), data.size()), (ssize_t)data.size());
+    close(fd);
+    return path;
+}
+
+static std::unique_ptr<MagdaPCMFile> OpenTemp(const std::vector<unsigned char> &data) {
+    std::string path = WriteTemp(data);
+    std::unique_ptr<MagdaPCMFile> file(new MagdaPCMFile());
+    WDL_FastString error;
+    bool ok = file->Open(path.c_str(), error);
+    unlink(path.c_str());
+    return ok ? std::move(file) : nullptr;
+}
+
+TEST(PCMFileTest, DecodesWAV16Stereo) {
+    std::vector<unsigned char> samples;
+    PutLE(samples, 16384, 2);           // L0 = 0.5
+    PutLE(samples, (uint16_t)-32768, 2); // R0 = -1
+    PutLE(samples, 0, 2);
+    PutLE(samples, 8192, 2);
+    auto file = OpenTemp(MakeWAV(1, 16, 2, 48000, samples));
+    ASSERT_TRUE(file);
+    EXPECT_EQ(file->GetSampleRate(), 48000);
+    EXPECT_EQ(file->GetChannels(), 2);
+    EXPECT_EQ(file->GetNumFrames(), 2);
+
+    float out[4];
+    file->ReadFrames(0, 2, out, false);
+    EXPECT_FLOAT_EQ(out[0], 0.5f);
+    EXPECT_FLOAT_EQ(out[1], -1.0f);
+    EXPECT_FLOAT_EQ(out[2], 0.0f);
+    EXPECT_FLOAT_EQ(out[3], 0.25f);
+}
+
+TEST(PCMFileTest, DecodesWAV24AndExtensibleFloat) {
+    std::vector<unsigned char> samples24;
+    PutLE(samples24, 0x400000, 3); // 0.5
+    PutLE(samples24, 0xC00000, 3); // -0.5
+    auto file24 = OpenTemp(MakeWAV(1, 24, 1, 44100, samples24));
+    ASSERT_TRUE(file24);
+    EXPECT_EQ(file24->GetFormat(), PCM_FORMAT_INT24);
+    float out[2];
+    file24->ReadFrames(0, 2, out, false);
+    EXPECT_FLOAT_EQ(out[0], 0.5f);
+    EXPECT_FLOAT_EQ(out[1], -0.5f);
+
+    std::vector<unsigned char> samplesFloat;
+    float values[2] = {0.125f, -0.75f};
+    uint32_t raw[2];
+    memcpy(raw, values, sizeof(raw));
+    PutLE(samplesFloat, raw[0], 4);
+    PutLE(samplesFloat, raw[1], 4);
+    auto fileFloat = OpenTemp(MakeWAV(3, 32, 1, 44100, samplesFloat, true));
+    ASSERT_TRUE(fileFloat);
+    EXPECT_EQ(fileFloat->GetFormat(), PCM_FORMAT_FLOAT32);
+    fileFloat->ReadFrames(0, 2, out, false);
+    EXPECT_FLOAT_EQ(out[0], 0.125f);
+    EXPECT_FLOAT_EQ(out[1], -0.75f);
+}
+
+TEST(PCMFileTest, DecodesAIFFAndLittleEndianAIFC) {
+    std::vector<unsigned char> samples;
+    PutBE(samples, 16384, 2);
+    PutBE(samples, (uint16_t)-16384, 2);
+    auto file = OpenTemp(MakeAIFF(16, 1, 2, samples));
+    ASSERT_TRUE(file);
+    EXPECT_EQ(file->GetSampleRate(), 44100);
+    EXPECT_EQ(file->GetNumFrames(), 2);
+    float out[2];
+    file->ReadFrames(0, 2, out, false);
+    EXPECT_FLOAT_EQ(out[0], 0.5f);
+    EXPECT_FLOAT_EQ(out[1], -0.5f);
+
+    std::vector<unsigned char> sowt;
+    PutLE(sowt, 0x200000, 3); // 0.25
+    PutLE(sowt, 0x600000, 3); // 0.75
+    auto fileSowt = OpenTemp(MakeAIFF(24, 2, 1, sowt, "sowt"));
+    ASSERT_TRUE(fileSowt);
+    fileSowt->ReadFrames(0, 1, out, false);
+    EXPECT_FLOAT_EQ(out[0], 0.25f);
+    EXPECT_FLOAT_EQ(out[1], 0.75f);
+}
+
+TEST(PCMFileTest, RejectsUnsupportedFiles) {
+    std::vector<unsigned char> samples(4, 0x80);
+    EXPECT_FALSE(OpenTemp(MakeWAV(1, 8, 1, 44100, samples)));
+    EXPECT_FALSE(OpenTemp(MakeWAV(2, 16, 1, 44100, samples))); // ADPCM
+    EXPECT_FALSE(OpenTemp(MakeAIFF(16, 1, 2, samples, "ima4")));
+    std::vector<unsigned char> text = {'I', 'D', '3', 4, 0, 0, 0, 0, 0, 0, 0, 0};
+    EXPECT_FALSE(OpenTemp(text));
+}
+
+TEST(PCMFileTest, TruncatedDataIsClampedToTheFile) {
+    std::vector<unsigned char> samples;
+    PutLE(samples, 16384, 2);
+    PutLE(samples, 16384, 2);
+    std::vector<unsigned char> wav = MakeWAV(1, 16, 1, 44100, samples);
+    // Claim far more data than the file holds, as while it is being written
+    wav[wav.size() - 8] = 0xFF;
+    wav[wav.size() - 7] = 0xFF;
+    auto file = OpenTemp(wav);
+    ASSERT_TRUE(file);
+    EXPECT_EQ(file->GetNumFrames(), 2);
+}
+
+// Mono ramp: frame i = i / 256
+static std::unique_ptr<MagdaPCMFile> MakeRamp(int frames) {
+    std::vector<unsigned char> samples;
+    for (int i = 0; i < frames; i++) {
+        PutLE(samples, (uint16_t)(i * 128), 2);
+    }
+    return OpenTemp(MakeWAV(1, 16, 1, 1000, samples));
+}
+
+TEST(PCMFileSourceTest, AppliesOffsetLengthAndGain) {
+    auto file = MakeRamp(100);
+    ASSERT_TRUE(file);
+    // 10 ms in, 50 ms long, at half volume
+    MagdaPCMFileSource source(std::move(file), 0.010, 0.050, 1.0, 0.5f, false);
+    EXPECT_FALSE(source.NeedsMainThread());
+    EXPECT_EQ(source.GetTotalFrames(), 50);
+
+    std::vector<float> out(64);
+    EXPECT_EQ(source.ReadBlock(out.data(), 30), 30);
+    EXPECT_FLOAT_EQ(out[0], 10 / 256.0f * 0.5f);
+    EXPECT_EQ(source.ReadBlock(out.data(), 30), 20);
+    EXPECT_FLOAT_EQ(out[19], 59 / 256.0f * 0.5f);
+    EXPECT_EQ(source.ReadBlock(out.data(), 30), 0);
+    EXPECT_TRUE(source.HadAudio());
+}
+
+TEST(PCMFileSourceTest, LoopsOrPadsPastTheEnd) {
+    std::vector<float> out(8);
+    MagdaPCMFileSource padded(MakeRamp(4), -0.002, 0.008, 1.0, 1.0f, false);
+    ASSERT_EQ(padded.ReadBlock(out.data(), 8), 8);
+    float expectedPadded[8] = {0, 0, 0, 1 / 256.0f, 2 / 256.0f, 3 / 256.0f, 0, 0};
+    for (int i = 0; i < 8; i++) {
+        EXPECT_FLOAT_EQ(out[i], expectedPadded[i]);
+    }
+
+    MagdaPCMFileSource looped(MakeRamp(4), 0.0, 0.008, 1.0, 1.0f, true);
+    ASSERT_EQ(looped.ReadBlock(out.data(), 8), 8);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_FLOAT_EQ(out[i], (i % 4) / 256.0f);
+    }
+}
+
+TEST(PCMFileSourceTest, PlayrateResamplesByInterpolation) {
+    // Double speed: every other source frame
+    MagdaPCMFileSource fast(MakeRamp(100), 0.0, 0.020, 2.0, 1.0f, false);
+    std::vector<float> out(20);
+    ASSERT_EQ(fast.ReadBlock(out.data(), 20), 20);
+    for (int i = 0; i < 20; i++) {
+        EXPECT_NEAR(out[i], (2 * i) / 256.0f, 1e-6f);
+    }
+
+    // Half speed: midpoints in between, across block boundaries
+    MagdaPCMFileSource slow(MakeRamp(100), 0.0, 0.020, 0.5, 1.0f, false);
+    for (int block = 0; block < 4; block++) {
+        ASSERT_EQ(slow.ReadBlock(out.data(), 5), 5);
+        for (int i = 0; i < 5; i++) {
+            EXPECT_NEAR(out[i], (block * 5 + i) * 0.5f / 256.0f, 1e-6f);
+        }
+    }
+}
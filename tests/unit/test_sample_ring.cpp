@@ -0,0 +1,85 @@
+/**
+ * Unit tests for the single-producer/single-consumer sample ring
+ *
+ * Covers capacity rounding, wrap-around, all-or-nothing writes and a
+ * producer and consumer running on separate threads.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "magda_sample_ring.h"
+
+TEST(SampleRingTest, CapacityRoundsUpToPowerOfTwo) {
+    MagdaSampleRing ring(100);
+    EXPECT_EQ(ring.GetCapacity(), 128u);
+    EXPECT_EQ(ring.GetReadAvailable(), 0u);
+    EXPECT_EQ(ring.GetWriteAvailable(), 128u);
+}
+
+TEST(SampleRingTest, WrapsAroundTheEnd) {
+    MagdaSampleRing ring(8);
+    std::vector<float> out(8);
+    float first[6] = {1, 2, 3, 4, 5, 6};
+    ASSERT_TRUE(ring.Write(first, 6));
+    EXPECT_EQ(ring.Read(out.data(), 4), 4u);
+
+    // Starts at slot 6 and wraps to the front
+    float second[5] = {7, 8, 9, 10, 11};
+    ASSERT_TRUE(ring.Write(second, 5));
+    EXPECT_EQ(ring.GetReadAvailable(), 7u);
+    EXPECT_EQ(ring.Read(out.data(), 8), 7u);
+    float expected[7] = {5, 6, 7, 8, 9, 10, 11};
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(out[i], expected[i]);
+    }
+    EXPECT_EQ(ring.Read(out.data(), 8), 0u);
+}
+
+TEST(SampleRingTest, WritesAreAllOrNothing) {
+    MagdaSampleRing ring(8);
+    std::vector<float> data(6, 1.0f);
+    ASSERT_TRUE(ring.Write(data.data(), 6));
+    EXPECT_FALSE(ring.Write(data.data(), 3));
+    EXPECT_EQ(ring.GetReadAvailable(), 6u);
+    EXPECT_TRUE(ring.Write(data.data(), 2));
+    EXPECT_EQ(ring.GetWriteAvailable(), 0u);
+}
+
+TEST(SampleRingTest, ThreadedProducerAndConsumerLoseNothing) {
+    const int kBlock = 48;
+    const int kBlocks = 2000;
+    MagdaSampleRing ring(256);
+
+    std::thread producer([&]() {
+        std::vector<float> block(kBlock);
+        for (int b = 0; b < kBlocks; b++) {
+            for (int i = 0; i < kBlock; i++) {
+                block[i] = (float)(b * kBlock + i);
+            }
+            while (!ring.Write(block.data(), kBlock)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<float> out(kBlock);
+    long long expected = 0;
+    bool inOrder = true;
+    while (expected < (long long)kBlock * kBlocks) {
+        size_t count = ring.Read(out.data(), out.size());
+        if (count == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            inOrder = inOrder && out[i] == (float)expected;
+            expected++;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(ring.GetReadAvailable(), 0u);
+}
@@ -0,0 +1,99 @@
+/**
+ * Unit tests for the per-band stereo image and the low-end mono check
+ *
+ * Runs stereo test signals through the same path as the analysis stream
+ * (fused time-domain kernel, side-channel STFT) and checks the low-end
+ * correlation and mono compatibility for hard-panned, out-of-phase and
+ * in-phase bass.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_dsp_kernels.h"
+#include "magda_stereo_image.h"
+
+static const int kSampleRate = 48000;
+static const float kPi = 3.14159265358979f;
+
+// Two seconds of a low sine, gainL / gainR on the left / right channel
+static std::vector<float> LowSine(float gainL, float gainR, float hz = 80.0f) {
+    int frames = kSampleRate * 2;
+    std::vector<float> interleaved(frames * 2);
+    for (int n = 0; n < frames; n++) {
+        float x = 0.5f * sinf(2.0f * kPi * hz * n / kSampleRate);
+        interleaved[n * 2] = gainL * x;
+        interleaved[n * 2 + 1] = gainR * x;
+    }
+    return interleaved;
+}
+
+static void Analyze(const std::vector<float> &interleaved, std::vector<StereoBand> &bands,
+                    StereoAnalysis &stereo) {
+    int frames = (int)(interleaved.size() / 2);
+    std::vector<float> mono(frames), side(frames);
+    TimeDomainStats stats;
+    MagdaDSPKernels::AccumulateTimeDomain(interleaved.data(), frames, 2, stats, mono.data(),
+                                          nullptr, side.data());
+
+    MagdaSTFT stft(4096, 2048, 1);
+    stft.SetSilenceGate(-70.0f);
+    stft.EnableSideChannel();
+    stft.Process(mono.data(), frames, side.data());
+    stft.Flush();
+
+    stereo = StereoAnalysis();
+    MagdaStereoImage::Analyze(stft, kSampleRate, bands, stereo);
+}
+
+TEST(StereoImageTest, HardPannedBassIsUncorrelated) {
+    std::vector<StereoBand> bands;
+    StereoAnalysis stereo;
+    Analyze(LowSine(1.0f, 0.0f), bands, stereo);
+
+    EXPECT_NEAR(stereo.lowEndCorrelation, 0.0f, 0.01f);
+    EXPECT_FALSE(stereo.lowEndMonoCompatible);
+    // 60-250 Hz band: equal mid and side
+    ASSERT_EQ(bands.size(), 7u);
+    EXPECT_NEAR(bands[1].correlation, 0.0f, 0.01f);
+    EXPECT_NEAR(bands[1].width, 1.0f, 0.01f);
+}
+
+TEST(StereoImageTest, OutOfPhaseBassIsNotMonoCompatible) {
+    std::vector<StereoBand> bands;
+    StereoAnalysis stereo;
+    Analyze(LowSine(1.0f, -1.0f), bands, stereo);
+
+    EXPECT_NEAR(stereo.lowEndCorrelation, -1.0f, 0.01f);
+    EXPECT_FALSE(stereo.lowEndMonoCompatible);
+    ASSERT_EQ(bands.size(), 7u);
+    EXPECT_LT(bands[1].midLevel, bands[1].sideLevel - 60.0f);
+}
+
+TEST(StereoImageTest, InPhaseBassIsMonoCompatible) {
+    std::vector<StereoBand> bands;
+    StereoAnalysis stereo;
+    // Panned a little to the left, still in phase
+    Analyze(LowSine(1.0f, 0.7f), bands, stereo);
+
+    EXPECT_NEAR(stereo.lowEndCorrelation, 1.0f, 0.01f);
+    EXPECT_TRUE(stereo.lowEndMonoCompatible);
+    ASSERT_EQ(bands.size(), 7u);
+    EXPECT_LT(bands[1].width, 0.2f);
+}
+
+TEST(StereoImageTest, InaudibleLowEndCountsAsMonoCompatible) {
+    std::vector<StereoBand> bands;
+    StereoAnalysis stereo;
+    // Out of phase but far below the floor, with audible in-phase highs
+    std::vector<float> signal = LowSine(1e-4f, -1e-4f);
+    std::vector<float> highs = LowSine(1.0f, 1.0f, 3000.0f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        signal[i] += highs[i];
+    }
+    Analyze(signal, bands, stereo);
+
+    EXPECT_LT(stereo.lowEndCorrelation, 0.0f);
+    EXPECT_TRUE(stereo.lowEndMonoCompatible);
+}
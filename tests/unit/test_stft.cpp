@@ -0,0 +1,200 @@
+/**
+ * Unit tests for the multi-threaded STFT accumulator
+ *
+ * Checks that magnitude sums don't depend on thread count or block size,
+ * that the silence gate skips only the quiet windows, and the side channel
+ * mid/side/cross sums.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "magda_fft.h"
+#include "magda_stft.h"
+
+static std::vector<float> TestSignal(int frames) {
+    std::vector<float> x(frames);
+    unsigned int seed = 777;
+    for (int n = 0; n < frames; n++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 8) & 0xffff) / 65535.0f - 0.5f;
+        x[n] = 0.5f * sinf(0.031f * n) + 0.1f * noise;
+    }
+    return x;
+}
+
+static MagdaSTFT RunSTFT(const std::vector<float>& x, int threads, int blockFrames) {
+    MagdaSTFT stft(1024, 512, threads);
+    for (size_t pos = 0; pos < x.size(); pos += blockFrames) {
+        int n = (int)std::min((size_t)blockFrames, x.size() - pos);
+        stft.Process(x.data() + pos, n);
+    }
+    stft.Flush();
+    return stft;
+}
+
+TEST(MagdaSTFTTest, ResultDoesNotDependOnThreadCount) {
+    std::vector<float> x = TestSignal(200000);
+    MagdaSTFT single = RunSTFT(x, 1, 16384);
+    for (int threads : {0, 2, 3, 16}) {
+        MagdaSTFT multi = RunSTFT(x, threads, 16384);
+        ASSERT_EQ(multi.GetNumWindows(), single.GetNumWindows());
+        for (int i = 0; i < single.GetNumBins(); i++) {
+            ASSERT_EQ(multi.GetMagnitudeSums()[i], single.GetMagnitudeSums()[i])
+                << "threads=" << threads << " bin=" << i;
+        }
+    }
+}
+
+TEST(MagdaSTFTTest, ResultDoesNotDependOnBlockSize) {
+    std::vector<float> x = TestSignal(50000);
+    MagdaSTFT a = RunSTFT(x, 0, 100);
+    MagdaSTFT b = RunSTFT(x, 0, 50000);
+    ASSERT_EQ(a.GetNumWindows(), b.GetNumWindows());
+    for (int i = 0; i < a.GetNumBins(); i++) {
+        ASSERT_EQ(a.GetMagnitudeSums()[i], b.GetMagnitudeSums()[i]);
+    }
+}
+
+TEST(MagdaSTFTTest, MatchesSerialWindowLoop) {
+    std::vector<float> x = TestSignal(20000);
+    MagdaSTFT stft = RunSTFT(x, 0, 4096);
+
+    auto plan = MagdaFFT::GetPlan(1024);
+    std::vector<float> windowed(1024), re(513), im(513), work(plan->GetWorkSize());
+    std::vector<double> sums(513, 0.0);
+    long long windows = 0;
+    for (size_t start = 0; start + 1024 <= x.size(); start += 512) {
+        for (int i = 0; i < 1024; i++) {
+            windowed[i] = x[start + i] * plan->GetWindow()[i];
+        }
+        plan->Forward(windowed.data(), re.data(), im.data(), work.data());
+        for (int k = 0; k < 513; k++) {
+            sums[k] += sqrtf(re[k] * re[k] + im[k] * im[k]);
+        }
+        windows++;
+    }
+
+    ASSERT_EQ(stft.GetNumWindows(), windows);
+    for (int k = 0; k < 513; k++) {
+        EXPECT_EQ(stft.GetMagnitudeSums()[k], sums[k]);
+    }
+}
+
+TEST(MagdaSTFTTest, ShortInputHasNoWindows) {
+    std::vector<float> x = TestSignal(1000);
+    MagdaSTFT stft = RunSTFT(x, 0, 1000);
+    EXPECT_EQ(stft.GetNumWindows(), 0);
+}
+
+TEST(MagdaSTFTTest, SilenceGateSkipsQuietWindows) {
+    // Signal, then silence, then signal again
+    std::vector<float> x = TestSignal(60000);
+    std::fill(x.begin() + 20000, x.begin() + 40000, 0.0f);
+
+    MagdaSTFT gated(1024, 512, 0);
+    int callbacks = 0;
+    gated.SetWindowCallback([&](const float*, const float*) { callbacks++; });
+    gated.SetSilenceGate(-70.0f);
+    gated.Process(x.data(), (int)x.size());
+    gated.Flush();
+
+    // Windows fully inside the silent stretch: starts 20480..38912
+    long long silent = (38912 - 20480) / 512 + 1;
+    EXPECT_EQ(gated.GetNumWindows(), (long long)callbacks);
+    EXPECT_EQ(gated.GetNumActiveWindows(), gated.GetNumWindows() - silent);
+
+    // Active windows are analyzed exactly as without a gate
+    MagdaSTFT ungated = RunSTFT(x, 0, (int)x.size());
+    ASSERT_EQ(ungated.GetNumWindows(), gated.GetNumWindows());
+    EXPECT_EQ(ungated.GetNumActiveWindows(), ungated.GetNumWindows());
+    for (int i = 0; i < gated.GetNumBins(); i++) {
+        EXPECT_EQ(gated.GetMagnitudeSums()[i], ungated.GetMagnitudeSums()[i]);
+    }
+}
+
+TEST(MagdaSTFTTest, SilenceGateKeepsLoudWindows) {
+    std::vector<float> x = TestSignal(50000);
+    MagdaSTFT gated(1024, 512, 0);
+    gated.SetSilenceGate(-70.0f);
+    gated.Process(x.data(), (int)x.size());
+    gated.Flush();
+    EXPECT_EQ(gated.GetNumActiveWindows(), gated.GetNumWindows());
+}
+
+TEST(MagdaSTFTTest, SilenceGateThresholdIsWindowRMS) {
+    // Constant -60 dBFS: passes a -70 dB gate, not a -50 dB one
+    std::vector<float> x(20000, 0.001f);
+    MagdaSTFT low(1024, 512, 0);
+    low.SetSilenceGate(-70.0f);
+    low.Process(x.data(), (int)x.size());
+    low.Flush();
+    EXPECT_EQ(low.GetNumActiveWindows(), low.GetNumWindows());
+
+    MagdaSTFT high(1024, 512, 0);
+    high.SetSilenceGate(-50.0f);
+    high.Process(x.data(), (int)x.size());
+    high.Flush();
+    EXPECT_GT(high.GetNumWindows(), 0);
+    EXPECT_EQ(high.GetNumActiveWindows(), 0);
+    for (int i = 0; i < high.GetNumBins(); i++) {
+        EXPECT_EQ(high.GetMagnitudeSums()[i], 0.0);
+    }
+}
+
+TEST(MagdaSTFTTest, SideChannelSums) {
+    std::vector<float> mid = TestSignal(30000);
+    std::vector<float> negated(mid.size());
+    for (size_t i = 0; i < mid.size(); i++) {
+        negated[i] = -mid[i];
+    }
+
+    // Side = -mid (left channel silent): |S|^2 = |M|^2 and Re(M S*) = -|M|^2
+    MagdaSTFT stft(1024, 512, 0);
+    stft.EnableSideChannel();
+    double magnitudeSquares = 0.0;
+    stft.SetWindowCallback([&](const float*, const float* magnitudes) {
+        for (int k = 0; k < 513; k++) {
+            magnitudeSquares += (double)magnitudes[k] * magnitudes[k];
+        }
+    });
+    stft.Process(mid.data(), (int)mid.size(), negated.data());
+    stft.Flush();
+
+    ASSERT_TRUE(stft.HasSideChannel());
+    double midTotal = 0.0;
+    for (int k = 0; k < stft.GetNumBins(); k++) {
+        EXPECT_EQ(stft.GetSidePowerSums()[k], stft.GetMidPowerSums()[k]);
+        EXPECT_EQ(stft.GetCrossSums()[k], -stft.GetMidPowerSums()[k]);
+        midTotal += stft.GetMidPowerSums()[k];
+    }
+    EXPECT_NEAR(midTotal, magnitudeSquares, 1e-4 * magnitudeSquares);
+}
+
+TEST(MagdaSTFTTest, SideChannelDefaultsToSilence) {
+    std::vector<float> mid = TestSignal(20000);
+    MagdaSTFT stft(1024, 512, 0);
+    stft.EnableSideChannel();
+    stft.Process(mid.data(), (int)mid.size());
+    stft.Flush();
+    for (int k = 0; k < stft.GetNumBins(); k++) {
+        EXPECT_EQ(stft.GetSidePowerSums()[k], 0.0);
+        EXPECT_EQ(stft.GetCrossSums()[k], 0.0);
+        EXPECT_GE(stft.GetMidPowerSums()[k], 0.0);
+    }
+}
+
+TEST(MagdaSTFTTest, SideChannelKeepsOutOfPhaseWindows) {
+    // L = -R: the downmix is silent but the gate still sees the side signal
+    std::vector<float> silent(20000, 0.0f);
+    std::vector<float> side = TestSignal(20000);
+    MagdaSTFT stft(1024, 512, 0);
+    stft.EnableSideChannel();
+    stft.SetSilenceGate(-70.0f);
+    stft.Process(silent.data(), (int)silent.size(), side.data());
+    stft.Flush();
+    EXPECT_GT(stft.GetNumWindows(), 0);
+    EXPECT_EQ(stft.GetNumActiveWindows(), stft.GetNumWindows());
+}
@@ -0,0 +1,98 @@
+/**
+ * Unit tests for the oversampled true-peak detector
+ *
+ * Uses signals whose inter-sample peaks are known analytically.
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "magda_true_peak.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static float ToDb(float linear) { return 20.0f * log10f(linear); }
+
+// Quarter-sample-rate sine shifted by 45 degrees: every sample lands at
+// +/-0.707 * amplitude while the waveform itself reaches the full amplitude
+static std::vector<float> QuarterRateSine(int frames, float amplitude) {
+    std::vector<float> x(frames);
+    for (int n = 0; n < frames; n++) {
+        x[n] = amplitude * (float)sin(M_PI / 2.0 * n + M_PI / 4.0);
+    }
+    return x;
+}
+
+TEST(MagdaTruePeakTest, FindsInterSamplePeak) {
+    std::vector<float> x = QuarterRateSine(48000, 1.0f);
+    MagdaTruePeakDetector detector(48000, 1);
+    detector.Process(x.data(), (int)x.size());
+
+    // Sample peak is -3 dBFS, the true peak is 0 dBTP
+    EXPECT_NEAR(ToDb(detector.GetTruePeak()), 0.0f, 0.5f);
+}
+
+TEST(MagdaTruePeakTest, HigherOversamplingAlsoFindsPeak) {
+    std::vector<float> x = QuarterRateSine(48000, 0.5f);
+    MagdaTruePeakDetector detector(48000, 1, 8);
+    detector.Process(x.data(), (int)x.size());
+
+    EXPECT_EQ(detector.GetOversampling(), 8);
+    EXPECT_NEAR(ToDb(detector.GetTruePeak()), ToDb(0.5f), 0.5f);
+}
+
+TEST(MagdaTruePeakTest, LowFrequencyMatchesSamplePeak) {
+    std::vector<float> x(44100);
+    for (size_t n = 0; n < x.size(); n++) {
+        x[n] = 0.25f * (float)sin(2.0 * M_PI * 100.0 * n / 44100.0);
+    }
+    MagdaTruePeakDetector detector(44100, 1);
+    detector.Process(x.data(), (int)x.size());
+
+    EXPECT_NEAR(ToDb(detector.GetTruePeak()), ToDb(0.25f), 0.05f);
+    EXPECT_TRUE(detector.GetOvers().empty());
+}
+
+TEST(MagdaTruePeakTest, ReportsWhereOversHappen) {
+    // Quiet stereo signal with one hot burst on the right channel at 1.0 s
+    const int sampleRate = 48000;
+    std::vector<float> x((size_t)sampleRate * 2 * 2, 0.0f);
+    std::vector<float> burst = QuarterRateSine(sampleRate / 20, 1.0f);
+    for (size_t i = 0; i < burst.size(); i++) {
+        x[(sampleRate + i) * 2 + 1] = burst[i];
+    }
+
+    MagdaTruePeakDetector detector(sampleRate, 2, 4, -1.0f);
+    for (int pos = 0; pos < sampleRate * 2; pos += 1000) {
+        detector.Process(x.data() + (size_t)pos * 2, 1000);
+    }
+
+    std::vector<TruePeakOver> overs = detector.GetOvers();
+    ASSERT_EQ(overs.size(), 1u);
+    EXPECT_EQ(overs[0].channel, 1);
+    EXPECT_GT(overs[0].time, 0.99);
+    EXPECT_LT(overs[0].time, 1.06);
+    EXPECT_GT(overs[0].level, -1.0f);
+}
+
+TEST(MagdaTruePeakTest, KeepsOnlyTheWorstOvers) {
+    // Five bursts of increasing level, 0.5 s apart; keep the top 3
+    const int sampleRate = 48000;
+    std::vector<float> x((size_t)sampleRate * 3, 0.0f);
+    for (int b = 0; b < 5; b++) {
+        std::vector<float> burst = QuarterRateSine(480, 0.95f + 0.1f * b);
+        std::copy(burst.begin(), burst.end(), x.begin() + (size_t)(b * sampleRate / 2));
+    }
+
+    MagdaTruePeakDetector detector(sampleRate, 1, 4, -1.0f, 3);
+    detector.Process(x.data(), (int)x.size());
+
+    std::vector<TruePeakOver> overs = detector.GetOvers();
+    ASSERT_EQ(overs.size(), 3u);
+    EXPECT_GT(overs[0].level, overs[1].level);
+    EXPECT_GT(overs[1].level, overs[2].level);
+    EXPECT_NEAR(overs[0].time, 2.0, 0.02);
+}
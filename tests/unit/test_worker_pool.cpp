@@ -0,0 +1,95 @@
+/**
+ * Unit tests for the shared worker pool
+ *
+ * These tests don't depend on REAPER and can run in CI environments.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "magda_worker_pool.h"
+
+TEST(MagdaWorkerPoolTest, RunsEveryIndexOnce) {
+    MagdaWorkerPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.ParallelFor(1000, 0, [&](int i) { hits[i]++; });
+    for (auto& h : hits) {
+        EXPECT_EQ(h.load(), 1);
+    }
+}
+
+TEST(MagdaWorkerPoolTest, RespectsThreadCap) {
+    MagdaWorkerPool pool(8);
+    std::atomic<int> active(0), maxActive(0);
+    pool.ParallelFor(64, 2, [&](int) {
+        int now = ++active;
+        int prev = maxActive.load();
+        while (now > prev && !maxActive.compare_exchange_weak(prev, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        --active;
+    });
+    EXPECT_LE(maxActive.load(), 2);
+}
+
+TEST(MagdaWorkerPoolTest, NestedAndConcurrentCallsComplete) {
+    MagdaWorkerPool pool(3);
+    std::atomic<int> total(0);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++) {
+        callers.emplace_back([&]() {
+            pool.ParallelFor(8, 0, [&](int) {
+                pool.ParallelFor(8, 0, [&](int) { total++; });
+            });
+        });
+    }
+    for (auto& t : callers) {
+        t.join();
+    }
+    EXPECT_EQ(total.load(), 4 * 8 * 8);
+}
+
+TEST(MagdaWorkerPoolTest, WorksWithoutWorkers) {
+    MagdaWorkerPool pool(0);
+    int sum = 0;
+    pool.ParallelFor(10, 0, [&](int i) { sum += i; });
+    EXPECT_EQ(sum, 45);
+}
+
+TEST(MagdaWorkerPoolTest, SubmittedTasksRunAndMayNest) {
+    MagdaWorkerPool pool(3);
+    std::atomic<int> total(0);
+    std::atomic<int> finished(0);
+    for (int t = 0; t < 16; t++) {
+        pool.Submit([&]() {
+            pool.ParallelFor(8, 0, [&](int) { total++; });
+            finished++;
+        });
+    }
+    for (int i = 0; i < 2000 && finished.load() < 16; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(finished.load(), 16);
+    EXPECT_EQ(total.load(), 16 * 8);
+}
+
+TEST(MagdaWorkerPoolTest, SubmitNeverRunsOnTheCaller) {
+    MagdaWorkerPool pool(0);
+    std::atomic<bool> ran(false);
+    std::atomic<bool> onCaller(true);
+    std::thread::id caller = std::this_thread::get_id();
+    pool.Submit([&]() {
+        onCaller = std::this_thread::get_id() == caller;
+        ran = true;
+    });
+    for (int i = 0; i < 2000 && !ran.load(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(ran.load());
+    EXPECT_FALSE(onCaller.load());
+}
+
+TEST(MagdaWorkerPoolTest, SharedPoolHasAWorker) {
+    EXPECT_GE(MagdaWorkerPool::Get().GetNumWorkers(), 1);
+}